@@ -39,6 +39,7 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
+#include "timers.h"
 
 /* IO library includes. */
 #include "FreeRTOS_IO.h"
@@ -55,6 +56,33 @@ is already included from FreeRTOS_IO_BSP.h. */
 /* The TEMT bit in the line status register. */
 #define uartTX_BUSY_MASK			( 1UL << 6UL )
 
+/* Called on entry to and exit from the UART interrupt, for example to time
+it.  Can be defined in FreeRTOSIOConfig.h. */
+#ifndef ioconfigUART_ISR_ENTER
+	#define ioconfigUART_ISR_ENTER()
+#endif
+
+#ifndef ioconfigUART_ISR_EXIT
+	#define ioconfigUART_ISR_EXIT()
+#endif
+
+#ifndef ioconfigDEFER_UART_RX_CHAR_QUEUE
+	#define ioconfigDEFER_UART_RX_CHAR_QUEUE	0
+#endif
+
+#if ( ioconfigDEFER_UART_RX_CHAR_QUEUE == 1 ) && ( INCLUDE_xTimerPendFunctionCall != 1 )
+	#error ioconfigDEFER_UART_RX_CHAR_QUEUE needs INCLUDE_xTimerPendFunctionCall set to 1 in FreeRTOSConfig.h.
+#endif
+
+/* The characters the interrupt can hold for the timer service task to queue.
+Must be a power of 2. */
+#define uartDEFERRED_RX_BYTES		( 64UL )
+
+/* The states of the deferred reception. */
+#define uartDEFERRED_RX_IDLE		( 0UL )	/* No call of prvQueueDeferredRxChars() is pending or running. */
+#define uartDEFERRED_RX_PENDING		( 1UL )	/* A call is waiting in the timer command queue. */
+#define uartDEFERRED_RX_RUNNING		( 2UL )	/* The timer service task is in prvQueueDeferredRxChars(). */
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -62,6 +90,24 @@ is already included from FreeRTOS_IO_BSP.h. */
  */
 static inline size_t prvFillFifoFromBuffer( LPC_UART_TypeDef * const pxUART, uint8_t **ppucBuffer, const size_t xTotalBytes );
 
+#if ioconfigDEFER_UART_RX_CHAR_QUEUE == 1
+
+	/*
+	 * Called from the interrupt in place of ioutilsRX_CHARS_INTO_QUEUE_FROM_ISR().
+	 * Empties the receive FIFO into ucDeferredRx, then pends a call of
+	 * prvQueueDeferredRxChars() unless one is already pending or running.  If
+	 * the call cannot be pended the characters are queued from the interrupt.
+	 */
+	static void prvDeferRxChars( LPC_UART_TypeDef * const pxUART, Transfer_Control_t * const pxTransferControl, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+	/*
+	 * Run by the timer service task.  Sends the characters held in
+	 * ucDeferredRx to the character queue of pvTransferControl.
+	 */
+	static void prvQueueDeferredRxChars( void *pvTransferControl, unsigned long ulUnused );
+
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* Stores the transfer control structures that are currently in use by the
@@ -72,6 +118,21 @@ static Transfer_Control_t *pxRxTransferControlStructs[ boardNUM_UARTS ] = { NULL
 /* Stores the IRQ numbers of the supported UART ports. */
 static const IRQn_Type xIRQ[] = { UART0_IRQn, UART1_IRQn, UART2_IRQn, UART3_IRQn };
 
+#if ioconfigDEFER_UART_RX_CHAR_QUEUE == 1
+
+	/* The characters taken from the receive FIFO by the interrupt and not yet
+	queued.  Only the interrupt writes ulDeferredRxHead.  ulDeferredRxTail is
+	written by the timer service task while a call is pending or running, and
+	by the interrupt otherwise, so neither needs a critical section. */
+	static uint8_t ucDeferredRx[ uartDEFERRED_RX_BYTES ];
+	static volatile uint32_t ulDeferredRxHead = 0UL, ulDeferredRxTail = 0UL;
+
+	/* One of the uartDEFERRED_RX_ states.  A burst of characters is queued by
+	one call, which keeps running until it finds no more. */
+	static volatile uint32_t ulDeferredRxState = uartDEFERRED_RX_IDLE;
+
+#endif
+
 /*-----------------------------------------------------------*/
 
 portBASE_TYPE FreeRTOS_UART_open( Peripheral_Control_t * const pxPeripheralControl )
@@ -261,17 +322,12 @@ LPC_UART_TypeDef * const pxUART = ( LPC_UART_TypeDef * const ) diGET_PERIPHERAL_
 
 				#if ioconfigUSE_UART_CIRCULAR_BUFFER_RX == 1
 				{
-					/* There is nothing to prevent multiple tasks attempting to
-					read the circular buffer at any one time.  The implementation
-					of the circular buffer uses a semaphore to indicate when new
-					data is available, and the semaphore will ensure that only the
-					highest priority task that is attempting a read will actually
-					receive bytes. */
+					/* The circular buffer is a stream buffer with a single
+					reader, so only one task at a time may read from it.  Tasks
+					that share the port must serialise their reads themselves. */
 					ioutilsRECEIVE_CHARS_FROM_CIRCULAR_BUFFER
 						(
 							pxPeripheralControl,
-							UART_IntConfig( pxUART, UART_INTCFG_RBR, DISABLE ),	/* Disable peripheral. */
-							UART_IntConfig( pxUART, UART_INTCFG_RBR, ENABLE ), 	/* Enable peripheral. */
 							( ( uint8_t * ) pvBuffer ),							/* Data destination. */
 							xBytes,												/* Bytes to read. */
 							xReturn												/* Number of bytes read. */
@@ -419,6 +475,101 @@ portBASE_TYPE xReturn = pdPASS;
 /*-----------------------------------------------------------*/
 
 
+#if ioconfigDEFER_UART_RX_CHAR_QUEUE == 1
+
+	static void prvDeferRxChars( LPC_UART_TypeDef * const pxUART, Transfer_Control_t * const pxTransferControl, portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	Character_Queue_State_t * const pxCharQueueState = ( Character_Queue_State_t * ) pxTransferControl->pvTransferState;
+	uint32_t ulHead = ulDeferredRxHead;
+	uint8_t ucChar;
+
+		/* The FIFO is always emptied, to clear the interrupt. */
+		while( ( pxUART->LSR & UART_LSR_RDR ) != 0 )
+		{
+			ucChar = pxUART->RBR;
+
+			if( ( ulHead - ulDeferredRxTail ) < uartDEFERRED_RX_BYTES )
+			{
+				ucDeferredRx[ ulHead & ( uartDEFERRED_RX_BYTES - 1UL ) ] = ucChar;
+				ulHead++;
+			}
+			else
+			{
+				/* The timer service task has not kept up.  This is an
+				overrun, as when the queue itself is full. */
+				pxCharQueueState->usErrorState = pdTRUE;
+			}
+		}
+
+		ulDeferredRxHead = ulHead;
+
+		if( ulDeferredRxState == uartDEFERRED_RX_IDLE )
+		{
+			if( xTimerPendFunctionCallFromISR( prvQueueDeferredRxChars, ( void * ) pxTransferControl, 0UL, pxHigherPriorityTaskWoken ) == pdPASS )
+			{
+				ulDeferredRxState = uartDEFERRED_RX_PENDING;
+			}
+			else
+			{
+				/* The timer command queue is full.  Nothing else would queue
+				the characters until more arrive, which may be never if they
+				end a command, so queue them here as when nothing is deferred.
+				No call is pending or running, so the tail is not in use. */
+				while( ulDeferredRxTail != ulHead )
+				{
+					if( xQueueSendToBackFromISR( pxCharQueueState->xQueue, &( ucDeferredRx[ ulDeferredRxTail & ( uartDEFERRED_RX_BYTES - 1UL ) ] ), pxHigherPriorityTaskWoken ) != pdPASS )
+					{
+						pxCharQueueState->usErrorState = pdTRUE;
+					}
+
+					ulDeferredRxTail++;
+				}
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvQueueDeferredRxChars( void *pvTransferControl, unsigned long ulUnused )
+	{
+	Character_Queue_State_t * const pxCharQueueState = ( Character_Queue_State_t * ) ( ( Transfer_Control_t * ) pvTransferControl )->pvTransferState;
+	uint32_t ulTail = ulDeferredRxTail;
+
+		( void ) ulUnused;
+
+		/* Characters that arrive from now on are left for this call. */
+		ulDeferredRxState = uartDEFERRED_RX_RUNNING;
+
+		while( ulDeferredRxState != uartDEFERRED_RX_IDLE )
+		{
+			while( ulTail != ulDeferredRxHead )
+			{
+				/* Never block, as that would hold up the timers. */
+				if( xQueueSendToBack( pxCharQueueState->xQueue, &( ucDeferredRx[ ulTail & ( uartDEFERRED_RX_BYTES - 1UL ) ] ), 0 ) != pdPASS )
+				{
+					pxCharQueueState->usErrorState = pdTRUE;
+				}
+
+				ulTail++;
+				ulDeferredRxTail = ulTail;
+			}
+
+			/* Characters that arrived after the last check would otherwise
+			wait for the next interrupt. */
+			taskENTER_CRITICAL();
+			{
+				if( ulTail == ulDeferredRxHead )
+				{
+					ulDeferredRxState = uartDEFERRED_RX_IDLE;
+				}
+			}
+			taskEXIT_CRITICAL();
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ioconfigDEFER_UART_RX_CHAR_QUEUE */
+
+
 #if ioconfigINCLUDE_UART != 1
 	/* If the UART driver is not being used, rename the interrupt handler.  This
 	will prevent it being installed in the vector table.  The linker will then
@@ -434,6 +585,8 @@ portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 const unsigned portBASE_TYPE uxUARTNumber = 3UL;
 Transfer_Control_t *pxTransferStruct;
 
+	ioconfigUART_ISR_ENTER();
+
 	/* Determine the interrupt source. */
 	ulInterruptSource = UART_GetIntId( LPC_UART3 );
 
@@ -462,7 +615,13 @@ Transfer_Control_t *pxTransferStruct;
 
 				case ioctlUSE_CHARACTER_QUEUE_RX :
 
-					#if ioconfigUSE_UART_RX_CHAR_QUEUE == 1
+					#if ( ioconfigUSE_UART_RX_CHAR_QUEUE == 1 ) && ( ioconfigDEFER_UART_RX_CHAR_QUEUE == 1 )
+					{
+						/* Only empty the FIFO here.  The characters are
+						queued by the timer service task. */
+						prvDeferRxChars( LPC_UART3, pxTransferStruct, &xHigherPriorityTaskWoken );
+					}
+					#elif ioconfigUSE_UART_RX_CHAR_QUEUE == 1
 					{
 						ioutilsRX_CHARS_INTO_QUEUE_FROM_ISR( pxTransferStruct, ( ( LPC_UART3->LSR & UART_LSR_RDR ) != 0 ), LPC_UART3->RBR, ulReceived, xHigherPriorityTaskWoken );
 					}
@@ -520,6 +679,8 @@ Transfer_Control_t *pxTransferStruct;
 	/* The ulReceived parameter is not used by the UART ISR. */
 	( void ) ulReceived;
 
+	ioconfigUART_ISR_EXIT();
+
 	/* If lHigherPriorityTaskWoken is now equal to pdTRUE, then a context
 	switch should be performed before the interrupt exists.  That ensures the
 	unblocked (higher priority) task is returned to immediately. */
@@ -0,0 +1,295 @@
+/*
+ * Fixed size block pools and the pointer queues that pass their blocks.  See
+ * block_pool.h.
+ *
+ * The pool is one run of storage divided into blocks of xBlockSize bytes.  A
+ * free block holds the address of the next free block in its first word, and
+ * pvFreeList points to the first, so a block is taken from, and given back
+ * to, the front of the list without a search.
+ */
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "block_pool.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* The structure is rounded up so the storage that follows it, when both are
+allocated together, is aligned. */
+#define blockpoolSTRUCT_SIZE	( ( sizeof( xBLOCK_POOL ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/*
+ * Definition of the block pool structure.  xStaticBlockPool in FreeRTOS.h
+ * must be kept the same size.
+ */
+typedef struct xBLOCK_POOL
+{
+	void * volatile pvFreeList;				/*< The first free block, or NULL if every block is in use. */
+	unsigned char *pucStorage;				/*< The first block. */
+	size_t xBlockSize;						/*< The size of each block, rounded up by blockpoolBLOCK_SIZE(). */
+	unsigned portBASE_TYPE uxBlockCount;
+	volatile unsigned portBASE_TYPE uxFreeCount;
+	unsigned portBASE_TYPE uxMinimumFreeCount;	/*< The fewest free blocks there have been. */
+
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char ucStaticallyAllocated;	/*< pdTRUE if the structure and storage were given by the application, so must not be freed. */
+	#endif
+
+} xBLOCK_POOL;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Divide the storage of a new pool into blocks and put them all on the free
+ * list.
+ */
+static void prvInitialiseNewBlockPool( xBLOCK_POOL *pxBlockPool, unsigned char *pucStorage, size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Take the first block from the free list.  Must be called with interrupts
+ * masked.
+ */
+static void *prvTakeBlock( xBLOCK_POOL *pxBlockPool ) PRIVILEGED_FUNCTION;
+
+/*
+ * Put a block on the front of the free list.  Must be called with interrupts
+ * masked.
+ */
+static void prvGiveBlock( xBLOCK_POOL *pxBlockPool, void *pvBlock ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+xBlockPoolHandle xBlockPoolCreate( size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount )
+{
+xBLOCK_POOL *pxNewBlockPool;
+
+	configASSERT( uxBlockCount > 0 );
+
+	/* The structure and the storage are allocated together, the storage
+	following the structure. */
+	pxNewBlockPool = ( xBLOCK_POOL * ) pvPortMalloc( blockpoolSTRUCT_SIZE + blockpoolSTORAGE_BYTES( xBlockSize, uxBlockCount ) );
+
+	if( pxNewBlockPool != NULL )
+	{
+		prvInitialiseNewBlockPool( pxNewBlockPool, ( ( unsigned char * ) pxNewBlockPool ) + blockpoolSTRUCT_SIZE, xBlockSize, uxBlockCount );
+
+		#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+			pxNewBlockPool->ucStaticallyAllocated = ( unsigned char ) pdFALSE;
+		}
+		#endif
+	}
+
+	configASSERT( pxNewBlockPool );
+
+	return ( xBlockPoolHandle ) pxNewBlockPool;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xBlockPoolHandle xBlockPoolCreateStatic( size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount, unsigned char *pucPoolStorage, xStaticBlockPool *pxStaticBlockPool )
+	{
+	xBLOCK_POOL *pxNewBlockPool = ( xBLOCK_POOL * ) pxStaticBlockPool;
+
+		/* xStaticBlockPool must be kept in step with xBLOCK_POOL. */
+		configASSERT( sizeof( xStaticBlockPool ) == sizeof( xBLOCK_POOL ) );
+		configASSERT( uxBlockCount > 0 );
+		configASSERT( pucPoolStorage );
+		configASSERT( ( ( ( unsigned long ) pucPoolStorage ) & ( unsigned long ) portBYTE_ALIGNMENT_MASK ) == 0UL );
+		configASSERT( pxStaticBlockPool );
+
+		prvInitialiseNewBlockPool( pxNewBlockPool, pucPoolStorage, xBlockSize, uxBlockCount );
+		pxNewBlockPool->ucStaticallyAllocated = ( unsigned char ) pdTRUE;
+
+		return ( xBlockPoolHandle ) pxNewBlockPool;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+void vBlockPoolDelete( xBlockPoolHandle xBlockPool )
+{
+xBLOCK_POOL *pxBlockPool = ( xBLOCK_POOL * ) xBlockPool;
+
+	configASSERT( pxBlockPool );
+	configASSERT( pxBlockPool->uxFreeCount == pxBlockPool->uxBlockCount );
+
+	/* The memory of a pool created in buffers given by the application
+	belongs to the application. */
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		if( pxBlockPool->ucStaticallyAllocated == ( unsigned char ) pdFALSE )
+	#endif
+	{
+		vPortFree( pxBlockPool );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void *pvBlockPoolAlloc( xBlockPoolHandle xBlockPool )
+{
+void *pvBlock;
+
+	configASSERT( xBlockPool );
+
+	taskENTER_CRITICAL();
+	{
+		pvBlock = prvTakeBlock( ( xBLOCK_POOL * ) xBlockPool );
+	}
+	taskEXIT_CRITICAL();
+
+	return pvBlock;
+}
+/*-----------------------------------------------------------*/
+
+void *pvBlockPoolAllocFromISR( xBlockPoolHandle xBlockPool )
+{
+void *pvBlock;
+unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+	configASSERT( xBlockPool );
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		pvBlock = prvTakeBlock( ( xBLOCK_POOL * ) xBlockPool );
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return pvBlock;
+}
+/*-----------------------------------------------------------*/
+
+void vBlockPoolFree( xBlockPoolHandle xBlockPool, void *pvBlock )
+{
+	configASSERT( xBlockPool );
+
+	taskENTER_CRITICAL();
+	{
+		prvGiveBlock( ( xBLOCK_POOL * ) xBlockPool, pvBlock );
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vBlockPoolFreeFromISR( xBlockPoolHandle xBlockPool, void *pvBlock )
+{
+unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+	configASSERT( xBlockPool );
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		prvGiveBlock( ( xBLOCK_POOL * ) xBlockPool, pvBlock );
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+}
+/*-----------------------------------------------------------*/
+
+unsigned portBASE_TYPE uxBlockPoolGetFreeCount( xBlockPoolHandle xBlockPool )
+{
+	configASSERT( xBlockPool );
+
+	return ( ( xBLOCK_POOL * ) xBlockPool )->uxFreeCount;
+}
+/*-----------------------------------------------------------*/
+
+unsigned portBASE_TYPE uxBlockPoolGetMinimumFreeCount( xBlockPoolHandle xBlockPool )
+{
+	configASSERT( xBlockPool );
+
+	return ( ( xBLOCK_POOL * ) xBlockPool )->uxMinimumFreeCount;
+}
+/*-----------------------------------------------------------*/
+
+signed portBASE_TYPE xBlockPoolSend( xQueueHandle xQueue, void *pvBlock, portTickType xTicksToWait )
+{
+	configASSERT( pvBlock );
+
+	/* The queue copies the pointer, not the block it points to. */
+	return xQueueGenericSend( xQueue, &pvBlock, xTicksToWait, queueSEND_TO_BACK );
+}
+/*-----------------------------------------------------------*/
+
+signed portBASE_TYPE xBlockPoolSendFromISR( xQueueHandle xQueue, void *pvBlock, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+	configASSERT( pvBlock );
+
+	return xQueueGenericSendFromISR( xQueue, &pvBlock, pxHigherPriorityTaskWoken, queueSEND_TO_BACK );
+}
+/*-----------------------------------------------------------*/
+
+void *pvBlockPoolReceive( xQueueHandle xQueue, portTickType xTicksToWait )
+{
+void *pvBlock;
+
+	if( xQueueGenericReceive( xQueue, &pvBlock, xTicksToWait, pdFALSE ) != pdPASS )
+	{
+		pvBlock = NULL;
+	}
+
+	return pvBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewBlockPool( xBLOCK_POOL *pxBlockPool, unsigned char *pucStorage, size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount )
+{
+unsigned portBASE_TYPE uxBlock;
+unsigned char *pucBlock;
+
+	pxBlockPool->pucStorage = pucStorage;
+	pxBlockPool->xBlockSize = blockpoolBLOCK_SIZE( xBlockSize );
+	pxBlockPool->uxBlockCount = uxBlockCount;
+	pxBlockPool->uxFreeCount = uxBlockCount;
+	pxBlockPool->uxMinimumFreeCount = uxBlockCount;
+
+	/* Link each block to the one after it, and the last to nothing. */
+	pucBlock = pucStorage;
+
+	for( uxBlock = 1; uxBlock < uxBlockCount; uxBlock++ )
+	{
+		*( ( void ** ) pucBlock ) = ( void * ) ( pucBlock + pxBlockPool->xBlockSize );
+		pucBlock += pxBlockPool->xBlockSize;
+	}
+
+	*( ( void ** ) pucBlock ) = NULL;
+	pxBlockPool->pvFreeList = ( void * ) pucStorage;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvTakeBlock( xBLOCK_POOL *pxBlockPool )
+{
+void *pvBlock = pxBlockPool->pvFreeList;
+
+	if( pvBlock != NULL )
+	{
+		pxBlockPool->pvFreeList = *( ( void ** ) pvBlock );
+		( pxBlockPool->uxFreeCount )--;
+
+		if( pxBlockPool->uxFreeCount < pxBlockPool->uxMinimumFreeCount )
+		{
+			pxBlockPool->uxMinimumFreeCount = pxBlockPool->uxFreeCount;
+		}
+	}
+
+	return pvBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvGiveBlock( xBLOCK_POOL *pxBlockPool, void *pvBlock )
+{
+	/* The block must be the start of one of the blocks of this pool, and the
+	pool cannot already have every block back. */
+	configASSERT( ( ( unsigned char * ) pvBlock >= pxBlockPool->pucStorage ) && ( ( unsigned char * ) pvBlock < pxBlockPool->pucStorage + ( pxBlockPool->xBlockSize * pxBlockPool->uxBlockCount ) ) );
+	configASSERT( ( ( size_t ) ( ( unsigned char * ) pvBlock - pxBlockPool->pucStorage ) % pxBlockPool->xBlockSize ) == 0 );
+	configASSERT( pxBlockPool->uxFreeCount < pxBlockPool->uxBlockCount );
+
+	*( ( void ** ) pvBlock ) = pxBlockPool->pvFreeList;
+	pxBlockPool->pvFreeList = pvBlock;
+	( pxBlockPool->uxFreeCount )++;
+}
+/*-----------------------------------------------------------*/
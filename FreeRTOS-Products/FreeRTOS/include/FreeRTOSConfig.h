@@ -57,13 +57,23 @@
 #include <stdint.h>
 extern uint32_t SystemCoreClock;
 
+/* The stack depths measured by the stack monitor, where there are any. */
+#include "Stack-sizes.h"
+
+/* The microsecond counter the run time stats are taken from. */
+#include "Timebase.h"
+
 /* Priorities to assign to tasks created by this demo. */
 #define configUART_COMMAND_CONSOLE_TASK_PRIORITY	( 3U )
 #define configSPI_7_SEG_WRITE_TASK_PRIORITY			( 2U )
 #define configI2C_TASK_PRIORITY						( 0U )
 
 /* Stack sizes to assign to tasks created by this demo. */
-#define configUART_COMMAND_CONSOLE_STACK_SIZE		( configMINIMAL_STACK_SIZE * 2 )
+#ifdef stacksizesUARTCMD
+	#define configUART_COMMAND_CONSOLE_STACK_SIZE	stacksizesUARTCMD
+#else
+	#define configUART_COMMAND_CONSOLE_STACK_SIZE	( configMINIMAL_STACK_SIZE * 2 )
+#endif
 #define configSPI_7_SEG_WRITE_TASK_STACK_SIZE		( configMINIMAL_STACK_SIZE * 2 )
 #define configI2C_TASK_STACK_SIZE					( configMINIMAL_STACK_SIZE * 4 )
 
@@ -97,11 +107,64 @@ http://www.FreeRTOS.org/FreeRTOS-Plus/FreeRTOS_Plus_CLI/ */
 #define configUSE_TRACE_FACILITY		1
 #define configUSE_16_BIT_TICKS			0
 #define configUSE_MUTEXES				1
-#define configUSE_CO_ROUTINES 			0
+/* Only the "coroutine" command uses co-routines - build with
+-DconfigUSE_CO_ROUTINES=1 to include it. */
+#ifndef configUSE_CO_ROUTINES
+	#define configUSE_CO_ROUTINES 		0
+#endif
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
 #define configUSE_COUNTING_SEMAPHORES 	0
 #define configUSE_ALTERNATIVE_API 		0
 #define configUSE_RECURSIVE_MUTEXES		1
+#define configUSE_TASK_NOTIFICATIONS	1
+
+/* Select the task to run with the CLZ instruction, from a bitmap of the
+priorities that have ready tasks, rather than by searching the ready lists. */
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION	1
+
+/* Allow tasks, queues, semaphores and timers to be created in buffers given
+by the application, so the application can start without using the heap. */
+#define configSUPPORT_STATIC_ALLOCATION	1
+
+/* Let a task block on several queues and semaphores at once. */
+#define configUSE_QUEUE_SETS			1
+
+/* Stop the tick and sleep in the idle task while no task needs to run.  The
+sleep is the Cortex-M3 Sleep mode, so SysTick keeps counting. */
+#define configUSE_TICKLESS_IDLE			1
+
+/* Keep the tasks due within the next 64 ticks in a delay wheel, so a task
+blocking with a timeout is put away in the same time however many tasks are
+delayed, and the tick only looks at the tasks it wakes.  The 10ms control loop
+falls within the wheel.  The longer timeouts of the sumo behaviour wait in the
+delayed list until they are due within 64 ticks. */
+#define configUSE_DELAY_WHEEL			1
+#define configDELAY_WHEEL_BITS			6
+
+/* Count the cycles each tick interrupt takes, for the "tick" command.  Left
+out of the match build, as it adds DWT accounting to every tick - build a
+measurement build with -DconfigGENERATE_TICK_STATS=1. */
+#ifndef configGENERATE_TICK_STATS
+	#define configGENERATE_TICK_STATS	0
+#endif
+
+/* Record context switches, queue operations and notifications in a RAM ring
+buffer with DWT timestamps, written out by the "trace" command.  The header
+defines the trace hooks.  Left out of the match build, as a hook then runs on
+every context switch and queue operation - build a measurement build with
+-DconfigUSE_TRACE_RECORDER=1. */
+#ifndef configUSE_TRACE_RECORDER
+	#define configUSE_TRACE_RECORDER	0
+#endif
+
+#if configUSE_TRACE_RECORDER == 1
+	#include "Trace-recorder.h"
+#endif
+
+/* Keep the peak stack use of every task, warn through
+vApplicationStackWarningHook() when a task runs low and print right sized
+depths for Stack-sizes.h with the "stacks" command. */
+#define configUSE_STACK_MONITOR			1
 
 /* Hook function related definitions. */
 #define configUSE_TICK_HOOK				0
@@ -113,15 +176,32 @@ http://www.FreeRTOS.org/FreeRTOS-Plus/FreeRTOS_Plus_CLI/ */
 /* Software timer related definitions. */
 #define configUSE_TIMERS				1
 #define configTIMER_TASK_PRIORITY		( configMAX_PRIORITIES - 3 )
-#define configTIMER_QUEUE_LENGTH		10
-#define configTIMER_TASK_STACK_DEPTH	configMINIMAL_STACK_SIZE
+/* The timer command queue carries the commands tasks send to the timers, the
+wake messages sent when an interrupt starts a timer in the wheel, and the
+calls pended by interrupts.  The UART receive interrupt has at most one call
+pending, and queues the characters itself if it cannot pend one, so the queue
+has room for it on top of the 10 used by the timers. */
+#define configTIMER_QUEUE_LENGTH		16
+#ifdef stacksizesTMR_SVC
+	#define configTIMER_TASK_STACK_DEPTH	stacksizesTMR_SVC
+#else
+	#define configTIMER_TASK_STACK_DEPTH	configMINIMAL_STACK_SIZE
+#endif
 
-/* Run time stats gathering definitions. */
-void vMainConfigureTimerForRunTimeStats( void );
-uint32_t ulMainGetRunTimeCounterValue( void );
+/* Keep active timers in a timer wheel, so starting, stopping and resetting a
+timer takes the same time however many are active, and interrupts can do so
+without going through the timer queue. */
+#define configUSE_TIMER_WHEEL			1
+
+/* Run time stats are counted in microseconds by TIMER0, the free running
+counter of Timebase.c, which is never stopped or reset.  main() starts it
+before the scheduler, and starting it again from the kernel is harmless, so the
+stats do not depend on that.  Reading the counter is a single load, so unlike
+piecing the time together from the SysTick and the tick count it cannot race
+with the tick interrupt. */
 #define configGENERATE_RUN_TIME_STATS	1
-#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() vMainConfigureTimerForRunTimeStats()
-#define portGET_RUN_TIME_COUNTER_VALUE() ulMainGetRunTimeCounterValue()
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() vTimebaseStart()
+#define portGET_RUN_TIME_COUNTER_VALUE() ulTimebaseMicroseconds()
 
 
 /* Set the following definitions to 1 to include the API function, or zero
@@ -134,7 +214,9 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelayUntil				1
 #define INCLUDE_vTaskDelay					1
 #define INCLUDE_uxTaskGetStackHighWaterMark	1
+#define INCLUDE_uxTaskGetStackStats			1
 #define INCLUDE_xTimerGetTimerTaskHandle	0
+#define INCLUDE_xTimerPendFunctionCall		1	/* Lets interrupts leave work to the timer service task, see FreeRTOSIOConfig.h. */
 #define INCLUDE_xTaskGetIdleTaskHandle		0
 
 #ifdef DEBUG
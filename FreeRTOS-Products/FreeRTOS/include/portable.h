@@ -357,6 +357,27 @@ void vPortFree( void *pv ) PRIVILEGED_FUNCTION;
 void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Heap statistics, only provided by heap_tlsf.c.  The sizes include the block
+ * headers.  The fragmentation is the percentage of the free space that is not
+ * in the largest free block - 0 when all the free space is in one block.
+ */
+typedef struct xHEAP_STATS
+{
+	size_t xFreeBytesRemaining;
+	size_t xMinimumEverFreeBytesRemaining;		/*<< The high water mark of the heap. */
+	size_t xLargestFreeBlockSize;
+	size_t xNumberOfFreeBlocks;
+	size_t xNumberOfAllocations;				/*<< Successful calls to pvPortMalloc(). */
+	size_t xNumberOfFrees;
+	size_t xNumberOfFailures;					/*<< Calls to pvPortMalloc() that returned NULL. */
+} xHeapStats;
+
+size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
+size_t xPortGetLargestFreeBlockSize( void ) PRIVILEGED_FUNCTION;
+unsigned portBASE_TYPE uxPortGetHeapFragmentation( void ) PRIVILEGED_FUNCTION;
+void vPortGetHeapStats( xHeapStats *pxStats ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
@@ -114,6 +114,32 @@ typedef xQueueHandle xSemaphoreHandle;
 		}																																		\
 	}
 
+/**
+ * semphr. h
+ * <pre>vSemaphoreCreateBinaryStatic( xSemaphoreHandle xSemaphore, xStaticQueue *pxSemaphoreBuffer )</pre>
+ *
+ * <i>Macro</i> that creates a binary semaphore as vSemaphoreCreateBinary()
+ * does, in pxSemaphoreBuffer rather than in memory allocated from the heap.
+ * Like vSemaphoreCreateBinary() the semaphore starts in the given state.
+ * Only available when configSUPPORT_STATIC_ALLOCATION is set to 1.
+ *
+ * @param xSemaphore Handle to the created semaphore.  Should be of type xSemaphoreHandle.
+ *
+ * @param pxSemaphoreBuffer Holds the semaphore for as long as it exists, so
+ * is normally declared static.
+ *
+ * \defgroup vSemaphoreCreateBinaryStatic vSemaphoreCreateBinaryStatic
+ * \ingroup Semaphores
+ */
+#define vSemaphoreCreateBinaryStatic( xSemaphore, pxSemaphoreBuffer )																			\
+	{																																			\
+		( xSemaphore ) = xQueueGenericCreateStatic( ( unsigned portBASE_TYPE ) 1, semSEMAPHORE_QUEUE_ITEM_LENGTH, NULL, ( pxSemaphoreBuffer ), queueQUEUE_TYPE_BINARY_SEMAPHORE );	\
+		if( ( xSemaphore ) != NULL )																											\
+		{																																		\
+			xSemaphoreGive( ( xSemaphore ) );																									\
+		}																																		\
+	}
+
 /**
  * semphr. h
  * <pre>xSemaphoreTake(
@@ -588,6 +614,22 @@ typedef xQueueHandle xSemaphoreHandle;
  */
 #define xSemaphoreCreateMutex() xQueueCreateMutex( queueQUEUE_TYPE_MUTEX )
 
+/**
+ * semphr. h
+ * <pre>xSemaphoreHandle xSemaphoreCreateMutexStatic( xStaticQueue *pxMutexBuffer )</pre>
+ *
+ * <i>Macro</i> that creates a mutex as xSemaphoreCreateMutex() does, in
+ * pxMutexBuffer rather than in memory allocated from the heap.  Only
+ * available when configSUPPORT_STATIC_ALLOCATION is set to 1.
+ *
+ * @return xSemaphore Handle to the created mutex semaphore, or NULL if
+ * pxMutexBuffer is NULL.
+ *
+ * \defgroup xSemaphoreCreateMutexStatic xSemaphoreCreateMutexStatic
+ * \ingroup Semaphores
+ */
+#define xSemaphoreCreateMutexStatic( pxMutexBuffer ) xQueueCreateMutexStatic( queueQUEUE_TYPE_MUTEX, ( pxMutexBuffer ) )
+
 
 /**
  * semphr. h
@@ -643,6 +685,20 @@ typedef xQueueHandle xSemaphoreHandle;
  */
 #define xSemaphoreCreateRecursiveMutex() xQueueCreateMutex( queueQUEUE_TYPE_RECURSIVE_MUTEX )
 
+/**
+ * semphr. h
+ * <pre>xSemaphoreHandle xSemaphoreCreateRecursiveMutexStatic( xStaticQueue *pxMutexBuffer )</pre>
+ *
+ * <i>Macro</i> that creates a recursive mutex as
+ * xSemaphoreCreateRecursiveMutex() does, in pxMutexBuffer rather than in
+ * memory allocated from the heap.  Only available when
+ * configSUPPORT_STATIC_ALLOCATION is set to 1.
+ *
+ * \defgroup xSemaphoreCreateRecursiveMutexStatic xSemaphoreCreateRecursiveMutexStatic
+ * \ingroup Semaphores
+ */
+#define xSemaphoreCreateRecursiveMutexStatic( pxMutexBuffer ) xQueueCreateMutexStatic( queueQUEUE_TYPE_RECURSIVE_MUTEX, ( pxMutexBuffer ) )
+
 /**
  * semphr. h
  * <pre>xSemaphoreHandle xSemaphoreCreateCounting( unsigned portBASE_TYPE uxMaxCount, unsigned portBASE_TYPE uxInitialCount )</pre>
@@ -706,6 +762,21 @@ typedef xQueueHandle xSemaphoreHandle;
  */
 #define xSemaphoreCreateCounting( uxMaxCount, uxInitialCount ) xQueueCreateCountingSemaphore( ( uxMaxCount ), ( uxInitialCount ) )
 
+/**
+ * semphr. h
+ * <pre>xSemaphoreHandle xSemaphoreCreateCountingStatic( unsigned portBASE_TYPE uxMaxCount, unsigned portBASE_TYPE uxInitialCount, xStaticQueue *pxSemaphoreBuffer )</pre>
+ *
+ * <i>Macro</i> that creates a counting semaphore as
+ * xSemaphoreCreateCounting() does, in pxSemaphoreBuffer rather than in
+ * memory allocated from the heap.  Only available when both
+ * configSUPPORT_STATIC_ALLOCATION and configUSE_COUNTING_SEMAPHORES are set
+ * to 1.
+ *
+ * \defgroup xSemaphoreCreateCountingStatic xSemaphoreCreateCountingStatic
+ * \ingroup Semaphores
+ */
+#define xSemaphoreCreateCountingStatic( uxMaxCount, uxInitialCount, pxSemaphoreBuffer ) xQueueCreateCountingSemaphoreStatic( ( uxMaxCount ), ( uxInitialCount ), ( pxSemaphoreBuffer ) )
+
 /**
  * semphr. h
  * <pre>void vSemaphoreDelete( xSemaphoreHandle xSemaphore );</pre>
@@ -0,0 +1,163 @@
+/*
+ * Stream buffers pass a stream of bytes from one writer to one reader, where
+ * either may be an interrupt.
+ *
+ * A stream buffer is a ring of bytes with a head, written only by the writer,
+ * and a tail, written only by the reader.  Each side copies as many bytes as
+ * it can in at most two memcpy() calls, one either side of the end of the
+ * ring, and then moves its own index.  As neither side ever writes the index
+ * of the other, the data path needs no critical section and no interrupt
+ * masking - the only synchronisation is the compiler barrier between copying
+ * the bytes and publishing the new index.
+ *
+ * A reader that finds the buffer empty blocks on its direct to task
+ * notification, and is woken by the writer once there are at least the
+ * trigger level of bytes to read.  A writer that finds the buffer full blocks
+ * the same way until the reader has made space.  As the notification of the
+ * task is used, a task must not wait on its own notification for anything
+ * else while it reads from or writes to a stream buffer.
+ *
+ * There must only be one writer and one reader at a time.  If several tasks
+ * write to, or read from, the same stream buffer, they must serialise their
+ * calls themselves, for example with a mutex.  A queue should be used
+ * instead where there is more than one writer or reader.
+ */
+
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#ifndef INC_FREERTOS_H
+	#error "#include FreeRTOS.h" must appear in source files before "#include stream_buffer.h"
+#endif
+
+#if ( configUSE_TASK_NOTIFICATIONS != 1 )
+	#error Stream buffers wake tasks with direct to task notifications, so configUSE_TASK_NOTIFICATIONS must be set to 1 in FreeRTOSConfig.h.
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Type by which stream buffers are referenced.
+ */
+typedef void * xStreamBufferHandle;
+
+/**
+ * xStreamBufferHandle xStreamBufferCreate( size_t xBufferSizeBytes, size_t xTriggerLevelBytes );
+ *
+ * Create a stream buffer that can hold xBufferSizeBytes bytes.  A reader
+ * blocked on the empty buffer is not woken until xTriggerLevelBytes bytes are
+ * waiting, or its block time expires.  A trigger level of 0 is treated as 1.
+ *
+ * The ring keeps one byte free to tell a full buffer from an empty one, so
+ * xBufferSizeBytes + 1 bytes are allocated for it.
+ *
+ * Returns the handle of the stream buffer, or NULL if it could not be
+ * allocated.
+ */
+xStreamBufferHandle xStreamBufferCreate( size_t xBufferSizeBytes, size_t xTriggerLevelBytes ) PRIVILEGED_FUNCTION;
+
+/**
+ * xStreamBufferHandle xStreamBufferCreateStatic( size_t xBufferSizeBytes,
+ * 												size_t xTriggerLevelBytes,
+ * 												unsigned char *pucStreamBufferStorage,
+ * 												xStaticStreamBuffer *pxStaticStreamBuffer );
+ *
+ * Creates a stream buffer as xStreamBufferCreate() does, but in
+ * pxStaticStreamBuffer and pucStreamBufferStorage rather than in memory
+ * allocated from the heap.  pucStreamBufferStorage must be at least
+ * xBufferSizeBytes + 1 bytes long.  Only available when
+ * configSUPPORT_STATIC_ALLOCATION is set to 1 in FreeRTOSConfig.h.
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xStreamBufferHandle xStreamBufferCreateStatic( size_t xBufferSizeBytes, size_t xTriggerLevelBytes, unsigned char *pucStreamBufferStorage, xStaticStreamBuffer *pxStaticStreamBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * void vStreamBufferDelete( xStreamBufferHandle xStreamBuffer );
+ *
+ * Delete a stream buffer, freeing its memory if it was allocated from the
+ * heap.  No task may be blocked on it.
+ */
+void vStreamBufferDelete( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/**
+ * size_t xStreamBufferSend( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, portTickType xTicksToWait );
+ *
+ * Copy xDataLengthBytes bytes from pvTxData into the stream buffer.  While
+ * the buffer is full the writer blocks for up to xTicksToWait ticks in all,
+ * writing each part of the data as space is made for it.
+ *
+ * Returns the number of bytes written, which is less than xDataLengthBytes
+ * only if the block time expired.
+ */
+size_t xStreamBufferSend( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * size_t xStreamBufferSendFromISR( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken );
+ *
+ * A version of xStreamBufferSend() that can be called from an interrupt
+ * service routine.  It never blocks, so writes only as many bytes as there is
+ * space for.  *pxHigherPriorityTaskWoken is set to pdTRUE if the write woke a
+ * reader of higher priority than the interrupted task.
+ *
+ * Returns the number of bytes written.
+ */
+size_t xStreamBufferSendFromISR( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * size_t xStreamBufferReceive( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, portTickType xTicksToWait );
+ *
+ * Copy up to xBufferLengthBytes bytes out of the stream buffer into pvRxData.
+ * If the buffer is empty the reader blocks for up to xTicksToWait ticks for
+ * the trigger level of bytes to arrive.  It does not wait for more bytes
+ * once there are any to read.
+ *
+ * Returns the number of bytes read, which is 0 if the block time expired
+ * with the buffer still empty.
+ */
+size_t xStreamBufferReceive( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * size_t xStreamBufferReceiveFromISR( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken );
+ *
+ * A version of xStreamBufferReceive() that can be called from an interrupt
+ * service routine.  It never blocks.  *pxHigherPriorityTaskWoken is set to
+ * pdTRUE if the read woke a writer of higher priority than the interrupted
+ * task.
+ */
+size_t xStreamBufferReceiveFromISR( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * size_t xStreamBufferBytesAvailable( xStreamBufferHandle xStreamBuffer );
+ * size_t xStreamBufferSpacesAvailable( xStreamBufferHandle xStreamBuffer );
+ *
+ * The number of bytes waiting to be read, and the number that can be written
+ * before the buffer is full.  Either may be called by the reader or the
+ * writer.
+ */
+size_t xStreamBufferBytesAvailable( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+size_t xStreamBufferSpacesAvailable( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/**
+ * void vStreamBufferSetTriggerLevel( xStreamBufferHandle xStreamBuffer, size_t xTriggerLevelBytes );
+ *
+ * Change the trigger level of the stream buffer.  A trigger level of 0 is
+ * treated as 1, and one larger than the buffer as the size of the buffer.
+ */
+void vStreamBufferSetTriggerLevel( xStreamBufferHandle xStreamBuffer, size_t xTriggerLevelBytes ) PRIVILEGED_FUNCTION;
+
+/**
+ * void vStreamBufferDiscard( xStreamBufferHandle xStreamBuffer );
+ *
+ * Throw away every byte waiting to be read.  As it moves the tail it must
+ * only be called by the reader.
+ */
+void vStreamBufferDiscard( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STREAM_BUFFER_H */
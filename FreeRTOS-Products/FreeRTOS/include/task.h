@@ -84,6 +84,30 @@ extern "C" {
  */
 typedef void * xTaskHandle;
 
+/*
+ * Actions that can be performed on the notification value of a task by
+ * xTaskNotify() and xTaskNotifyFromISR().
+ */
+typedef enum
+{
+	eNoAction = 0,				/* Notify the task without updating its notification value. */
+	eSetBits,					/* Set bits in the notification value of the task. */
+	eIncrement,					/* Increment the notification value of the task. */
+	eSetValueWithOverwrite,		/* Set the notification value to a specific value, even if the previous value has not yet been read. */
+	eSetValueWithoutOverwrite	/* Set the notification value if the previous value has been read. */
+} eNotifyAction;
+
+/*
+ * Returned by eTaskConfirmSleepModeStatus(), which the port calls with
+ * interrupts disabled just before it sleeps.
+ */
+typedef enum
+{
+	eAbortSleep = 0,			/* A task became ready, or a context switch was held off, since the sleep was decided on, so do not sleep. */
+	eStandardSleep,				/* Sleep for no longer than the expected idle time. */
+	eNoTasksWaitingTimeout		/* Every other task is suspended or blocked without a timeout, so only an interrupt can end the sleep. */
+} eSleepModeStatus;
+
 /*
  * Used internally only.
  */
@@ -269,6 +293,58 @@ typedef struct xTASK_PARAMTERS
  */
 #define xTaskCreate( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask ) xTaskGenericCreate( ( pvTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxCreatedTask ), ( NULL ), ( NULL ) )
 
+/**
+ * task. h
+ *<pre>
+ xTaskHandle xTaskCreateStatic(
+								  pdTASK_CODE pvTaskCode,
+								  const signed char * const pcName,
+								  unsigned short usStackDepth,
+								  void *pvParameters,
+								  unsigned portBASE_TYPE uxPriority,
+								  portSTACK_TYPE *puxStackBuffer,
+								  xStaticTask *pxTaskBuffer
+							  );</pre>
+ *
+ * Create a new task as xTaskCreate() does, but in memory given by the
+ * caller rather than memory allocated from the heap.  Only available when
+ * configSUPPORT_STATIC_ALLOCATION is set to 1 in FreeRTOSConfig.h.
+ *
+ * Both buffers must exist for as long as the task does, so are normally
+ * declared static or at file scope.  If the task is deleted the kernel stops
+ * using them once the idle task has cleaned up after the task.
+ *
+ * @param puxStackBuffer An array of at least usStackDepth portSTACK_TYPE
+ * variables, used as the stack of the task.
+ *
+ * @param pxTaskBuffer Used to hold the task control block of the task.
+ *
+ * The other parameters are as xTaskCreate().
+ *
+ * @return The handle of the created task.  The task cannot fail to be
+ * created, unless a parameter is NULL in which case NULL is returned.
+ *
+ * Example usage:
+   <pre>
+ #define STACK_SIZE 200
+
+ static portSTACK_TYPE xStack[ STACK_SIZE ];
+ static xStaticTask xTaskBuffer;
+
+ void vOtherFunction( void )
+ {
+ xTaskHandle xHandle;
+
+	 xHandle = xTaskCreateStatic( vTaskCode, "NAME", STACK_SIZE, NULL, tskIDLE_PRIORITY, xStack, &xTaskBuffer );
+ }
+   </pre>
+ * \defgroup xTaskCreateStatic xTaskCreateStatic
+ * \ingroup Tasks
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xTaskHandle xTaskCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, portSTACK_TYPE *puxStackBuffer, xStaticTask *pxTaskBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * task. h
  *<pre>
@@ -1039,9 +1115,24 @@ signed char *pcTaskGetTaskName( xTaskHandle xTaskToQuery );
  */
 void vTaskList( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
 
+/*
+ * The run time stats of one task, as filled in by uxTaskGetRunTimeStats().
+ * The times are in counts of the run time counter.
+ */
+typedef struct xTASK_RUN_TIME_STATS
+{
+	xTaskHandle xHandle;
+	const signed char *pcTaskName;
+	unsigned portBASE_TYPE uxPriority;
+	unsigned long long ullRunTime;			/*<< The total time the task has run for. */
+	unsigned long ulMaxBurst;				/*<< The longest the task has run for before another task was switched in. */
+	unsigned long ulSwitchesIn;				/*<< The number of times the task has been switched in. */
+	unsigned long ulHundredthsOfAPercent;	/*<< ullRunTime as a share of the total run time, 10000 being all of it. */
+} xTaskRunTimeStats;
+
 /**
  * task. h
- * <PRE>void vTaskGetRunTimeStats( char *pcWriteBuffer );</PRE>
+ * <PRE>unsigned portBASE_TYPE uxTaskGetRunTimeStats( xTaskRunTimeStats *pxStats, unsigned portBASE_TYPE uxMaxTasks, unsigned long long *pullTotalRunTime );</PRE>
  *
  * configGENERATE_RUN_TIME_STATS must be defined as 1 for this function
  * to be available.  The application must also then provide definitions
@@ -1050,26 +1141,34 @@ void vTaskList( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
  * and return the timers current count value respectively.  The counter
  * should be at least 10 times the frequency of the tick count.
  *
- * NOTE: This function will disable interrupts for its duration.  It is
- * not intended for normal application runtime use but as a debug aid.
+ * Setting configGENERATE_RUN_TIME_STATS to 1 will result in the total
+ * execution time, the longest single run and the number of times switched in
+ * being kept for each task.  The execution times are kept in 64 bits, so
+ * carry on being correct after the counter wraps, as long as no task runs
+ * for a whole wrap of the counter without a context switch.
+ *
+ * Calling uxTaskGetRunTimeStats() copies the stats of each task into
+ * pxStats, including the time the calling task has run for since it was last
+ * switched in.  No text is formatted - that is up to the caller.  The
+ * scheduler is suspended while the tasks are walked, but interrupts are left
+ * enabled.
  *
- * Setting configGENERATE_RUN_TIME_STATS to 1 will result in a total
- * accumulated execution time being stored for each task.  The resolution
- * of the accumulated time value depends on the frequency of the timer
- * configured by the portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() macro.
- * Calling vTaskGetRunTimeStats() writes the total execution time of each
- * task into a buffer, both as an absolute count value and as a percentage
- * of the total system execution time.
+ * @param pxStats An array of uxMaxTasks structures into which the stats are
+ * copied.  uxTaskGetNumberOfTasks() gives how many are needed.
  *
- * @param pcWriteBuffer A buffer into which the execution times will be
- * written, in ascii form.  This buffer is assumed to be large enough to
- * contain the generated report.  Approximately 40 bytes per task should
- * be sufficient.
+ * @param uxMaxTasks The number of structures in pxStats.  The stats of any
+ * further tasks are left out.
  *
- * \page vTaskGetRunTimeStats vTaskGetRunTimeStats
+ * @param pullTotalRunTime Set to the total run time since the scheduler was
+ * started, the sum of the run times of all the tasks, including any that
+ * have been deleted.  Can be NULL.
+ *
+ * @return The number of structures filled in.
+ *
+ * \page uxTaskGetRunTimeStats uxTaskGetRunTimeStats
  * \ingroup TaskUtils
  */
-void vTaskGetRunTimeStats( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
+unsigned portBASE_TYPE uxTaskGetRunTimeStats( xTaskRunTimeStats *pxStats, unsigned portBASE_TYPE uxMaxTasks, unsigned long long *pullTotalRunTime ) PRIVILEGED_FUNCTION;
 
 /**
  * task. h
@@ -1125,6 +1224,43 @@ unsigned long ulTaskEndTrace( void ) PRIVILEGED_FUNCTION;
  */
 unsigned portBASE_TYPE uxTaskGetStackHighWaterMark( xTaskHandle xTask ) PRIVILEGED_FUNCTION;
 
+/*
+ * The stack use of one task, as filled in by uxTaskGetStackStats().  Both
+ * sizes are in words.
+ */
+typedef struct xTASK_STACK_STATS
+{
+	xTaskHandle xHandle;
+	const signed char *pcTaskName;
+	unsigned short usStackDepth;			/*<< The size of the stack, as given when the task was created. */
+	unsigned short usLeastFree;				/*<< The high water mark - the least stack there has been left unused. */
+} xTaskStackStats;
+
+/**
+ * task.h
+ * <PRE>unsigned portBASE_TYPE uxTaskGetStackStats( xTaskStackStats *pxStats, unsigned portBASE_TYPE uxMaxTasks );</PRE>
+ *
+ * INCLUDE_uxTaskGetStackStats must be set to 1 in FreeRTOSConfig.h for this
+ * function to be available.  It adds the stack depth to each TCB.
+ *
+ * Copies the stack depth and high water mark of every task, including those
+ * deleted but not yet freed by the idle task, into pxStats.  The deepest the
+ * task has used its stack is usStackDepth - usLeastFree.  The scheduler is
+ * suspended while the tasks are walked, but interrupts are left enabled.
+ *
+ * @param pxStats An array of uxMaxTasks structures into which the stack use
+ * is copied.
+ *
+ * @param uxMaxTasks The number of structures in pxStats.  Any further tasks
+ * are left out.
+ *
+ * @return The number of structures filled in.
+ *
+ * \page uxTaskGetStackStats uxTaskGetStackStats
+ * \ingroup TaskUtils
+ */
+unsigned portBASE_TYPE uxTaskGetStackStats( xTaskStackStats *pxStats, unsigned portBASE_TYPE uxMaxTasks ) PRIVILEGED_FUNCTION;
+
 /* When using trace macros it is sometimes necessary to include tasks.h before
 FreeRTOS.h.  When this is done pdTASK_HOOK_CODE will not yet have been defined,
 so the following two prototypes will cause a compilation error.  This can be
@@ -1174,6 +1310,113 @@ portBASE_TYPE xTaskCallApplicationTaskHook( xTaskHandle xTask, void *pvParameter
  */
 xTaskHandle xTaskGetIdleTaskHandle( void );
 
+/**
+ * task. h
+ * <PRE>signed portBASE_TYPE xTaskNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction );</PRE>
+ *
+ * configUSE_TASK_NOTIFICATIONS must be undefined or set to 1 for the task
+ * notification functions to be available.
+ *
+ * Each task has a 32 bit notification value and a notification state, held
+ * in its TCB.  Sending a notification to a task sets the state to pending,
+ * updates the value as given by eAction, and, if the task was blocked in
+ * xTaskNotifyWait() or ulTaskNotifyTake(), moves it straight to its ready
+ * list.  No queue, event list or copy is involved, so a notification is a
+ * faster and smaller replacement for a binary or counting semaphore, or a
+ * queue of one 32 bit item, that only ever has one task receiving from it.
+ *
+ * The value can only be received by the task it is sent to, and the sender
+ * cannot block waiting for the value to be read.
+ *
+ * @param xTaskToNotify The handle of the task being notified.
+ *
+ * @param ulValue Used to update the notification value, as given by eAction.
+ *
+ * @param eAction One of eNoAction, eSetBits, eIncrement,
+ * eSetValueWithOverwrite and eSetValueWithoutOverwrite.
+ *
+ * @return pdFAIL if eAction is eSetValueWithoutOverwrite and the task had a
+ * notification pending, otherwise pdPASS.
+ *
+ * \defgroup xTaskNotify xTaskNotify
+ * \ingroup TaskNotifications
+ */
+signed portBASE_TYPE xTaskNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>signed portBASE_TYPE xTaskNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, signed portBASE_TYPE *pxHigherPriorityTaskWoken );</PRE>
+ *
+ * A version of xTaskNotify() that can be called from an interrupt service
+ * routine.  *pxHigherPriorityTaskWoken is set to pdTRUE if the notified task
+ * was blocked waiting for the notification and has a priority at least as
+ * high as the task that was interrupted, in which case a context switch
+ * should be requested before the interrupt exits.
+ *
+ * \defgroup xTaskNotifyFromISR xTaskNotifyFromISR
+ * \ingroup TaskNotifications
+ */
+signed portBASE_TYPE xTaskNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>signed portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait );</PRE>
+ *
+ * Wait, optionally in the Blocked state, for the calling task to receive a
+ * notification.
+ *
+ * @param ulBitsToClearOnEntry Bits cleared from the notification value of
+ * the calling task before it waits, if no notification is already pending.
+ *
+ * @param ulBitsToClearOnExit Bits cleared from the notification value when
+ * a notification is received, after the value is copied to
+ * *pulNotificationValue.
+ *
+ * @param pulNotificationValue Where to copy the notification value.  Can be
+ * NULL.
+ *
+ * @param xTicksToWait The maximum time to wait.  portMAX_DELAY waits
+ * indefinitely if INCLUDE_vTaskSuspend is set to 1.
+ *
+ * @return pdTRUE if a notification was received, otherwise pdFALSE.
+ *
+ * \defgroup xTaskNotifyWait xTaskNotifyWait
+ * \ingroup TaskNotifications
+ */
+signed portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait );</PRE>
+ *
+ * Use the notification value of the calling task as a counting semaphore,
+ * given with xTaskNotifyGive() or vTaskNotifyGiveFromISR().  Waits, for at
+ * most xTicksToWait, for the value to be non-zero, then either clears it
+ * (xClearCountOnExit pdTRUE, like taking a binary semaphore) or decrements
+ * it (xClearCountOnExit pdFALSE, like taking a counting semaphore).
+ *
+ * @return The notification value before it was cleared or decremented, so
+ * zero if the wait timed out.
+ *
+ * \defgroup ulTaskNotifyTake ulTaskNotifyTake
+ * \ingroup TaskNotifications
+ */
+unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>signed portBASE_TYPE xTaskNotifyGive( xTaskHandle xTaskToNotify );</PRE>
+ * <PRE>void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, signed portBASE_TYPE *pxHigherPriorityTaskWoken );</PRE>
+ *
+ * Increment the notification value of a task, the equivalent of giving a
+ * semaphore, to be taken with ulTaskNotifyTake().
+ *
+ * \defgroup xTaskNotifyGive xTaskNotifyGive
+ * \ingroup TaskNotifications
+ */
+#define xTaskNotifyGive( xTaskToNotify ) xTaskNotify( ( xTaskToNotify ), 0UL, eIncrement )
+#define vTaskNotifyGiveFromISR( xTaskToNotify, pxHigherPriorityTaskWoken ) ( void ) xTaskNotifyFromISR( ( xTaskToNotify ), 0UL, eIncrement, ( pxHigherPriorityTaskWoken ) )
+
 /*-----------------------------------------------------------
  * SCHEDULER INTERNALS AVAILABLE FOR PORTING PURPOSES
  *----------------------------------------------------------*/
@@ -1190,6 +1433,31 @@ xTaskHandle xTaskGetIdleTaskHandle( void );
  */
 void vTaskIncrementTick( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Only available when configUSE_TICKLESS_IDLE is set to 1.  Called by
+ * portSUPPRESS_TICKS_AND_SLEEP() on waking, with the scheduler suspended, to
+ * add the xTicksToJump tick interrupts that did not happen while the tick
+ * was stopped to the tick count.  The count must not pass the time the next
+ * task unblocks.
+ */
+void vTaskStepTick( portTickType xTicksToJump ) PRIVILEGED_FUNCTION;
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Only available when configUSE_TICKLESS_IDLE is set to 1.  Called by
+ * portSUPPRESS_TICKS_AND_SLEEP() with interrupts disabled, just before it
+ * sleeps, to check that nothing has happened since the idle task decided to
+ * sleep that means it should not.
+ */
+eSleepModeStatus eTaskConfirmSleepModeStatus( void ) PRIVILEGED_FUNCTION;
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
  * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
@@ -75,6 +75,10 @@ as defined below. */
 #define tmrCOMMAND_CHANGE_PERIOD			2
 #define tmrCOMMAND_DELETE					3
 
+/* Commands that run a function rather than act on a timer are negative. */
+#define tmrCOMMAND_EXECUTE_CALLBACK_FROM_ISR	( -2 )
+#define tmrCOMMAND_EXECUTE_CALLBACK				( -1 )
+
 /*-----------------------------------------------------------
  * MACROS AND DEFINITIONS
  *----------------------------------------------------------*/
@@ -90,6 +94,10 @@ typedef void * xTimerHandle;
 /* Define the prototype to which timer callback functions must conform. */
 typedef void (*tmrTIMER_CALLBACK)( xTimerHandle xTimer );
 
+/* Define the prototype of functions run by xTimerPendFunctionCall() and
+xTimerPendFunctionCallFromISR(). */
+typedef void (*tmrPENDED_FUNCTION)( void *pvParameter1, unsigned long ulParameter2 );
+
 /**
  * xTimerHandle xTimerCreate( 	const signed char *pcTimerName,
  * 								portTickType xTimerPeriodInTicks,
@@ -219,6 +227,27 @@ typedef void (*tmrTIMER_CALLBACK)( xTimerHandle xTimer );
  */
 xTimerHandle xTimerCreate( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void * pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction ) PRIVILEGED_FUNCTION;
 
+/**
+ * xTimerHandle xTimerCreateStatic( 	const signed char *pcTimerName,
+ * 										portTickType xTimerPeriodInTicks,
+ * 										unsigned portBASE_TYPE uxAutoReload,
+ * 										void * pvTimerID,
+ * 										tmrTIMER_CALLBACK pxCallbackFunction,
+ * 										xStaticTimer *pxTimerBuffer );
+ *
+ * Creates a timer as xTimerCreate() does, but in pxTimerBuffer rather than in
+ * memory allocated from the heap.  Only available when
+ * configSUPPORT_STATIC_ALLOCATION is set to 1 in FreeRTOSConfig.h.
+ *
+ * pxTimerBuffer must exist for as long as the timer does, so is normally
+ * declared static.  Deleting the timer does not free it.
+ *
+ * The other parameters and the return value are as xTimerCreate().
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xTimerHandle xTimerCreateStatic( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void * pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction, xStaticTimer *pxTimerBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * void *pvTimerGetTimerID( xTimerHandle xTimer );
  *
@@ -923,12 +952,114 @@ xTaskHandle xTimerGetTimerDaemonTaskHandle( void );
  */
 #define xTimerResetFromISR( xTimer, pxHigherPriorityTaskWoken ) xTimerGenericCommand( ( xTimer ), tmrCOMMAND_START, ( xTaskGetTickCountFromISR() ), ( pxHigherPriorityTaskWoken ), 0U )
 
+/**
+ * portBASE_TYPE xTimerStartDirectFromISR( xTimerHandle xTimer, portBASE_TYPE *pxHigherPriorityTaskWoken );
+ * portBASE_TYPE xTimerResetDirectFromISR( xTimerHandle xTimer, portBASE_TYPE *pxHigherPriorityTaskWoken );
+ * portBASE_TYPE xTimerStopDirectFromISR( xTimerHandle xTimer, portBASE_TYPE *pxHigherPriorityTaskWoken );
+ * portBASE_TYPE xTimerChangePeriodDirectFromISR( xTimerHandle xTimer, portTickType xNewPeriod, portBASE_TYPE *pxHigherPriorityTaskWoken );
+ *
+ * Only available when configUSE_TIMER_WHEEL is set to 1, when active timers
+ * are kept in a timer wheel rather than in a list sorted by expiry time.
+ *
+ * Versions of xTimerStartFromISR(), xTimerResetFromISR(), xTimerStopFromISR()
+ * and xTimerChangePeriodFromISR() that do not send a command to the timer
+ * service task.  The timer is moved in the timer wheel by the function
+ * itself, with interrupts masked for a time that does not depend on the
+ * number of active timers, so the change has been made by the time the
+ * function returns.  The timer service task is only sent a message, to wake
+ * it, if the timer is now due before the task would otherwise wake.
+ * *pxHigherPriorityTaskWoken is set to pdTRUE if that message unblocks the
+ * task and it has a higher priority than the task that was interrupted.
+ *
+ * A timer cannot be deleted this way, as only the timer service task knows
+ * whether the callback of the timer is running.
+ *
+ * @return pdPASS, unless no timer has been created yet.
+ */
+#if ( configUSE_TIMER_WHEEL == 1 )
+	#define xTimerStartDirectFromISR( xTimer, pxHigherPriorityTaskWoken ) xTimerGenericCommandDirect( ( xTimer ), tmrCOMMAND_START, ( xTaskGetTickCountFromISR() ), ( pxHigherPriorityTaskWoken ) )
+	#define xTimerResetDirectFromISR( xTimer, pxHigherPriorityTaskWoken ) xTimerGenericCommandDirect( ( xTimer ), tmrCOMMAND_START, ( xTaskGetTickCountFromISR() ), ( pxHigherPriorityTaskWoken ) )
+	#define xTimerStopDirectFromISR( xTimer, pxHigherPriorityTaskWoken ) xTimerGenericCommandDirect( ( xTimer ), tmrCOMMAND_STOP, 0U, ( pxHigherPriorityTaskWoken ) )
+	#define xTimerChangePeriodDirectFromISR( xTimer, xNewPeriod, pxHigherPriorityTaskWoken ) xTimerGenericCommandDirect( ( xTimer ), tmrCOMMAND_CHANGE_PERIOD, ( xNewPeriod ), ( pxHigherPriorityTaskWoken ) )
+#endif
+
+/**
+ * portBASE_TYPE xTimerPendFunctionCallFromISR( tmrPENDED_FUNCTION xFunctionToPend,
+ *                                              void *pvParameter1,
+ *                                              unsigned long ulParameter2,
+ *                                              signed portBASE_TYPE *pxHigherPriorityTaskWoken );
+ *
+ * INCLUDE_xTimerPendFunctionCall must be set to 1 in FreeRTOSConfig.h for
+ * this function to be available.
+ *
+ * Used from an interrupt to have xFunctionToPend( pvParameter1, ulParameter2 )
+ * run by the timer service task (timer daemon task), so work that need not be
+ * done in the interrupt can leave it.  The function and its two parameters
+ * are sent on the timer command queue, in the order they are pended and after
+ * any timer commands already waiting.  The function runs at
+ * configTIMER_TASK_PRIORITY, on the stack of the timer service task, and
+ * must not block, as that would hold up every timer.
+ *
+ * @param xFunctionToPend The function to run.
+ *
+ * @param pvParameter1 The first parameter of the function.
+ *
+ * @param ulParameter2 The second parameter of the function.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the timer service task is
+ * unblocked and has a higher priority than the task that was interrupted, in
+ * which case a context switch should be requested before the interrupt exits.
+ *
+ * @return pdPASS if the call was queued, or pdFAIL if the timer command queue
+ * was full or no timer service task has been created yet.
+ *
+ * Example usage:
+ * @verbatim
+ * // Runs in the timer service task.
+ * void vProcessBlock( void *pvBlock, unsigned long ulBytes )
+ * {
+ *     // Work through ulBytes bytes at pvBlock.
+ * }
+ *
+ * void vAnExampleInterruptServiceRoutine( void )
+ * {
+ * portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+ *
+ *     // Read the block from the peripheral, then leave the rest to the
+ *     // timer service task.
+ *     xTimerPendFunctionCallFromISR( vProcessBlock, ( void * ) ucBlock, ulBytes, &xHigherPriorityTaskWoken );
+ *
+ *     portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
+ * }
+ * @endverbatim
+ */
+portBASE_TYPE xTimerPendFunctionCallFromISR( tmrPENDED_FUNCTION xFunctionToPend, void *pvParameter1, unsigned long ulParameter2, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * portBASE_TYPE xTimerPendFunctionCall( tmrPENDED_FUNCTION xFunctionToPend,
+ *                                       void *pvParameter1,
+ *                                       unsigned long ulParameter2,
+ *                                       portTickType xTicksToWait );
+ *
+ * INCLUDE_xTimerPendFunctionCall must be set to 1 in FreeRTOSConfig.h for
+ * this function to be available.
+ *
+ * The task version of xTimerPendFunctionCallFromISR().  Waits up to
+ * xTicksToWait for space in the timer command queue.
+ *
+ * @return pdPASS if the call was queued, otherwise pdFAIL.
+ */
+portBASE_TYPE xTimerPendFunctionCall( tmrPENDED_FUNCTION xFunctionToPend, void *pvParameter1, unsigned long ulParameter2, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
 /*
  * Functions beyond this part are not part of the public API and are intended
  * for use by the kernel only.
  */
 portBASE_TYPE xTimerCreateTimerTask( void ) PRIVILEGED_FUNCTION;
 portBASE_TYPE xTimerGenericCommand( xTimerHandle xTimer, portBASE_TYPE xCommandID, portTickType xOptionalValue, signed portBASE_TYPE *pxHigherPriorityTaskWoken, portTickType xBlockTime ) PRIVILEGED_FUNCTION;
+#if ( configUSE_TIMER_WHEEL == 1 )
+	portBASE_TYPE xTimerGenericCommandDirect( xTimerHandle xTimer, portBASE_TYPE xCommandID, portTickType xOptionalValue, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+#endif
 
 #ifdef __cplusplus
 }
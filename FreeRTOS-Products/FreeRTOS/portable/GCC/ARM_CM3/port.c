@@ -69,11 +69,13 @@ FreeRTOS.org versions prior to V4.4.0 did not include this definition. */
 /* Constants required to manipulate the NVIC. */
 #define portNVIC_SYSTICK_CTRL		( ( volatile unsigned long *) 0xe000e010 )
 #define portNVIC_SYSTICK_LOAD		( ( volatile unsigned long *) 0xe000e014 )
+#define portNVIC_SYSTICK_CURRENT_VALUE	( ( volatile unsigned long *) 0xe000e018 )
 #define portNVIC_INT_CTRL			( ( volatile unsigned long *) 0xe000ed04 )
 #define portNVIC_SYSPRI2			( ( volatile unsigned long *) 0xe000ed20 )
 #define portNVIC_SYSTICK_CLK		0x00000004
 #define portNVIC_SYSTICK_INT		0x00000002
 #define portNVIC_SYSTICK_ENABLE		0x00000001
+#define portNVIC_SYSTICK_COUNT_FLAG	0x00010000
 #define portNVIC_PENDSVSET			0x10000000
 #define portNVIC_PENDSV_PRI			( ( ( unsigned long ) configKERNEL_INTERRUPT_PRIORITY ) << 16 )
 #define portNVIC_SYSTICK_PRI		( ( ( unsigned long ) configKERNEL_INTERRUPT_PRIORITY ) << 24 )
@@ -81,6 +83,18 @@ FreeRTOS.org versions prior to V4.4.0 did not include this definition. */
 /* Constants required to set up the initial stack. */
 #define portINITIAL_XPSR			( 0x01000000 )
 
+/* SysTick is a 24 bit down counter. */
+#define portMAX_24_BIT_NUMBER		( 0xffffffUL )
+
+/* The core clock cycles SysTick is stopped for while vPortSuppressTicksAndSleep()
+reprograms it, which are taken off the sleep so the tick count does not drift
+behind calendar time. */
+#define portMISSED_COUNTS_FACTOR	( 45UL )
+
+/* The DWT cycle counter, used to time the wake from sleep and the tick
+interrupt.  It only counts once the application has enabled it. */
+#define portDWT_CYCCNT				( ( volatile unsigned long *) 0xe0001004 )
+
 /* The priority used by the kernel is assigned to a variable to make access
 from inline assembler easier. */
 const unsigned long ulKernelPriority = configKERNEL_INTERRUPT_PRIORITY;
@@ -89,6 +103,27 @@ const unsigned long ulKernelPriority = configKERNEL_INTERRUPT_PRIORITY;
 variable. */
 static unsigned portBASE_TYPE uxCriticalNesting = 0xaaaaaaaa;
 
+/* The SysTick counts in one tick, which are only known once the clock has
+been configured, as configCPU_CLOCK_HZ is SystemCoreClock. */
+static unsigned long ulTimerCountsForOneTick = 0;
+
+#if configUSE_TICKLESS_IDLE == 1
+
+	/* The most ticks SysTick can be stopped for, and the counts lost each
+	time it is stopped and restarted. */
+	static unsigned long ulMaximumPossibleSuppressedTicks = 0;
+	static unsigned long ulStoppedTimerCompensation = 0;
+
+	static xPortSleepStats xSleepStats = { 0 };
+
+#endif /* configUSE_TICKLESS_IDLE */
+
+#if configGENERATE_TICK_STATS == 1
+
+	static xPortTickStats xTickStats = { 0 };
+
+#endif /* configGENERATE_TICK_STATS */
+
 /*
  * Setup the timer to generate the tick interrupts.
  */
@@ -255,6 +290,9 @@ void xPortPendSVHandler( void )
 void xPortSysTickHandler( void )
 {
 unsigned long ulDummy;
+#if configGENERATE_TICK_STATS == 1
+	unsigned long ulStartCycles, ulCycles;
+#endif
 
 	/* If using preemption, also force a context switch. */
 	#if configUSE_PREEMPTION == 1
@@ -263,21 +301,215 @@ unsigned long ulDummy;
 
 	ulDummy = portSET_INTERRUPT_MASK_FROM_ISR();
 	{
+		#if configGENERATE_TICK_STATS == 1
+			ulStartCycles = *(portDWT_CYCCNT);
+		#endif
+
 		vTaskIncrementTick();
+
+		#if configGENERATE_TICK_STATS == 1
+		{
+			/* The time the interrupts that use the kernel API are held
+			off for. */
+			ulCycles = *(portDWT_CYCCNT) - ulStartCycles;
+			xTickStats.ulTicks++;
+			xTickStats.ulCycles += ulCycles;
+			if( ulCycles > xTickStats.ulMaxCycles )
+			{
+				xTickStats.ulMaxCycles = ulCycles;
+			}
+		}
+		#endif
 	}
 	portCLEAR_INTERRUPT_MASK_FROM_ISR( ulDummy );
 }
 /*-----------------------------------------------------------*/
 
+#if configGENERATE_TICK_STATS == 1
+
+	void vPortGetTickStats( xPortTickStats *pxStats )
+	{
+		portENTER_CRITICAL();
+		{
+			*pxStats = xTickStats;
+			xTickStats.ulMaxCycles = 0UL;
+		}
+		portEXIT_CRITICAL();
+	}
+
+#endif /* configGENERATE_TICK_STATS */
+/*-----------------------------------------------------------*/
+
 /*
  * Setup the systick timer to generate the tick interrupts at the required
  * frequency.
  */
 void prvSetupTimerInterrupt( void )
 {
+	ulTimerCountsForOneTick = ( configCPU_CLOCK_HZ / configTICK_RATE_HZ );
+
+	#if configUSE_TICKLESS_IDLE == 1
+	{
+		ulMaximumPossibleSuppressedTicks = portMAX_24_BIT_NUMBER / ulTimerCountsForOneTick;
+		ulStoppedTimerCompensation = portMISSED_COUNTS_FACTOR;
+	}
+	#endif /* configUSE_TICKLESS_IDLE */
+
 	/* Configure SysTick to interrupt at the requested rate. */
-	*(portNVIC_SYSTICK_LOAD) = ( configCPU_CLOCK_HZ / configTICK_RATE_HZ ) - 1UL;
+	*(portNVIC_SYSTICK_LOAD) = ulTimerCountsForOneTick - 1UL;
 	*(portNVIC_SYSTICK_CTRL) = portNVIC_SYSTICK_CLK | portNVIC_SYSTICK_INT | portNVIC_SYSTICK_ENABLE;
 }
 /*-----------------------------------------------------------*/
 
+#if configUSE_TICKLESS_IDLE == 1
+
+	void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime )
+	{
+	unsigned long ulReloadValue, ulCompleteTickPeriods, ulCompletedSysTickDecrements, ulCalculatedLoadValue;
+	unsigned long ulWakeTime, ulWakeCycles;
+	portTickType xModifiableIdleTime;
+
+		/* Called by the idle task with the scheduler suspended. */
+		if( xExpectedIdleTime > ulMaximumPossibleSuppressedTicks )
+		{
+			xExpectedIdleTime = ulMaximumPossibleSuppressedTicks;
+		}
+
+		/* Stop SysTick while it is reprogrammed.  The counts it misses are
+		made up by ulStoppedTimerCompensation. */
+		*(portNVIC_SYSTICK_CTRL) &= ~portNVIC_SYSTICK_ENABLE;
+
+		/* Sleep until the end of the tick in progress, then for all but one
+		of the remaining ticks. */
+		ulReloadValue = *(portNVIC_SYSTICK_CURRENT_VALUE) + ( ulTimerCountsForOneTick * ( xExpectedIdleTime - 1UL ) );
+		if( ulReloadValue > ulStoppedTimerCompensation )
+		{
+			ulReloadValue -= ulStoppedTimerCompensation;
+		}
+
+		/* PRIMASK rather than BASEPRI masks the interrupts, as WFI still
+		wakes on an interrupt masked by PRIMASK, but the interrupt does not
+		run until the tick count has been put right. */
+		__asm volatile( "cpsid i" ::: "memory" );
+
+		if( eTaskConfirmSleepModeStatus() == eAbortSleep )
+		{
+			/* Restart SysTick from where it stopped, then put back the reload
+			value of a whole tick for the tick after. */
+			*(portNVIC_SYSTICK_LOAD) = *(portNVIC_SYSTICK_CURRENT_VALUE);
+			*(portNVIC_SYSTICK_CTRL) |= portNVIC_SYSTICK_ENABLE;
+			*(portNVIC_SYSTICK_LOAD) = ulTimerCountsForOneTick - 1UL;
+
+			xSleepStats.ulAborts++;
+
+			__asm volatile( "cpsie i" ::: "memory" );
+		}
+		else
+		{
+			/* SysTick restarts from the new reload value. */
+			*(portNVIC_SYSTICK_LOAD) = ulReloadValue;
+			*(portNVIC_SYSTICK_CURRENT_VALUE) = 0UL;
+			*(portNVIC_SYSTICK_CTRL) |= portNVIC_SYSTICK_ENABLE;
+
+			xModifiableIdleTime = xExpectedIdleTime;
+			configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+			if( xModifiableIdleTime > 0 )
+			{
+				__asm volatile( "dsb" ::: "memory" );
+				__asm volatile( "wfi" );
+				__asm volatile( "isb" );
+			}
+			ulWakeTime = *(portDWT_CYCCNT);
+			configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+			/* Let the interrupt that woke the processor run at once, while
+			SysTick still counts the time it takes. */
+			ulWakeCycles = *(portDWT_CYCCNT) - ulWakeTime;
+			__asm volatile( "cpsie i" ::: "memory" );
+			__asm volatile( "dsb" );
+			__asm volatile( "isb" );
+
+			/* Mask interrupts again while SysTick is stopped, as time spent
+			in an interrupt then would be lost from the tick count. */
+			__asm volatile( "cpsid i" ::: "memory" );
+			__asm volatile( "dsb" );
+			__asm volatile( "isb" );
+
+			/* Stop SysTick by writing the control register rather than
+			changing it, as reading it clears the count flag, which shows
+			whether SysTick reached zero. */
+			*(portNVIC_SYSTICK_CTRL) = portNVIC_SYSTICK_CLK | portNVIC_SYSTICK_INT;
+
+			if( ( *(portNVIC_SYSTICK_CTRL) & portNVIC_SYSTICK_COUNT_FLAG ) != 0UL )
+			{
+				/* SysTick ended the sleep, and its interrupt has run or is
+				pending.  Either way it counts the last of the expected ticks
+				itself, when the scheduler resumes.  SysTick has reloaded with
+				ulReloadValue, so only what is left of the tick now in
+				progress is loaded. */
+				ulCalculatedLoadValue = ( ulTimerCountsForOneTick - 1UL ) - ( ulReloadValue - *(portNVIC_SYSTICK_CURRENT_VALUE) );
+
+				/* Do not allow a tiny value, or one that has underflowed
+				because the post sleep processing took too long. */
+				if( ( ulCalculatedLoadValue < ulStoppedTimerCompensation ) || ( ulCalculatedLoadValue > ulTimerCountsForOneTick ) )
+				{
+					ulCalculatedLoadValue = ( ulTimerCountsForOneTick - 1UL );
+				}
+
+				*(portNVIC_SYSTICK_LOAD) = ulCalculatedLoadValue;
+
+				ulCompleteTickPeriods = xExpectedIdleTime - 1UL;
+				ulCompletedSysTickDecrements = ( xExpectedIdleTime * ulTimerCountsForOneTick ) - ulCalculatedLoadValue;
+				xSleepStats.ulTickWakes++;
+			}
+			else
+			{
+				/* Another interrupt ended the sleep.  Count the whole ticks
+				that passed, and load what is left of the tick in
+				progress. */
+				ulCompletedSysTickDecrements = ( xExpectedIdleTime * ulTimerCountsForOneTick ) - *(portNVIC_SYSTICK_CURRENT_VALUE);
+				ulCompleteTickPeriods = ulCompletedSysTickDecrements / ulTimerCountsForOneTick;
+				*(portNVIC_SYSTICK_LOAD) = ( ( ulCompleteTickPeriods + 1UL ) * ulTimerCountsForOneTick ) - ulCompletedSysTickDecrements;
+			}
+
+			/* Restart SysTick from the load value, then put back the reload
+			value of a whole tick for the tick after. */
+			*(portNVIC_SYSTICK_CURRENT_VALUE) = 0UL;
+			*(portNVIC_SYSTICK_CTRL) = portNVIC_SYSTICK_CLK | portNVIC_SYSTICK_INT | portNVIC_SYSTICK_ENABLE;
+			*(portNVIC_SYSTICK_LOAD) = ulTimerCountsForOneTick - 1UL;
+
+			vTaskStepTick( ulCompleteTickPeriods );
+
+			/* Only the idle task writes the statistics, and no task can run
+			to read them while the scheduler is suspended. */
+			xSleepStats.ulSleeps++;
+			xSleepStats.ulTicksSuppressed += ulCompleteTickPeriods;
+			xSleepStats.ullSleepCounts += ulCompletedSysTickDecrements;
+			xSleepStats.ulWakeCycles += ulWakeCycles;
+			if( ulWakeCycles > xSleepStats.ulMaxWakeCycles )
+			{
+				xSleepStats.ulMaxWakeCycles = ulWakeCycles;
+			}
+
+			__asm volatile( "cpsie i" ::: "memory" );
+		}
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+#if configUSE_TICKLESS_IDLE == 1
+
+	void vPortGetSleepStats( xPortSleepStats *pxStats )
+	{
+		portENTER_CRITICAL();
+		{
+			*pxStats = xSleepStats;
+			xSleepStats.ulMaxWakeCycles = 0UL;
+		}
+		portEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
@@ -102,6 +102,26 @@ extern void vPortYieldFromISR( void );
 #define portEND_SWITCHING_ISR( xSwitchRequired ) if( xSwitchRequired ) vPortYieldFromISR()
 /*-----------------------------------------------------------*/
 
+/* Port optimised task selection.  Bit n of uxReadyPriorities is set while
+there are ready tasks of priority n, and the highest priority with ready tasks
+is found with the CLZ instruction, so configMAX_PRIORITIES can be at most 32. */
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+
+	static inline unsigned char ucPortCountLeadingZeros( unsigned long ulBitmap )
+	{
+	unsigned char ucReturn;
+
+		__asm volatile ( "clz %0, %1" : "=r" ( ucReturn ) : "r" ( ulBitmap ) );
+		return ucReturn;
+	}
+
+	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = ( 31 - ucPortCountLeadingZeros( ( uxReadyPriorities ) ) )
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+/*-----------------------------------------------------------*/
+
 
 /* Critical section management. */
 
@@ -148,6 +168,58 @@ extern void vPortExitCritical( void );
 
 #define portNOP()
 
+/* The Cortex-M3 has a single core that sees its own memory accesses in
+order, so only the compiler has to be stopped from moving them. */
+#define portMEMORY_BARRIER() __asm volatile( "" ::: "memory" )
+/*-----------------------------------------------------------*/
+
+/* Tickless idle.  The idle task stops SysTick and sleeps with WFI for as
+many ticks as it expects to be idle, up to the most the 24 bit SysTick can
+count.  Sleep mode is used rather than deep sleep, so SysTick keeps running
+and the time asleep is known exactly. */
+#if configUSE_TICKLESS_IDLE == 1
+
+	extern void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+
+	/* Counted since the scheduler started, by vPortSuppressTicksAndSleep(). */
+	typedef struct xPORT_SLEEP_STATS
+	{
+		unsigned long ulSleeps;				/* Times the processor slept. */
+		unsigned long ulAborts;				/* Sleeps abandoned because a task became ready first. */
+		unsigned long ulTickWakes;			/* Sleeps that lasted the whole expected idle time.  The rest were ended early by another interrupt. */
+		unsigned long ulTicksSuppressed;	/* Tick interrupts that did not happen. */
+		unsigned long long ullSleepCounts;	/* SysTick counts, of the core clock, spent asleep. */
+		unsigned long ulWakeCycles;			/* Total core clock cycles from waking until the interrupt that woke the processor can run. */
+		unsigned long ulMaxWakeCycles;		/* The most of those for one sleep, since the last call to vPortGetSleepStats(). */
+	} xPortSleepStats;
+
+	/*
+	 * Copy the sleep statistics into *pxStats, and start the next maximum.
+	 */
+	void vPortGetSleepStats( xPortSleepStats *pxStats );
+
+#endif /* configUSE_TICKLESS_IDLE */
+
+/* Tick interrupt statistics.  The cycles are counted by the DWT cycle
+counter, so are only right once the application has enabled it. */
+#if configGENERATE_TICK_STATS == 1
+
+	/* Counted since the scheduler started, by xPortSysTickHandler(). */
+	typedef struct xPORT_TICK_STATS
+	{
+		unsigned long ulTicks;				/* Tick interrupts. */
+		unsigned long ulCycles;				/* Total core clock cycles spent processing them, with interrupts masked.  Only differences are meaningful, as it wraps. */
+		unsigned long ulMaxCycles;			/* The most for one tick, since the last call to vPortGetTickStats(). */
+	} xPortTickStats;
+
+	/*
+	 * Copy the tick statistics into *pxStats, and start the next maximum.
+	 */
+	void vPortGetTickStats( xPortTickStats *pxStats );
+
+#endif /* configGENERATE_TICK_STATS */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,538 @@
+/*
+ * An implementation of pvPortMalloc() and vPortFree() that takes the same
+ * time whatever state the heap is in, using a two level segregated fit
+ * (TLSF) allocator, and that combines adjacent free blocks.
+ *
+ * Free blocks are kept in lists by size.  The first level divides the sizes
+ * by powers of two, and the second level divides each power of two into
+ * heapSL_COUNT equal ranges.  A bitmap of each level records which lists are
+ * not empty, so the list to take a block from is found with two count leading
+ * or trailing zeros instructions rather than by walking a list.  Every block
+ * records the block before it in memory, so a freed block is merged with any
+ * free neighbour on either side in constant time.  Neither pvPortMalloc() nor
+ * vPortFree() contains a loop.
+ *
+ * A request is rounded up to the start of the next list before the lists are
+ * searched, so the first block of the list found is always big enough.  The
+ * cost is that a request can fail while a block big enough for it is free, if
+ * that block is in the same list as the request would be.  Blocks are split,
+ * so rounding up wastes nothing once a block is found.
+ *
+ * An allocated block has a header of two words, the size and the address of
+ * the block before it.  The two list pointers of a free block are kept in the
+ * space that would be returned to the caller.
+ *
+ * As well as xPortGetFreeHeapSize(), the size of the largest free block, the
+ * fragmentation and the least free space there has ever been are available -
+ * see portable.h.
+ *
+ * See heap_2.c, in the FreeRTOS distribution, for the allocator this replaces.
+ */
+#include <stdlib.h>
+#include <stddef.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Each power of two is divided into 2^heapSL_LOG2 second level lists. */
+#define heapSL_LOG2				( 3 )
+#define heapSL_COUNT			( 1 << heapSL_LOG2 )
+
+#if portBYTE_ALIGNMENT == 8
+	#define heapALIGNMENT_LOG2	( 3 )
+#elif portBYTE_ALIGNMENT == 4
+	#define heapALIGNMENT_LOG2	( 2 )
+#elif portBYTE_ALIGNMENT == 2
+	#define heapALIGNMENT_LOG2	( 1 )
+#else
+	#define heapALIGNMENT_LOG2	( 0 )
+#endif
+
+/* Block sizes are multiples of portBYTE_ALIGNMENT, so blocks smaller than
+heapSMALL_BLOCK_SIZE all go in first level list 0, whose second level lists
+are portBYTE_ALIGNMENT apart. */
+#define heapFL_SHIFT			( heapSL_LOG2 + heapALIGNMENT_LOG2 )
+#define heapSMALL_BLOCK_SIZE	( ( size_t ) 1 << heapFL_SHIFT )
+
+/* The first level lists cover heaps of up to 2^heapFL_MAX_LOG2 bytes. */
+#define heapFL_MAX_LOG2			( 16 )
+#define heapFL_COUNT			( heapFL_MAX_LOG2 - heapFL_SHIFT + 1 )
+
+/* The index of the most and least significant set bits of a non zero value.
+GCC uses the CLZ instruction of the Cortex-M3 for the first, and CLZ of the
+bit reversed value (RBIT) for the second. */
+#define heapFLS( x )			( 31 - __builtin_clz( ( unsigned int ) ( x ) ) )
+#define heapFFS( x )			( __builtin_ctz( ( unsigned int ) ( x ) ) )
+
+#define heapROUND_UP( x )		( ( ( x ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* Bit 0 of the size of a block is set while the block is free. */
+#define heapBLOCK_FREE			( ( size_t ) 1 )
+#define heapBLOCK_SIZE( pxBlock )	( ( pxBlock )->xBlockSize & ~heapBLOCK_FREE )
+#define heapIS_FREE( pxBlock )	( ( ( pxBlock )->xBlockSize & heapBLOCK_FREE ) != 0 )
+#define heapNEXT_PHYSICAL( pxBlock )	( ( xBlockHeader * ) ( ( ( unsigned char * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) ) )
+
+/* The header of every block.  Only the first two members are kept while the
+block is allocated - the list pointers overlap the memory given to the
+caller. */
+typedef struct A_BLOCK_HEADER
+{
+	struct A_BLOCK_HEADER *pxPrevPhysical;	/*<< The block before this one in memory, NULL for the first block. */
+	size_t xBlockSize;						/*<< The size of the block, including the header, plus heapBLOCK_FREE while free. */
+	struct A_BLOCK_HEADER *pxNextFree;		/*<< The next block in the same free list. */
+	struct A_BLOCK_HEADER *pxPrevFree;		/*<< The previous block in the same free list. */
+} xBlockHeader;
+
+/* The part of the header kept while a block is allocated, and the smallest
+block that can hold the whole header when it is freed. */
+#define heapHEADER_SIZE			( heapROUND_UP( offsetof( xBlockHeader, pxNextFree ) ) )
+#define heapMINIMUM_BLOCK_SIZE	( heapROUND_UP( sizeof( xBlockHeader ) ) )
+
+/* Allocate the memory for the heap.  The struct is used to force byte
+alignment without using any non-portable code. */
+static union xRTOS_HEAP
+{
+	#if portBYTE_ALIGNMENT == 8
+		volatile portDOUBLE dDummy;
+	#else
+		volatile unsigned long ulDummy;
+	#endif
+	unsigned char ucHeap[ configTOTAL_HEAP_SIZE ];
+} xHeap;
+
+/* The heads of the free lists, and the bitmaps of the lists that are not
+empty - bit n of ulFLBitmap for first level n, and bit n of ucSLBitmaps[ f ]
+for second level list n of first level f. */
+static xBlockHeader *pxFreeLists[ heapFL_COUNT ][ heapSL_COUNT ];
+static unsigned long ulFLBitmap = 0UL;
+static unsigned char ucSLBitmaps[ heapFL_COUNT ];
+
+static portBASE_TYPE xHeapHasBeenInitialised = pdFALSE;
+
+/* The statistics.  The free bytes include the headers of the free blocks. */
+static size_t xFreeBytesRemaining = 0;
+static size_t xMinimumEverFreeBytesRemaining = 0;
+static size_t xNumberOfFreeBlocks = 0;
+static size_t xNumberOfAllocations = 0;
+static size_t xNumberOfFrees = 0;
+static size_t xNumberOfFailures = 0;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Make the whole heap one free block, followed by an allocated block of zero
+ * size that stops the last block being merged with whatever follows the heap.
+ */
+static void prvHeapInit( void );
+
+/*
+ * Find the lists a block of xSize bytes belongs in.
+ */
+static void prvMapping( size_t xSize, unsigned portBASE_TYPE *puxFL, unsigned portBASE_TYPE *puxSL );
+
+/*
+ * Return a free block of at least xSize bytes, without removing it from its
+ * list, or NULL if there is none.
+ */
+static xBlockHeader *prvFindSuitableBlock( size_t xSize );
+
+/*
+ * Add a block to, or remove it from, the free list for its size.
+ */
+static void prvInsertFreeBlock( xBlockHeader *pxBlock );
+static void prvRemoveFreeBlock( xBlockHeader *pxBlock );
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+xBlockHeader *pxBlock, *pxNewBlock;
+void *pvReturn = NULL;
+
+	vTaskSuspendAll();
+	{
+		/* If this is the first call to malloc then the heap will require
+		initialisation to setup the free lists. */
+		if( xHeapHasBeenInitialised == pdFALSE )
+		{
+			prvHeapInit();
+		}
+
+		if( ( xWantedSize > 0 ) && ( xWantedSize < configTOTAL_HEAP_SIZE ) )
+		{
+			/* The wanted size is increased so it can contain the header, and
+			so the block can hold the whole header once it is freed. */
+			xWantedSize = heapROUND_UP( xWantedSize + heapHEADER_SIZE );
+
+			if( xWantedSize < heapMINIMUM_BLOCK_SIZE )
+			{
+				xWantedSize = heapMINIMUM_BLOCK_SIZE;
+			}
+
+			pxBlock = prvFindSuitableBlock( xWantedSize );
+
+			if( pxBlock != NULL )
+			{
+				prvRemoveFreeBlock( pxBlock );
+
+				/* If the rest of the block is big enough to be a block on its
+				own, it is split off and returned to the free lists.  The
+				block after it cannot be free, as free blocks are always
+				merged, so there is nothing to merge it with. */
+				if( ( pxBlock->xBlockSize - xWantedSize ) >= heapMINIMUM_BLOCK_SIZE )
+				{
+					pxNewBlock = ( void * ) ( ( ( unsigned char * ) pxBlock ) + xWantedSize );
+					pxNewBlock->xBlockSize = pxBlock->xBlockSize - xWantedSize;
+					pxNewBlock->pxPrevPhysical = pxBlock;
+					heapNEXT_PHYSICAL( pxNewBlock )->pxPrevPhysical = pxNewBlock;
+					pxBlock->xBlockSize = xWantedSize;
+
+					prvInsertFreeBlock( pxNewBlock );
+				}
+
+				pvReturn = ( void * ) ( ( ( unsigned char * ) pxBlock ) + heapHEADER_SIZE );
+				xNumberOfAllocations++;
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+			}
+		}
+
+		if( pvReturn == NULL )
+		{
+			xNumberOfFailures++;
+		}
+	}
+	xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+xBlockHeader *pxBlock, *pxNeighbour;
+
+	if( pv )
+	{
+		/* The memory being freed will have a header immediately before it.
+		The void cast is used to prevent byte alignment warnings from the
+		compiler. */
+		pxBlock = ( void * ) ( ( ( unsigned char * ) pv ) - heapHEADER_SIZE );
+		configASSERT( !heapIS_FREE( pxBlock ) );
+
+		vTaskSuspendAll();
+		{
+			/* Merge with the block before, if it is free. */
+			pxNeighbour = pxBlock->pxPrevPhysical;
+			if( ( pxNeighbour != NULL ) && heapIS_FREE( pxNeighbour ) )
+			{
+				prvRemoveFreeBlock( pxNeighbour );
+				pxNeighbour->xBlockSize += pxBlock->xBlockSize;
+				pxBlock = pxNeighbour;
+				heapNEXT_PHYSICAL( pxBlock )->pxPrevPhysical = pxBlock;
+			}
+
+			/* And with the block after, if it is free.  The zero size block at
+			the end of the heap never is. */
+			pxNeighbour = heapNEXT_PHYSICAL( pxBlock );
+			if( heapIS_FREE( pxNeighbour ) )
+			{
+				prvRemoveFreeBlock( pxNeighbour );
+				pxBlock->xBlockSize += pxNeighbour->xBlockSize;
+				heapNEXT_PHYSICAL( pxBlock )->pxPrevPhysical = pxBlock;
+			}
+
+			prvInsertFreeBlock( pxBlock );
+			xNumberOfFrees++;
+		}
+		xTaskResumeAll();
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+size_t xReturn;
+
+	vTaskSuspendAll();
+	{
+		if( xHeapHasBeenInitialised == pdFALSE )
+		{
+			prvHeapInit();
+		}
+
+		xReturn = xFreeBytesRemaining;
+	}
+	xTaskResumeAll();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+size_t xReturn;
+
+	vTaskSuspendAll();
+	{
+		if( xHeapHasBeenInitialised == pdFALSE )
+		{
+			prvHeapInit();
+		}
+
+		xReturn = xMinimumEverFreeBytesRemaining;
+	}
+	xTaskResumeAll();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetLargestFreeBlockSize( void )
+{
+xBlockHeader *pxBlock;
+unsigned portBASE_TYPE uxFL, uxSL;
+size_t xReturn = 0;
+
+	vTaskSuspendAll();
+	{
+		if( xHeapHasBeenInitialised == pdFALSE )
+		{
+			prvHeapInit();
+		}
+
+		/* The largest block is in the highest list that is not empty, but the
+		blocks of a list are not sorted, so the list is walked. */
+		if( ulFLBitmap != 0UL )
+		{
+			uxFL = ( unsigned portBASE_TYPE ) heapFLS( ulFLBitmap );
+			uxSL = ( unsigned portBASE_TYPE ) heapFLS( ucSLBitmaps[ uxFL ] );
+
+			for( pxBlock = pxFreeLists[ uxFL ][ uxSL ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+			{
+				if( heapBLOCK_SIZE( pxBlock ) > xReturn )
+				{
+					xReturn = heapBLOCK_SIZE( pxBlock );
+				}
+			}
+		}
+	}
+	xTaskResumeAll();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+unsigned portBASE_TYPE uxPortGetHeapFragmentation( void )
+{
+size_t xFree, xLargest;
+unsigned portBASE_TYPE uxReturn = 0;
+
+	/* The two are read separately, so could be inconsistent if the heap is
+	used in between, but each is correct when it is read. */
+	xLargest = xPortGetLargestFreeBlockSize();
+	xFree = xPortGetFreeHeapSize();
+
+	if( ( xFree != 0 ) && ( xLargest < xFree ) )
+	{
+		uxReturn = ( unsigned portBASE_TYPE ) ( 100UL - ( ( ( unsigned long ) xLargest * 100UL ) / ( unsigned long ) xFree ) );
+	}
+
+	return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( xHeapStats *pxStats )
+{
+	pxStats->xLargestFreeBlockSize = xPortGetLargestFreeBlockSize();
+
+	vTaskSuspendAll();
+	{
+		pxStats->xFreeBytesRemaining = xFreeBytesRemaining;
+		pxStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		pxStats->xNumberOfFreeBlocks = xNumberOfFreeBlocks;
+		pxStats->xNumberOfAllocations = xNumberOfAllocations;
+		pxStats->xNumberOfFrees = xNumberOfFrees;
+		pxStats->xNumberOfFailures = xNumberOfFailures;
+	}
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+xBlockHeader *pxFirstBlock, *pxEndBlock;
+size_t xFirstBlockSize;
+
+	/* The first level lists must cover the whole heap. */
+	configASSERT( configTOTAL_HEAP_SIZE < ( ( size_t ) 1 << heapFL_MAX_LOG2 ) );
+
+	/* The union keeps the start of the heap aligned.  The end of the heap is
+	taken by the zero size block, which is given room for a whole header so
+	nothing is written outside the heap.  The void casts are used to prevent
+	byte alignment warnings from the compiler. */
+	xFirstBlockSize = ( configTOTAL_HEAP_SIZE & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) ) - heapMINIMUM_BLOCK_SIZE;
+
+	pxFirstBlock = ( void * ) xHeap.ucHeap;
+	pxFirstBlock->pxPrevPhysical = NULL;
+	pxFirstBlock->xBlockSize = xFirstBlockSize;
+
+	pxEndBlock = ( void * ) ( xHeap.ucHeap + xFirstBlockSize );
+	pxEndBlock->pxPrevPhysical = pxFirstBlock;
+	pxEndBlock->xBlockSize = 0;
+
+	prvInsertFreeBlock( pxFirstBlock );
+	xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+	xHeapHasBeenInitialised = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMapping( size_t xSize, unsigned portBASE_TYPE *puxFL, unsigned portBASE_TYPE *puxSL )
+{
+unsigned portBASE_TYPE uxFLS;
+
+	if( xSize < heapSMALL_BLOCK_SIZE )
+	{
+		*puxFL = 0;
+		*puxSL = ( unsigned portBASE_TYPE ) ( xSize >> heapALIGNMENT_LOG2 );
+	}
+	else
+	{
+		/* The top bit of the size gives the first level, and the heapSL_LOG2
+		bits below it the second. */
+		uxFLS = ( unsigned portBASE_TYPE ) heapFLS( xSize );
+		*puxSL = ( unsigned portBASE_TYPE ) ( ( xSize >> ( uxFLS - heapSL_LOG2 ) ) ^ heapSL_COUNT );
+		*puxFL = uxFLS - ( heapFL_SHIFT - 1 );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static xBlockHeader *prvFindSuitableBlock( size_t xSize )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+unsigned long ulMap;
+xBlockHeader *pxReturn = NULL;
+
+	/* Round up to the start of the next list, so every block in the list
+	found is big enough. */
+	if( xSize >= heapSMALL_BLOCK_SIZE )
+	{
+		xSize += ( ( size_t ) 1 << ( heapFLS( xSize ) - heapSL_LOG2 ) ) - 1;
+	}
+
+	prvMapping( xSize, &uxFL, &uxSL );
+
+	if( uxFL < heapFL_COUNT )
+	{
+		/* A list of this first level at or above the second level, or failing
+		that any list of a higher first level. */
+		ulMap = ( unsigned long ) ucSLBitmaps[ uxFL ] & ( ~0UL << uxSL );
+
+		if( ulMap == 0UL )
+		{
+			ulMap = ulFLBitmap & ( ~0UL << ( uxFL + 1 ) );
+
+			if( ulMap != 0UL )
+			{
+				uxFL = ( unsigned portBASE_TYPE ) heapFFS( ulMap );
+				ulMap = ( unsigned long ) ucSLBitmaps[ uxFL ];
+			}
+		}
+
+		if( ulMap != 0UL )
+		{
+			uxSL = ( unsigned portBASE_TYPE ) heapFFS( ulMap );
+			pxReturn = pxFreeLists[ uxFL ][ uxSL ];
+		}
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( xBlockHeader *pxBlock )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+
+	prvMapping( pxBlock->xBlockSize, &uxFL, &uxSL );
+
+	pxBlock->pxPrevFree = NULL;
+	pxBlock->pxNextFree = pxFreeLists[ uxFL ][ uxSL ];
+
+	if( pxBlock->pxNextFree != NULL )
+	{
+		pxBlock->pxNextFree->pxPrevFree = pxBlock;
+	}
+
+	pxFreeLists[ uxFL ][ uxSL ] = pxBlock;
+	ulFLBitmap |= 1UL << uxFL;
+	ucSLBitmaps[ uxFL ] |= ( unsigned char ) ( 1U << uxSL );
+
+	xFreeBytesRemaining += pxBlock->xBlockSize;
+	xNumberOfFreeBlocks++;
+	pxBlock->xBlockSize |= heapBLOCK_FREE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( xBlockHeader *pxBlock )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+
+	pxBlock->xBlockSize &= ~heapBLOCK_FREE;
+	prvMapping( pxBlock->xBlockSize, &uxFL, &uxSL );
+
+	if( pxBlock->pxNextFree != NULL )
+	{
+		pxBlock->pxNextFree->pxPrevFree = pxBlock->pxPrevFree;
+	}
+
+	if( pxBlock->pxPrevFree != NULL )
+	{
+		pxBlock->pxPrevFree->pxNextFree = pxBlock->pxNextFree;
+	}
+	else
+	{
+		/* The block was the head of its list. */
+		pxFreeLists[ uxFL ][ uxSL ] = pxBlock->pxNextFree;
+
+		if( pxBlock->pxNextFree == NULL )
+		{
+			ucSLBitmaps[ uxFL ] &= ( unsigned char ) ~( 1U << uxSL );
+
+			if( ucSLBitmaps[ uxFL ] == 0U )
+			{
+				ulFLBitmap &= ~( 1UL << uxFL );
+			}
+		}
+	}
+
+	xFreeBytesRemaining -= pxBlock->xBlockSize;
+	xNumberOfFreeBlocks--;
+}
+/*-----------------------------------------------------------*/
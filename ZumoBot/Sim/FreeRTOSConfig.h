@@ -0,0 +1,160 @@
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*
+ * FreeRTOS configuration for the host simulation.  The values that affect the
+ * behaviour of the application are the same as those in
+ * ZumoBot/Source/FreeRTOSConfig.h, and must be kept in step with it.  Only
+ * the settings that depend on the port differ.
+ */
+
+#include <stdint.h>
+extern uint32_t SystemCoreClock;
+
+/* Priorities to assign to tasks created by this demo. */
+#define configUART_COMMAND_CONSOLE_TASK_PRIORITY	( 3U )
+#define configSPI_7_SEG_WRITE_TASK_PRIORITY			( 2U )
+#define configI2C_TASK_PRIORITY						( 0U )
+
+/* Stack sizes to assign to tasks created by this demo.  The simulated tasks
+run on host stacks allocated by the port, so these only affect the amount of
+heap used. */
+#define configUART_COMMAND_CONSOLE_STACK_SIZE		( configMINIMAL_STACK_SIZE * 2 )
+#define configSPI_7_SEG_WRITE_TASK_STACK_SIZE		( configMINIMAL_STACK_SIZE * 2 )
+#define configI2C_TASK_STACK_SIZE					( configMINIMAL_STACK_SIZE * 4 )
+
+#define configCOMMAND_INT_MAX_OUTPUT_SIZE			1024
+
+#define configUSE_PREEMPTION			1
+#define configMAX_PRIORITIES			( ( unsigned portBASE_TYPE ) 7 )
+#define configCPU_CLOCK_HZ				( SystemCoreClock )
+#define configTICK_RATE_HZ				( ( portTickType ) 1000 )
+#define configMINIMAL_STACK_SIZE		( ( unsigned short ) 90 )
+#define configMAX_TASK_NAME_LEN			( 12 )
+#define configIDLE_SHOULD_YIELD			0
+#define configQUEUE_REGISTRY_SIZE		10
+#define configUSE_TRACE_FACILITY		1
+#define configUSE_16_BIT_TICKS			0
+#define configUSE_MUTEXES				1
+#define configUSE_CO_ROUTINES 			0
+#define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
+#define configUSE_COUNTING_SEMAPHORES 	0
+#define configUSE_ALTERNATIVE_API 		0
+#define configUSE_RECURSIVE_MUTEXES		1
+#define configUSE_TASK_NOTIFICATIONS	1
+
+/* As on the target.  Can be set to 0 with make DEFINES=... to compare. */
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION	1
+#endif
+
+/* As on the target. */
+#ifndef configSUPPORT_STATIC_ALLOCATION
+	#define configSUPPORT_STATIC_ALLOCATION	1
+#endif
+
+/* As on the target. */
+#ifndef configUSE_QUEUE_SETS
+	#define configUSE_QUEUE_SETS	1
+#endif
+
+/* Unlike the target, the tick is not stopped in idle.  The idle task never
+runs, as the simulated processor jumps straight to its next event instead. */
+#define configUSE_TICKLESS_IDLE			0
+
+/* As on the target.  The tick benchmark also builds with the sorted delayed
+list, for comparison.  The simulated port does not count the cycles of each
+tick, so configGENERATE_TICK_STATS is left at 0. */
+#ifndef configUSE_DELAY_WHEEL
+	#define configUSE_DELAY_WHEEL		1
+#endif
+
+#ifndef configDELAY_WHEEL_BITS
+	#define configDELAY_WHEEL_BITS		6
+#endif
+
+/* A stack word is twice the size it is on the target, so the heap is twice
+the size too. */
+#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 30 * 1024 ) )
+
+/* Hook function related definitions. */
+#define configUSE_TICK_HOOK				0
+#define configUSE_IDLE_HOOK				0
+#define configUSE_MALLOC_FAILED_HOOK	1
+#define configCHECK_FOR_STACK_OVERFLOW	2
+
+/* Software timer related definitions. */
+#define configUSE_TIMERS				1
+#define configTIMER_TASK_PRIORITY		( configMAX_PRIORITIES - 3 )
+#define configTIMER_QUEUE_LENGTH		10
+#define configTIMER_TASK_STACK_DEPTH	configMINIMAL_STACK_SIZE
+
+/* As on the target.  The timer benchmark also builds with the sorted list,
+for comparison. */
+#ifndef configUSE_TIMER_WHEEL
+	#define configUSE_TIMER_WHEEL		1
+#endif
+
+/* Run time stats are gathered in microseconds of host CPU time, so they show
+what the application code costs rather than how long it waits. */
+#define configGENERATE_RUN_TIME_STATS	1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE() ulPortSimHostMicroseconds()
+
+#define INCLUDE_vTaskPrioritySet			1
+#define INCLUDE_uxTaskPriorityGet			1
+#define INCLUDE_vTaskDelete					1
+#define INCLUDE_vTaskCleanUpResources		0
+#define INCLUDE_vTaskSuspend				1
+#define INCLUDE_vTaskDelayUntil				1
+#define INCLUDE_vTaskDelay					1
+#define INCLUDE_uxTaskGetStackHighWaterMark	1
+#define INCLUDE_xTimerGetTimerTaskHandle	0
+
+/* The port runs the simulated hardware in place of the idle task, so needs
+to know which task that is. */
+#define INCLUDE_xTaskGetIdleTaskHandle		1
+
+/* A failed assert ends the simulated bout, and is reported, rather than
+stopping in a loop. */
+#define configASSERT( x ) if( ( x ) == 0 ) { vPortSimAssert( __FILE__, __LINE__ ); }
+
+/* Tell the port the name of each task as it is created, so it can report the
+host CPU time used by each one. */
+#define traceTASK_CREATE( pxNewTCB ) { vPortSimTaskCreated( ( void * ) ( pxNewTCB )->pxTopOfStack, ( const char * ) ( pxNewTCB )->pcTaskName ); tracerecorderTASK_CREATE_HOOK( pxNewTCB ); }
+
+/* The trace recorder is left out by default, as the benchmarks are built from
+the same kernel objects without it.  Build with
+make DEFINES=-DconfigUSE_TRACE_RECORDER=1 to write the trace of a bout with
+sim -x.  The records are stamped with the simulated cycle counter, which only
+moves while the processor is idle, so the timeline shows the order of the
+events rather than the time the tasks take. */
+#ifndef configUSE_TRACE_RECORDER
+	#define configUSE_TRACE_RECORDER	0
+#endif
+
+#if configUSE_TRACE_RECORDER == 1
+	#include "Trace-recorder.h"
+#else
+	#define tracerecorderTASK_CREATE_HOOK( pxNewTCB )
+#endif
+
+/* The tasks run on host stacks (see port.c), so their FreeRTOS stacks are
+never written and the stack monitor would have nothing to measure. */
+#ifndef configUSE_STACK_MONITOR
+	#define configUSE_STACK_MONITOR		0
+#endif
+
+/* The interrupt priorities are only used to program the (simulated) NVIC. */
+#define configPRIO_BITS       					5
+#define configMAX_LIBRARY_INTERRUPT_PRIORITY	( 5 )
+#define configMIN_LIBRARY_INTERRUPT_PRIORITY	( 31 )
+#define configKERNEL_INTERRUPT_PRIORITY 		( configMIN_LIBRARY_INTERRUPT_PRIORITY << (8 - configPRIO_BITS) )
+#define configMAX_SYSCALL_INTERRUPT_PRIORITY 	( configMAX_LIBRARY_INTERRUPT_PRIORITY << (8 - configPRIO_BITS) )
+
+/* Implemented by the port. */
+void vPortSimAssert( const char *pcFile, unsigned long ulLine );
+void vPortSimTaskCreated( void *pvTopOfStack, const char *pcName );
+unsigned long ulPortSimHostMicroseconds( void );
+
+#endif /* FREERTOS_CONFIG_H */
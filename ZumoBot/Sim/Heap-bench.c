@@ -0,0 +1,373 @@
+/*
+ * Stress test and timing of the FreeRTOS heap, on the host.
+ *
+ * The heap is linked on its own, with the scheduler calls it makes replaced
+ * by functions that do nothing, and driven through two workloads:
+ *
+ *  + tasks: the way the application used to handle the edge of the ring -
+ *    a handful of tasks and queues that live for ever, and a task (TCB and a
+ *    1000 word stack) created and deleted over and over, with short lived
+ *    small allocations in between.
+ *  + random: heapbenchSLOTS slots, each either empty or holding a block of a
+ *    random size between 8 bytes and heapbenchMAX_RANDOM_SIZE.  Each step
+ *    picks a slot at random, and frees its block or allocates one.
+ *
+ * The time each call takes is measured with the host monotonic clock, so the
+ * worst cases include the odd host interrupt - compare the 99.9th percentile
+ * rather than the maximum.  The fragmentation is sampled every
+ * heapbenchSAMPLE_STEPS steps.
+ *
+ * Usage: heapbench [-n steps] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define heapbenchNS_PER_SECOND		( 1000000000ULL )
+
+#define heapbenchSLOTS				( 64 )
+#define heapbenchMAX_RANDOM_SIZE	( 1024UL )
+#define heapbenchSAMPLE_STEPS		( 1000UL )
+
+/* The call times are counted in heapbenchBINS bins of heapbenchBIN_NS.  The
+last bin also counts everything longer. */
+#define heapbenchBINS				( 1000 )
+#define heapbenchBIN_NS				( 10ULL )
+
+/* The sizes of the kernel objects in the tasks workload.  A stack word is
+the size of a portSTACK_TYPE, so the sizes scale with the port as they do on
+the target. */
+#define heapbenchTCB_SIZE			( 100UL )
+#define heapbenchSTACK_SIZE( x )	( ( unsigned long ) ( x ) * sizeof( portSTACK_TYPE ) )
+#define heapbenchQUEUE_SIZE			( 160UL )
+#define heapbenchSMALL_SIZE			( 32UL )
+#define heapbenchSMALL_SLOTS		( 8 )
+
+/* The times of one kind of call. */
+typedef struct xHEAPBENCH_TIMES
+{
+	unsigned long ulCalls;
+	unsigned long ulFailures;
+	unsigned long long ullTotalNanoseconds;
+	unsigned long long ullMaxNanoseconds;
+	unsigned long ulBins[ heapbenchBINS ];
+} xHeapBenchTimes;
+
+/* The results of one workload. */
+typedef struct xHEAPBENCH_RESULT
+{
+	xHeapBenchTimes xMalloc;
+	xHeapBenchTimes xFree;
+	unsigned long ulWorstFragmentation;
+} xHeapBenchResult;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Call pvPortMalloc() or vPortFree(), and add the time taken to pxResult.
+ */
+static void *prvMalloc( size_t xSize, xHeapBenchResult *pxResult );
+static void prvFree( void *pv, xHeapBenchResult *pxResult );
+
+/*
+ * The workloads.
+ */
+static void prvTasksWorkload( unsigned long ulSteps, xHeapBenchResult *pxResult );
+static void prvRandomWorkload( unsigned long ulSteps, xHeapBenchResult *pxResult );
+
+/*
+ * Sample the fragmentation every heapbenchSAMPLE_STEPS steps.
+ */
+static void prvSample( unsigned long ulStep, xHeapBenchResult *pxResult );
+
+/*
+ * Print the results of a workload, and the heap statistics at its end.
+ */
+static void prvReport( const char *pcName, const xHeapBenchResult *pxResult );
+static void prvReportTimes( const char *pcName, const xHeapBenchTimes *pxTimes );
+
+static unsigned long prvRandom( void );
+static unsigned long long prvNanoseconds( void );
+
+/*-----------------------------------------------------------*/
+
+static unsigned long ulRandomState = 1UL;
+
+/* The blocks held by the workloads.  Both workloads share the heap, and the
+tasks workload frees everything before the random workload starts. */
+static void *pvSlots[ heapbenchSLOTS ];
+
+static xHeapBenchResult xTasksResult, xRandomResult;
+
+/*-----------------------------------------------------------*/
+
+int main( int argc, char *argv[] )
+{
+unsigned long ulSteps = 1000000UL;
+int iOption;
+
+	while( ( iOption = getopt( argc, argv, "n:s:" ) ) != -1 )
+	{
+		switch( iOption )
+		{
+			case 'n' :	ulSteps = strtoul( optarg, NULL, 0 );
+						break;
+			case 's' :	ulRandomState = strtoul( optarg, NULL, 0 ) | 1UL;
+						break;
+			default :	fprintf( stderr, "Usage: heapbench [-n steps] [-s seed]\n" );
+						return EXIT_FAILURE;
+		}
+	}
+
+	printf( "%lu steps of each workload, %u byte heap\n\n", ulSteps, ( unsigned ) configTOTAL_HEAP_SIZE );
+	printf( "%-8s %-7s %10s %8s %8s %8s %8s\n", "Workload", "Call", "Calls", "Failed", "Mean ns", "99.9% ns", "Max ns" );
+
+	prvTasksWorkload( ulSteps, &xTasksResult );
+	prvReport( "tasks", &xTasksResult );
+
+	prvRandomWorkload( ulSteps, &xRandomResult );
+	prvReport( "random", &xRandomResult );
+
+	return EXIT_SUCCESS;
+}
+/*-----------------------------------------------------------*/
+
+void vTaskSuspendAll( void )
+{
+}
+/*-----------------------------------------------------------*/
+
+signed portBASE_TYPE xTaskResumeAll( void )
+{
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+	/* Failures are counted by the heap. */
+}
+/*-----------------------------------------------------------*/
+
+void vPortSimAssert( const char *pcFile, unsigned long ulLine )
+{
+	fprintf( stderr, "assert failed at %s:%lu\n", pcFile, ulLine );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+static void *prvMalloc( size_t xSize, xHeapBenchResult *pxResult )
+{
+unsigned long long ullStart, ullTime;
+void *pvReturn;
+
+	ullStart = prvNanoseconds();
+	pvReturn = pvPortMalloc( xSize );
+	ullTime = prvNanoseconds() - ullStart;
+
+	pxResult->xMalloc.ulCalls++;
+	if( pvReturn == NULL )
+	{
+		pxResult->xMalloc.ulFailures++;
+	}
+	pxResult->xMalloc.ullTotalNanoseconds += ullTime;
+	if( ullTime > pxResult->xMalloc.ullMaxNanoseconds )
+	{
+		pxResult->xMalloc.ullMaxNanoseconds = ullTime;
+	}
+	pxResult->xMalloc.ulBins[ ( ullTime / heapbenchBIN_NS < heapbenchBINS ) ? ullTime / heapbenchBIN_NS : heapbenchBINS - 1 ]++;
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFree( void *pv, xHeapBenchResult *pxResult )
+{
+unsigned long long ullStart, ullTime;
+
+	ullStart = prvNanoseconds();
+	vPortFree( pv );
+	ullTime = prvNanoseconds() - ullStart;
+
+	pxResult->xFree.ulCalls++;
+	pxResult->xFree.ullTotalNanoseconds += ullTime;
+	if( ullTime > pxResult->xFree.ullMaxNanoseconds )
+	{
+		pxResult->xFree.ullMaxNanoseconds = ullTime;
+	}
+	pxResult->xFree.ulBins[ ( ullTime / heapbenchBIN_NS < heapbenchBINS ) ? ullTime / heapbenchBIN_NS : heapbenchBINS - 1 ]++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTasksWorkload( unsigned long ulSteps, xHeapBenchResult *pxResult )
+{
+void *pvTCB = NULL, *pvStack = NULL, *pvLongLived[ 8 ];
+unsigned long ulStep, ulSlot;
+
+	/* The objects created at start up, which are never deleted - the sumo,
+	control, console and timer tasks, and their queues. */
+	pvLongLived[ 0 ] = prvMalloc( heapbenchTCB_SIZE, pxResult );
+	pvLongLived[ 1 ] = prvMalloc( heapbenchSTACK_SIZE( configMINIMAL_STACK_SIZE * 2 ), pxResult );
+	pvLongLived[ 2 ] = prvMalloc( heapbenchQUEUE_SIZE, pxResult );
+	pvLongLived[ 3 ] = prvMalloc( heapbenchTCB_SIZE, pxResult );
+	pvLongLived[ 4 ] = prvMalloc( heapbenchSTACK_SIZE( configMINIMAL_STACK_SIZE * 2 ), pxResult );
+	pvLongLived[ 5 ] = prvMalloc( heapbenchTCB_SIZE, pxResult );
+	pvLongLived[ 6 ] = prvMalloc( heapbenchSTACK_SIZE( configMINIMAL_STACK_SIZE ), pxResult );
+	pvLongLived[ 7 ] = prvMalloc( heapbenchQUEUE_SIZE, pxResult );
+
+	for( ulStep = 0UL; ulStep < ulSteps; ulStep++ )
+	{
+		if( ( ulStep & 1UL ) == 0UL )
+		{
+			/* Create or delete the edge handling task, in the same order as
+			xTaskCreate() and vTaskDelete(). */
+			if( pvStack == NULL )
+			{
+				pvTCB = prvMalloc( heapbenchTCB_SIZE, pxResult );
+				pvStack = prvMalloc( heapbenchSTACK_SIZE( 1000 ), pxResult );
+			}
+			else
+			{
+				prvFree( pvStack, pxResult );
+				prvFree( pvTCB, pxResult );
+				pvStack = NULL;
+				pvTCB = NULL;
+			}
+		}
+		else
+		{
+			/* A short lived small allocation, freed at random. */
+			ulSlot = prvRandom() % heapbenchSMALL_SLOTS;
+			if( pvSlots[ ulSlot ] == NULL )
+			{
+				pvSlots[ ulSlot ] = prvMalloc( heapbenchSMALL_SIZE + ( prvRandom() % heapbenchSMALL_SIZE ), pxResult );
+			}
+			else
+			{
+				prvFree( pvSlots[ ulSlot ], pxResult );
+				pvSlots[ ulSlot ] = NULL;
+			}
+		}
+
+		prvSample( ulStep, pxResult );
+	}
+
+	prvFree( pvStack, pxResult );
+	prvFree( pvTCB, pxResult );
+
+	for( ulSlot = 0UL; ulSlot < heapbenchSLOTS; ulSlot++ )
+	{
+		prvFree( pvSlots[ ulSlot ], pxResult );
+		pvSlots[ ulSlot ] = NULL;
+	}
+
+	for( ulSlot = 0UL; ulSlot < ( sizeof( pvLongLived ) / sizeof( void * ) ); ulSlot++ )
+	{
+		prvFree( pvLongLived[ ulSlot ], pxResult );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvRandomWorkload( unsigned long ulSteps, xHeapBenchResult *pxResult )
+{
+unsigned long ulStep, ulSlot;
+
+	for( ulStep = 0UL; ulStep < ulSteps; ulStep++ )
+	{
+		ulSlot = prvRandom() % heapbenchSLOTS;
+
+		if( pvSlots[ ulSlot ] == NULL )
+		{
+			pvSlots[ ulSlot ] = prvMalloc( 8UL + ( prvRandom() % ( heapbenchMAX_RANDOM_SIZE - 7UL ) ), pxResult );
+		}
+		else
+		{
+			prvFree( pvSlots[ ulSlot ], pxResult );
+			pvSlots[ ulSlot ] = NULL;
+		}
+
+		prvSample( ulStep, pxResult );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSample( unsigned long ulStep, xHeapBenchResult *pxResult )
+{
+unsigned long ulFragmentation;
+
+	if( ( ulStep % heapbenchSAMPLE_STEPS ) == 0UL )
+	{
+		ulFragmentation = ( unsigned long ) uxPortGetHeapFragmentation();
+		if( ulFragmentation > pxResult->ulWorstFragmentation )
+		{
+			pxResult->ulWorstFragmentation = ulFragmentation;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char *pcName, const xHeapBenchResult *pxResult )
+{
+xHeapStats xStats;
+
+	vPortGetHeapStats( &xStats );
+
+	printf( "%-8s", pcName );
+	prvReportTimes( "malloc", &( pxResult->xMalloc ) );
+	printf( "%-8s", "" );
+	prvReportTimes( "free", &( pxResult->xFree ) );
+	printf( "         %lu%% worst fragmentation, %lu free blocks at the end, %lu bytes least free since the start\n\n",
+			pxResult->ulWorstFragmentation, ( unsigned long ) xStats.xNumberOfFreeBlocks, ( unsigned long ) xStats.xMinimumEverFreeBytesRemaining );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportTimes( const char *pcName, const xHeapBenchTimes *pxTimes )
+{
+unsigned long ulBin, ulCount = 0UL;
+
+	if( pxTimes->ulCalls == 0UL )
+	{
+		printf( " %-7s %10s\n", pcName, "0" );
+		return;
+	}
+
+	/* The bin the 99.9th percentile falls in. */
+	for( ulBin = 0UL; ulBin < ( heapbenchBINS - 1 ); ulBin++ )
+	{
+		ulCount += pxTimes->ulBins[ ulBin ];
+		if( ulCount >= ( pxTimes->ulCalls - ( pxTimes->ulCalls / 1000UL ) ) )
+		{
+			break;
+		}
+	}
+
+	printf( " %-7s %10lu %8lu %8.1f %8llu %8llu\n", pcName, pxTimes->ulCalls, pxTimes->ulFailures, ( double ) pxTimes->ullTotalNanoseconds / ( double ) pxTimes->ulCalls,
+			( unsigned long long ) ( ulBin + 1UL ) * heapbenchBIN_NS, pxTimes->ullMaxNanoseconds );
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long prvRandom( void )
+{
+	/* xorshift, kept to 32 bits so the sequence is the same on any host. */
+	ulRandomState ^= ( ulRandomState << 13 ) & 0xffffffffUL;
+	ulRandomState ^= ulRandomState >> 17;
+	ulRandomState ^= ( ulRandomState << 5 ) & 0xffffffffUL;
+	return ulRandomState;
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long long prvNanoseconds( void )
+{
+struct timespec xNow;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	return ( ( unsigned long long ) xNow.tv_sec * heapbenchNS_PER_SECOND ) + ( unsigned long long ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,5 @@
+/*
+ * main.c includes the GPIO driver header with the capitalisation used by the
+ * LPCXpresso project, which only works on a case insensitive file system.
+ */
+#include "lpc17xx_gpio.h"
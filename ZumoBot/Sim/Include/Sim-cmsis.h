@@ -0,0 +1,61 @@
+#ifndef SIM_CMSIS_H
+#define SIM_CMSIS_H
+
+/*
+ * Host versions of the CMSIS core instruction and special register
+ * intrinsics.  The CMSIS versions are Cortex-M3 inline assembler, so this
+ * file is included before anything else (with -include) and defines their
+ * include guards, which leaves the rest of core_cm3.h - the NVIC, SCB and
+ * SysTick register access, which is plain C - usable on the host.
+ *
+ * Simulated interrupts never interrupt running code, so the interrupt
+ * masking intrinsics do nothing.
+ */
+
+#include <stdint.h>
+
+#define __CORE_CMINSTR_H__
+#define __CORE_CMFUNC_H__
+
+static inline void __NOP( void ) {}
+static inline void __WFI( void ) {}
+static inline void __WFE( void ) {}
+static inline void __SEV( void ) {}
+static inline void __ISB( void ) { __sync_synchronize(); }
+static inline void __DSB( void ) { __sync_synchronize(); }
+static inline void __DMB( void ) { __sync_synchronize(); }
+static inline void __CLREX( void ) {}
+
+static inline uint32_t __REV( uint32_t value ) { return __builtin_bswap32( value ); }
+static inline uint32_t __REV16( uint32_t value ) { return ( ( value & 0xff00ff00UL ) >> 8 ) | ( ( value & 0x00ff00ffUL ) << 8 ); }
+static inline int32_t __REVSH( int32_t value ) { return ( int16_t ) __builtin_bswap16( ( uint16_t ) value ); }
+static inline uint8_t __CLZ( uint32_t value ) { return ( value == 0UL ) ? 32U : ( uint8_t ) __builtin_clz( value ); }
+
+static inline uint32_t __RBIT( uint32_t value )
+{
+uint32_t result = 0UL;
+int bit;
+
+	for( bit = 0; bit < 32; bit++ )
+	{
+		result = ( result << 1 ) | ( ( value >> bit ) & 1UL );
+	}
+
+	return result;
+}
+
+static inline void __enable_irq( void ) {}
+static inline void __disable_irq( void ) {}
+static inline void __enable_fault_irq( void ) {}
+static inline void __disable_fault_irq( void ) {}
+static inline uint32_t __get_PRIMASK( void ) { return 0UL; }
+static inline void __set_PRIMASK( uint32_t priMask ) { ( void ) priMask; }
+static inline uint32_t __get_BASEPRI( void ) { return 0UL; }
+static inline void __set_BASEPRI( uint32_t value ) { ( void ) value; }
+static inline uint32_t __get_FAULTMASK( void ) { return 0UL; }
+static inline void __set_FAULTMASK( uint32_t faultMask ) { ( void ) faultMask; }
+static inline uint32_t __get_CONTROL( void ) { return 0UL; }
+static inline void __set_CONTROL( uint32_t control ) { ( void ) control; }
+static inline uint32_t __get_IPSR( void ) { return 0UL; }
+
+#endif /* SIM_CMSIS_H */
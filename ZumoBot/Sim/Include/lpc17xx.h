@@ -0,0 +1,5 @@
+/*
+ * The NXP driver library includes the CMSIS device header in lower case,
+ * which only works on a case insensitive file system.
+ */
+#include "LPC17xx.h"
@@ -0,0 +1,40 @@
+#ifndef SIM_PORT_H
+#define SIM_PORT_H
+
+/*
+ * The interface between the simulated FreeRTOS port and the rest of the
+ * simulation.
+ */
+
+/* The most tasks the port can report on. */
+#define portSIM_MAX_TASKS		( 16 )
+
+typedef struct xPORT_SIM_TASK_STATS
+{
+	char pcName[ configMAX_TASK_NAME_LEN ];
+	unsigned long ulActivations;			/* Times the task was switched in. */
+	unsigned long long ullCPUNanoseconds;	/* Host CPU time used by the task. */
+	unsigned long long ullMaxRunNanoseconds;/* Longest time the task ran before blocking or being preempted. */
+} xPortSimTaskStats;
+
+/*
+ * Called by the port whenever the idle task would run.  Must advance the
+ * simulated time to the next hardware event and service any simulated
+ * interrupts that are due, calling vPortSimTick() for each tick.  Provided
+ * by the simulation.
+ */
+void vPortSimIdle( void );
+
+/*
+ * Perform one RTOS tick.  Only call from vPortSimIdle().
+ */
+void vPortSimTick( void );
+
+/*
+ * Copy the statistics of up to uxMaxTasks tasks into pxStats, returning the
+ * number copied.  The idle task entry holds the time spent simulating the
+ * hardware.
+ */
+unsigned long ulPortSimGetTaskStats( xPortSimTaskStats *pxStats, unsigned long uxMaxTasks );
+
+#endif /* SIM_PORT_H */
@@ -0,0 +1,275 @@
+/*
+ * FreeRTOS port for the host simulation.  See portmacro.h.
+ *
+ * Each task is given a ucontext and a host stack.  The FreeRTOS stack of the
+ * task is not used, other than to hold a pointer to the simulated task, which
+ * is what pxPortInitialiseStack() returns as the top of stack.
+ *
+ * The idle task is never switched to.  When the scheduler selects it, control
+ * returns to the context that started the scheduler, which calls
+ * vPortSimIdle() to advance simulated time and run simulated interrupts until
+ * another task is ready.  Application code therefore takes no simulated time,
+ * but the host CPU time it uses is measured.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Simulation includes. */
+#include "Sim-port.h"
+
+/* The host stack given to each task.  Application code is compiled for the
+host, so needs far more stack than on the target. */
+#define portSIM_HOST_STACK_SIZE		( 256 * 1024 )
+
+typedef struct xSIM_TASK
+{
+	ucontext_t xContext;
+	pdTASK_CODE pxCode;
+	void *pvParameters;
+	xPortSimTaskStats xStats;
+} xSimTask;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The function every task context starts in.
+ */
+static void prvTaskEntry( void );
+
+/*
+ * Return the simulated task of a TCB.  The first member of a TCB is its top
+ * of stack pointer.
+ */
+static xSimTask *prvGetSimTask( void *pvTCB );
+
+/*
+ * Charge the host CPU time used since the last switch to the task that was
+ * running, and start timing pxTo.
+ */
+static void prvAccountSwitch( xSimTask *pxFrom, xSimTask *pxTo );
+
+static unsigned long long prvHostNanoseconds( void );
+
+/*-----------------------------------------------------------*/
+
+extern void * volatile pxCurrentTCB;
+
+/* The context that runs vPortSimIdle(). */
+static ucontext_t xSchedulerContext;
+
+static xTaskHandle xIdleTask = NULL;
+
+static xSimTask *pxSimTasks[ portSIM_MAX_TASKS ];
+static unsigned long ulNumSimTasks = 0UL;
+
+static unsigned long long ullLastSwitchTime = 0ULL;
+static unsigned portBASE_TYPE uxCriticalNesting = 0;
+
+/*-----------------------------------------------------------*/
+
+portSTACK_TYPE *pxPortInitialiseStack( portSTACK_TYPE *pxTopOfStack, pdTASK_CODE pxCode, void *pvParameters )
+{
+xSimTask *pxSimTask;
+
+	pxSimTask = calloc( 1, sizeof( xSimTask ) );
+	configASSERT( pxSimTask );
+
+	pxSimTask->pxCode = pxCode;
+	pxSimTask->pvParameters = pvParameters;
+
+	getcontext( &( pxSimTask->xContext ) );
+	pxSimTask->xContext.uc_stack.ss_sp = malloc( portSIM_HOST_STACK_SIZE );
+	pxSimTask->xContext.uc_stack.ss_size = portSIM_HOST_STACK_SIZE;
+	pxSimTask->xContext.uc_link = NULL;
+	configASSERT( pxSimTask->xContext.uc_stack.ss_sp );
+	makecontext( &( pxSimTask->xContext ), prvTaskEntry, 0 );
+
+	pxTopOfStack--;
+	*( ( xSimTask ** ) pxTopOfStack ) = pxSimTask;
+
+	return pxTopOfStack;
+}
+/*-----------------------------------------------------------*/
+
+void vPortSimTaskCreated( void *pvTopOfStack, const char *pcName )
+{
+xSimTask *pxSimTask = *( ( xSimTask ** ) pvTopOfStack );
+
+	strncpy( pxSimTask->xStats.pcName, pcName, configMAX_TASK_NAME_LEN - 1 );
+
+	if( ulNumSimTasks < portSIM_MAX_TASKS )
+	{
+		pxSimTasks[ ulNumSimTasks ] = pxSimTask;
+		ulNumSimTasks++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xPortStartScheduler( void )
+{
+xSimTask *pxIdle;
+
+	xIdleTask = xTaskGetIdleTaskHandle();
+	pxIdle = prvGetSimTask( xIdleTask );
+	ullLastSwitchTime = prvHostNanoseconds();
+
+	for( ;; )
+	{
+		if( pxCurrentTCB != xIdleTask )
+		{
+			prvAccountSwitch( pxIdle, prvGetSimTask( pxCurrentTCB ) );
+			swapcontext( &xSchedulerContext, &( prvGetSimTask( pxCurrentTCB )->xContext ) );
+		}
+		else
+		{
+			vPortSimIdle();
+			vTaskSwitchContext();
+		}
+	}
+
+	/* Should not get here. */
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+	exit( EXIT_SUCCESS );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+xSimTask *pxFrom, *pxTo;
+
+	if( pxCurrentTCB == xIdleTask )
+	{
+		/* Called from a simulated interrupt.  The scheduler selects the next
+		task when the interrupt returns. */
+		return;
+	}
+
+	pxFrom = prvGetSimTask( pxCurrentTCB );
+	vTaskSwitchContext();
+
+	if( pxCurrentTCB == xIdleTask )
+	{
+		prvAccountSwitch( pxFrom, prvGetSimTask( xIdleTask ) );
+		swapcontext( &( pxFrom->xContext ), &xSchedulerContext );
+	}
+	else
+	{
+		pxTo = prvGetSimTask( pxCurrentTCB );
+
+		if( pxTo != pxFrom )
+		{
+			prvAccountSwitch( pxFrom, pxTo );
+			swapcontext( &( pxFrom->xContext ), &( pxTo->xContext ) );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldFromISR( void )
+{
+	/* Nothing to do - see portEND_SWITCHING_ISR(). */
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting );
+	uxCriticalNesting--;
+}
+/*-----------------------------------------------------------*/
+
+void vPortSimTick( void )
+{
+	vTaskIncrementTick();
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulPortSimGetTaskStats( xPortSimTaskStats *pxStats, unsigned long uxMaxTasks )
+{
+unsigned long ulTask;
+
+	for( ulTask = 0UL; ( ulTask < ulNumSimTasks ) && ( ulTask < uxMaxTasks ); ulTask++ )
+	{
+		pxStats[ ulTask ] = pxSimTasks[ ulTask ]->xStats;
+	}
+
+	return ulTask;
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulPortSimHostMicroseconds( void )
+{
+	return ( unsigned long ) ( prvHostNanoseconds() / 1000ULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortSimAssert( const char *pcFile, unsigned long ulLine )
+{
+	fprintf( stderr, "configASSERT() failed: %s:%lu\n", pcFile, ulLine );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+static void prvTaskEntry( void )
+{
+xSimTask *pxSimTask = prvGetSimTask( pxCurrentTCB );
+
+	pxSimTask->pxCode( pxSimTask->pvParameters );
+
+	/* Tasks must not return. */
+	fprintf( stderr, "Task %s returned\n", pxSimTask->xStats.pcName );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+static xSimTask *prvGetSimTask( void *pvTCB )
+{
+	return *( ( xSimTask ** ) ( *( ( portSTACK_TYPE ** ) pvTCB ) ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvAccountSwitch( xSimTask *pxFrom, xSimTask *pxTo )
+{
+unsigned long long ullNow, ullRun;
+
+	ullNow = prvHostNanoseconds();
+	ullRun = ullNow - ullLastSwitchTime;
+
+	pxFrom->xStats.ullCPUNanoseconds += ullRun;
+	if( ullRun > pxFrom->xStats.ullMaxRunNanoseconds )
+	{
+		pxFrom->xStats.ullMaxRunNanoseconds = ullRun;
+	}
+
+	pxTo->xStats.ulActivations++;
+	ullLastSwitchTime = ullNow;
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long long prvHostNanoseconds( void )
+{
+struct timespec xNow;
+
+	clock_gettime( CLOCK_THREAD_CPUTIME_ID, &xNow );
+	return ( ( unsigned long long ) xNow.tv_sec * 1000000000ULL ) + ( unsigned long long ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,536 @@
+/*
+ * The simulated dohyo, robots and sensors.  See Sim-arena.h.
+ */
+
+#include <stdint.h>
+#include <math.h>
+
+/* Simulation includes. */
+#include "Sim-arena.h"
+
+/* A mini sumo dohyo - 77cm across, with a 2.5cm white border. */
+#define simarenaRING_RADIUS				( 0.385 )
+#define simarenaBORDER_WIDTH			( 0.025 )
+
+/* Both robots are 10cm discs.  The robots start this far from the centre, on
+opposite sides. */
+#define simarenaROBOT_RADIUS			( 0.05 )
+#define simarenaTRACK_WIDTH				( 0.085 )
+#define simarenaSTART_DISTANCE			( 0.15 )
+
+/* The Zumo at full PWM, the opponent at full speed, and how quickly the
+wheels of both follow a change of command. */
+#define simarenaZUMO_MAX_SPEED			( 0.6 )
+#define simarenaOPPONENT_MAX_SPEED		( 0.5 )
+#define simarenaMOTOR_TIME_CONSTANT		( 0.05 )
+
+/* Each motor of the Zumo reaches a different fraction of
+simarenaZUMO_MAX_SPEED in each bout, as the battery and the gearboxes would
+make it, so open loop commands do not drive it straight. */
+#define simarenaMOTOR_GAIN_MIN			( 0.8 )
+#define simarenaMOTOR_GAIN_RANGE		( 0.3 )
+
+/* The start button is pressed this long after the bout starts, and held for
+simarenaBUTTON_HOLD_NS.  The opponent starts moving simarenaOPPONENT_DELAY_NS
+after the button is pressed, which is when the Zumo finishes its countdown. */
+#define simarenaBUTTON_PRESS_NS			( 100000000ULL )
+#define simarenaBUTTON_HOLD_NS			( 100000000ULL )
+#define simarenaOPPONENT_DELAY_NS		( 3000000000ULL )
+
+/* The Sharp distance sensors.  The output voltage follows a power law of the
+distance between 10cm and 80cm, and is simarenaDISTANCE_BASELINE_V when nothing
+is in the beam.  The beam is simarenaDISTANCE_BEAM_RADIANS either side of the
+sensor axis. */
+#define simarenaDISTANCE_COEFFICIENT	( 27.86 )
+#define simarenaDISTANCE_EXPONENT		( -1.15 )
+#define simarenaDISTANCE_MIN_CM			( 10.0 )
+#define simarenaDISTANCE_MAX_CM			( 80.0 )
+#define simarenaDISTANCE_BASELINE_V		( 0.25 )
+#define simarenaDISTANCE_BEAM_RADIANS	( 10.0 * M_PI / 180.0 )
+#define simarenaDISTANCE_NOISE_COUNTS	( 8.0 )
+#define simarenaADC_REFERENCE_V			( 3.3 )
+#define simarenaADC_MAX_COUNT			( 4095.0 )
+
+/* The QTR-RC discharge times over white, over black, and with the emitters
+off or off the edge of the ring, in microseconds. */
+#define simarenaWHITE_US				( 120.0 )
+#define simarenaWHITE_NOISE_US			( 20.0 )
+#define simarenaBLACK_US				( 2600.0 )
+#define simarenaBLACK_NOISE_US			( 200.0 )
+#define simarenaNO_REFLECTION_US		( 3000.0 )
+
+/* How the wandering opponent changes direction. */
+#define simarenaWANDER_MIN_NS			( 500000000ULL )
+#define simarenaWANDER_RANGE_NS			( 1000000000ULL )
+#define simarenaEDGE_MARGIN				( 0.1 )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Return a pseudo random number, from a generator seeded for each bout so
+ * bouts can be repeated.
+ */
+static unsigned long prvRandom( void );
+
+/*
+ * Return a uniformly distributed number from 0.0 to 1.0, and an
+ * approximately normally distributed number with a standard deviation of
+ * dDeviation.
+ */
+static double prvUniform( void );
+static double prvNoise( double dDeviation );
+
+/*
+ * Return dAngle in the range -pi to pi.
+ */
+static double prvWrapAngle( double dAngle );
+
+/*
+ * Move a robot on by dSeconds, with wheel commands from -1.0 to 1.0.
+ */
+static void prvMoveRobot( xSimRobotState *pxRobot, double dSeconds, double dLeft, double dRight, double dMaxSpeed );
+
+/*
+ * Push apart the robots if they overlap.
+ */
+static void prvCollide( void );
+
+/*
+ * Choose the wheel commands of the opponent.
+ */
+static void prvDriveOpponent( unsigned long long ullNow, double *pdLeft, double *pdRight );
+
+/*
+ * Return the wheel commands that turn a robot through dError radians while
+ * driving at dSpeed.
+ */
+static void prvSteer( double dError, double dSpeed, double *pdLeft, double *pdRight );
+
+/*
+ * Work out what each distance sensor of the Zumo can see.
+ */
+static void prvUpdateDistanceSensors( void );
+
+/*
+ * Return non-zero if the centre of the robot is outside the ring.
+ */
+static int prvIsOut( const xSimRobotState *pxRobot );
+
+/*-----------------------------------------------------------*/
+
+/* The direction of each distance sensor, relative to the front of the
+Zumo - front, front left, front right and rear. */
+static const double dSensorAngles[ simarenaNUM_DISTANCE_SENSORS ] = { 0.0, M_PI / 6.0, -M_PI / 6.0, M_PI };
+
+/* The position of each floor sensor relative to the centre of the Zumo, x
+forward and y to the left - left, right and centre. */
+static const double dFloorSensorX[ simarenaNUM_FLOOR_SENSORS ] = { 0.04, 0.04, 0.04 };
+static const double dFloorSensorY[ simarenaNUM_FLOOR_SENSORS ] = { 0.035, -0.035, 0.0 };
+
+static xSimArenaConfig xConfig;
+static xSimRobotState xZumo, xOpponent;
+static unsigned long ulRandomState = 1UL;
+static long lOutcome = simarenaRUNNING;
+
+/* The voltage at each distance sensor output, without noise. */
+static double dDistanceVolts[ simarenaNUM_DISTANCE_SENSORS ];
+
+/* The wandering opponent keeps a turn rate until ullNextWanderChange. */
+static unsigned long long ullNextWanderChange = 0ULL;
+static double dWanderTurn = 0.0;
+
+/* The gain of each motor of the Zumo in this bout, and the distance each
+wheel has turned through, which is what the encoders measure. */
+static double dLeftGain = 1.0, dRightGain = 1.0;
+static double dLeftDistance = 0.0, dRightDistance = 0.0;
+
+/*-----------------------------------------------------------*/
+
+void vSimArenaInit( const xSimArenaConfig *pxConfig )
+{
+double dPlacement;
+
+	xConfig = *pxConfig;
+
+	/* Zero is the one state xorshift cannot leave. */
+	ulRandomState = ( xConfig.ulSeed * 2654435761UL ) | 1UL;
+
+	if( xConfig.ulOpponent == simarenaOPPONENT_MIX )
+	{
+		xConfig.ulOpponent = prvRandom() % simarenaOPPONENT_MIX;
+	}
+
+	/* The robots start on opposite sides of the centre, facing any
+	direction, so the Zumo has to search. */
+	dPlacement = prvUniform() * 2.0 * M_PI;
+
+	xZumo.dX = simarenaSTART_DISTANCE * cos( dPlacement );
+	xZumo.dY = simarenaSTART_DISTANCE * sin( dPlacement );
+	xZumo.dHeading = prvWrapAngle( prvUniform() * 2.0 * M_PI );
+	xZumo.dLeftSpeed = 0.0;
+	xZumo.dRightSpeed = 0.0;
+
+	xOpponent.dX = -xZumo.dX;
+	xOpponent.dY = -xZumo.dY;
+	xOpponent.dHeading = prvWrapAngle( prvUniform() * 2.0 * M_PI );
+	xOpponent.dLeftSpeed = 0.0;
+	xOpponent.dRightSpeed = 0.0;
+
+	lOutcome = simarenaRUNNING;
+	ullNextWanderChange = 0ULL;
+	dWanderTurn = 0.0;
+
+	dLeftGain = simarenaMOTOR_GAIN_MIN + ( prvUniform() * simarenaMOTOR_GAIN_RANGE );
+	dRightGain = simarenaMOTOR_GAIN_MIN + ( prvUniform() * simarenaMOTOR_GAIN_RANGE );
+	dLeftDistance = 0.0;
+	dRightDistance = 0.0;
+
+	prvUpdateDistanceSensors();
+}
+/*-----------------------------------------------------------*/
+
+void vSimArenaStep( unsigned long long ullNow, double dSeconds, double dLeft, double dRight )
+{
+double dOpponentLeft, dOpponentRight;
+int iZumoOut, iOpponentOut;
+
+	if( lOutcome != simarenaRUNNING )
+	{
+		return;
+	}
+
+	prvDriveOpponent( ullNow, &dOpponentLeft, &dOpponentRight );
+	prvMoveRobot( &xZumo, dSeconds, dLeft * dLeftGain, dRight * dRightGain, simarenaZUMO_MAX_SPEED );
+	dLeftDistance += xZumo.dLeftSpeed * dSeconds;
+	dRightDistance += xZumo.dRightSpeed * dSeconds;
+	prvMoveRobot( &xOpponent, dSeconds, dOpponentLeft, dOpponentRight, simarenaOPPONENT_MAX_SPEED );
+	prvCollide();
+	prvUpdateDistanceSensors();
+
+	iZumoOut = prvIsOut( &xZumo );
+	iOpponentOut = prvIsOut( &xOpponent );
+
+	if( ( iZumoOut != 0 ) && ( iOpponentOut != 0 ) )
+	{
+		lOutcome = simarenaDRAW;
+	}
+	else if( iZumoOut != 0 )
+	{
+		lOutcome = simarenaLOSS;
+	}
+	else if( iOpponentOut != 0 )
+	{
+		lOutcome = simarenaWIN;
+	}
+	else if( ullNow >= ( simarenaBUTTON_PRESS_NS + xConfig.ullTimeLimit ) )
+	{
+		lOutcome = simarenaDRAW;
+	}
+}
+/*-----------------------------------------------------------*/
+
+long lSimArenaOutcome( void )
+{
+	return lOutcome;
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulSimArenaReadDistance( unsigned long ulSensor )
+{
+	return ulSimArenaSampleDistance( dDistanceVolts[ ulSensor ] );
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulSimArenaSampleDistance( double dVolts )
+{
+double dCounts;
+
+	dCounts = ( dVolts * simarenaADC_MAX_COUNT ) / simarenaADC_REFERENCE_V;
+	dCounts += prvNoise( simarenaDISTANCE_NOISE_COUNTS );
+
+	if( dCounts < 0.0 )
+	{
+		dCounts = 0.0;
+	}
+	else if( dCounts > simarenaADC_MAX_COUNT )
+	{
+		dCounts = simarenaADC_MAX_COUNT;
+	}
+
+	return ( unsigned long ) dCounts;
+}
+/*-----------------------------------------------------------*/
+
+double dSimArenaDistanceVolts( double dCentimetres )
+{
+	if( dCentimetres < simarenaDISTANCE_MIN_CM )
+	{
+		dCentimetres = simarenaDISTANCE_MIN_CM;
+	}
+
+	if( dCentimetres > simarenaDISTANCE_MAX_CM )
+	{
+		return simarenaDISTANCE_BASELINE_V;
+	}
+
+	return simarenaDISTANCE_COEFFICIENT * pow( dCentimetres, simarenaDISTANCE_EXPONENT );
+}
+/*-----------------------------------------------------------*/
+
+unsigned long long ullSimArenaFloorDischarge( unsigned long ulSensor, int iEmitterOn )
+{
+double dX, dY, dRadius, dMicroseconds;
+
+	dX = xZumo.dX + ( dFloorSensorX[ ulSensor ] * cos( xZumo.dHeading ) ) - ( dFloorSensorY[ ulSensor ] * sin( xZumo.dHeading ) );
+	dY = xZumo.dY + ( dFloorSensorX[ ulSensor ] * sin( xZumo.dHeading ) ) + ( dFloorSensorY[ ulSensor ] * cos( xZumo.dHeading ) );
+	dRadius = sqrt( ( dX * dX ) + ( dY * dY ) );
+
+	if( ( iEmitterOn == 0 ) || ( dRadius > simarenaRING_RADIUS ) )
+	{
+		dMicroseconds = simarenaNO_REFLECTION_US;
+	}
+	else if( dRadius > ( simarenaRING_RADIUS - simarenaBORDER_WIDTH ) )
+	{
+		dMicroseconds = simarenaWHITE_US + prvNoise( simarenaWHITE_NOISE_US );
+	}
+	else
+	{
+		dMicroseconds = simarenaBLACK_US + prvNoise( simarenaBLACK_NOISE_US );
+	}
+
+	if( dMicroseconds < 1.0 )
+	{
+		dMicroseconds = 1.0;
+	}
+
+	return ( unsigned long long ) ( dMicroseconds * 1000.0 );
+}
+/*-----------------------------------------------------------*/
+
+int iSimArenaButtonPressed( unsigned long long ullNow )
+{
+	return ( ullNow >= simarenaBUTTON_PRESS_NS ) && ( ullNow < ( simarenaBUTTON_PRESS_NS + simarenaBUTTON_HOLD_NS ) );
+}
+/*-----------------------------------------------------------*/
+
+unsigned long long ullSimArenaButtonPressTime( void )
+{
+	return simarenaBUTTON_PRESS_NS;
+}
+/*-----------------------------------------------------------*/
+
+void vSimArenaGetRobots( xSimRobotState *pxZumo, xSimRobotState *pxOpponent )
+{
+	*pxZumo = xZumo;
+	*pxOpponent = xOpponent;
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulSimArenaOpponent( void )
+{
+	return xConfig.ulOpponent;
+}
+/*-----------------------------------------------------------*/
+
+void vSimArenaGetWheelDistances( double *pdLeft, double *pdRight )
+{
+	*pdLeft = dLeftDistance;
+	*pdRight = dRightDistance;
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long prvRandom( void )
+{
+uint32_t ulState = ( uint32_t ) ulRandomState;
+
+	/* xorshift32. */
+	ulState ^= ulState << 13;
+	ulState ^= ulState >> 17;
+	ulState ^= ulState << 5;
+	ulRandomState = ulState;
+
+	return ulState;
+}
+/*-----------------------------------------------------------*/
+
+static double prvUniform( void )
+{
+	return ( double ) prvRandom() / 4294967295.0;
+}
+/*-----------------------------------------------------------*/
+
+static double prvNoise( double dDeviation )
+{
+double dSum;
+
+	/* The sum of four uniform numbers, scaled to unit variance. */
+	dSum = prvUniform() + prvUniform() + prvUniform() + prvUniform() - 2.0;
+	return dSum * sqrt( 3.0 ) * dDeviation;
+}
+/*-----------------------------------------------------------*/
+
+static double prvWrapAngle( double dAngle )
+{
+	while( dAngle > M_PI )
+	{
+		dAngle -= 2.0 * M_PI;
+	}
+
+	while( dAngle < -M_PI )
+	{
+		dAngle += 2.0 * M_PI;
+	}
+
+	return dAngle;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMoveRobot( xSimRobotState *pxRobot, double dSeconds, double dLeft, double dRight, double dMaxSpeed )
+{
+double dGain, dSpeed, dTurnRate;
+
+	/* First order lag from the command to the wheel speed. */
+	dGain = dSeconds / ( simarenaMOTOR_TIME_CONSTANT + dSeconds );
+	pxRobot->dLeftSpeed += ( ( dLeft * dMaxSpeed ) - pxRobot->dLeftSpeed ) * dGain;
+	pxRobot->dRightSpeed += ( ( dRight * dMaxSpeed ) - pxRobot->dRightSpeed ) * dGain;
+
+	dSpeed = ( pxRobot->dLeftSpeed + pxRobot->dRightSpeed ) / 2.0;
+	dTurnRate = ( pxRobot->dRightSpeed - pxRobot->dLeftSpeed ) / simarenaTRACK_WIDTH;
+
+	pxRobot->dX += dSpeed * cos( pxRobot->dHeading ) * dSeconds;
+	pxRobot->dY += dSpeed * sin( pxRobot->dHeading ) * dSeconds;
+	pxRobot->dHeading = prvWrapAngle( pxRobot->dHeading + ( dTurnRate * dSeconds ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCollide( void )
+{
+double dX, dY, dDistance, dOverlap;
+
+	dX = xOpponent.dX - xZumo.dX;
+	dY = xOpponent.dY - xZumo.dY;
+	dDistance = sqrt( ( dX * dX ) + ( dY * dY ) );
+	dOverlap = ( 2.0 * simarenaROBOT_RADIUS ) - dDistance;
+
+	if( ( dOverlap > 0.0 ) && ( dDistance > 0.0 ) )
+	{
+		dX /= dDistance;
+		dY /= dDistance;
+
+		xZumo.dX -= dX * dOverlap / 2.0;
+		xZumo.dY -= dY * dOverlap / 2.0;
+		xOpponent.dX += dX * dOverlap / 2.0;
+		xOpponent.dY += dY * dOverlap / 2.0;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvDriveOpponent( unsigned long long ullNow, double *pdLeft, double *pdRight )
+{
+double dRadius, dOutward, dTarget, dError;
+
+	*pdLeft = 0.0;
+	*pdRight = 0.0;
+
+	if( ( ullNow < ( simarenaBUTTON_PRESS_NS + simarenaOPPONENT_DELAY_NS ) ) || ( xConfig.ulOpponent == simarenaOPPONENT_STILL ) )
+	{
+		return;
+	}
+
+	dRadius = sqrt( ( xOpponent.dX * xOpponent.dX ) + ( xOpponent.dY * xOpponent.dY ) );
+	dOutward = ( xOpponent.dX * cos( xOpponent.dHeading ) ) + ( xOpponent.dY * sin( xOpponent.dHeading ) );
+
+	if( xConfig.ulOpponent == simarenaOPPONENT_CHARGE )
+	{
+		dTarget = atan2( xZumo.dY - xOpponent.dY, xZumo.dX - xOpponent.dX );
+		dError = prvWrapAngle( dTarget - xOpponent.dHeading );
+
+		if( ( dRadius > ( simarenaRING_RADIUS - simarenaEDGE_MARGIN ) ) && ( dOutward > 0.0 ) && ( fabs( dError ) > ( M_PI / 4.0 ) ) )
+		{
+			/* Near the edge, facing out, and the Zumo is not ahead. */
+			dError = prvWrapAngle( atan2( -xOpponent.dY, -xOpponent.dX ) - xOpponent.dHeading );
+		}
+
+		prvSteer( dError, 1.0, pdLeft, pdRight );
+	}
+	else
+	{
+		if( ullNow >= ullNextWanderChange )
+		{
+			dWanderTurn = ( prvUniform() - 0.5 ) * M_PI;
+			ullNextWanderChange = ullNow + simarenaWANDER_MIN_NS + ( unsigned long long ) ( prvUniform() * ( double ) simarenaWANDER_RANGE_NS );
+		}
+
+		if( ( dRadius > ( simarenaRING_RADIUS - simarenaEDGE_MARGIN ) ) && ( dOutward > 0.0 ) )
+		{
+			dError = prvWrapAngle( atan2( -xOpponent.dY, -xOpponent.dX ) - xOpponent.dHeading );
+		}
+		else
+		{
+			dError = dWanderTurn * 0.2;
+		}
+
+		prvSteer( dError, 0.6, pdLeft, pdRight );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSteer( double dError, double dSpeed, double *pdLeft, double *pdRight )
+{
+double dTurn;
+
+	if( fabs( dError ) > ( M_PI / 3.0 ) )
+	{
+		/* Turn on the spot. */
+		dTurn = ( dError > 0.0 ) ? dSpeed : -dSpeed;
+		*pdLeft = -dTurn;
+		*pdRight = dTurn;
+	}
+	else
+	{
+		dTurn = dError * 2.0 * dSpeed;
+		*pdLeft = dSpeed - dTurn;
+		*pdRight = dSpeed + dTurn;
+	}
+
+	*pdLeft = fmax( -1.0, fmin( 1.0, *pdLeft ) );
+	*pdRight = fmax( -1.0, fmin( 1.0, *pdRight ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateDistanceSensors( void )
+{
+double dX, dY, dCentres, dOffAxis, dHalfWidth, dCentimetres;
+unsigned long ulSensor;
+
+	dX = xOpponent.dX - xZumo.dX;
+	dY = xOpponent.dY - xZumo.dY;
+	dCentres = sqrt( ( dX * dX ) + ( dY * dY ) );
+
+	/* The angle the opponent covers either side of its centre. */
+	dHalfWidth = ( dCentres > simarenaROBOT_RADIUS ) ? asin( simarenaROBOT_RADIUS / dCentres ) : ( M_PI / 2.0 );
+
+	/* The sensors are on the edge of the Zumo. */
+	dCentimetres = ( dCentres - ( 2.0 * simarenaROBOT_RADIUS ) ) * 100.0;
+
+	for( ulSensor = 0UL; ulSensor < simarenaNUM_DISTANCE_SENSORS; ulSensor++ )
+	{
+		dOffAxis = prvWrapAngle( atan2( dY, dX ) - ( xZumo.dHeading + dSensorAngles[ ulSensor ] ) );
+
+		if( fabs( dOffAxis ) <= ( simarenaDISTANCE_BEAM_RADIANS + dHalfWidth ) )
+		{
+			dDistanceVolts[ ulSensor ] = dSimArenaDistanceVolts( dCentimetres );
+		}
+		else
+		{
+			dDistanceVolts[ ulSensor ] = simarenaDISTANCE_BASELINE_V;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static int prvIsOut( const xSimRobotState *pxRobot )
+{
+	return ( ( pxRobot->dX * pxRobot->dX ) + ( pxRobot->dY * pxRobot->dY ) ) > ( simarenaRING_RADIUS * simarenaRING_RADIUS );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,120 @@
+#ifndef SIM_ARENA_H
+#define SIM_ARENA_H
+
+/*
+ * A 2D model of a mini sumo bout - the dohyo, the Zumo, the opponent, the
+ * Sharp IR distance sensors and the QTR-RC floor sensors.
+ *
+ * Both robots are discs with differential drive.  Each wheel follows its
+ * commanded speed with a first order lag, and robots that overlap are pushed
+ * apart equally, so the faster robot pushes the slower one.  A robot is out
+ * of the ring once its centre crosses the edge.  The motors of the Zumo are
+ * not matched - each has its own gain, chosen at random for each bout.
+ */
+
+/* How the opponent behaves. */
+#define simarenaOPPONENT_STILL		( 0 )	/* Never moves. */
+#define simarenaOPPONENT_WANDER		( 1 )	/* Drives around the ring at random, avoiding the edge. */
+#define simarenaOPPONENT_CHARGE		( 2 )	/* Turns towards the Zumo and drives at it. */
+#define simarenaOPPONENT_MIX		( 3 )	/* One of the above, chosen at random for each bout. */
+
+/* The result of a bout. */
+#define simarenaRUNNING				( 0 )
+#define simarenaWIN					( 1 )	/* The opponent left the ring. */
+#define simarenaLOSS				( 2 )	/* The Zumo left the ring. */
+#define simarenaDRAW				( 3 )	/* Both left together, or the time limit was reached. */
+#define simarenaNUM_OUTCOMES		( 4 )
+
+/* The number of distance sensors, on ADC channels 0 to 3, and floor sensors,
+on P2.10 to P2.12. */
+#define simarenaNUM_DISTANCE_SENSORS	( 4 )
+#define simarenaNUM_FLOOR_SENSORS		( 3 )
+
+typedef struct xSIM_ARENA_CONFIG
+{
+	unsigned long ulSeed;				/* Seeds the position, noise and opponent of the bout. */
+	unsigned long ulOpponent;			/* One of the simarenaOPPONENT_ constants. */
+	unsigned long long ullTimeLimit;	/* Nanoseconds from the start button being pressed. */
+} xSimArenaConfig;
+
+typedef struct xSIM_ROBOT_STATE
+{
+	double dX, dY;			/* Metres from the centre of the ring. */
+	double dHeading;		/* Radians, anticlockwise from the x axis. */
+	double dLeftSpeed;		/* Metres per second. */
+	double dRightSpeed;
+} xSimRobotState;
+
+/*
+ * Place the robots for a new bout.
+ */
+void vSimArenaInit( const xSimArenaConfig *pxConfig );
+
+/*
+ * Move both robots on by dSeconds.  dLeft and dRight are the motor commands
+ * of the Zumo, from -1.0 (full reverse) to 1.0 (full forward).  ullNow is the
+ * simulated time at the end of the step.
+ */
+void vSimArenaStep( unsigned long long ullNow, double dSeconds, double dLeft, double dRight );
+
+/*
+ * Return the outcome of the bout so far, one of the simarena result
+ * constants.
+ */
+long lSimArenaOutcome( void );
+
+/*
+ * Return the 12 bit ADC reading of distance sensor ulSensor, including
+ * noise.
+ */
+unsigned long ulSimArenaReadDistance( unsigned long ulSensor );
+
+/*
+ * Return the 12 bit ADC reading of a distance sensor whose output is dVolts,
+ * including noise.
+ */
+unsigned long ulSimArenaSampleDistance( double dVolts );
+
+/*
+ * Return the output, in volts, of a distance sensor with the opponent
+ * dCentimetres away on its axis, or with nothing in the beam if that is out
+ * of range.
+ */
+double dSimArenaDistanceVolts( double dCentimetres );
+
+/*
+ * Return how long, in nanoseconds, floor sensor ulSensor takes to discharge
+ * once released.  If the emitters are off, or the floor under the sensor is
+ * black, the result is longer than any sensible timeout.
+ */
+unsigned long long ullSimArenaFloorDischarge( unsigned long ulSensor, int iEmitterOn );
+
+/*
+ * Return non-zero while the start button is held down.
+ */
+int iSimArenaButtonPressed( unsigned long long ullNow );
+
+/*
+ * Return the time the start button is pressed, so the falling edge of its pin
+ * can be simulated when it happens.
+ */
+unsigned long long ullSimArenaButtonPressTime( void );
+
+/*
+ * Copy the state of the Zumo and the opponent.
+ */
+void vSimArenaGetRobots( xSimRobotState *pxZumo, xSimRobotState *pxOpponent );
+
+/*
+ * Return the opponent in use, which is never simarenaOPPONENT_MIX.
+ */
+unsigned long ulSimArenaOpponent( void );
+
+/*
+ * Return the distance, in metres, each wheel of the Zumo has turned through
+ * since the bout started, negative for reverse.  Wheels that slip while
+ * pushing still turn.
+ */
+void vSimArenaGetWheelDistances( double *pdLeft, double *pdRight );
+
+#endif /* SIM_ARENA_H */
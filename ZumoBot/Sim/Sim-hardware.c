@@ -0,0 +1,1124 @@
+/*
+ * The simulated LPC1769 peripherals.  See Sim-hardware.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Example includes. */
+#include "UART-interrupt-driven-command-console.h"
+
+/* Library includes. */
+#include "LPC17xx.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_gpdma.h"
+#include "lpc17xx_pwm.h"
+
+/* Simulation includes. */
+#include "Sim-port.h"
+#include "Sim-hardware.h"
+#include "Sim-arena.h"
+
+#define simhwNS_PER_SECOND			( 1000000000ULL )
+
+/* The RTOS tick, which is also the arena physics step. */
+#define simhwTICK_NS				( simhwNS_PER_SECOND / configTICK_RATE_HZ )
+
+/* The DWT cycle counter runs at the core clock. */
+#define simhwDWT_CTRL				( *( ( volatile uint32_t * ) 0xe0001000UL ) )
+#define simhwDWT_CYCCNT				( *( ( volatile uint32_t * ) 0xe0001004UL ) )
+
+/* The GPIO registers, and the x86 flag that makes the processor trap after
+each instruction. */
+#define simhwGPIO_SIZE				( 0x4000UL )
+#define simhwTRAP_FLAG				( 0x100 )
+
+#define simhwNUM_TIMERS				( 4 )
+#define simhwNUM_PWM_MATCHES		( 7 )
+#define simhwNUM_MATCH_CHANNELS		( 4 )
+#define simhwNUM_GPIO_PORTS			( 5 )
+
+/* The match control bits of one match channel. */
+#define simhwMCR_INTERRUPT( x )		( 1UL << ( ( x ) * 3UL ) )
+#define simhwMCR_RESET( x )			( 1UL << ( ( ( x ) * 3UL ) + 1UL ) )
+#define simhwMCR_STOP( x )			( 1UL << ( ( ( x ) * 3UL ) + 2UL ) )
+
+#define simhwTCR_ENABLE				( 1UL << 0UL )
+#define simhwTCR_RESET				( 1UL << 1UL )
+
+/* The count control mode bits.  Anything but zero counts edges on a capture
+input rather than the peripheral clock. */
+#define simhwCTCR_MODE_MASK			( 0x03UL )
+
+/* The QEI position reset bit, and the velocity timer interrupt. */
+#define simhwQEI_CON_RESP			( 1UL << 0UL )
+#define simhwQEI_INT_TIM			( 1UL << 1UL )
+
+/* The wheel encoders give 12 counts per motor revolution, counting both
+edges of both phases, through a 75:1 gearbox to a 39mm wheel.  Phase A rises
+once every four counts. */
+#define simhwENCODER_COUNTS_PER_METRE	( ( 12.0 * 75.0 ) / ( M_PI * 0.039 ) )
+#define simhwENCODER_COUNTS_PER_RISE	( 4.0 )
+
+/* The board wiring.  The floor sensors are on P2.10 to P2.12 with the IR
+emitters switched by P2.7, the start button is on P0.11, the direction of the
+right and left motors is set by P0.5 and P0.10, and PWM1 channels 3 and 4
+drive the right and left motors. */
+#define simhwFLOOR_PORT				( 2 )
+#define simhwFLOOR_FIRST_PIN		( 10UL )
+#define simhwEMITTER_MASK			( 1UL << 7UL )
+#define simhwBUTTON_PORT			( 0 )
+#define simhwBUTTON_MASK			( 1UL << 11UL )
+#define simhwRIGHT_DIRECTION_MASK	( 1UL << 5UL )
+#define simhwLEFT_DIRECTION_MASK	( 1UL << 10UL )
+#define simhwRIGHT_PWM_CHANNEL		( 3 )
+#define simhwLEFT_PWM_CHANNEL		( 4 )
+
+/* The right encoder is read by the QEI, and phase A of the left encoder is
+counted by TIMER2 through CAP2.0. */
+#define simhwLEFT_ENCODER_TIMER		( 2 )
+
+/* The ADC control register fields, and the number of ADC clocks one
+conversion takes. */
+#define simhwADC_SEL_MASK			( 0xffUL )
+#define simhwADC_CLKDIV( x )		( ( ( x ) >> 8UL ) & 0xffUL )
+#define simhwADC_BURST				( 1UL << 16UL )
+#define simhwADC_PDN				( 1UL << 21UL )
+#define simhwADC_DONE				( 1UL << 31UL )
+#define simhwADC_CLOCKS_PER_SAMPLE	( 65ULL )
+#define simhwADC_NUM_CHANNELS		( 8 )
+
+#define simhwDMA_NUM_CHANNELS		( 8 )
+#define simhwDMA_CHANNEL_SPACING	( 0x20UL )
+#define simhwDMA_ENABLE				( 1UL << 0UL )
+#define simhwDMA_SRC_PERIPHERAL( x )	( ( ( x ) >> 1UL ) & 0x1fUL )
+#define simhwDMA_ITC				( 1UL << 15UL )
+#define simhwDMA_TRANSFER_SIZE( x )	( ( x ) & 0xfffUL )
+#define simhwDMA_SWIDTH( x )		( ( ( x ) >> 18UL ) & 0x7UL )
+#define simhwDMA_SI					( 1UL << 26UL )
+#define simhwDMA_DI					( 1UL << 27UL )
+#define simhwDMA_I					( 1UL << 31UL )
+
+/* Some registers are read only to the firmware, but written by the
+simulated hardware. */
+#define simhwWRITE( xRegister, ulValue )	( *( ( volatile uint32_t * ) &( xRegister ) ) = ( ulValue ) )
+
+/* The simulation accesses the GPIO registers through a second, writable,
+mapping. */
+#define simhwGPIO_PORT( x )			( ( LPC_GPIO_TypeDef * ) ( pucGPIO + ( ( uintptr_t ) pxPorts[ x ] - LPC_GPIO_BASE ) ) )
+
+/* No event is pending. */
+#define simhwNEVER					( ~0ULL )
+
+/* A block of address space that holds peripheral registers. */
+typedef struct xSIM_REGION
+{
+	uintptr_t ulBase;
+	size_t xSize;
+} xSimRegion;
+
+typedef void ( *pdSIM_HANDLER )( void );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Bring the simulated hardware up to date with the register writes the
+ * firmware has made since the last call.
+ */
+static void prvSyncRegisters( void );
+
+/*
+ * Apply the FIOSET, FIOCLR and FIOPIN writes to the output latches, and drive
+ * the input pins.
+ */
+static void prvSyncGPIO( void );
+
+/*
+ * The signal handlers that let each write to a GPIO register complete, then
+ * act on it.
+ */
+static void prvGPIOWriteFault( int iSignal, siginfo_t *pxInfo, void *pvContext );
+static void prvGPIOWriteDone( int iSignal, siginfo_t *pxInfo, void *pvContext );
+
+/*
+ * Start timing the discharge of floor sensors that have been released, and
+ * stop timing those that are being charged again.
+ */
+static void prvSyncFloorSensors( uint32_t ulOldDirection, uint32_t ulNewDirection );
+
+/*
+ * Count the timers on to ullTime.
+ */
+static void prvAdvanceTimers( unsigned long long ullTime );
+
+/*
+ * Return the time at which the next match of timer ulTimer will occur, or
+ * simhwNEVER.
+ */
+static unsigned long long prvNextTimerMatch( unsigned long ulTimer );
+
+/*
+ * Perform the actions of the match registers of timer ulTimer that equal its
+ * counter.
+ */
+static void prvTimerMatch( unsigned long ulTimer );
+
+/*
+ * A floor sensor pin has discharged.
+ */
+static void prvFloorSensorFall( unsigned long ulSensor );
+
+/*
+ * The start button has been pressed, so its pin falls.
+ */
+static void prvButtonPress( void );
+
+/*
+ * Complete a burst of conversions, and raise the DMA request.
+ */
+static void prvADCRound( void );
+
+/*
+ * Serve a DMA request from peripheral ulPeripheral.
+ */
+static void prvDMARequest( uint32_t ulPeripheral );
+
+/*
+ * Step the arena and the RTOS tick.
+ */
+static void prvTick( void );
+
+/*
+ * Update the QEI position and the TIMER2 count from the distance the wheels
+ * have turned.
+ */
+static void prvSyncEncoders( void );
+
+/*
+ * The QEI velocity timer has reloaded.
+ */
+static void prvQEITimer( void );
+
+/*
+ * Return the period of the QEI velocity timer, in nanoseconds.
+ */
+static unsigned long long prvQEITimerPeriod( void );
+
+/*
+ * Call an interrupt handler, measuring the host CPU time it uses.
+ */
+static void prvCallHandler( unsigned long ulIRQ, pdSIM_HANDLER pxHandler );
+
+/*
+ * Return the time, in nanoseconds, taken by one burst of conversions of all
+ * the selected ADC channels.
+ */
+static unsigned long long prvADCRoundTime( void );
+
+static unsigned long long prvHostNanoseconds( void );
+
+/*-----------------------------------------------------------*/
+
+/* The handlers are only called if the firmware provides them. */
+extern void TIMER0_IRQHandler( void ) __attribute__( ( weak ) );
+extern void TIMER1_IRQHandler( void ) __attribute__( ( weak ) );
+extern void TIMER2_IRQHandler( void ) __attribute__( ( weak ) );
+extern void TIMER3_IRQHandler( void ) __attribute__( ( weak ) );
+extern void QEI_IRQHandler( void ) __attribute__( ( weak ) );
+extern void EINT3_IRQHandler( void ) __attribute__( ( weak ) );
+extern void DMA_IRQHandler( void ) __attribute__( ( weak ) );
+
+/* The NXP driver library checks its parameters, and calls this if one is
+wrong. */
+void check_failed( uint8_t *file, uint32_t line );
+
+/* Required by the NXP driver library to work out the peripheral clocks.  The
+simulated part runs at the same speed as the target. */
+uint32_t SystemCoreClock = 100000000UL;
+
+/* The GPIO registers are mapped separately, by iSimHardwareStartBout(). */
+static const xSimRegion xRegions[] =
+{
+	{ LPC_APB0_BASE, 0x100000UL },		/* APB0 and APB1. */
+	{ LPC_AHB_BASE, 0x200000UL },
+	{ 0xe0000000UL, 0x100000UL }		/* The Cortex-M3 private peripheral bus. */
+};
+
+static LPC_TIM_TypeDef * const pxTimers[ simhwNUM_TIMERS ] = { LPC_TIM0, LPC_TIM1, LPC_TIM2, LPC_TIM3 };
+static const uint32_t ulTimerClocks[ simhwNUM_TIMERS ] = { CLKPWR_PCLKSEL_TIMER0, CLKPWR_PCLKSEL_TIMER1, CLKPWR_PCLKSEL_TIMER2, CLKPWR_PCLKSEL_TIMER3 };
+
+static LPC_GPIO_TypeDef * const pxPorts[ simhwNUM_GPIO_PORTS ] = { LPC_GPIO0, LPC_GPIO1, LPC_GPIO2, LPC_GPIO3, LPC_GPIO4 };
+
+static xSimIRQStats xIRQStats[ simhwNUM_IRQS ] =
+{
+	{ "TIMER0", 0UL, 0ULL, 0ULL },
+	{ "TIMER1", 0UL, 0ULL, 0ULL },
+	{ "TIMER2", 0UL, 0ULL, 0ULL },
+	{ "TIMER3", 0UL, 0ULL, 0ULL },
+	{ "EINT3", 0UL, 0ULL, 0ULL },
+	{ "DMA", 0UL, 0ULL, 0ULL },
+	{ "QEI", 0UL, 0ULL, 0ULL }
+};
+
+/* The writable mapping of the GPIO registers. */
+static uint8_t *pucGPIO = NULL;
+
+/* Simulated time, in nanoseconds. */
+static unsigned long long ullNow = 0ULL;
+static unsigned long long ullNextTick = simhwTICK_NS;
+
+/* The output latch and the level of the input pins of each port, and the
+value last written to each FIOPIN register, so writes by the firmware can be
+seen. */
+static uint32_t ulOutputLatch[ simhwNUM_GPIO_PORTS ];
+static uint32_t ulInputLevel[ simhwNUM_GPIO_PORTS ];
+static uint32_t ulLastPinValue[ simhwNUM_GPIO_PORTS ];
+static uint32_t ulLastDirection[ simhwNUM_GPIO_PORTS ];
+
+/* When each floor sensor pin will read low, if it is discharging. */
+static unsigned long long ullFloorFall[ simarenaNUM_FLOOR_SENSORS ] = { simhwNEVER, simhwNEVER, simhwNEVER };
+
+/* When the start button is pressed. */
+static unsigned long long ullButtonPress = simhwNEVER;
+
+/* When the ADC burst in progress completes. */
+static unsigned long long ullNextADCRound = simhwNEVER;
+
+/* The PWM1 match values in use, which are only taken from the match
+registers enabled in the latch enable register. */
+static uint32_t ulPWMMatch[ simhwNUM_PWM_MATCHES ];
+
+/* When the QEI velocity timer next reloads. */
+static unsigned long long ullNextQEITimer = simhwNEVER;
+
+/* The encoder count of the right wheel when the QEI position was last reset,
+and the number of times phase A of the left encoder has crossed a rising edge
+position when it was last counted. */
+static long long llQEIOrigin = 0LL;
+static long long llLastLeftRise = 0LL;
+
+/*-----------------------------------------------------------*/
+
+int iSimHardwareInit( void )
+{
+unsigned long ulRegion;
+void *pvMapped;
+struct sigaction xAction;
+int iReturn = 1;
+
+	sigemptyset( &( xAction.sa_mask ) );
+	xAction.sa_flags = SA_SIGINFO;
+	xAction.sa_sigaction = prvGPIOWriteFault;
+	sigaction( SIGSEGV, &xAction, NULL );
+	xAction.sa_sigaction = prvGPIOWriteDone;
+	sigaction( SIGTRAP, &xAction, NULL );
+
+	for( ulRegion = 0UL; ulRegion < ( sizeof( xRegions ) / sizeof( xSimRegion ) ); ulRegion++ )
+	{
+		pvMapped = mmap( ( void * ) xRegions[ ulRegion ].ulBase, xRegions[ ulRegion ].xSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0 );
+
+		if( pvMapped != ( void * ) xRegions[ ulRegion ].ulBase )
+		{
+			fprintf( stderr, "Cannot map the peripherals at 0x%08lx\n", ( unsigned long ) xRegions[ ulRegion ].ulBase );
+			iReturn = 0;
+			break;
+		}
+	}
+
+	return iReturn;
+}
+/*-----------------------------------------------------------*/
+
+int iSimHardwareStartBout( void )
+{
+int iFile;
+void *pvMapped;
+
+	/* GPIO writes to FIOSET and FIOCLR act on the pins, so two writes to
+	FIOSET cannot be told apart from one if the registers are plain memory.
+	The firmware sees a read only mapping instead, so each write traps, and
+	the simulation sees it as it happens.  The memory is shared, so it must be
+	created separately for each bout. */
+	iFile = memfd_create( "GPIO", 0 );
+	if( ( iFile < 0 ) || ( ftruncate( iFile, simhwGPIO_SIZE ) != 0 ) )
+	{
+		return 0;
+	}
+
+	pucGPIO = mmap( NULL, simhwGPIO_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, iFile, 0 );
+	pvMapped = mmap( ( void * ) LPC_GPIO_BASE, simhwGPIO_SIZE, PROT_READ, MAP_SHARED | MAP_FIXED_NOREPLACE, iFile, 0 );
+	close( iFile );
+
+	if( ( pucGPIO == MAP_FAILED ) || ( pvMapped != ( void * ) LPC_GPIO_BASE ) )
+	{
+		fprintf( stderr, "Cannot map the GPIO at 0x%08lx\n", ( unsigned long ) LPC_GPIO_BASE );
+		return 0;
+	}
+
+	ullButtonPress = ullSimArenaButtonPressTime();
+
+	prvSyncGPIO();
+	return 1;
+}
+/*-----------------------------------------------------------*/
+
+unsigned long long ullSimHardwareNow( void )
+{
+	return ullNow;
+}
+/*-----------------------------------------------------------*/
+
+void vSimHardwareGetIRQStats( xSimIRQStats *pxStats )
+{
+unsigned long ulIRQ;
+
+	for( ulIRQ = 0UL; ulIRQ < simhwNUM_IRQS; ulIRQ++ )
+	{
+		pxStats[ ulIRQ ] = xIRQStats[ ulIRQ ];
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortSimIdle( void )
+{
+unsigned long long ullNext, ullMatch[ simhwNUM_TIMERS ];
+unsigned long ulTimer, ulSensor;
+
+	prvSyncRegisters();
+
+	/* Find the next event. */
+	ullNext = ullNextTick;
+
+	for( ulTimer = 0UL; ulTimer < simhwNUM_TIMERS; ulTimer++ )
+	{
+		ullMatch[ ulTimer ] = prvNextTimerMatch( ulTimer );
+		if( ullMatch[ ulTimer ] < ullNext )
+		{
+			ullNext = ullMatch[ ulTimer ];
+		}
+	}
+
+	for( ulSensor = 0UL; ulSensor < simarenaNUM_FLOOR_SENSORS; ulSensor++ )
+	{
+		if( ullFloorFall[ ulSensor ] < ullNext )
+		{
+			ullNext = ullFloorFall[ ulSensor ];
+		}
+	}
+
+	if( ullButtonPress < ullNext )
+	{
+		ullNext = ullButtonPress;
+	}
+
+	if( ullNextADCRound < ullNext )
+	{
+		ullNext = ullNextADCRound;
+	}
+
+	if( ullNextQEITimer < ullNext )
+	{
+		ullNext = ullNextQEITimer;
+	}
+
+	prvAdvanceTimers( ullNext );
+	ullNow = ullNext;
+
+	/* Perform every event that is due.  Each one can change the registers,
+	so they are synchronised again after each. */
+	for( ulTimer = 0UL; ulTimer < simhwNUM_TIMERS; ulTimer++ )
+	{
+		if( ullMatch[ ulTimer ] == ullNow )
+		{
+			prvTimerMatch( ulTimer );
+			prvSyncRegisters();
+		}
+	}
+
+	for( ulSensor = 0UL; ulSensor < simarenaNUM_FLOOR_SENSORS; ulSensor++ )
+	{
+		if( ullFloorFall[ ulSensor ] == ullNow )
+		{
+			prvFloorSensorFall( ulSensor );
+			prvSyncRegisters();
+		}
+	}
+
+	if( ullButtonPress == ullNow )
+	{
+		prvButtonPress();
+		prvSyncRegisters();
+	}
+
+	if( ullNextADCRound == ullNow )
+	{
+		prvADCRound();
+		prvSyncRegisters();
+	}
+
+	if( ullNextQEITimer == ullNow )
+	{
+		prvQEITimer();
+		prvSyncRegisters();
+	}
+
+	if( ullNextTick == ullNow )
+	{
+		prvTick();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void check_failed( uint8_t *file, uint32_t line )
+{
+	fprintf( stderr, "Driver library parameter check failed: %s:%lu\n", ( const char * ) file, ( unsigned long ) line );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+void vUARTCommandConsoleStart( void )
+{
+	/* The UART is not simulated, so there is no console.  The commands are
+	still registered, and Sim-main.c collects the statistics they display
+	directly. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvGPIOWriteFault( int iSignal, siginfo_t *pxInfo, void *pvContext )
+{
+ucontext_t *pxContext = ( ucontext_t * ) pvContext;
+uintptr_t ulAddress = ( uintptr_t ) pxInfo->si_addr;
+
+	if( ( ulAddress < LPC_GPIO_BASE ) || ( ulAddress >= ( LPC_GPIO_BASE + simhwGPIO_SIZE ) ) || ( pucGPIO == NULL ) )
+	{
+		/* A real fault.  Return to the faulting instruction with the default
+		action restored. */
+		signal( iSignal, SIG_DFL );
+		return;
+	}
+
+	/* Let the write complete, then trap after it. */
+	mprotect( ( void * ) LPC_GPIO_BASE, simhwGPIO_SIZE, PROT_READ | PROT_WRITE );
+	pxContext->uc_mcontext.gregs[ REG_EFL ] |= simhwTRAP_FLAG;
+}
+/*-----------------------------------------------------------*/
+
+static void prvGPIOWriteDone( int iSignal, siginfo_t *pxInfo, void *pvContext )
+{
+ucontext_t *pxContext = ( ucontext_t * ) pvContext;
+
+	( void ) iSignal;
+	( void ) pxInfo;
+
+	mprotect( ( void * ) LPC_GPIO_BASE, simhwGPIO_SIZE, PROT_READ );
+	pxContext->uc_mcontext.gregs[ REG_EFL ] &= ~simhwTRAP_FLAG;
+
+	prvSyncGPIO();
+}
+/*-----------------------------------------------------------*/
+
+static void prvSyncRegisters( void )
+{
+unsigned long ulChannel, ulTimer;
+LPC_GPDMACH_TypeDef *pxChannel;
+
+	prvSyncGPIO();
+
+	/* Write one to clear interrupt flags. */
+	simhwWRITE( LPC_GPIOINT->IO0IntStatF, LPC_GPIOINT->IO0IntStatF & ~LPC_GPIOINT->IO0IntClr );
+	simhwWRITE( LPC_GPIOINT->IO0IntStatR, LPC_GPIOINT->IO0IntStatR & ~LPC_GPIOINT->IO0IntClr );
+	simhwWRITE( LPC_GPIOINT->IO2IntStatF, LPC_GPIOINT->IO2IntStatF & ~LPC_GPIOINT->IO2IntClr );
+	simhwWRITE( LPC_GPIOINT->IO2IntStatR, LPC_GPIOINT->IO2IntStatR & ~LPC_GPIOINT->IO2IntClr );
+	LPC_GPIOINT->IO0IntClr = 0UL;
+	LPC_GPIOINT->IO2IntClr = 0UL;
+	simhwWRITE( LPC_GPIOINT->IntStatus, ( ( LPC_GPIOINT->IO0IntStatF | LPC_GPIOINT->IO0IntStatR ) != 0UL ? 1UL : 0UL )
+										| ( ( LPC_GPIOINT->IO2IntStatF | LPC_GPIOINT->IO2IntStatR ) != 0UL ? 4UL : 0UL ) );
+
+	simhwWRITE( LPC_GPDMA->DMACIntTCStat, LPC_GPDMA->DMACIntTCStat & ~LPC_GPDMA->DMACIntTCClear );
+	simhwWRITE( LPC_GPDMA->DMACIntErrStat, LPC_GPDMA->DMACIntErrStat & ~LPC_GPDMA->DMACIntErrClr );
+	LPC_GPDMA->DMACIntTCClear = 0UL;
+	LPC_GPDMA->DMACIntErrClr = 0UL;
+	simhwWRITE( LPC_GPDMA->DMACIntStat, LPC_GPDMA->DMACIntTCStat | LPC_GPDMA->DMACIntErrStat );
+	simhwWRITE( LPC_GPDMA->DMACRawIntTCStat, LPC_GPDMA->DMACIntTCStat );
+	simhwWRITE( LPC_GPDMA->DMACRawIntErrStat, LPC_GPDMA->DMACIntErrStat );
+
+	simhwWRITE( LPC_GPDMA->DMACEnbldChns, 0UL );
+	for( ulChannel = 0UL; ulChannel < simhwDMA_NUM_CHANNELS; ulChannel++ )
+	{
+		pxChannel = ( LPC_GPDMACH_TypeDef * ) ( LPC_GPDMACH0_BASE + ( ulChannel * simhwDMA_CHANNEL_SPACING ) );
+		if( ( pxChannel->DMACCConfig & simhwDMA_ENABLE ) != 0UL )
+		{
+			simhwWRITE( LPC_GPDMA->DMACEnbldChns, LPC_GPDMA->DMACEnbldChns | ( 1UL << ulChannel ) );
+		}
+	}
+
+	/* A burst of conversions starts as soon as burst mode is selected. */
+	if( ( ( LPC_ADC->ADCR & simhwADC_BURST ) != 0UL ) && ( ( LPC_ADC->ADCR & simhwADC_PDN ) != 0UL ) && ( ( LPC_ADC->ADCR & simhwADC_SEL_MASK ) != 0UL ) )
+	{
+		if( ullNextADCRound == simhwNEVER )
+		{
+			ullNextADCRound = ullNow + prvADCRoundTime();
+		}
+	}
+	else
+	{
+		ullNextADCRound = simhwNEVER;
+	}
+
+	/* The timer counter is held at zero while the reset bit is set. */
+	for( ulTimer = 0UL; ulTimer < simhwNUM_TIMERS; ulTimer++ )
+	{
+		if( ( pxTimers[ ulTimer ]->TCR & simhwTCR_RESET ) != 0UL )
+		{
+			pxTimers[ ulTimer ]->TC = 0UL;
+			pxTimers[ ulTimer ]->PC = 0UL;
+		}
+	}
+
+	/* The QEI interrupt enable, clear and set registers are write only, and
+	the order of writes to them is not seen, so clearing is assumed to come
+	first - as it does when the driver initialises the QEI. */
+	simhwWRITE( LPC_QEI->QEIIE, ( LPC_QEI->QEIIE & ~LPC_QEI->QEIIEC ) | LPC_QEI->QEIIES );
+	simhwWRITE( LPC_QEI->QEIINTSTAT, ( LPC_QEI->QEIINTSTAT & ~LPC_QEI->QEICLR ) | LPC_QEI->QEISET );
+	simhwWRITE( LPC_QEI->QEIIEC, 0UL );
+	simhwWRITE( LPC_QEI->QEIIES, 0UL );
+	simhwWRITE( LPC_QEI->QEICLR, 0UL );
+	simhwWRITE( LPC_QEI->QEISET, 0UL );
+
+	if( ( LPC_QEI->QEICON & simhwQEI_CON_RESP ) != 0UL )
+	{
+		llQEIOrigin += ( long long ) ( int32_t ) LPC_QEI->QEIPOS;
+		simhwWRITE( LPC_QEI->QEICON, 0UL );
+		prvSyncEncoders();
+	}
+
+	/* The velocity timer runs while the QEI is powered. */
+	if( ( LPC_SC->PCONP & CLKPWR_PCONP_PCQEI ) != 0UL )
+	{
+		if( ullNextQEITimer == simhwNEVER )
+		{
+			ullNextQEITimer = ullNow + prvQEITimerPeriod();
+		}
+	}
+	else
+	{
+		ullNextQEITimer = simhwNEVER;
+	}
+
+	if( ( simhwDWT_CTRL & 1UL ) != 0UL )
+	{
+		simhwDWT_CYCCNT = ( uint32_t ) ( ( ullNow * ( SystemCoreClock / 1000000UL ) ) / 1000ULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSyncGPIO( void )
+{
+unsigned long ulPort;
+uint32_t ulDirection, ulOldDirection;
+LPC_GPIO_TypeDef *pxPort;
+
+	for( ulPort = 0UL; ulPort < simhwNUM_GPIO_PORTS; ulPort++ )
+	{
+		pxPort = simhwGPIO_PORT( ulPort );
+		ulDirection = pxPort->FIODIR;
+
+		/* A write to FIOPIN sets the output latch of the output pins. */
+		if( ( ( pxPort->FIOPIN ^ ulLastPinValue[ ulPort ] ) & ulDirection ) != 0UL )
+		{
+			ulOutputLatch[ ulPort ] = ( ulOutputLatch[ ulPort ] & ~ulDirection ) | ( pxPort->FIOPIN & ulDirection );
+		}
+
+		ulOutputLatch[ ulPort ] |= pxPort->FIOSET;
+		ulOutputLatch[ ulPort ] &= ~( pxPort->FIOCLR );
+		pxPort->FIOSET = 0UL;
+		pxPort->FIOCLR = 0UL;
+
+		ulOldDirection = ulLastDirection[ ulPort ];
+		ulLastDirection[ ulPort ] = ulDirection;
+
+		if( ulPort == simhwFLOOR_PORT )
+		{
+			prvSyncFloorSensors( ulOldDirection, ulDirection );
+		}
+		else if( ulPort == simhwBUTTON_PORT )
+		{
+			/* The button is pulled up, and connects the pin to ground. */
+			if( iSimArenaButtonPressed( ullNow ) != 0 )
+			{
+				ulInputLevel[ ulPort ] &= ~simhwBUTTON_MASK;
+			}
+			else
+			{
+				ulInputLevel[ ulPort ] |= simhwBUTTON_MASK;
+			}
+		}
+
+		pxPort->FIOPIN = ( ulOutputLatch[ ulPort ] & ulDirection ) | ( ulInputLevel[ ulPort ] & ~ulDirection );
+		ulLastPinValue[ ulPort ] = pxPort->FIOPIN;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSyncFloorSensors( uint32_t ulOldDirection, uint32_t ulNewDirection )
+{
+unsigned long ulSensor;
+uint32_t ulMask;
+int iEmitterOn;
+
+	iEmitterOn = ( ( ulOutputLatch[ simhwFLOOR_PORT ] & ulNewDirection & simhwEMITTER_MASK ) != 0UL );
+
+	for( ulSensor = 0UL; ulSensor < simarenaNUM_FLOOR_SENSORS; ulSensor++ )
+	{
+		ulMask = 1UL << ( simhwFLOOR_FIRST_PIN + ulSensor );
+
+		if( ( ulNewDirection & ulMask ) != 0UL )
+		{
+			/* Driven, so charging (or discharging through the pin). */
+			ullFloorFall[ ulSensor ] = simhwNEVER;
+			if( ( ulOutputLatch[ simhwFLOOR_PORT ] & ulMask ) != 0UL )
+			{
+				ulInputLevel[ simhwFLOOR_PORT ] |= ulMask;
+			}
+			else
+			{
+				ulInputLevel[ simhwFLOOR_PORT ] &= ~ulMask;
+			}
+		}
+		else if( ( ulOldDirection & ulMask ) != 0UL )
+		{
+			/* Just released.  A charged sensor reads high until the
+			phototransistor has discharged it. */
+			if( ( ulInputLevel[ simhwFLOOR_PORT ] & ulMask ) != 0UL )
+			{
+				ullFloorFall[ ulSensor ] = ullNow + ullSimArenaFloorDischarge( ulSensor, iEmitterOn );
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvAdvanceTimers( unsigned long long ullTime )
+{
+unsigned long ulTimer;
+unsigned __int128 xClock;
+unsigned long long ullCycles;
+LPC_TIM_TypeDef *pxTimer;
+
+	for( ulTimer = 0UL; ulTimer < simhwNUM_TIMERS; ulTimer++ )
+	{
+		pxTimer = pxTimers[ ulTimer ];
+
+		if( ( ( pxTimer->TCR & simhwTCR_ENABLE ) != 0UL ) && ( ( pxTimer->TCR & simhwTCR_RESET ) == 0UL ) && ( ( pxTimer->CTCR & simhwCTCR_MODE_MASK ) == 0UL ) )
+		{
+			/* The peripheral clock cycles that start in the interval. */
+			xClock = CLKPWR_GetPCLK( ulTimerClocks[ ulTimer ] );
+			ullCycles = ( unsigned long long ) ( ( ( unsigned __int128 ) ullTime * xClock ) / simhwNS_PER_SECOND );
+			ullCycles -= ( unsigned long long ) ( ( ( unsigned __int128 ) ullNow * xClock ) / simhwNS_PER_SECOND );
+			ullCycles += pxTimer->PC;
+
+			pxTimer->TC += ( uint32_t ) ( ullCycles / ( pxTimer->PR + 1ULL ) );
+			pxTimer->PC = ( uint32_t ) ( ullCycles % ( pxTimer->PR + 1ULL ) );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long long prvNextTimerMatch( unsigned long ulTimer )
+{
+LPC_TIM_TypeDef * const pxTimer = pxTimers[ ulTimer ];
+volatile uint32_t * const pulMatch = &( pxTimer->MR0 );
+unsigned long long ullReturn = simhwNEVER, ullTicks, ullCycles, ullClock, ullStartCycles, ullTime;
+unsigned long ulChannel;
+
+	/* Counters only match when an edge is counted, which is not
+	simulated. */
+	if( ( ( pxTimer->TCR & simhwTCR_ENABLE ) != 0UL ) && ( ( pxTimer->TCR & simhwTCR_RESET ) == 0UL ) && ( ( pxTimer->CTCR & simhwCTCR_MODE_MASK ) == 0UL ) )
+	{
+		ullClock = CLKPWR_GetPCLK( ulTimerClocks[ ulTimer ] );
+		ullStartCycles = ( unsigned long long ) ( ( ( unsigned __int128 ) ullNow * ullClock ) / simhwNS_PER_SECOND );
+
+		for( ulChannel = 0UL; ulChannel < simhwNUM_MATCH_CHANNELS; ulChannel++ )
+		{
+			if( ( pxTimer->MCR & ( simhwMCR_INTERRUPT( ulChannel ) | simhwMCR_RESET( ulChannel ) | simhwMCR_STOP( ulChannel ) ) ) != 0UL )
+			{
+				/* A match register equal to the counter has already matched,
+				so will not match again until the counter wraps. */
+				ullTicks = ( uint32_t ) ( pulMatch[ ulChannel ] - pxTimer->TC );
+				if( ullTicks == 0ULL )
+				{
+					ullTicks = 0x100000000ULL;
+				}
+
+				/* The first instant at which enough cycles have started. */
+				ullCycles = ( ullTicks * ( pxTimer->PR + 1ULL ) ) - pxTimer->PC;
+				ullTime = ( unsigned long long ) ( ( ( ( unsigned __int128 ) ( ullStartCycles + ullCycles ) * simhwNS_PER_SECOND ) + ullClock - 1ULL ) / ullClock );
+
+				if( ullTime < ullReturn )
+				{
+					ullReturn = ullTime;
+				}
+			}
+		}
+	}
+
+	return ullReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTimerMatch( unsigned long ulTimer )
+{
+static const pdSIM_HANDLER pxHandlers[ simhwNUM_TIMERS ] = { TIMER0_IRQHandler, TIMER1_IRQHandler, TIMER2_IRQHandler, TIMER3_IRQHandler };
+LPC_TIM_TypeDef * const pxTimer = pxTimers[ ulTimer ];
+volatile uint32_t * const pulMatch = &( pxTimer->MR0 );
+uint32_t ulMatched = 0UL, ulTC = pxTimer->TC;
+unsigned long ulChannel;
+
+	for( ulChannel = 0UL; ulChannel < simhwNUM_MATCH_CHANNELS; ulChannel++ )
+	{
+		if( pulMatch[ ulChannel ] == ulTC )
+		{
+			ulMatched |= 1UL << ulChannel;
+
+			if( ( pxTimer->MCR & simhwMCR_RESET( ulChannel ) ) != 0UL )
+			{
+				pxTimer->TC = 0UL;
+				pxTimer->PC = 0UL;
+			}
+
+			if( ( pxTimer->MCR & simhwMCR_STOP( ulChannel ) ) != 0UL )
+			{
+				pxTimer->TCR &= ~simhwTCR_ENABLE;
+			}
+
+			if( ( pxTimer->MCR & simhwMCR_INTERRUPT( ulChannel ) ) != 0UL )
+			{
+				pxTimer->IR |= 1UL << ulChannel;
+			}
+		}
+	}
+
+	if( ( pxTimer->IR != 0UL ) && ( pxHandlers[ ulTimer ] != NULL ) )
+	{
+		prvCallHandler( simhwIRQ_TIMER0 + ulTimer, pxHandlers[ ulTimer ] );
+
+		/* IR is write one to clear, which plain memory cannot do, so the
+		handler is assumed to have cleared the flags it was called for. */
+		pxTimer->IR &= ~ulMatched;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvFloorSensorFall( unsigned long ulSensor )
+{
+const uint32_t ulMask = 1UL << ( simhwFLOOR_FIRST_PIN + ulSensor );
+
+	ullFloorFall[ ulSensor ] = simhwNEVER;
+	ulInputLevel[ simhwFLOOR_PORT ] &= ~ulMask;
+	prvSyncGPIO();
+
+	if( ( LPC_GPIOINT->IO2IntEnF & ulMask ) != 0UL )
+	{
+		simhwWRITE( LPC_GPIOINT->IO2IntStatF, LPC_GPIOINT->IO2IntStatF | ulMask );
+		simhwWRITE( LPC_GPIOINT->IntStatus, LPC_GPIOINT->IntStatus | 4UL );
+
+		if( EINT3_IRQHandler != NULL )
+		{
+			prvCallHandler( simhwIRQ_EINT3, EINT3_IRQHandler );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvButtonPress( void )
+{
+	/* The level of the pin follows the arena, so only the edge is made
+	here. */
+	ullButtonPress = simhwNEVER;
+	prvSyncGPIO();
+
+	if( ( LPC_GPIOINT->IO0IntEnF & simhwBUTTON_MASK ) != 0UL )
+	{
+		simhwWRITE( LPC_GPIOINT->IO0IntStatF, LPC_GPIOINT->IO0IntStatF | simhwBUTTON_MASK );
+		simhwWRITE( LPC_GPIOINT->IntStatus, LPC_GPIOINT->IntStatus | 1UL );
+
+		if( EINT3_IRQHandler != NULL )
+		{
+			prvCallHandler( simhwIRQ_EINT3, EINT3_IRQHandler );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvADCRound( void )
+{
+volatile uint32_t * const pulData = ( volatile uint32_t * ) &( LPC_ADC->ADDR0 );
+unsigned long ulChannel;
+uint32_t ulValue, ulLast = 0UL;
+
+	for( ulChannel = 0UL; ulChannel < simhwADC_NUM_CHANNELS; ulChannel++ )
+	{
+		if( ( LPC_ADC->ADCR & ( 1UL << ulChannel ) ) != 0UL )
+		{
+			if( ulChannel < simarenaNUM_DISTANCE_SENSORS )
+			{
+				ulValue = ( uint32_t ) ulSimArenaReadDistance( ulChannel );
+			}
+			else
+			{
+				ulValue = 0UL;
+			}
+
+			ulValue = simhwADC_DONE | ( ( ulValue & 0xfffUL ) << 4UL ) | ( ulChannel << 24UL );
+			simhwWRITE( pulData[ ulChannel ], ulValue );
+			simhwWRITE( LPC_ADC->ADGDR, ulValue );
+			ulLast = ulChannel;
+		}
+	}
+
+	simhwWRITE( LPC_ADC->ADSTAT, ( LPC_ADC->ADCR & simhwADC_SEL_MASK ) | ( 1UL << 16UL ) );
+	ullNextADCRound = ullNow + prvADCRoundTime();
+
+	/* The DMA request is raised by the done flag of a channel whose
+	interrupt is enabled. */
+	if( ( LPC_ADC->ADINTEN & ( ( 1UL << ulLast ) | ( 1UL << 8UL ) ) ) != 0UL )
+	{
+		prvDMARequest( GPDMA_CONN_ADC );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvDMARequest( uint32_t ulPeripheral )
+{
+LPC_GPDMACH_TypeDef *pxChannel;
+GPDMA_LLI_Type *pxNext;
+unsigned long ulChannel, ulItem, ulItems, ulWidth;
+uint32_t ulControl, ulTerminalCount = 0UL;
+uint8_t *pucSource, *pucDestination;
+
+	if( ( LPC_GPDMA->DMACConfig & GPDMA_DMACConfig_E ) == 0UL )
+	{
+		return;
+	}
+
+	for( ulChannel = 0UL; ulChannel < simhwDMA_NUM_CHANNELS; ulChannel++ )
+	{
+		pxChannel = ( LPC_GPDMACH_TypeDef * ) ( LPC_GPDMACH0_BASE + ( ulChannel * simhwDMA_CHANNEL_SPACING ) );
+
+		if( ( ( pxChannel->DMACCConfig & simhwDMA_ENABLE ) == 0UL ) || ( simhwDMA_SRC_PERIPHERAL( pxChannel->DMACCConfig ) != ulPeripheral ) )
+		{
+			continue;
+		}
+
+		ulControl = pxChannel->DMACCControl;
+		ulItems = simhwDMA_TRANSFER_SIZE( ulControl );
+		ulWidth = 1UL << simhwDMA_SWIDTH( ulControl );
+		pucSource = ( uint8_t * ) ( uintptr_t ) pxChannel->DMACCSrcAddr;
+		pucDestination = ( uint8_t * ) ( uintptr_t ) pxChannel->DMACCDestAddr;
+
+		for( ulItem = 0UL; ulItem < ulItems; ulItem++ )
+		{
+			switch( ulWidth )
+			{
+				case 1 :	*( ( volatile uint8_t * ) pucDestination ) = *( ( volatile uint8_t * ) pucSource );
+							break;
+				case 2 :	*( ( volatile uint16_t * ) pucDestination ) = *( ( volatile uint16_t * ) pucSource );
+							break;
+				default :	*( ( volatile uint32_t * ) pucDestination ) = *( ( volatile uint32_t * ) pucSource );
+							break;
+			}
+
+			if( ( ulControl & simhwDMA_SI ) != 0UL )
+			{
+				pucSource += ulWidth;
+			}
+
+			if( ( ulControl & simhwDMA_DI ) != 0UL )
+			{
+				pucDestination += ulWidth;
+			}
+		}
+
+		if( ( ( ulControl & simhwDMA_I ) != 0UL ) && ( ( pxChannel->DMACCConfig & simhwDMA_ITC ) != 0UL ) )
+		{
+			ulTerminalCount |= 1UL << ulChannel;
+		}
+
+		/* Load the next linked list item, or stop. */
+		if( pxChannel->DMACCLLI != 0UL )
+		{
+			pxNext = ( GPDMA_LLI_Type * ) ( uintptr_t ) pxChannel->DMACCLLI;
+			pxChannel->DMACCSrcAddr = pxNext->SrcAddr;
+			pxChannel->DMACCDestAddr = pxNext->DstAddr;
+			pxChannel->DMACCLLI = pxNext->NextLLI;
+			pxChannel->DMACCControl = pxNext->Control;
+		}
+		else
+		{
+			pxChannel->DMACCSrcAddr = ( uint32_t ) ( uintptr_t ) pucSource;
+			pxChannel->DMACCDestAddr = ( uint32_t ) ( uintptr_t ) pucDestination;
+			pxChannel->DMACCControl &= ~simhwDMA_TRANSFER_SIZE( 0xffffffffUL );
+			pxChannel->DMACCConfig &= ~simhwDMA_ENABLE;
+		}
+	}
+
+	if( ulTerminalCount != 0UL )
+	{
+		simhwWRITE( LPC_GPDMA->DMACIntTCStat, LPC_GPDMA->DMACIntTCStat | ulTerminalCount );
+		simhwWRITE( LPC_GPDMA->DMACIntStat, LPC_GPDMA->DMACIntStat | ulTerminalCount );
+
+		if( DMA_IRQHandler != NULL )
+		{
+			prvCallHandler( simhwIRQ_DMA, DMA_IRQHandler );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvTick( void )
+{
+double dDuty[ 2 ] = { 0.0, 0.0 };
+volatile uint32_t * const pulMatch0To3 = &( LPC_PWM1->MR0 );
+volatile uint32_t * const pulMatch4To6 = &( LPC_PWM1->MR4 );
+const unsigned long ulChannels[ 2 ] = { simhwLEFT_PWM_CHANNEL, simhwRIGHT_PWM_CHANNEL };
+const uint32_t ulDirectionMasks[ 2 ] = { simhwLEFT_DIRECTION_MASK, simhwRIGHT_DIRECTION_MASK };
+unsigned long ulMotor, ulChannel;
+
+	ullNextTick += simhwTICK_NS;
+
+	/* Match values are latched when the counter next resets.  The PWM period
+	is much shorter than the tick, so that is taken to be now. */
+	for( ulChannel = 0UL; ulChannel < simhwNUM_PWM_MATCHES; ulChannel++ )
+	{
+		if( ( LPC_PWM1->LER & ( 1UL << ulChannel ) ) != 0UL )
+		{
+			ulPWMMatch[ ulChannel ] = ( ulChannel < 4UL ) ? pulMatch0To3[ ulChannel ] : pulMatch4To6[ ulChannel - 4UL ];
+		}
+	}
+	LPC_PWM1->LER = 0UL;
+
+	/* The motors only turn while PWM1 is running and the channel output is
+	enabled.  A high direction pin reverses the motor. */
+	if( ( ( LPC_PWM1->TCR & PWM_TCR_COUNTER_ENABLE ) != 0UL ) && ( ( LPC_PWM1->TCR & PWM_TCR_PWM_ENABLE ) != 0UL ) && ( ulPWMMatch[ 0 ] != 0UL ) )
+	{
+		for( ulMotor = 0UL; ulMotor < 2UL; ulMotor++ )
+		{
+			ulChannel = ulChannels[ ulMotor ];
+
+			if( ( LPC_PWM1->PCR & PWM_PCR_PWMENAn( ulChannel ) ) != 0UL )
+			{
+				dDuty[ ulMotor ] = ( double ) ulPWMMatch[ ulChannel ] / ( double ) ulPWMMatch[ 0 ];
+				if( dDuty[ ulMotor ] > 1.0 )
+				{
+					dDuty[ ulMotor ] = 1.0;
+				}
+
+				if( ( ulOutputLatch[ 0 ] & ulLastDirection[ 0 ] & ulDirectionMasks[ ulMotor ] ) != 0UL )
+				{
+					dDuty[ ulMotor ] = -dDuty[ ulMotor ];
+				}
+			}
+		}
+	}
+
+	vSimArenaStep( ullNow, ( double ) simhwTICK_NS / ( double ) simhwNS_PER_SECOND, dDuty[ 0 ], dDuty[ 1 ] );
+	if( lSimArenaOutcome() != simarenaRUNNING )
+	{
+		vSimBoutFinished( lSimArenaOutcome() );
+	}
+
+	prvSyncEncoders();
+	vPortSimTick();
+}
+/*-----------------------------------------------------------*/
+
+static void prvSyncEncoders( void )
+{
+LPC_TIM_TypeDef * const pxTimer = pxTimers[ simhwLEFT_ENCODER_TIMER ];
+double dLeft, dRight;
+long long llRise;
+
+	vSimArenaGetWheelDistances( &dLeft, &dRight );
+
+	/* The position counter wraps at QEIMAXPOS, which the firmware sets to the
+	full 32 bits. */
+	simhwWRITE( LPC_QEI->QEIPOS, ( uint32_t ) ( ( long long ) floor( dRight * simhwENCODER_COUNTS_PER_METRE ) - llQEIOrigin ) );
+
+	/* TIMER2 counts each rising edge of phase A, whichever way the wheel
+	turns. */
+	llRise = ( long long ) floor( ( dLeft * simhwENCODER_COUNTS_PER_METRE ) / simhwENCODER_COUNTS_PER_RISE );
+	if( ( ( pxTimer->TCR & simhwTCR_ENABLE ) != 0UL ) && ( ( pxTimer->TCR & simhwTCR_RESET ) == 0UL ) && ( ( pxTimer->CTCR & simhwCTCR_MODE_MASK ) != 0UL ) )
+	{
+		pxTimer->TC += ( uint32_t ) llabs( llRise - llLastLeftRise );
+	}
+	llLastLeftRise = llRise;
+}
+/*-----------------------------------------------------------*/
+
+static void prvQEITimer( void )
+{
+	ullNextQEITimer += prvQEITimerPeriod();
+
+	simhwWRITE( LPC_QEI->QEIINTSTAT, LPC_QEI->QEIINTSTAT | simhwQEI_INT_TIM );
+	if( ( ( LPC_QEI->QEIIE & simhwQEI_INT_TIM ) != 0UL ) && ( QEI_IRQHandler != NULL ) )
+	{
+		prvCallHandler( simhwIRQ_QEI, QEI_IRQHandler );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long long prvQEITimerPeriod( void )
+{
+	return ( ( ( unsigned long long ) LPC_QEI->QEILOAD + 1ULL ) * simhwNS_PER_SECOND ) / CLKPWR_GetPCLK( CLKPWR_PCLKSEL_QEI );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCallHandler( unsigned long ulIRQ, pdSIM_HANDLER pxHandler )
+{
+unsigned long long ullStart, ullTime;
+
+	ullStart = prvHostNanoseconds();
+	pxHandler();
+	ullTime = prvHostNanoseconds() - ullStart;
+
+	xIRQStats[ ulIRQ ].ulCalls++;
+	xIRQStats[ ulIRQ ].ullCPUNanoseconds += ullTime;
+	if( ullTime > xIRQStats[ ulIRQ ].ullMaxNanoseconds )
+	{
+		xIRQStats[ ulIRQ ].ullMaxNanoseconds = ullTime;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long long prvADCRoundTime( void )
+{
+unsigned long long ullClocks, ullChannels;
+uint32_t ulSelected;
+
+	ulSelected = LPC_ADC->ADCR & simhwADC_SEL_MASK;
+	ullChannels = ( unsigned long long ) __builtin_popcount( ulSelected );
+	ullClocks = ullChannels * simhwADC_CLOCKS_PER_SAMPLE * ( simhwADC_CLKDIV( LPC_ADC->ADCR ) + 1ULL );
+
+	return ( ullClocks * simhwNS_PER_SECOND ) / CLKPWR_GetPCLK( CLKPWR_PCLKSEL_ADC );
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long long prvHostNanoseconds( void )
+{
+struct timespec xNow;
+
+	clock_gettime( CLOCK_THREAD_CPUTIME_ID, &xNow );
+	return ( ( unsigned long long ) xNow.tv_sec * 1000000000ULL ) + ( unsigned long long ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,76 @@
+#ifndef SIM_HARDWARE_H
+#define SIM_HARDWARE_H
+
+/*
+ * The simulated LPC1769 peripherals.
+ *
+ * The peripheral register blocks are mapped into the host process at the
+ * same addresses they have on the target, so LPC17xx.h, the NXP driver
+ * library and the application access them unchanged.  The registers are
+ * plain memory - the simulation reads what the firmware wrote each time
+ * simulated time is advanced, and writes back whatever the hardware would
+ * have changed.  Only the peripherals the robot uses are simulated:
+ *
+ *  + TIMER0 to TIMER3 count, match, reset, stop and interrupt.
+ *  + GPIO output latches (FIOSET, FIOCLR, FIOPIN) and the port 2 falling
+ *    edge interrupts.  The GPIO registers are the exception to plain memory -
+ *    firmware writes to them are trapped, so each one is seen in order.
+ *  + The ADC in burst mode, feeding the GPDMA with linked list items.
+ *  + PWM1 is only read, to find the duty of the motor channels, and match
+ *    values only take effect once enabled in the latch enable register.
+ *  + The QEI position counter and velocity timer interrupt, fed by the right
+ *    wheel encoder, and TIMER2 counting phase A of the left wheel encoder.
+ *  + The DWT cycle counter follows simulated time.
+ *
+ * The RTOS tick is generated every millisecond of simulated time, and the
+ * arena physics are stepped at the same time.
+ */
+
+/* The interrupts that are simulated, used to index the statistics. */
+#define simhwIRQ_TIMER0			( 0 )
+#define simhwIRQ_TIMER1			( 1 )
+#define simhwIRQ_TIMER2			( 2 )
+#define simhwIRQ_TIMER3			( 3 )
+#define simhwIRQ_EINT3			( 4 )
+#define simhwIRQ_DMA			( 5 )
+#define simhwIRQ_QEI			( 6 )
+#define simhwNUM_IRQS			( 7 )
+
+typedef struct xSIM_IRQ_STATS
+{
+	const char *pcName;
+	unsigned long ulCalls;					/* Times the handler was called. */
+	unsigned long long ullCPUNanoseconds;	/* Host CPU time used by the handler. */
+	unsigned long long ullMaxNanoseconds;	/* Longest single call. */
+} xSimIRQStats;
+
+/*
+ * Map the peripheral register blocks.  Must be called once, before anything
+ * accesses a register.  Returns 0 if the addresses are not available.
+ */
+int iSimHardwareInit( void );
+
+/*
+ * Prepare the hardware for a new bout, in the process that will run it.
+ * Returns 0 on failure.
+ */
+int iSimHardwareStartBout( void );
+
+/*
+ * Return the simulated time, in nanoseconds since the bout started.
+ */
+unsigned long long ullSimHardwareNow( void );
+
+/*
+ * Copy the statistics of the simulated interrupts into pxStats, which must
+ * have room for simhwNUM_IRQS entries.
+ */
+void vSimHardwareGetIRQStats( xSimIRQStats *pxStats );
+
+/*
+ * Called once the arena has decided the outcome of the bout.  Provided by
+ * Sim-main.c, and does not return.
+ */
+void vSimBoutFinished( long lOutcome );
+
+#endif /* SIM_HARDWARE_H */
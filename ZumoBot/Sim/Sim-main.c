@@ -0,0 +1,604 @@
+/*
+ * Runs simulated sumo bouts against the unmodified ZumoBot application.
+ *
+ * Each bout runs in a child process, so every bout starts the firmware from
+ * its reset state.  The child places the robots, then calls the firmware
+ * main() (compiled as iFirmwareMain()), which never returns - when the arena
+ * decides the bout, vSimBoutFinished() sends the result to the parent through
+ * a pipe and exits.  The parent runs the bouts, several at a time if asked,
+ * and reports the results and the host CPU time used by each task and
+ * interrupt handler.
+ *
+ * Usage: sim [-n bouts] [-s seed] [-t seconds] [-o opponent] [-j jobs] [-v]
+ *            [-x file]
+ *
+ * The time each search takes to find the opponent is reported as the time
+ * to acquire.  To compare it with the old search, which only turns on the
+ * spot, rebuild with make clean; make DEFINES=-DsumoUSE_OPPONENT_TRACKER=0.
+ *
+ * The opponent is one of still, wander, charge or mix.  A bout that crashes
+ * or hangs is reported with its seed, so it can be repeated on its own with
+ * -n 1 -s seed.
+ *
+ * With -x, the first bout writes the output of the trace recorder's "trace"
+ * command to the file as it ends, for the tracejson tool (see Trace-json.c).
+ * The recorder is only built in with
+ * make clean; make DEFINES=-DconfigUSE_TRACE_RECORDER=1.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Zumo includes. */
+#include "Control-loop.h"
+#include "Motor-control.h"
+#include "Sumo-behaviour.h"
+
+/* Simulation includes. */
+#include "Sim-port.h"
+#include "Sim-hardware.h"
+#include "Sim-arena.h"
+
+#define simmainNS_PER_SECOND		( 1000000000ULL )
+
+/* The most bouts run at the same time. */
+#define simmainMAX_JOBS				( 64 )
+
+/* A bout is abandoned as hung if it runs for this many seconds, plus one
+second for each second of the time limit. */
+#define simmainHANG_SECONDS			( 10U )
+
+/* The result of one bout, sent from the child to the parent. */
+typedef struct xSIM_BOUT_RESULT
+{
+	long lOutcome;
+	unsigned long ulOpponent;
+	unsigned long long ullSimNanoseconds;
+	unsigned long long ullHostNanoseconds;
+	xSumoStats xSumo;
+	xControlLoopStats xControl;
+	xMotorControlStats xMotors;
+	xHeapStats xHeap;
+	unsigned long ulNumTasks;
+	xPortSimTaskStats xTasks[ portSIM_MAX_TASKS ];
+	xSimIRQStats xIRQs[ simhwNUM_IRQS ];
+} xSimBoutResult;
+
+/* A bout in progress. */
+typedef struct xSIM_JOB
+{
+	pid_t xPid;
+	int iPipe;
+	unsigned long ulBout;
+} xSimJob;
+
+/* The results of all the bouts so far. */
+typedef struct xSIM_TOTALS
+{
+	unsigned long ulOutcomes[ simarenaNUM_OUTCOMES ];
+	unsigned long ulCrashed;
+	unsigned long long ullSimNanoseconds;
+	unsigned long long ullHostNanoseconds;
+	unsigned long ulEdgeEvents;
+	unsigned long ulEventsLost;
+	unsigned long ulMaxEdgeToReverseMicroseconds;
+	unsigned long ulTaskSpawns;
+	unsigned long ulTaskSpawnFailures;
+	unsigned long ulMaxTaskSpawnMicroseconds;
+	unsigned long ulAcquisitions;
+	unsigned long ulSearchTimeouts;
+	unsigned long long ullAcquireMicroseconds;
+	unsigned long ulMaxAcquireMicroseconds;
+	unsigned long ulControlPeriods;
+	unsigned long ulControlOverruns;
+	unsigned long ulMaxControlJitterMicroseconds;
+	unsigned long ulMotorPeriods;
+	unsigned long ulMotorSaturatedPeriods;
+	unsigned long ulLeastHeapFree;
+	unsigned long ulHeapFailures;
+	unsigned long ulNumTasks;
+	xPortSimTaskStats xTasks[ portSIM_MAX_TASKS ];
+	xSimIRQStats xIRQs[ simhwNUM_IRQS ];
+} xSimTotals;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The firmware main(), from main.c.
+ */
+int iFirmwareMain( void );
+
+/*
+ * Start bout ulBout in a child process.
+ */
+static void prvStartBout( xSimJob *pxJob, unsigned long ulBout );
+
+/*
+ * Wait for any bout to end, and add its result to the totals.
+ */
+static void prvCollectBout( xSimJob *pxJobs, unsigned long *pulRunning );
+
+/*
+ * Add the result of one bout to the totals.
+ */
+static void prvAccumulate( const xSimBoutResult *pxResult );
+
+/*
+ * Print the totals.
+ */
+static void prvReport( unsigned long long ullWallNanoseconds );
+
+/*
+ * Write the trace recorder output to the -x file.
+ */
+static void prvWriteTrace( void );
+
+static unsigned long long prvNanoseconds( clockid_t xClock );
+static void prvUsage( void );
+
+/*-----------------------------------------------------------*/
+
+static const char * const pcOpponentNames[] = { "still", "wander", "charge", "mix" };
+static const char * const pcOutcomeNames[ simarenaNUM_OUTCOMES ] = { "running", "win", "loss", "draw" };
+
+/* The command line options. */
+static unsigned long ulBouts = 100UL;
+static unsigned long ulSeed = 1UL;
+static unsigned long ulTimeLimit = 60UL;
+static unsigned long ulOpponent = simarenaOPPONENT_MIX;
+static unsigned long ulJobs = 1UL;
+static int iVerbose = 0;
+static const char *pcTraceFile = NULL;
+
+/* The write end of the result pipe, and the bout run, in a child. */
+static int iResultPipe = -1;
+static unsigned long ulChildBout = 0UL;
+
+static xSimTotals xTotals;
+
+/*-----------------------------------------------------------*/
+
+int main( int argc, char *argv[] )
+{
+xSimJob xJobs[ simmainMAX_JOBS ];
+unsigned long ulBout, ulRunning = 0UL, ulOption;
+unsigned long long ullStart;
+int iOption;
+
+	while( ( iOption = getopt( argc, argv, "n:s:t:o:j:vx:" ) ) != -1 )
+	{
+		switch( iOption )
+		{
+			case 'n' :	ulBouts = strtoul( optarg, NULL, 0 );
+						break;
+			case 's' :	ulSeed = strtoul( optarg, NULL, 0 );
+						break;
+			case 't' :	ulTimeLimit = strtoul( optarg, NULL, 0 );
+						break;
+			case 'j' :	ulJobs = strtoul( optarg, NULL, 0 );
+						break;
+			case 'v' :	iVerbose = 1;
+						break;
+			case 'x' :	pcTraceFile = optarg;
+						break;
+			case 'o' :	for( ulOption = 0UL; ulOption < ( sizeof( pcOpponentNames ) / sizeof( char * ) ); ulOption++ )
+						{
+							if( strcmp( optarg, pcOpponentNames[ ulOption ] ) == 0 )
+							{
+								break;
+							}
+						}
+
+						if( ulOption == ( sizeof( pcOpponentNames ) / sizeof( char * ) ) )
+						{
+							prvUsage();
+						}
+
+						ulOpponent = ulOption;
+						break;
+			default :	prvUsage();
+						break;
+		}
+	}
+
+	if( ( ulJobs == 0UL ) || ( ulJobs > simmainMAX_JOBS ) || ( ulTimeLimit == 0UL ) )
+	{
+		prvUsage();
+	}
+
+	if( ( pcTraceFile != NULL ) && ( configUSE_TRACE_RECORDER != 1 ) )
+	{
+		fprintf( stderr, "sim: -x needs the trace recorder - make clean; make DEFINES=-DconfigUSE_TRACE_RECORDER=1\n" );
+		return EXIT_FAILURE;
+	}
+
+	/* Mapped before the bouts are started, so every child inherits its own
+	copy of the registers in their reset state. */
+	if( iSimHardwareInit() == 0 )
+	{
+		return EXIT_FAILURE;
+	}
+
+	ullStart = prvNanoseconds( CLOCK_MONOTONIC );
+
+	for( ulBout = 0UL; ulBout < ulBouts; ulBout++ )
+	{
+		if( ulRunning == ulJobs )
+		{
+			prvCollectBout( xJobs, &ulRunning );
+		}
+
+		prvStartBout( &( xJobs[ ulRunning ] ), ulBout );
+		ulRunning++;
+	}
+
+	while( ulRunning > 0UL )
+	{
+		prvCollectBout( xJobs, &ulRunning );
+	}
+
+	prvReport( prvNanoseconds( CLOCK_MONOTONIC ) - ullStart );
+
+	return ( xTotals.ulCrashed == 0UL ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+/*-----------------------------------------------------------*/
+
+void vSimBoutFinished( long lOutcome )
+{
+xSimBoutResult xResult;
+
+	memset( &xResult, 0, sizeof( xResult ) );
+	xResult.lOutcome = lOutcome;
+	xResult.ulOpponent = ulSimArenaOpponent();
+	xResult.ullSimNanoseconds = ullSimHardwareNow();
+	xResult.ullHostNanoseconds = prvNanoseconds( CLOCK_PROCESS_CPUTIME_ID );
+	vSumoGetStats( &( xResult.xSumo ) );
+	vControlLoopGetStats( &( xResult.xControl ) );
+	vMotorControlGetStats( &( xResult.xMotors ) );
+	vPortGetHeapStats( &( xResult.xHeap ) );
+	xResult.ulNumTasks = ulPortSimGetTaskStats( xResult.xTasks, portSIM_MAX_TASKS );
+	vSimHardwareGetIRQStats( xResult.xIRQs );
+
+	if( ( pcTraceFile != NULL ) && ( ulChildBout == 0UL ) )
+	{
+		prvWriteTrace();
+	}
+
+	if( write( iResultPipe, &xResult, sizeof( xResult ) ) != ( ssize_t ) sizeof( xResult ) )
+	{
+		_exit( EXIT_FAILURE );
+	}
+
+	_exit( EXIT_SUCCESS );
+}
+/*-----------------------------------------------------------*/
+
+static void prvStartBout( xSimJob *pxJob, unsigned long ulBout )
+{
+xSimArenaConfig xConfig;
+int iPipe[ 2 ];
+
+	fflush( stdout );
+
+	if( pipe( iPipe ) != 0 )
+	{
+		perror( "pipe" );
+		exit( EXIT_FAILURE );
+	}
+
+	pxJob->ulBout = ulBout;
+	pxJob->iPipe = iPipe[ 0 ];
+	pxJob->xPid = fork();
+
+	if( pxJob->xPid < 0 )
+	{
+		perror( "fork" );
+		exit( EXIT_FAILURE );
+	}
+	else if( pxJob->xPid == 0 )
+	{
+		close( iPipe[ 0 ] );
+		iResultPipe = iPipe[ 1 ];
+		ulChildBout = ulBout;
+
+		alarm( simmainHANG_SECONDS + ( unsigned ) ulTimeLimit );
+
+		if( iSimHardwareStartBout() == 0 )
+		{
+			_exit( EXIT_FAILURE );
+		}
+
+		xConfig.ulSeed = ulSeed + ulBout;
+		xConfig.ulOpponent = ulOpponent;
+		xConfig.ullTimeLimit = ( unsigned long long ) ulTimeLimit * simmainNS_PER_SECOND;
+		vSimArenaInit( &xConfig );
+
+		iFirmwareMain();
+
+		/* The firmware main() should never return. */
+		_exit( EXIT_FAILURE );
+	}
+
+	close( iPipe[ 1 ] );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCollectBout( xSimJob *pxJobs, unsigned long *pulRunning )
+{
+xSimBoutResult xResult;
+unsigned long ulJob;
+pid_t xPid;
+int iStatus;
+
+	do
+	{
+		xPid = wait( &iStatus );
+	} while( xPid < 0 );
+
+	for( ulJob = 0UL; ulJob < *pulRunning; ulJob++ )
+	{
+		if( pxJobs[ ulJob ].xPid == xPid )
+		{
+			break;
+		}
+	}
+
+	if( ulJob == *pulRunning )
+	{
+		return;
+	}
+
+	if( ( WIFEXITED( iStatus ) != 0 ) && ( WEXITSTATUS( iStatus ) == EXIT_SUCCESS ) && ( read( pxJobs[ ulJob ].iPipe, &xResult, sizeof( xResult ) ) == ( ssize_t ) sizeof( xResult ) ) )
+	{
+		prvAccumulate( &xResult );
+
+		if( iVerbose != 0 )
+		{
+			printf( "bout %lu seed %lu %s: %s after %.2fs, %lu edge events, %.1fms host CPU\n",
+					pxJobs[ ulJob ].ulBout, ulSeed + pxJobs[ ulJob ].ulBout, pcOpponentNames[ xResult.ulOpponent ],
+					pcOutcomeNames[ xResult.lOutcome ], ( double ) xResult.ullSimNanoseconds / 1e9,
+					( unsigned long ) xResult.xSumo.ulEdgeEvents, ( double ) xResult.ullHostNanoseconds / 1e6 );
+		}
+	}
+	else
+	{
+		xTotals.ulCrashed++;
+
+		if( WIFSIGNALED( iStatus ) != 0 )
+		{
+			printf( "bout %lu crashed with signal %d (%s) - repeat with -n 1 -s %lu\n", pxJobs[ ulJob ].ulBout, WTERMSIG( iStatus ),
+					( WTERMSIG( iStatus ) == SIGALRM ) ? "hung" : strsignal( WTERMSIG( iStatus ) ), ulSeed + pxJobs[ ulJob ].ulBout );
+		}
+		else
+		{
+			printf( "bout %lu failed - repeat with -n 1 -s %lu\n", pxJobs[ ulJob ].ulBout, ulSeed + pxJobs[ ulJob ].ulBout );
+		}
+	}
+
+	close( pxJobs[ ulJob ].iPipe );
+
+	/* Keep the running jobs at the start of the array. */
+	( *pulRunning )--;
+	pxJobs[ ulJob ] = pxJobs[ *pulRunning ];
+}
+/*-----------------------------------------------------------*/
+
+static void prvAccumulate( const xSimBoutResult *pxResult )
+{
+unsigned long ulTask, ulTotal, ulIRQ;
+xPortSimTaskStats *pxTotal;
+
+	xTotals.ulOutcomes[ pxResult->lOutcome ]++;
+	xTotals.ullSimNanoseconds += pxResult->ullSimNanoseconds;
+	xTotals.ullHostNanoseconds += pxResult->ullHostNanoseconds;
+	xTotals.ulEdgeEvents += pxResult->xSumo.ulEdgeEvents;
+	xTotals.ulEventsLost += pxResult->xSumo.ulEventsLost;
+
+	if( ( pxResult->xSumo.ulEdgeEvents != 0UL ) && ( pxResult->xSumo.ulMaxEdgeToReverseMicroseconds > xTotals.ulMaxEdgeToReverseMicroseconds ) )
+	{
+		xTotals.ulMaxEdgeToReverseMicroseconds = pxResult->xSumo.ulMaxEdgeToReverseMicroseconds;
+	}
+
+	xTotals.ulTaskSpawns += pxResult->xSumo.ulTaskSpawns;
+	xTotals.ulTaskSpawnFailures += pxResult->xSumo.ulTaskSpawnFailures;
+
+	if( pxResult->xSumo.ulMaxTaskSpawnMicroseconds > xTotals.ulMaxTaskSpawnMicroseconds )
+	{
+		xTotals.ulMaxTaskSpawnMicroseconds = pxResult->xSumo.ulMaxTaskSpawnMicroseconds;
+	}
+
+	xTotals.ulAcquisitions += pxResult->xSumo.ulAcquisitions;
+	xTotals.ulSearchTimeouts += pxResult->xSumo.ulSearchTimeouts;
+	xTotals.ullAcquireMicroseconds += pxResult->xSumo.ulTotalAcquireMicroseconds;
+
+	if( pxResult->xSumo.ulMaxAcquireMicroseconds > xTotals.ulMaxAcquireMicroseconds )
+	{
+		xTotals.ulMaxAcquireMicroseconds = pxResult->xSumo.ulMaxAcquireMicroseconds;
+	}
+
+	xTotals.ulControlPeriods += pxResult->xControl.ulPeriods;
+	xTotals.ulControlOverruns += pxResult->xControl.ulOverruns;
+
+	if( pxResult->xControl.ulMaxJitterMicroseconds > xTotals.ulMaxControlJitterMicroseconds )
+	{
+		xTotals.ulMaxControlJitterMicroseconds = pxResult->xControl.ulMaxJitterMicroseconds;
+	}
+
+	xTotals.ulMotorPeriods += pxResult->xMotors.ulPeriods;
+	xTotals.ulMotorSaturatedPeriods += pxResult->xMotors.ulSaturatedPeriods;
+	xTotals.ulHeapFailures += pxResult->xHeap.xNumberOfFailures;
+
+	if( ( xTotals.ulLeastHeapFree == 0UL ) || ( pxResult->xHeap.xMinimumEverFreeBytesRemaining < xTotals.ulLeastHeapFree ) )
+	{
+		xTotals.ulLeastHeapFree = pxResult->xHeap.xMinimumEverFreeBytesRemaining;
+	}
+
+	/* Tasks are matched by name, as they are not always created in the same
+	order. */
+	for( ulTask = 0UL; ulTask < pxResult->ulNumTasks; ulTask++ )
+	{
+		for( ulTotal = 0UL; ulTotal < xTotals.ulNumTasks; ulTotal++ )
+		{
+			if( strcmp( xTotals.xTasks[ ulTotal ].pcName, pxResult->xTasks[ ulTask ].pcName ) == 0 )
+			{
+				break;
+			}
+		}
+
+		if( ulTotal == xTotals.ulNumTasks )
+		{
+			if( ulTotal == portSIM_MAX_TASKS )
+			{
+				continue;
+			}
+
+			memset( &( xTotals.xTasks[ ulTotal ] ), 0, sizeof( xPortSimTaskStats ) );
+			strcpy( xTotals.xTasks[ ulTotal ].pcName, pxResult->xTasks[ ulTask ].pcName );
+			xTotals.ulNumTasks++;
+		}
+
+		pxTotal = &( xTotals.xTasks[ ulTotal ] );
+		pxTotal->ulActivations += pxResult->xTasks[ ulTask ].ulActivations;
+		pxTotal->ullCPUNanoseconds += pxResult->xTasks[ ulTask ].ullCPUNanoseconds;
+		if( pxResult->xTasks[ ulTask ].ullMaxRunNanoseconds > pxTotal->ullMaxRunNanoseconds )
+		{
+			pxTotal->ullMaxRunNanoseconds = pxResult->xTasks[ ulTask ].ullMaxRunNanoseconds;
+		}
+	}
+
+	for( ulIRQ = 0UL; ulIRQ < simhwNUM_IRQS; ulIRQ++ )
+	{
+		xTotals.xIRQs[ ulIRQ ].pcName = pxResult->xIRQs[ ulIRQ ].pcName;
+		xTotals.xIRQs[ ulIRQ ].ulCalls += pxResult->xIRQs[ ulIRQ ].ulCalls;
+		xTotals.xIRQs[ ulIRQ ].ullCPUNanoseconds += pxResult->xIRQs[ ulIRQ ].ullCPUNanoseconds;
+		if( pxResult->xIRQs[ ulIRQ ].ullMaxNanoseconds > xTotals.xIRQs[ ulIRQ ].ullMaxNanoseconds )
+		{
+			xTotals.xIRQs[ ulIRQ ].ullMaxNanoseconds = pxResult->xIRQs[ ulIRQ ].ullMaxNanoseconds;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( unsigned long long ullWallNanoseconds )
+{
+unsigned long ulCompleted = 0UL, ulOutcome, ulTask, ulIRQ;
+const xPortSimTaskStats *pxTask;
+const xSimIRQStats *pxIRQ;
+
+	for( ulOutcome = simarenaWIN; ulOutcome < simarenaNUM_OUTCOMES; ulOutcome++ )
+	{
+		ulCompleted += xTotals.ulOutcomes[ ulOutcome ];
+	}
+
+	printf( "%lu bouts against %s, seed %lu, %lus limit\n", ulBouts, pcOpponentNames[ ulOpponent ], ulSeed, ulTimeLimit );
+	printf( "  win %lu  loss %lu  draw %lu  crashed %lu\n", xTotals.ulOutcomes[ simarenaWIN ], xTotals.ulOutcomes[ simarenaLOSS ],
+			xTotals.ulOutcomes[ simarenaDRAW ], xTotals.ulCrashed );
+
+	if( ulCompleted == 0UL )
+	{
+		return;
+	}
+
+	printf( "  %.1fs simulated in %.2fs (%lu jobs), %.0f times real time\n", ( double ) xTotals.ullSimNanoseconds / 1e9,
+			( double ) ullWallNanoseconds / 1e9, ulJobs, ( double ) xTotals.ullSimNanoseconds / ( double ) ullWallNanoseconds );
+	printf( "  mean bout %.2fs simulated, %.2fms host CPU\n", ( double ) xTotals.ullSimNanoseconds / 1e9 / ( double ) ulCompleted,
+			( double ) xTotals.ullHostNanoseconds / 1e6 / ( double ) ulCompleted );
+	printf( "  %lu edge events, %lu events lost, %lu us worst edge to reverse (simulated time)\n", xTotals.ulEdgeEvents,
+			xTotals.ulEventsLost, xTotals.ulMaxEdgeToReverseMicroseconds );
+
+	#if( sumoMEASURE_TASK_SPAWN_LATENCY == 1 )
+	{
+		/* The idle task never runs in the simulation, so the created tasks
+		are never freed, and once the heap is used up the rest fail. */
+		printf( "  %lu edge events also handled by a created task, %lu creations failed, %lu us worst edge to reverse (simulated time)\n",
+				xTotals.ulTaskSpawns, xTotals.ulTaskSpawnFailures, xTotals.ulMaxTaskSpawnMicroseconds );
+	}
+	#endif
+	printf( "  %lu searches found the opponent, %lu gave up, %.0fms mean %.0fms worst time to acquire (simulated time)\n",
+			xTotals.ulAcquisitions, xTotals.ulSearchTimeouts,
+			( xTotals.ulAcquisitions != 0UL ) ? ( double ) xTotals.ullAcquireMicroseconds / 1e3 / ( double ) xTotals.ulAcquisitions : 0.0,
+			( double ) xTotals.ulMaxAcquireMicroseconds / 1e3 );
+	printf( "  %lu control steps of %ums, %lu overruns, %lu us worst jitter (simulated time)\n", xTotals.ulControlPeriods,
+			( unsigned ) controlloopPERIOD_MS, xTotals.ulControlOverruns, xTotals.ulMaxControlJitterMicroseconds );
+	printf( "  %lu motor control periods of %uus, %lu saturated\n", xTotals.ulMotorPeriods, ( unsigned ) motorcontrolPERIOD_US,
+			xTotals.ulMotorSaturatedPeriods );
+	printf( "  heap %lu of %u bytes least free, %lu allocations failed\n\n", xTotals.ulLeastHeapFree, ( unsigned ) configTOTAL_HEAP_SIZE,
+			xTotals.ulHeapFailures );
+
+	/* The idle task entry holds the time spent simulating the hardware,
+	including the interrupt handlers listed below. */
+	printf( "%-12s %12s %12s %10s %10s\n", "Task", "Activations", "CPU ms", "Mean us", "Max us" );
+	for( ulTask = 0UL; ulTask < xTotals.ulNumTasks; ulTask++ )
+	{
+		pxTask = &( xTotals.xTasks[ ulTask ] );
+		printf( "%-12s %12lu %12.2f %10.3f %10.3f\n", pxTask->pcName, pxTask->ulActivations, ( double ) pxTask->ullCPUNanoseconds / 1e6,
+				( pxTask->ulActivations != 0UL ) ? ( double ) pxTask->ullCPUNanoseconds / 1e3 / ( double ) pxTask->ulActivations : 0.0,
+				( double ) pxTask->ullMaxRunNanoseconds / 1e3 );
+	}
+
+	printf( "\n%-12s %12s %12s %10s %10s\n", "Interrupt", "Calls", "CPU ms", "Mean us", "Max us" );
+	for( ulIRQ = 0UL; ulIRQ < simhwNUM_IRQS; ulIRQ++ )
+	{
+		pxIRQ = &( xTotals.xIRQs[ ulIRQ ] );
+		if( pxIRQ->ulCalls != 0UL )
+		{
+			printf( "%-12s %12lu %12.2f %10.3f %10.3f\n", pxIRQ->pcName, pxIRQ->ulCalls, ( double ) pxIRQ->ullCPUNanoseconds / 1e6,
+					( double ) pxIRQ->ullCPUNanoseconds / 1e3 / ( double ) pxIRQ->ulCalls, ( double ) pxIRQ->ullMaxNanoseconds / 1e3 );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long long prvNanoseconds( clockid_t xClock )
+{
+struct timespec xNow;
+
+	clock_gettime( xClock, &xNow );
+	return ( ( unsigned long long ) xNow.tv_sec * simmainNS_PER_SECOND ) + ( unsigned long long ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteTrace( void )
+{
+#if configUSE_TRACE_RECORDER == 1
+	char cLine[ configCOMMAND_INT_MAX_OUTPUT_SIZE ];
+	unsigned long ulLine = 0UL;
+	unsigned long ulMore;
+	FILE *pxFile;
+
+	pxFile = fopen( pcTraceFile, "w" );
+
+	if( pxFile == NULL )
+	{
+		perror( pcTraceFile );
+		return;
+	}
+
+	do
+	{
+		ulMore = ulTraceRecorderWriteLine( cLine, ulLine );
+		fputs( cLine, pxFile );
+		ulLine++;
+	} while( ulMore != 0UL );
+
+	fclose( pxFile );
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvUsage( void )
+{
+	fprintf( stderr, "Usage: sim [-n bouts] [-s seed] [-t seconds] [-o still|wander|charge|mix] [-j jobs] [-v] [-x file]\n" );
+	exit( EXIT_FAILURE );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,301 @@
+/*
+ * Timing of delayed tasks, on the host.
+ *
+ * The kernel is linked with the simulated port but none of the firmware.
+ * For each of 10, 100 and 1000 tasks, each of which delays for a random
+ * number of ticks of up to tickbenchMAX_DELAY again and again, simulated time
+ * is left to run for tickbenchRUN_TICKS ticks, and it times:
+ *
+ *  + delay: from a task calling vTaskDelay() to the next task, or the
+ *    simulated idle, running.  Mostly the placing of the task in the delay
+ *    wheel or the delayed list, with the scheduler suspended.
+ *  + tick: each call of vTaskIncrementTick(), which runs with interrupts
+ *    masked on the target, so holds off the PWM and ADC interrupts.  It moves
+ *    the tasks that are due to the ready lists, so the time grows with the
+ *    tasks woken at once, about tasks / ( tickbenchMAX_DELAY / 2 ).
+ *
+ * The times are measured with the host monotonic clock, so the worst cases
+ * include the odd host interrupt - compare the 99.9th percentile rather than
+ * the maximum.
+ *
+ * Built as tickbench with the delay wheel, and as tickbench-list with the
+ * sorted delayed list only, for comparison.
+ *
+ * Usage: tickbench [-t ticks] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Simulation includes. */
+#include "Sim-port.h"
+
+#define tickbenchNS_PER_SECOND		( 1000000000ULL )
+
+#define tickbenchMAX_TASKS			( 1000 )
+#define tickbenchMAX_DELAY			( 100UL )
+#define tickbenchBENCH_PRIORITY		( tskIDLE_PRIORITY + 1 )
+#define tickbenchDELAY_PRIORITY		( tskIDLE_PRIORITY + 2 )
+
+/* The times are counted in tickbenchBINS bins of tickbenchBIN_NS.  The last
+bin also counts everything longer. */
+#define tickbenchBINS				( 1000 )
+#define tickbenchBIN_NS				( 10ULL )
+
+/* The times taken. */
+#define tickbenchDELAY				( 0 )
+#define tickbenchTICK				( 1 )
+#define tickbenchNUM_TIMES			( 2 )
+
+/* The times of one kind. */
+typedef struct xTICKBENCH_TIMES
+{
+	unsigned long ulCount;
+	unsigned long long ullTotalNanoseconds;
+	unsigned long long ullMaxNanoseconds;
+	unsigned long ulBins[ tickbenchBINS ];
+} xTickBenchTimes;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The task that creates the delaying tasks and reports the times.
+ */
+static void prvBenchTask( void *pvParameters );
+
+/*
+ * Each of the tasks that delay.
+ */
+static void prvDelayTask( void *pvParameters );
+
+/*
+ * If a task has just called vTaskDelay(), add the time since to the delay
+ * times.
+ */
+static void prvEndDelay( void );
+
+static void prvAddTime( xTickBenchTimes *pxTimes, unsigned long long ullTime );
+static void prvReportTimes( unsigned long ulTasks, const char *pcName, const xTickBenchTimes *pxTimes );
+
+static unsigned long prvRandom( void );
+static unsigned long long prvNanoseconds( void );
+
+/*-----------------------------------------------------------*/
+
+static unsigned long ulRandomState = 1UL;
+static unsigned long ulRunTicks = 10000UL;
+
+static const unsigned long ulTaskCounts[] = { 10UL, 100UL, 1000UL };
+static const char * const pcTimeNames[ tickbenchNUM_TIMES ] = { "delay", "tick" };
+
+static xStaticTask xTaskBuffers[ tickbenchMAX_TASKS ];
+static portSTACK_TYPE xTaskStacks[ tickbenchMAX_TASKS ][ configMINIMAL_STACK_SIZE ];
+static xTickBenchTimes xTimes[ tickbenchNUM_TIMES ];
+
+/* Set by the bench task while the times are taken. */
+static volatile portBASE_TYPE xTiming = pdFALSE;
+
+/* When the last task to call vTaskDelay() called it, or 0 once the next task
+has run. */
+static unsigned long long ullDelayStart = 0ULL;
+
+/*-----------------------------------------------------------*/
+
+int main( int argc, char *argv[] )
+{
+int iOption;
+
+	while( ( iOption = getopt( argc, argv, "t:s:" ) ) != -1 )
+	{
+		switch( iOption )
+		{
+			case 't' :	ulRunTicks = strtoul( optarg, NULL, 0 );
+						break;
+			case 's' :	ulRandomState = strtoul( optarg, NULL, 0 ) | 1UL;
+						break;
+			default :	fprintf( stderr, "Usage: tickbench [-t ticks] [-s seed]\n" );
+						return EXIT_FAILURE;
+		}
+	}
+
+	#if ( configUSE_DELAY_WHEEL == 1 )
+	{
+		printf( "Delay wheel of %u slots, delays of 1 to %lu ticks, %lu ticks\n\n", 1U << configDELAY_WHEEL_BITS, tickbenchMAX_DELAY, ulRunTicks );
+	}
+	#else
+	{
+		printf( "Sorted delayed list, delays of 1 to %lu ticks, %lu ticks\n\n", tickbenchMAX_DELAY, ulRunTicks );
+	}
+	#endif
+
+	printf( "%-6s %-13s %10s %8s %8s %8s\n", "Tasks", "Time", "Count", "Mean ns", "99.9% ns", "Max ns" );
+
+	xTaskCreate( prvBenchTask, ( const signed char * ) "Bench", configMINIMAL_STACK_SIZE, NULL, tickbenchBENCH_PRIORITY, NULL );
+	vTaskStartScheduler();
+
+	/* Only reached if the scheduler could not start. */
+	return EXIT_FAILURE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchTask( void *pvParameters )
+{
+unsigned long ulCount, ulTask = 0UL, ulTime;
+xTaskHandle xTask;
+
+	( void ) pvParameters;
+
+	for( ulCount = 0UL; ulCount < ( sizeof( ulTaskCounts ) / sizeof( unsigned long ) ); ulCount++ )
+	{
+		/* Each task delays as soon as it is created, as it has the higher
+		priority. */
+		for( ; ulTask < ulTaskCounts[ ulCount ]; ulTask++ )
+		{
+			xTask = xTaskCreateStatic( prvDelayTask, ( const signed char * ) "Delay", configMINIMAL_STACK_SIZE, NULL, tickbenchDELAY_PRIORITY, xTaskStacks[ ulTask ], &( xTaskBuffers[ ulTask ] ) );
+			configASSERT( xTask );
+		}
+
+		/* Let the delays get mixed up before timing them. */
+		vTaskDelay( ( portTickType ) tickbenchMAX_DELAY );
+
+		memset( xTimes, 0x00, sizeof( xTimes ) );
+		xTiming = pdTRUE;
+		vTaskDelay( ( portTickType ) ulRunTicks );
+		xTiming = pdFALSE;
+
+		for( ulTime = 0UL; ulTime < tickbenchNUM_TIMES; ulTime++ )
+		{
+			prvReportTimes( ulTaskCounts[ ulCount ], pcTimeNames[ ulTime ], &( xTimes[ ulTime ] ) );
+		}
+
+		printf( "\n" );
+	}
+
+	vTaskEndScheduler();
+}
+/*-----------------------------------------------------------*/
+
+static void prvDelayTask( void *pvParameters )
+{
+portTickType xTicks;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		xTicks = 1U + ( portTickType ) ( prvRandom() % tickbenchMAX_DELAY );
+
+		ullDelayStart = prvNanoseconds();
+		vTaskDelay( xTicks );
+		prvEndDelay();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvEndDelay( void )
+{
+unsigned long long ullTime;
+
+	if( ullDelayStart != 0ULL )
+	{
+		ullTime = prvNanoseconds() - ullDelayStart;
+		ullDelayStart = 0ULL;
+
+		if( xTiming != pdFALSE )
+		{
+			prvAddTime( &( xTimes[ tickbenchDELAY ] ), ullTime );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortSimIdle( void )
+{
+unsigned long long ullStart;
+
+	/* The task that delayed last is the one that switched to here. */
+	prvEndDelay();
+
+	/* There is no hardware, so time just moves on to the next tick. */
+	ullStart = prvNanoseconds();
+	vPortSimTick();
+
+	if( xTiming != pdFALSE )
+	{
+		prvAddTime( &( xTimes[ tickbenchTICK ] ), prvNanoseconds() - ullStart );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+	fprintf( stderr, "Out of heap\n" );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationStackOverflowHook( xTaskHandle pxTask, signed char *pcTaskName )
+{
+	( void ) pxTask;
+	fprintf( stderr, "Stack overflow in %s\n", ( char * ) pcTaskName );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+static void prvAddTime( xTickBenchTimes *pxTimes, unsigned long long ullTime )
+{
+	pxTimes->ulCount++;
+	pxTimes->ullTotalNanoseconds += ullTime;
+	if( ullTime > pxTimes->ullMaxNanoseconds )
+	{
+		pxTimes->ullMaxNanoseconds = ullTime;
+	}
+	pxTimes->ulBins[ ( ullTime / tickbenchBIN_NS < tickbenchBINS ) ? ullTime / tickbenchBIN_NS : tickbenchBINS - 1 ]++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportTimes( unsigned long ulTasks, const char *pcName, const xTickBenchTimes *pxTimes )
+{
+unsigned long ulBin, ulCount = 0UL;
+
+	/* The bin the 99.9th percentile falls in. */
+	for( ulBin = 0UL; ulBin < ( tickbenchBINS - 1 ); ulBin++ )
+	{
+		ulCount += pxTimes->ulBins[ ulBin ];
+		if( ulCount >= ( pxTimes->ulCount - ( pxTimes->ulCount / 1000UL ) ) )
+		{
+			break;
+		}
+	}
+
+	printf( "%-6lu %-13s %10lu %8.1f %8llu %8llu\n", ulTasks, pcName, pxTimes->ulCount,
+			( pxTimes->ulCount != 0UL ) ? ( double ) pxTimes->ullTotalNanoseconds / ( double ) pxTimes->ulCount : 0.0,
+			( unsigned long long ) ( ulBin + 1UL ) * tickbenchBIN_NS, pxTimes->ullMaxNanoseconds );
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long prvRandom( void )
+{
+	/* xorshift, kept to 32 bits so the sequence is the same on any host. */
+	ulRandomState ^= ( ulRandomState << 13 ) & 0xffffffffUL;
+	ulRandomState ^= ulRandomState >> 17;
+	ulRandomState ^= ( ulRandomState << 5 ) & 0xffffffffUL;
+	return ulRandomState;
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long long prvNanoseconds( void )
+{
+struct timespec xNow;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	return ( ( unsigned long long ) xNow.tv_sec * tickbenchNS_PER_SECOND ) + ( unsigned long long ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
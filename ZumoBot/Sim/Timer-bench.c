@@ -0,0 +1,378 @@
+/*
+ * Timing of the software timer service, on the host.
+ *
+ * The kernel is linked with the simulated port but none of the firmware, and
+ * a task of priority 1, below the timer service task, drives the timers.  For
+ * each of 10, 100 and 1000 active auto reload timers, with random periods of
+ * up to timerbenchMAX_PERIOD ticks, it times:
+ *
+ *  + reset, stop and start: xTimerReset(), xTimerStop() and xTimerStart() of
+ *    a random active timer from the task.  The timer service task preempts
+ *    the task as soon as the command is queued, so the time includes the
+ *    processing of the command.
+ *  + reset ISR: xTimerResetFromISR(), followed by the switch to the timer
+ *    service task it asks for.
+ *  + reset, stop and start direct: xTimerResetDirectFromISR() and the others,
+ *    which move the timer in the timer wheel without the queue.  Only when
+ *    configUSE_TIMER_WHEEL is 1.
+ *  + expire: simulated time is left to run for timerbenchRUN_TICKS ticks, and
+ *    the host CPU time of the timer service task is divided by the number of
+ *    timers that expired.  Each expiry also reloads the timer.
+ *
+ * Simulated time does not pass while the task runs, so no timer expires
+ * while the calls are timed.  The call times are measured with the host
+ * monotonic clock, so the worst cases include the odd host interrupt -
+ * compare the 99.9th percentile rather than the maximum.
+ *
+ * Built as timerbench with the timers in the timer wheel, and as
+ * timerbench-list with them in the sorted list, for comparison.
+ *
+ * Usage: timerbench [-n calls] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+/* Simulation includes. */
+#include "Sim-port.h"
+
+#define timerbenchNS_PER_SECOND		( 1000000000ULL )
+
+#define timerbenchMAX_TIMERS		( 1000 )
+#define timerbenchMAX_PERIOD		( 1000UL )
+#define timerbenchRUN_TICKS			( 10000UL )
+#define timerbenchTASK_PRIORITY		( tskIDLE_PRIORITY + 1 )
+
+/* The call times are counted in timerbenchBINS bins of timerbenchBIN_NS.  The
+last bin also counts everything longer. */
+#define timerbenchBINS				( 1000 )
+#define timerbenchBIN_NS			( 10ULL )
+
+/* The calls timed. */
+#define timerbenchRESET				( 0 )
+#define timerbenchSTOP				( 1 )
+#define timerbenchSTART				( 2 )
+#define timerbenchRESET_ISR			( 3 )
+#define timerbenchRESET_DIRECT		( 4 )
+#define timerbenchSTOP_DIRECT		( 5 )
+#define timerbenchSTART_DIRECT		( 6 )
+#define timerbenchNUM_CALLS			( 7 )
+
+/* The times of one kind of call. */
+typedef struct xTIMERBENCH_TIMES
+{
+	unsigned long ulCalls;
+	unsigned long long ullTotalNanoseconds;
+	unsigned long long ullMaxNanoseconds;
+	unsigned long ulBins[ timerbenchBINS ];
+} xTimerBenchTimes;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The task that drives the timers.
+ */
+static void prvBenchTask( void *pvParameters );
+
+/*
+ * Time ulCalls calls of one kind on random timers of the first ulTimers,
+ * adding the times to pxTimes.
+ */
+static void prvTimeCalls( unsigned long ulCall, unsigned long ulTimers, unsigned long ulCalls, xTimerBenchTimes *pxTimes );
+
+/*
+ * Let simulated time run, and report the timer service task CPU time for
+ * each timer that expired.
+ */
+static void prvTimeExpiries( unsigned long ulTimers );
+
+/*
+ * The callback of every timer.  Counts the expiries.
+ */
+static void prvTimerCallback( xTimerHandle xTimer );
+
+/*
+ * Return the host CPU time the timer service task has used.
+ */
+static unsigned long long prvTimerTaskNanoseconds( void );
+
+static void prvReportTimes( unsigned long ulTimers, const char *pcName, const xTimerBenchTimes *pxTimes );
+
+static unsigned long prvRandom( void );
+static unsigned long long prvNanoseconds( void );
+
+/*-----------------------------------------------------------*/
+
+static unsigned long ulRandomState = 1UL;
+static unsigned long ulCallsEach = 100000UL;
+
+static const unsigned long ulTimerCounts[] = { 10UL, 100UL, 1000UL };
+static const char * const pcCallNames[ timerbenchNUM_CALLS ] = { "reset", "stop", "start", "reset ISR", "reset direct", "stop direct", "start direct" };
+
+static xStaticTimer xTimerBuffers[ timerbenchMAX_TIMERS ];
+static xTimerHandle xTimers[ timerbenchMAX_TIMERS ];
+static xTimerBenchTimes xTimes[ timerbenchNUM_CALLS ];
+
+static volatile unsigned long ulExpiries = 0UL;
+
+/*-----------------------------------------------------------*/
+
+int main( int argc, char *argv[] )
+{
+int iOption;
+
+	while( ( iOption = getopt( argc, argv, "n:s:" ) ) != -1 )
+	{
+		switch( iOption )
+		{
+			case 'n' :	ulCallsEach = strtoul( optarg, NULL, 0 );
+						break;
+			case 's' :	ulRandomState = strtoul( optarg, NULL, 0 ) | 1UL;
+						break;
+			default :	fprintf( stderr, "Usage: timerbench [-n calls] [-s seed]\n" );
+						return EXIT_FAILURE;
+		}
+	}
+
+	#if ( configUSE_TIMER_WHEEL == 1 )
+	{
+		printf( "Timer wheel of %u levels of %u slots, %lu calls of each kind\n\n", ( unsigned ) configTIMER_WHEEL_LEVELS, 1U << configTIMER_WHEEL_BITS, ulCallsEach );
+	}
+	#else
+	{
+		printf( "Sorted timer list, %lu calls of each kind\n\n", ulCallsEach );
+	}
+	#endif
+
+	printf( "%-6s %-13s %10s %8s %8s %8s\n", "Timers", "Call", "Calls", "Mean ns", "99.9% ns", "Max ns" );
+
+	xTaskCreate( prvBenchTask, ( const signed char * ) "Bench", configMINIMAL_STACK_SIZE, NULL, timerbenchTASK_PRIORITY, NULL );
+	vTaskStartScheduler();
+
+	/* Only reached if the scheduler could not start. */
+	return EXIT_FAILURE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchTask( void *pvParameters )
+{
+unsigned long ulCount, ulTimer, ulTimers, ulCall;
+
+	( void ) pvParameters;
+
+	for( ulTimer = 0UL; ulTimer < timerbenchMAX_TIMERS; ulTimer++ )
+	{
+		xTimers[ ulTimer ] = xTimerCreateStatic( ( const signed char * ) "Bench", 1U + ( portTickType ) ( prvRandom() % timerbenchMAX_PERIOD ), pdTRUE, NULL, prvTimerCallback, &( xTimerBuffers[ ulTimer ] ) );
+		configASSERT( xTimers[ ulTimer ] );
+	}
+
+	for( ulCount = 0UL; ulCount < ( sizeof( ulTimerCounts ) / sizeof( unsigned long ) ); ulCount++ )
+	{
+		ulTimers = ulTimerCounts[ ulCount ];
+
+		for( ulTimer = 0UL; ulTimer < ulTimers; ulTimer++ )
+		{
+			xTimerStart( xTimers[ ulTimer ], portMAX_DELAY );
+		}
+
+		for( ulCall = 0UL; ulCall < timerbenchNUM_CALLS; ulCall++ )
+		{
+			#if ( configUSE_TIMER_WHEEL == 0 )
+			{
+				if( ulCall >= timerbenchRESET_DIRECT )
+				{
+					break;
+				}
+			}
+			#endif
+
+			memset( &( xTimes[ ulCall ] ), 0x00, sizeof( xTimerBenchTimes ) );
+			prvTimeCalls( ulCall, ulTimers, ulCallsEach, &( xTimes[ ulCall ] ) );
+			prvReportTimes( ulTimers, pcCallNames[ ulCall ], &( xTimes[ ulCall ] ) );
+		}
+
+		prvTimeExpiries( ulTimers );
+		printf( "\n" );
+
+		for( ulTimer = 0UL; ulTimer < ulTimers; ulTimer++ )
+		{
+			xTimerStop( xTimers[ ulTimer ], portMAX_DELAY );
+		}
+	}
+
+	vTaskEndScheduler();
+}
+/*-----------------------------------------------------------*/
+
+static void prvTimeCalls( unsigned long ulCall, unsigned long ulTimers, unsigned long ulCalls, xTimerBenchTimes *pxTimes )
+{
+unsigned long long ullStart, ullTime;
+unsigned long ulStep;
+xTimerHandle xTimer;
+portBASE_TYPE xHigherPriorityTaskWoken;
+
+	for( ulStep = 0UL; ulStep < ulCalls; ulStep++ )
+	{
+		xTimer = xTimers[ prvRandom() % ulTimers ];
+		xHigherPriorityTaskWoken = pdFALSE;
+
+		ullStart = prvNanoseconds();
+
+		switch( ulCall )
+		{
+			case timerbenchRESET :		xTimerReset( xTimer, portMAX_DELAY );
+										break;
+			case timerbenchSTOP :		xTimerStop( xTimer, portMAX_DELAY );
+										break;
+			case timerbenchSTART :		xTimerStart( xTimer, portMAX_DELAY );
+										break;
+			case timerbenchRESET_ISR :	xTimerResetFromISR( xTimer, &xHigherPriorityTaskWoken );
+										break;
+			#if ( configUSE_TIMER_WHEEL == 1 )
+				case timerbenchRESET_DIRECT :	xTimerResetDirectFromISR( xTimer, &xHigherPriorityTaskWoken );
+												break;
+				case timerbenchSTOP_DIRECT :	xTimerStopDirectFromISR( xTimer, &xHigherPriorityTaskWoken );
+												break;
+				case timerbenchSTART_DIRECT :	xTimerStartDirectFromISR( xTimer, &xHigherPriorityTaskWoken );
+												break;
+			#endif
+			default :					break;
+		}
+
+		if( xHigherPriorityTaskWoken != pdFALSE )
+		{
+			taskYIELD();
+		}
+
+		ullTime = prvNanoseconds() - ullStart;
+
+		/* A stopped timer is started again, and a started one stopped again,
+		untimed, so the number of active timers stays the same. */
+		if( ( ulCall == timerbenchSTOP ) || ( ulCall == timerbenchSTOP_DIRECT ) )
+		{
+			xTimerStart( xTimer, portMAX_DELAY );
+		}
+
+		pxTimes->ulCalls++;
+		pxTimes->ullTotalNanoseconds += ullTime;
+		if( ullTime > pxTimes->ullMaxNanoseconds )
+		{
+			pxTimes->ullMaxNanoseconds = ullTime;
+		}
+		pxTimes->ulBins[ ( ullTime / timerbenchBIN_NS < timerbenchBINS ) ? ullTime / timerbenchBIN_NS : timerbenchBINS - 1 ]++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvTimeExpiries( unsigned long ulTimers )
+{
+unsigned long long ullStart, ullTime;
+unsigned long ulStartExpiries, ulExpired;
+
+	ullStart = prvTimerTaskNanoseconds();
+	ulStartExpiries = ulExpiries;
+
+	vTaskDelay( ( portTickType ) timerbenchRUN_TICKS );
+
+	ullTime = prvTimerTaskNanoseconds() - ullStart;
+	ulExpired = ulExpiries - ulStartExpiries;
+
+	printf( "%-6lu %-13s %10lu %8.1f %8s %8s\n", ulTimers, "expire", ulExpired, ( ulExpired != 0UL ) ? ( double ) ullTime / ( double ) ulExpired : 0.0, "-", "-" );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTimerCallback( xTimerHandle xTimer )
+{
+	( void ) xTimer;
+	ulExpiries++;
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long long prvTimerTaskNanoseconds( void )
+{
+xPortSimTaskStats xStats[ portSIM_MAX_TASKS ];
+unsigned long ulTask, ulTasks;
+unsigned long long ullReturn = 0ULL;
+
+	ulTasks = ulPortSimGetTaskStats( xStats, portSIM_MAX_TASKS );
+
+	for( ulTask = 0UL; ulTask < ulTasks; ulTask++ )
+	{
+		if( strcmp( xStats[ ulTask ].pcName, "Tmr Svc" ) == 0 )
+		{
+			ullReturn = xStats[ ulTask ].ullCPUNanoseconds;
+		}
+	}
+
+	return ullReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortSimIdle( void )
+{
+	/* There is no hardware, so time just moves on to the next tick. */
+	vPortSimTick();
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+	fprintf( stderr, "Out of heap\n" );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationStackOverflowHook( xTaskHandle pxTask, signed char *pcTaskName )
+{
+	( void ) pxTask;
+	fprintf( stderr, "Stack overflow in %s\n", ( char * ) pcTaskName );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportTimes( unsigned long ulTimers, const char *pcName, const xTimerBenchTimes *pxTimes )
+{
+unsigned long ulBin, ulCount = 0UL;
+
+	/* The bin the 99.9th percentile falls in. */
+	for( ulBin = 0UL; ulBin < ( timerbenchBINS - 1 ); ulBin++ )
+	{
+		ulCount += pxTimes->ulBins[ ulBin ];
+		if( ulCount >= ( pxTimes->ulCalls - ( pxTimes->ulCalls / 1000UL ) ) )
+		{
+			break;
+		}
+	}
+
+	printf( "%-6lu %-13s %10lu %8.1f %8llu %8llu\n", ulTimers, pcName, pxTimes->ulCalls,
+			( pxTimes->ulCalls != 0UL ) ? ( double ) pxTimes->ullTotalNanoseconds / ( double ) pxTimes->ulCalls : 0.0,
+			( unsigned long long ) ( ulBin + 1UL ) * timerbenchBIN_NS, pxTimes->ullMaxNanoseconds );
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long prvRandom( void )
+{
+	/* xorshift, kept to 32 bits so the sequence is the same on any host. */
+	ulRandomState ^= ( ulRandomState << 13 ) & 0xffffffffUL;
+	ulRandomState ^= ulRandomState >> 17;
+	ulRandomState ^= ( ulRandomState << 5 ) & 0xffffffffUL;
+	return ulRandomState;
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long long prvNanoseconds( void )
+{
+struct timespec xNow;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	return ( ( unsigned long long ) xNow.tv_sec * timerbenchNS_PER_SECOND ) + ( unsigned long long ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,507 @@
+/*
+ * Converts the output of the trace recorder's "trace" command (see
+ * Trace-recorder.h) into a Chrome trace, for chrome://tracing or
+ * ui.perfetto.dev.
+ *
+ * The input is a capture of the UART command console, or the file written by
+ * sim -x.  Anything other than the recorder's lines is skipped, and if the
+ * capture holds more than one trace, the last one is converted.  The trace
+ * is written to standard output as JSON:
+ *
+ *  + one track per task, named with its priority and sorted with the highest
+ *    priority at the top, holding a slice from each time the task is
+ *    switched in until the next task is.
+ *  + an Interrupts track, above the tasks, holding the events that
+ *    interrupts recorded - the FromISR() calls.
+ *  + an instant on the track of the running task for each queue, semaphore
+ *    and notification event, block, delay, suspend, resume and priority
+ *    change, named with the queue or task it is about.
+ *
+ * The cycle counter is 32 bits, so wraps every 43 seconds at 100MHz - the
+ * records are in order, so each is taken to follow the one before by less
+ * than a wrap.
+ *
+ * Usage: tracejson [file] > trace.json
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define tracejsonMAX_LINE			( 4096 )
+#define tracejsonMAX_TASKS			( 256 )
+#define tracejsonMAX_QUEUES			( 256 )
+
+/* The Interrupts track. */
+#define tracejsonINTERRUPTS_TID		( 0UL )
+
+/* The events, as numbered in Trace-recorder.h. */
+#define tracejsonSWITCHED_IN				( 0UL )
+#define tracejsonTASK_CREATE				( 1UL )
+#define tracejsonTASK_DELAY					( 3UL )
+#define tracejsonTASK_RESUME_FROM_ISR		( 6UL )
+#define tracejsonPRIORITY_SET				( 7UL )
+#define tracejsonPRIORITY_DISINHERIT		( 9UL )
+#define tracejsonQUEUE_CREATE				( 10UL )
+#define tracejsonQUEUE_SEND_FROM_ISR		( 18UL )
+#define tracejsonQUEUE_RECEIVE_FROM_ISR		( 20UL )
+#define tracejsonNOTIFY_FROM_ISR			( 22UL )
+#define tracejsonNUM_EVENTS					( 25UL )
+
+/* What the object of an event is. */
+#define tracejsonOBJECT_NONE		( 0 )
+#define tracejsonOBJECT_TASK		( 1 )	/* The record's task is not the running task. */
+#define tracejsonOBJECT_QUEUE		( 2 )
+
+typedef struct xTRACE_JSON_RECORD
+{
+	unsigned long long ullCycles;
+	unsigned long ulEvent;
+	unsigned long ulTask;
+	unsigned long ulObject;
+} xTraceJsonRecord;
+
+typedef struct xTRACE_JSON_TASK
+{
+	int iKnown;
+	unsigned long ulPriority;
+	char cName[ 64 ];
+} xTraceJsonTask;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Parse one line of the input.
+ */
+static void prvParseLine( const char *pcLine );
+
+/*
+ * Add the records on a "rec" line.
+ */
+static void prvParseRecords( const char *pcRecords );
+
+/*
+ * Write the trace.
+ */
+static void prvWriteTrace( void );
+
+/*
+ * Write an event, separated from the last.  ullDuration is only used for
+ * "X" slices.
+ */
+static void prvWriteEvent( const char *pcPhase, unsigned long long ullCycles, unsigned long long ullDuration, unsigned long ulTid, const char *pcName );
+
+/*
+ * Write the name of a task or queue into pcBuffer.
+ */
+static void prvTaskName( char *pcBuffer, unsigned long ulTask );
+static void prvQueueName( char *pcBuffer, unsigned long ulQueue );
+
+/*
+ * Write a string as JSON, quoted and escaped.
+ */
+static void prvWriteString( const char *pcString );
+
+static double prvMicroseconds( unsigned long long ullCycles );
+
+/*-----------------------------------------------------------*/
+
+static const char * const pcEventNames[ tracejsonNUM_EVENTS ] =
+{
+	"Switched in", "Create", "Delete", "Delay", "Suspend", "Resume", "Resume from ISR",
+	"Priority set", "Priority inherit", "Priority disinherit", "Create", "Send", "Send failed",
+	"Receive", "Receive failed", "Peek", "Block to send", "Block to receive", "Send from ISR",
+	"Send from ISR failed", "Receive from ISR", "Notify", "Notify from ISR", "Block on notify",
+	"Notified"
+};
+
+static const int iEventObjects[ tracejsonNUM_EVENTS ] =
+{
+	tracejsonOBJECT_NONE, tracejsonOBJECT_TASK, tracejsonOBJECT_TASK, tracejsonOBJECT_NONE,
+	tracejsonOBJECT_TASK, tracejsonOBJECT_TASK, tracejsonOBJECT_TASK, tracejsonOBJECT_TASK,
+	tracejsonOBJECT_TASK, tracejsonOBJECT_TASK, tracejsonOBJECT_QUEUE, tracejsonOBJECT_QUEUE,
+	tracejsonOBJECT_QUEUE, tracejsonOBJECT_QUEUE, tracejsonOBJECT_QUEUE, tracejsonOBJECT_QUEUE,
+	tracejsonOBJECT_QUEUE, tracejsonOBJECT_QUEUE, tracejsonOBJECT_QUEUE, tracejsonOBJECT_QUEUE,
+	tracejsonOBJECT_QUEUE, tracejsonOBJECT_TASK, tracejsonOBJECT_TASK, tracejsonOBJECT_NONE,
+	tracejsonOBJECT_NONE
+};
+
+/* As numbered by queue.h. */
+static const char * const pcQueueTypes[] = { "Queue", "Mutex", "Counting semaphore", "Binary semaphore", "Recursive mutex", "Queue set" };
+
+static unsigned long ulCyclesPerSecond = 0UL;
+static unsigned long ulRecordsMade = 0UL;
+
+static xTraceJsonTask xTasks[ tracejsonMAX_TASKS ];
+static int iQueueTypes[ tracejsonMAX_QUEUES ];
+
+static xTraceJsonRecord *pxRecords = NULL;
+static unsigned long ulNumRecords = 0UL;
+static unsigned long ulMaxRecords = 0UL;
+
+/* Set once the first event is written, so the next is preceded by a
+comma. */
+static int iWritten = 0;
+
+/*-----------------------------------------------------------*/
+
+int main( int argc, char *argv[] )
+{
+char cLine[ tracejsonMAX_LINE ];
+FILE *pxFile = stdin;
+int iReturn = EXIT_SUCCESS;
+
+	if( argc > 2 )
+	{
+		fprintf( stderr, "Usage: tracejson [file] > trace.json\n" );
+		return EXIT_FAILURE;
+	}
+
+	if( argc == 2 )
+	{
+		pxFile = fopen( argv[ 1 ], "r" );
+
+		if( pxFile == NULL )
+		{
+			perror( argv[ 1 ] );
+			return EXIT_FAILURE;
+		}
+	}
+
+	while( fgets( cLine, sizeof( cLine ), pxFile ) != NULL )
+	{
+		prvParseLine( cLine );
+	}
+
+	if( ulCyclesPerSecond == 0UL )
+	{
+		fprintf( stderr, "tracejson: no trace found\n" );
+		iReturn = EXIT_FAILURE;
+	}
+	else
+	{
+		prvWriteTrace();
+
+		fprintf( stderr, "tracejson: %lu records", ulNumRecords );
+		if( ulRecordsMade > ulNumRecords )
+		{
+			fprintf( stderr, ", the last of %lu made", ulRecordsMade );
+		}
+		fprintf( stderr, "\n" );
+	}
+
+	if( pxFile != stdin )
+	{
+		fclose( pxFile );
+	}
+
+	return iReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvParseLine( const char *pcLine )
+{
+unsigned long ulHz, ulMade, ulKept, ulNumber, ulValue;
+char cName[ 64 ];
+
+	/* The console may echo other text before a line. */
+	while( ( *pcLine == ' ' ) || ( *pcLine == '>' ) || ( *pcLine == '\t' ) )
+	{
+		pcLine++;
+	}
+
+	if( sscanf( pcLine, "trace %lu %lu %lu", &ulHz, &ulMade, &ulKept ) == 3 )
+	{
+		/* A new trace replaces any before it. */
+		ulCyclesPerSecond = ulHz;
+		ulRecordsMade = ulMade;
+		ulNumRecords = 0UL;
+		memset( xTasks, 0, sizeof( xTasks ) );
+		memset( iQueueTypes, -1, sizeof( iQueueTypes ) );
+	}
+	else if( ulCyclesPerSecond == 0UL )
+	{
+		/* Nothing before the first trace line is used. */
+	}
+	else if( sscanf( pcLine, "task %lu %lu %63[^\r\n]", &ulNumber, &ulValue, cName ) == 3 )
+	{
+		if( ulNumber < tracejsonMAX_TASKS )
+		{
+			xTasks[ ulNumber ].iKnown = 1;
+			xTasks[ ulNumber ].ulPriority = ulValue;
+			strcpy( xTasks[ ulNumber ].cName, cName );
+		}
+	}
+	else if( sscanf( pcLine, "queue %lu %lu", &ulNumber, &ulValue ) == 2 )
+	{
+		if( ( ulNumber < tracejsonMAX_QUEUES ) && ( ulValue < ( sizeof( pcQueueTypes ) / sizeof( char * ) ) ) )
+		{
+			iQueueTypes[ ulNumber ] = ( int ) ulValue;
+		}
+	}
+	else if( strncmp( pcLine, "rec ", 4 ) == 0 )
+	{
+		prvParseRecords( pcLine + 4 );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvParseRecords( const char *pcRecords )
+{
+unsigned int uiCycles, uiEvent, uiTask, uiObject;
+unsigned long long ullCycles;
+xTraceJsonRecord *pxRecord;
+
+	while( sscanf( pcRecords, "%8x%2x%2x%4x", &uiCycles, &uiEvent, &uiTask, &uiObject ) == 4 )
+	{
+		if( ulNumRecords == ulMaxRecords )
+		{
+			ulMaxRecords = ( ulMaxRecords == 0UL ) ? 1024UL : ( ulMaxRecords * 2UL );
+			pxRecords = realloc( pxRecords, ulMaxRecords * sizeof( xTraceJsonRecord ) );
+
+			if( pxRecords == NULL )
+			{
+				perror( "tracejson" );
+				exit( EXIT_FAILURE );
+			}
+		}
+
+		/* Unwrap the 32 bit cycle counter. */
+		if( ulNumRecords == 0UL )
+		{
+			ullCycles = uiCycles;
+		}
+		else
+		{
+			ullCycles = pxRecords[ ulNumRecords - 1UL ].ullCycles;
+			ullCycles += ( unsigned int ) ( uiCycles - ( unsigned int ) ullCycles );
+		}
+
+		pxRecord = &( pxRecords[ ulNumRecords ] );
+		pxRecord->ullCycles = ullCycles;
+		pxRecord->ulEvent = uiEvent;
+		pxRecord->ulTask = uiTask;
+		pxRecord->ulObject = uiObject;
+		ulNumRecords++;
+
+		pcRecords += 16;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteTrace( void )
+{
+unsigned long ulRecord, ulTask, ulRunning = 0UL, ulTid;
+unsigned long long ullSwitchedIn = 0ULL, ullFirst = 0ULL;
+const xTraceJsonRecord *pxRecord;
+char cName[ 160 ], cObject[ 96 ];
+int iRunning = 0;
+
+	if( ulNumRecords != 0UL )
+	{
+		ullFirst = pxRecords[ 0 ].ullCycles;
+	}
+
+	printf( "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n" );
+
+	/* Name and order the tracks.  Each task's track id is one more than its
+	number, as the interrupts are track 0. */
+	printf( "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"ZumoBot\"}},\n" );
+	printf( "{\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"name\":\"thread_name\",\"args\":{\"name\":\"Interrupts\"}},\n", tracejsonINTERRUPTS_TID );
+	printf( "{\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":0}}", tracejsonINTERRUPTS_TID );
+	iWritten = 1;
+
+	for( ulTask = 0UL; ulTask < tracejsonMAX_TASKS; ulTask++ )
+	{
+		if( xTasks[ ulTask ].iKnown != 0 )
+		{
+			printf( ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"name\":\"thread_name\",\"args\":{\"name\":", ulTask + 1UL );
+			sprintf( cName, "%s (priority %lu)", xTasks[ ulTask ].cName, xTasks[ ulTask ].ulPriority );
+			prvWriteString( cName );
+			printf( "}},\n{\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":%lu}}",
+					ulTask + 1UL, 1000UL - xTasks[ ulTask ].ulPriority );
+		}
+	}
+
+	for( ulRecord = 0UL; ulRecord < ulNumRecords; ulRecord++ )
+	{
+		pxRecord = &( pxRecords[ ulRecord ] );
+
+		if( pxRecord->ulEvent >= tracejsonNUM_EVENTS )
+		{
+			continue;
+		}
+
+		if( pxRecord->ulEvent == tracejsonSWITCHED_IN )
+		{
+			/* The kernel calls the hook on every switch, even when the same
+			task carries on, so only a change of task ends the slice. */
+			if( ( iRunning == 0 ) || ( pxRecord->ulTask != ulRunning ) )
+			{
+				if( iRunning != 0 )
+				{
+					prvTaskName( cName, ulRunning );
+					prvWriteEvent( "X", ullSwitchedIn - ullFirst, pxRecord->ullCycles - ullSwitchedIn, ulRunning + 1UL, cName );
+				}
+
+				iRunning = 1;
+				ulRunning = pxRecord->ulTask;
+				ullSwitchedIn = pxRecord->ullCycles;
+			}
+		}
+		else
+		{
+			switch( iEventObjects[ pxRecord->ulEvent ] )
+			{
+				case tracejsonOBJECT_TASK :
+					prvTaskName( cObject, pxRecord->ulTask );
+					if( ( pxRecord->ulEvent >= tracejsonPRIORITY_SET ) && ( pxRecord->ulEvent <= tracejsonPRIORITY_DISINHERIT ) )
+					{
+						sprintf( cName, "%s %s to %lu", pcEventNames[ pxRecord->ulEvent ], cObject, pxRecord->ulObject );
+					}
+					else
+					{
+						sprintf( cName, "%s %s", pcEventNames[ pxRecord->ulEvent ], cObject );
+					}
+					break;
+
+				case tracejsonOBJECT_QUEUE :
+					if( pxRecord->ulEvent == tracejsonQUEUE_CREATE )
+					{
+						/* The type is in the top byte, for when the queue
+						is not in the list. */
+						if( ( pxRecord->ulObject >> 8 ) < ( sizeof( pcQueueTypes ) / sizeof( char * ) ) )
+						{
+							sprintf( cName, "Create %s %lu", pcQueueTypes[ pxRecord->ulObject >> 8 ], pxRecord->ulObject & 0xffUL );
+						}
+						else
+						{
+							sprintf( cName, "Create queue %lu", pxRecord->ulObject & 0xffUL );
+						}
+					}
+					else
+					{
+						prvQueueName( cObject, pxRecord->ulObject );
+						sprintf( cName, "%s %s", pcEventNames[ pxRecord->ulEvent ], cObject );
+					}
+					break;
+
+				default :
+					strcpy( cName, pcEventNames[ pxRecord->ulEvent ] );
+					break;
+			}
+
+			/* Events from interrupts carry the task that was interrupted, or
+			the task they are about. */
+			if( ( pxRecord->ulEvent == tracejsonTASK_RESUME_FROM_ISR ) || ( pxRecord->ulEvent == tracejsonNOTIFY_FROM_ISR ) ||
+				( ( pxRecord->ulEvent >= tracejsonQUEUE_SEND_FROM_ISR ) && ( pxRecord->ulEvent <= tracejsonQUEUE_RECEIVE_FROM_ISR ) ) )
+			{
+				ulTid = tracejsonINTERRUPTS_TID;
+			}
+			else if( iEventObjects[ pxRecord->ulEvent ] == tracejsonOBJECT_TASK )
+			{
+				/* Created or changed by the running task, if known. */
+				ulTid = ( iRunning != 0 ) ? ( ulRunning + 1UL ) : tracejsonINTERRUPTS_TID;
+			}
+			else
+			{
+				ulTid = pxRecord->ulTask + 1UL;
+			}
+
+			prvWriteEvent( "i", pxRecord->ullCycles - ullFirst, 0ULL, ulTid, cName );
+		}
+	}
+
+	/* The task running at the end of the trace. */
+	if( iRunning != 0 )
+	{
+		prvTaskName( cName, ulRunning );
+		prvWriteEvent( "X", ullSwitchedIn - ullFirst, pxRecords[ ulNumRecords - 1UL ].ullCycles - ullSwitchedIn, ulRunning + 1UL, cName );
+	}
+
+	printf( "\n]}\n" );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteEvent( const char *pcPhase, unsigned long long ullCycles, unsigned long long ullDuration, unsigned long ulTid, const char *pcName )
+{
+	if( iWritten != 0 )
+	{
+		printf( ",\n" );
+	}
+
+	printf( "{\"ph\":\"%s\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,", pcPhase, ulTid, prvMicroseconds( ullCycles ) );
+
+	if( strcmp( pcPhase, "X" ) == 0 )
+	{
+		printf( "\"dur\":%.3f,", prvMicroseconds( ullDuration ) );
+	}
+	else
+	{
+		printf( "\"s\":\"t\"," );
+	}
+
+	printf( "\"name\":" );
+	prvWriteString( pcName );
+	printf( "}" );
+
+	iWritten = 1;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTaskName( char *pcBuffer, unsigned long ulTask )
+{
+	if( ( ulTask < tracejsonMAX_TASKS ) && ( xTasks[ ulTask ].iKnown != 0 ) )
+	{
+		strcpy( pcBuffer, xTasks[ ulTask ].cName );
+	}
+	else
+	{
+		sprintf( pcBuffer, "task %lu", ulTask );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvQueueName( char *pcBuffer, unsigned long ulQueue )
+{
+	if( ( ulQueue < tracejsonMAX_QUEUES ) && ( iQueueTypes[ ulQueue ] >= 0 ) )
+	{
+		sprintf( pcBuffer, "%s %lu", pcQueueTypes[ iQueueTypes[ ulQueue ] ], ulQueue );
+	}
+	else
+	{
+		sprintf( pcBuffer, "queue %lu", ulQueue );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteString( const char *pcString )
+{
+	putchar( '"' );
+
+	for( ; *pcString != '\0'; pcString++ )
+	{
+		if( ( *pcString == '"' ) || ( *pcString == '\\' ) )
+		{
+			putchar( '\\' );
+			putchar( *pcString );
+		}
+		else if( ( unsigned char ) *pcString < 0x20U )
+		{
+			printf( "\\u%04x", ( unsigned int ) ( unsigned char ) *pcString );
+		}
+		else
+		{
+			putchar( *pcString );
+		}
+	}
+
+	putchar( '"' );
+}
+/*-----------------------------------------------------------*/
+
+static double prvMicroseconds( unsigned long long ullCycles )
+{
+	return ( double ) ullCycles * 1e6 / ( double ) ulCyclesPerSecond;
+}
+/*-----------------------------------------------------------*/
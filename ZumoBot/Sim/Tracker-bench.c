@@ -0,0 +1,193 @@
+/*
+ * Detection of a slowly approaching opponent by the opponent tracker, on the
+ * host.
+ *
+ * Opponent-tracker.c is linked on its own, with the ADC sampler replaced by
+ * the model of the Sharp sensors in Sim-arena.c.  The Zumo stands still with
+ * nothing in the beams for trackerbenchSETTLE_MS, then the opponent drives
+ * straight at the front sensor from trackerbenchSTART_MM, at each of a range
+ * of speeds down to a crawl.  For each speed the bench reports how many runs,
+ * each with its own sensor noise, saw the opponent before it reached
+ * trackerbenchEND_MM, and how far away it really was when it was first seen.
+ *
+ * The reading of the sensor model rises from its baseline at about 600mm, so
+ * the approach starts there, and crosses the tracker threshold at about
+ * 430mm.  A baseline that follows the rise over those 170mm lets the opponent
+ * get closer before it is seen, or keeps it from being seen at all.
+ *
+ * Usage: trackerbench [-n runs] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Zumo includes. */
+#include "ADC-DMA-sampler.h"
+#include "Control-loop.h"
+#include "Opponent-tracker.h"
+
+/* Simulation includes. */
+#include "Sim-arena.h"
+
+#define trackerbenchSETTLE_MS		( 5000UL )
+#define trackerbenchSTART_MM		( 600.0 )
+#define trackerbenchEND_MM			( 100.0 )
+
+#define trackerbenchFRONT			( 0 )
+
+/* The speeds of the opponent, in mm/s. */
+static const unsigned long ulSpeeds[] = { 500UL, 200UL, 100UL, 50UL, 20UL, 10UL, 5UL, 2UL, 1UL };
+
+#define trackerbenchNUM_SPEEDS		( sizeof( ulSpeeds ) / sizeof( ulSpeeds[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Run one approach at ulSpeed mm/s, with the noise seeded by ulSeed.  Returns
+ * the distance, in mm, at which the opponent was first seen, or zero if it
+ * never was.
+ */
+static double prvApproach( unsigned long ulSpeed, unsigned long ulSeed );
+
+/*
+ * Set the reading of the front sensor to the mean of one block of samples
+ * with the opponent dMillimetres away.
+ */
+static void prvSample( double dMillimetres );
+
+/*-----------------------------------------------------------*/
+
+/* The readings returned by the sampler.  Only the front sensor ever sees the
+opponent. */
+static uint16_t usReadings[ adcsamplerNUM_CHANNELS ];
+
+/*-----------------------------------------------------------*/
+
+int main( int argc, char *argv[] )
+{
+unsigned long ulRuns = 20UL, ulSeed = 1UL, ulSpeed, ulRun, ulSeen;
+double dDistance, dTotal, dNearest;
+int iOption;
+
+	while( ( iOption = getopt( argc, argv, "n:s:" ) ) != -1 )
+	{
+		switch( iOption )
+		{
+			case 'n' :	ulRuns = strtoul( optarg, NULL, 0 );
+						break;
+			case 's' :	ulSeed = strtoul( optarg, NULL, 0 );
+						break;
+			default :	fprintf( stderr, "Usage: trackerbench [-n runs] [-s seed]\n" );
+						return EXIT_FAILURE;
+		}
+	}
+
+	printf( "Opponent approaching the front sensor from %.0fmm, %lu runs at each speed\n\n", trackerbenchSTART_MM, ulRuns );
+	printf( "%10s %8s %12s %12s\n", "Speed mm/s", "Seen", "Mean mm", "Nearest mm" );
+
+	for( ulSpeed = 0UL; ulSpeed < trackerbenchNUM_SPEEDS; ulSpeed++ )
+	{
+		ulSeen = 0UL;
+		dTotal = 0.0;
+		dNearest = trackerbenchSTART_MM;
+
+		for( ulRun = 0UL; ulRun < ulRuns; ulRun++ )
+		{
+			dDistance = prvApproach( ulSpeeds[ ulSpeed ], ulSeed + ulRun );
+
+			if( dDistance > 0.0 )
+			{
+				ulSeen++;
+				dTotal += dDistance;
+
+				if( dDistance < dNearest )
+				{
+					dNearest = dDistance;
+				}
+			}
+		}
+
+		if( ulSeen == 0UL )
+		{
+			printf( "%10lu %4lu/%-3lu %12s %12s\n", ulSpeeds[ ulSpeed ], ulSeen, ulRuns, "-", "-" );
+		}
+		else
+		{
+			printf( "%10lu %4lu/%-3lu %12.0f %12.0f\n", ulSpeeds[ ulSpeed ], ulSeen, ulRuns, dTotal / ( double ) ulSeen, dNearest );
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usADCSamplerGetAverage( uint8_t ucChannel )
+{
+	return usReadings[ ucChannel ];
+}
+/*-----------------------------------------------------------*/
+
+static double prvApproach( unsigned long ulSpeed, unsigned long ulSeed )
+{
+xSimArenaConfig xConfig;
+unsigned long ulMS;
+double dMillimetres;
+uint8_t ucChannel;
+
+	/* Only the noise of the arena is used. */
+	xConfig.ulSeed = ulSeed;
+	xConfig.ulOpponent = simarenaOPPONENT_STILL;
+	xConfig.ullTimeLimit = 0ULL;
+	vSimArenaInit( &xConfig );
+
+	for( ucChannel = 0U; ucChannel < adcsamplerNUM_CHANNELS; ucChannel++ )
+	{
+		usReadings[ ucChannel ] = ( uint16_t ) ulSimArenaSampleDistance( dSimArenaDistanceVolts( trackerbenchSTART_MM / 10.0 ) );
+	}
+
+	/* Long enough for the baselines to settle and the estimate of the last
+	run to be dropped. */
+	for( ulMS = 0UL; ulMS < trackerbenchSETTLE_MS; ulMS += controlloopPERIOD_MS )
+	{
+		prvSample( trackerbenchSTART_MM );
+		( void ) xOpponentTrackerUpdate( 0L, controlloopPERIOD_MS );
+	}
+
+	for( ulMS = 0UL; ; ulMS += controlloopPERIOD_MS )
+	{
+		dMillimetres = trackerbenchSTART_MM - ( ( ( double ) ulSpeed * ( double ) ulMS ) / 1000.0 );
+
+		if( dMillimetres < trackerbenchEND_MM )
+		{
+			return 0.0;
+		}
+
+		prvSample( dMillimetres );
+
+		if( xOpponentTrackerUpdate( 0L, controlloopPERIOD_MS ) != pdFALSE )
+		{
+			return dMillimetres;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSample( double dMillimetres )
+{
+unsigned long ulSample, ulTotal = 0UL;
+double dVolts;
+
+	dVolts = dSimArenaDistanceVolts( dMillimetres / 10.0 );
+
+	for( ulSample = 0UL; ulSample < adcsamplerSAMPLES_PER_BLOCK; ulSample++ )
+	{
+		ulTotal += ulSimArenaSampleDistance( dVolts );
+	}
+
+	usReadings[ trackerbenchFRONT ] = ( uint16_t ) ( ulTotal / adcsamplerSAMPLES_PER_BLOCK );
+}
+/*-----------------------------------------------------------*/
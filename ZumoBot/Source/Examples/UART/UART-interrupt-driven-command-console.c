@@ -87,6 +87,10 @@ static void prvUARTCommandConsoleTask( void *pvParameters );
 /* Holds the handle of the task that implements the UART command console. */
 static xTaskHandle xCommandConsoleTask = NULL;
 
+/* The task is created in these rather than on the heap. */
+static xStaticTask xCommandConsoleTaskBuffer;
+static portSTACK_TYPE xCommandConsoleStack[ configUART_COMMAND_CONSOLE_STACK_SIZE ];
+
 static const int8_t * const pcWelcomeMessage = ( int8_t * ) "FreeRTOS command server.\r\nType Help to view a list of registered commands.\r\n\r\n>";
 static const int8_t * const pcNewLine = ( int8_t * ) "\r\n";
 
@@ -94,12 +98,13 @@ static const int8_t * const pcNewLine = ( int8_t * ) "\r\n";
 
 void vUARTCommandConsoleStart( void )
 {
-	xTaskCreate( 	prvUARTCommandConsoleTask,				/* The task that implements the command console. */
-					( const int8_t * const ) "UARTCmd",/* Text name assigned to the task.  This is just to assist debugging.  The kernel does not use this name itself. */
-					configUART_COMMAND_CONSOLE_STACK_SIZE,	/* The size of the stack allocated to the task. */
-					NULL,									/* The parameter is not used, so NULL is passed. */
-					configUART_COMMAND_CONSOLE_TASK_PRIORITY,/* The priority allocated to the task. */
-					&xCommandConsoleTask );					/* Used to store the handle to the created task. */
+	xCommandConsoleTask = xTaskCreateStatic( 	prvUARTCommandConsoleTask,				/* The task that implements the command console. */
+												( const int8_t * const ) "UARTCmd",/* Text name assigned to the task.  This is just to assist debugging.  The kernel does not use this name itself. */
+												configUART_COMMAND_CONSOLE_STACK_SIZE,	/* The size of the stack allocated to the task. */
+												NULL,									/* The parameter is not used, so NULL is passed. */
+												configUART_COMMAND_CONSOLE_TASK_PRIORITY,/* The priority allocated to the task. */
+												xCommandConsoleStack,					/* The stack of the task. */
+												&xCommandConsoleTaskBuffer );			/* Holds the task control block. */
 }
 /*-----------------------------------------------------------*/
 
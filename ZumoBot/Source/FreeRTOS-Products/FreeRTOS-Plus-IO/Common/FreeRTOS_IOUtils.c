@@ -110,11 +110,10 @@ Transfer_Control_t *pxTransferControl = *ppxTransferControl;
 					Circular_Buffer_Rx_State_t *pxCircularBufferState;
 
 					/* In this case, the pvTransferState member points to a
-					circular buffer structure, which in turn contains a semaphore
-					and a buffer, both of which need to be deleted. */
+					circular buffer structure, which in turn contains a stream
+					buffer, both of which need to be deleted. */
 					pxCircularBufferState = ( Circular_Buffer_Rx_State_t * ) ( pxTransferControl->pvTransferState );
-					vSemaphoreDelete( pxCircularBufferState->xNewDataSemaphore );
-					vPortFree( ( void * ) ( pxCircularBufferState->pucBufferStart ) );
+					vStreamBufferDelete( pxCircularBufferState->xStreamBuffer );
 					vPortFree( pxCircularBufferState );
 				}
 				#endif /* ioconfigUSE_CIRCULAR_BUFFER_RX */
@@ -322,12 +322,9 @@ const int8_t cPeripheralNumber = diGET_PERIPHERAL_NUMBER( ( ( Peripheral_Control
 
 			#if ioconfigUSE_I2C_CIRCULAR_BUFFER_RX == 1
 			{
-				/* There is nothing to prevent multiple tasks attempting to
-				read the circular buffer at any one time.  The implementation
-				of the circular buffer uses a semaphore to indicate when new
-				data is available, and the semaphore will ensure that only the
-				highest priority task that is attempting a read will actually
-				receive bytes. */
+				/* The circular buffer is a stream buffer with a single
+				reader, so only one task at a time may read from it.  Tasks
+				that share the port must serialise their reads themselves. */
 
 				if( xDataDirection[ cPeripheralNumber ] == i2cIdle )
 				{
@@ -343,8 +340,6 @@ const int8_t cPeripheralNumber = diGET_PERIPHERAL_NUMBER( ( ( Peripheral_Control
 				ioutilsRECEIVE_CHARS_FROM_CIRCULAR_BUFFER
 					(
 						pxPeripheralControl,
-						I2C_IntCmd( pxI2C, DISABLE ),	/* Disable peripheral. */
-						I2C_IntCmd( pxI2C, ENABLE ), 	/* Enable peripheral. */
 						( ( uint8_t * ) pvBuffer ),		/* Data destination. */
 						xBytes,							/* Bytes to read. */
 						xReturn							/* Number of bytes read. */
@@ -331,12 +331,9 @@ const int8_t cPeripheralNumber = diGET_PERIPHERAL_NUMBER( ( ( Peripheral_Control
 			/* _RB_ This relies on Tx being configured to zero copy mode. */
 			#if ioconfigUSE_SSP_CIRCULAR_BUFFER_RX == 1
 			{
-				/* There is nothing to prevent multiple tasks attempting to
-				read the circular buffer at any one time.  The implementation
-				of the circular buffer uses a semaphore to indicate when new
-				data is available, and the semaphore will ensure that only the
-				highest priority task that is attempting a read will actually
-				receive bytes. */
+				/* The circular buffer is a stream buffer with a single
+				reader, so only one task at a time may read from it.  Tasks
+				that share the port must serialise their reads themselves. */
 
 				/* A write is performed first, to generate the clock required
 				to clock the data in.  NULL is passed as the source buffer as
@@ -362,15 +359,12 @@ const int8_t cPeripheralNumber = diGET_PERIPHERAL_NUMBER( ( ( Peripheral_Control
 					/* Write to solicit received data. */
 					FreeRTOS_SSP_write( pxPeripheralControl, NULL, xBytes );
 
-					/* This macro will continuously wait on the new data mutex,
-					reading bytes from the circular buffer each time it
-					receives it, until the desired number of bytes have been
-					read. */
+					/* This macro will continuously wait on the stream buffer,
+					reading bytes from it each time the interrupt writes some,
+					until the desired number of bytes have been read. */
 					ioutilsRECEIVE_CHARS_FROM_CIRCULAR_BUFFER
 						(
 							pxPeripheralControl,
-							SSP_IntConfig( pxSSP, sspRX_DATA_AVAILABLE_INTERRUPTS, DISABLE ), /* Disable interrupt. */
-							SSP_IntConfig( pxSSP, sspRX_DATA_AVAILABLE_INTERRUPTS, ENABLE ), /* Enable interrupt. */
 							( ( uint8_t * ) pvBuffer ),	/* Data destination. */
 							xBytes,						/* Bytes to read. */
 							xReturn						/* Number of bytes read. */
@@ -645,11 +639,11 @@ Transfer_Control_t *pxTxTransferStruct, *pxRxTransferStruct;
 
 						#if ioconfigUSE_SSP_CIRCULAR_BUFFER_RX == 1
 						{
-							/* This call will empty the FIFO, and give the New
-							Data semaphore so a task blocked on an SSP read
-							will unblock.  Note that this does not mean that
-							more data will not arrive after this interrupt,
-							even if there is no more data to send. */
+							/* This call will empty the FIFO, and notify the
+							task blocked on an SSP read so it will unblock.
+							Note that this does not mean that more data will
+							not arrive after this interrupt, even if there is
+							no more data to send. */
 							ioutilsRX_CHARS_INTO_CIRCULAR_BUFFER_FROM_ISR(
 																		pxRxTransferStruct, 	/* The structure that contains the reference to the circular buffer. */
 																		( ( LPC_SSP1->SR & SSP_SR_RNE ) != 0 ), 		/* While loop condition. */
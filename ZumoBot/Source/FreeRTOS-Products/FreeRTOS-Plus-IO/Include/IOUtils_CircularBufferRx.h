@@ -38,18 +38,23 @@
 #ifndef CIRCULAR_BUFFER_RX_H
 #define CIRCULAR_BUFFER_RX_H
 
+/* The circular buffer is a stream buffer, written by the interrupt and read
+by the task that calls FreeRTOS_read(), so only one task at a time may read
+from a peripheral that uses it. */
+#include "stream_buffer.h"
+
+/* Received characters are gathered into a block of up to this many bytes on
+the stack of the interrupt, and the block written to the stream buffer with one
+copy.  It matches the depth of the UART receive FIFO. */
+#define ioutilsCIRCULAR_BUFFER_RX_BLOCK_BYTES	( 16U )
+
 /* The transfer structure used when a circular buffer is used for
 reception. */
 typedef struct xCIRCULAR_BUFFER_RX_STATE
 {
-	xSemaphoreHandle xNewDataSemaphore;	/* Semaphore used to indicate the presence of new data. */
-	uint8_t *pucBufferStart;			/* The start address of the buffer storage area. */
-	uint16_t usBufferLength;			/* The total length of the circular buffer. */
-	uint16_t usNextWriteIndex;			/* Index into pucBufferStart to which the next received byte will be written. */
-	uint16_t usNextReadIndex;			/* Index into pucBufferStart from which the next byte will be read. */
+	xStreamBufferHandle xStreamBuffer;	/* The buffer storage, and the task waiting for data to arrive in it. */
 	uint16_t usErrorState;				/* Currently just set to pdFALSE or pdTRUE if a buffer overrun has not/has occurred respectively. */
 	portTickType xBlockTime;			/* The amount of time a task should be held in the Blocked state (not using CPU time) to wait for data to become available when it attempts a read. */
-	uint16_t usCharCount;				/* The number of characters currently in the circular buffer.  The difference between the number of characters written to the buffer, and the number read from the buffer. */
 } Circular_Buffer_Rx_State_t;
 
 
@@ -60,42 +65,37 @@ typedef struct xCIRCULAR_BUFFER_RX_STATE
 #define ioutilsRX_CHARS_INTO_CIRCULAR_BUFFER_FROM_ISR( pxTransferControl, xCondition, xReceiveFunction, ulReceived, xHigherPriorityTaskWoken )	\
 {																														\
 Circular_Buffer_Rx_State_t * const pxCircularBufferRxState = ( Circular_Buffer_Rx_State_t * ) ( ( pxTransferControl )->pvTransferState );	\
-uint16_t *pusNextWrite;																									\
+uint8_t ucBlock[ ioutilsCIRCULAR_BUFFER_RX_BLOCK_BYTES ];																\
+size_t xBlockBytes, xWritten;																							\
 																														\
-	pusNextWrite = &( pxCircularBufferRxState->usNextWriteIndex );														\
-																														\
-	while( ( xCondition ) )																								\
+	do																													\
 	{																													\
-		/* If there is space in the circular buffer. */																	\
-		if( pxCircularBufferRxState->usCharCount < pxCircularBufferRxState->usBufferLength )							\
+		xBlockBytes = 0U;																								\
+																														\
+		while( ( xBlockBytes < ioutilsCIRCULAR_BUFFER_RX_BLOCK_BYTES ) && ( xCondition ) )								\
+		{																												\
+			ucBlock[ xBlockBytes ] = ( xReceiveFunction );																\
+			xBlockBytes++;																								\
+		}																												\
+																														\
+		if( xBlockBytes > 0U )																							\
 		{																												\
-			pxCircularBufferRxState->pucBufferStart[ *pusNextWrite ] = ( xReceiveFunction );							\
-			ulReceived++;																								\
-			( pxCircularBufferRxState->usCharCount )++;																	\
+			/* The stream buffer notifies the reading task, if it is waiting.	\
+			No critical section is needed as this is the only writer. */		\
+			xWritten = xStreamBufferSendFromISR( pxCircularBufferRxState->xStreamBuffer, ucBlock, xBlockBytes, &( xHigherPriorityTaskWoken ) );	\
+			ulReceived += xWritten;																						\
 																														\
-			/* Move on to the next index, wrapping if necessary. */														\
-			( *pusNextWrite )++;																						\
-			if( *pusNextWrite == pxCircularBufferRxState->usBufferLength )												\
+			if( xWritten < xBlockBytes )																				\
 			{																											\
-				*pusNextWrite = 0U;																						\
+				/* An overrun has occurred. */																			\
+				pxCircularBufferRxState->usErrorState = pdTRUE;															\
 			}																											\
 		}																												\
-		else																											\
-		{																												\
-			/* An overrun has occurred. */																				\
-			pxCircularBufferRxState->usErrorState = pdTRUE;																\
-		}																												\
-	}																													\
 																														\
-	if( ulReceived > 0UL )																								\
-	{																													\
-		/* Unblock any tasks that might have been waiting for new data to 												\
-		arrive. */																										\
-		xSemaphoreGiveFromISR( pxCircularBufferRxState->xNewDataSemaphore, &( xHigherPriorityTaskWoken ) );				\
-	}																													\
+	} while( xBlockBytes == ioutilsCIRCULAR_BUFFER_RX_BLOCK_BYTES );													\
 }
 
-#define ioutilsRECEIVE_CHARS_FROM_CIRCULAR_BUFFER( pxPeripheralControl, xPeripheralDisable, xPeripheralEnable, pucBuffer, xBytes, xBytesReceived )	\
+#define ioutilsRECEIVE_CHARS_FROM_CIRCULAR_BUFFER( pxPeripheralControl, pucBuffer, xBytes, xBytesReceived )			\
 {																														\
 portTickType xTicksToWait;																								\
 xTimeOutType xTimeOut;																									\
@@ -108,13 +108,10 @@ Circular_Buffer_Rx_State_t *pxCircularBufferState = prvCIRCULAR_BUFFER_STATE( px
 	/* Are there any more bytes to be received? */																		\
 	while( ( xBytesReceived ) < xBytes )																				\
 	{																													\
-		/* Wait for data to be available. */																			\
-		if( xSemaphoreTake( pxCircularBufferState->xNewDataSemaphore, xTicksToWait ) == pdPASS )						\
-		{																												\
-			( xPeripheralDisable ); 																					\
-			( xBytesReceived ) += xIOUtilsReadCharsFromCircularBuffer( pxCircularBufferState, &( ( pucBuffer ) [ ( xBytesReceived ) ] ), xBytes - ( xBytesReceived ) ); \
-			( xPeripheralEnable );																						\
-		}																												\
+		/* Take whatever has arrived, waiting for the interrupt to write	\
+		something if nothing has.  The interrupt is not disabled, as it only	\
+		ever moves the head of the stream buffer and this task the tail. */	\
+		( xBytesReceived ) += xStreamBufferReceive( pxCircularBufferState->xStreamBuffer, &( ( pucBuffer ) [ ( xBytesReceived ) ] ), xBytes - ( xBytesReceived ), xTicksToWait ); \
 																														\
 		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )												\
 		{																												\
@@ -126,7 +123,6 @@ Circular_Buffer_Rx_State_t *pxCircularBufferState = prvCIRCULAR_BUFFER_STATE( px
 
 /* Prototypes of functions that are for internal use only. */
 portBASE_TYPE xIOUtilsConfigureCircularBufferRx( Peripheral_Control_t * const pxPeripheralControl, const portBASE_TYPE xBufferSize );
-portBASE_TYPE xIOUtilsReadCharsFromCircularBuffer( Circular_Buffer_Rx_State_t * const pxCircularBuffer, uint8_t * const pucBuffer, const size_t xBytesToRead );
 void vIOUtilsSetCircularBufferTimeout( Peripheral_Control_t *pxPeripheralControl, portTickType xMaxWaitTime );
 void vIOUtilsClearRxCircularBuffer( Peripheral_Control_t * const pxPeripheralControl );
 
@@ -136,6 +136,10 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define INCLUDE_xTimerGetTimerDaemonTaskHandle 0
 #endif
 
+#ifndef INCLUDE_xTimerPendFunctionCall
+	#define INCLUDE_xTimerPendFunctionCall 0
+#endif
+
 #ifndef INCLUDE_pcTaskGetTaskName
 	#define INCLUDE_pcTaskGetTaskName 0
 #endif
@@ -148,6 +152,10 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define INCLUDE_uxTaskGetStackHighWaterMark 0
 #endif
 
+#ifndef INCLUDE_uxTaskGetStackStats
+	#define INCLUDE_uxTaskGetStackStats 0
+#endif
+
 #ifndef configUSE_RECURSIVE_MUTEXES
 	#define configUSE_RECURSIVE_MUTEXES 0
 #endif
@@ -180,6 +188,71 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define configIDLE_SHOULD_YIELD		1
 #endif
 
+/* Ports that can find the highest priority ready task with a single
+instruction define portRECORD_READY_PRIORITY(), portRESET_READY_PRIORITY() and
+portGET_HIGHEST_PRIORITY(), and can then set this to 1. */
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#endif
+
+#ifndef configUSE_TASK_NOTIFICATIONS
+	#define configUSE_TASK_NOTIFICATIONS 1
+#endif
+
+#ifndef configSUPPORT_STATIC_ALLOCATION
+	#define configSUPPORT_STATIC_ALLOCATION 0
+#endif
+
+#ifndef configUSE_QUEUE_SETS
+	#define configUSE_QUEUE_SETS 0
+#endif
+
+#ifndef configUSE_TICKLESS_IDLE
+	#define configUSE_TICKLESS_IDLE 0
+#endif
+
+/* The idle task only stops the tick if it expects to be idle for at least
+this many ticks, as a shorter sleep saves less than it costs. */
+#ifndef configEXPECTED_IDLE_TIME_BEFORE_SLEEP
+	#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP 2
+#endif
+
+#if configEXPECTED_IDLE_TIME_BEFORE_SLEEP < 2
+	#error configEXPECTED_IDLE_TIME_BEFORE_SLEEP must not be less than 2
+#endif
+
+/* Called by the port just before and just after it sleeps, so the
+application can switch off, and back on, anything not needed while asleep.
+configPRE_SLEEP_PROCESSING() can set its parameter to 0 to stop the sleep. */
+#ifndef configPRE_SLEEP_PROCESSING
+	#define configPRE_SLEEP_PROCESSING( x )
+#endif
+
+#ifndef configPOST_SLEEP_PROCESSING
+	#define configPOST_SLEEP_PROCESSING( x )
+#endif
+
+#ifndef configUSE_DELAY_WHEEL
+	#define configUSE_DELAY_WHEEL 0
+#endif
+
+/* The delay wheel has 2^configDELAY_WHEEL_BITS slots, one for each of the
+ticks that follow.  Tasks that are to wake further ahead wait in the sorted
+delayed list until they are due within one turn of the wheel. */
+#ifndef configDELAY_WHEEL_BITS
+	#define configDELAY_WHEEL_BITS 6
+#endif
+
+#if configDELAY_WHEEL_BITS > 15
+	#error configDELAY_WHEEL_BITS must not be more than 15
+#endif
+
+/* Set to 1 for the port to count the core clock cycles taken by each tick
+interrupt.  Needs a port that supports it. */
+#ifndef configGENERATE_TICK_STATS
+	#define configGENERATE_TICK_STATS 0
+#endif
+
 #if configMAX_TASK_NAME_LEN < 1
 	#error configMAX_TASK_NAME_LEN must be set to a minimum of 1 in FreeRTOSConfig.h
 #endif
@@ -213,6 +286,36 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 
 #endif /* configUSE_TIMERS */
 
+/* The pended functions are run by the timer service task. */
+#if ( INCLUDE_xTimerPendFunctionCall == 1 ) && ( configUSE_TIMERS != 1 )
+	#error INCLUDE_xTimerPendFunctionCall requires configUSE_TIMERS to be set to 1.
+#endif
+
+#ifndef configUSE_TIMER_WHEEL
+	#define configUSE_TIMER_WHEEL 0
+#endif
+
+/* The timer wheel has configTIMER_WHEEL_LEVELS levels of
+2^configTIMER_WHEEL_BITS slots, so reaches
+2^( configTIMER_WHEEL_BITS * configTIMER_WHEEL_LEVELS ) ticks ahead.  Timers
+due further ahead wait in a list that is looked at each time the wheel turns
+all the way round. */
+#ifndef configTIMER_WHEEL_BITS
+	#define configTIMER_WHEEL_BITS 4
+#endif
+
+#ifndef configTIMER_WHEEL_LEVELS
+	#define configTIMER_WHEEL_LEVELS 4
+#endif
+
+#if ( configTIMER_WHEEL_BITS * configTIMER_WHEEL_LEVELS ) > 30
+	#error The timer wheel must not reach more than 2^30 ticks ahead
+#endif
+
+#if ( configUSE_TIMER_WHEEL == 1 ) && ( configUSE_16_BIT_TICKS == 1 ) && ( ( configTIMER_WHEEL_BITS * configTIMER_WHEEL_LEVELS ) > 14 )
+	#error With 16 bit ticks the timer wheel must not reach more than 2^14 ticks ahead
+#endif
+
 #ifndef INCLUDE_xTaskGetSchedulerState
 	#define INCLUDE_xTaskGetSchedulerState 0
 #endif
@@ -451,6 +554,38 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define traceTIMER_COMMAND_RECEIVED( pxTimer, xMessageID, xMessageValue )
 #endif
 
+#ifndef tracePEND_FUNC_CALL
+	#define tracePEND_FUNC_CALL( xFunctionToPend, pvParameter1, ulParameter2, xReturn )
+#endif
+
+#ifndef tracePEND_FUNC_CALL_FROM_ISR
+	#define tracePEND_FUNC_CALL_FROM_ISR( xFunctionToPend, pvParameter1, ulParameter2, xReturn )
+#endif
+
+#ifndef traceTASK_NOTIFY
+	#define traceTASK_NOTIFY()
+#endif
+
+#ifndef traceTASK_NOTIFY_FROM_ISR
+	#define traceTASK_NOTIFY_FROM_ISR()
+#endif
+
+#ifndef traceTASK_NOTIFY_WAIT_BLOCK
+	#define traceTASK_NOTIFY_WAIT_BLOCK()
+#endif
+
+#ifndef traceTASK_NOTIFY_WAIT
+	#define traceTASK_NOTIFY_WAIT()
+#endif
+
+#ifndef traceTASK_NOTIFY_TAKE_BLOCK
+	#define traceTASK_NOTIFY_TAKE_BLOCK()
+#endif
+
+#ifndef traceTASK_NOTIFY_TAKE
+	#define traceTASK_NOTIFY_TAKE()
+#endif
+
 #ifndef configGENERATE_RUN_TIME_STATS
 	#define configGENERATE_RUN_TIME_STATS 0
 #endif
@@ -493,5 +628,131 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define vPortFreeAligned( pvBlockToFree ) vPortFree( pvBlockToFree )
 #endif
 
+/* Stops the compiler moving memory accesses across it, for data shared
+without a critical section. */
+#ifndef portMEMORY_BARRIER
+	#define portMEMORY_BARRIER()
+#endif
+
+/* A port that supports tickless idle defines this to stop the tick and
+sleep for up to xExpectedIdleTime ticks. */
+#ifndef portSUPPRESS_TICKS_AND_SLEEP
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )
+#endif
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+#include "list.h"
+
+/*
+ * The buffers given to the static creation functions.  The task, queue and
+ * timer structures are private to tasks.c, queue.c and timers.c, so the
+ * members below are placeholders that only give each buffer the size and
+ * alignment of the structure it holds.  Each creation function checks the
+ * size.
+ */
+
+/*
+ * Buffer in which xTaskCreateStatic() builds the task control block.  The
+ * members must follow those of tskTCB in tasks.c.
+ */
+typedef struct xSTATIC_TASK
+{
+	void					*pvDummy1;
+	#if ( portUSING_MPU_WRAPPERS == 1 )
+		xMPU_SETTINGS		xDummy2;
+	#endif
+	xListItem				xDummy3[ 2 ];
+	unsigned portBASE_TYPE	uxDummy4;
+	void					*pvDummy5;
+	signed char				cDummy6[ configMAX_TASK_NAME_LEN ];
+	#if ( portSTACK_GROWTH > 0 )
+		void				*pvDummy7;
+	#endif
+	#if ( portCRITICAL_NESTING_IN_TCB == 1 )
+		unsigned portBASE_TYPE uxDummy8;
+	#endif
+	#if ( configUSE_TRACE_FACILITY == 1 )
+		unsigned portBASE_TYPE uxDummy9[ 2 ];
+	#endif
+	#if ( configUSE_MUTEXES == 1 )
+		unsigned portBASE_TYPE uxDummy10;
+	#endif
+	#if ( configUSE_APPLICATION_TASK_TAG == 1 )
+		void				*pvDummy11;
+	#endif
+	#if ( configGENERATE_RUN_TIME_STATS == 1 )
+		unsigned long long	ullDummy12;
+		unsigned long		ulDummy12[ 2 ];
+	#endif
+	#if ( INCLUDE_uxTaskGetStackStats == 1 )
+		unsigned short		usDummy16;
+	#endif
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+		unsigned long		ulDummy13;
+		unsigned char		ucDummy14;
+	#endif
+	unsigned char			ucDummy15;
+} xStaticTask;
+
+/*
+ * Buffer in which xQueueCreateStatic() and the static semaphore macros build
+ * the queue structure.  The members must follow those of xQUEUE in queue.c.
+ */
+typedef struct xSTATIC_QUEUE
+{
+	void					*pvDummy1[ 4 ];
+	xList					xDummy2[ 2 ];
+	unsigned portBASE_TYPE	uxDummy3[ 3 ];
+	signed portBASE_TYPE	xDummy4[ 2 ];
+	#if ( configUSE_QUEUE_SETS == 1 )
+		void				*pvDummy5;
+	#endif
+	#if ( configUSE_TRACE_FACILITY == 1 )
+		unsigned char		ucDummy6[ 2 ];
+	#endif
+	unsigned char			ucDummy7;
+} xStaticQueue;
+
+/*
+ * Buffer in which xTimerCreateStatic() builds the timer structure.  The
+ * members must follow those of xTIMER in timers.c.
+ */
+typedef struct xSTATIC_TIMER
+{
+	void					*pvDummy1;
+	xListItem				xDummy2;
+	portTickType			xDummy3;
+	unsigned portBASE_TYPE	uxDummy4;
+	void					*pvDummy5[ 2 ];
+	unsigned char			ucDummy6;
+} xStaticTimer;
+
+/*
+ * Buffer in which xStreamBufferCreateStatic() builds the stream buffer
+ * structure.  The members must follow those of xSTREAM_BUFFER in
+ * stream_buffer.c.
+ */
+typedef struct xSTATIC_STREAM_BUFFER
+{
+	size_t					xDummy1[ 4 ];
+	void					*pvDummy2[ 3 ];
+	unsigned char			ucDummy3;
+} xStaticStreamBuffer;
+
+/*
+ * Buffer in which xBlockPoolCreateStatic() builds the block pool structure.
+ * The members must follow those of xBLOCK_POOL in block_pool.c.
+ */
+typedef struct xSTATIC_BLOCK_POOL
+{
+	void					*pvDummy1[ 2 ];
+	size_t					xDummy2;
+	unsigned portBASE_TYPE	uxDummy3[ 3 ];
+	unsigned char			ucDummy4;
+} xStaticBlockPool;
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+
 #endif /* INC_FREERTOS_H */
 
@@ -0,0 +1,140 @@
+/*
+ * Block pools hand out blocks of one fixed size, and pointer queues pass the
+ * blocks between tasks and interrupts by reference, so data such as a sensor
+ * frame is written once, in place, and never copied.
+ *
+ * The free blocks of a pool are kept on a list threaded through the blocks
+ * themselves, so taking a block and giving one back each take a few
+ * instructions inside a critical section, whatever the state of the pool.
+ * Both can be called from an interrupt through their FromISR() versions.
+ *
+ * A pointer queue is an ordinary queue whose items are the addresses of
+ * blocks.  The queue copies only the pointer, which queue.c does with a
+ * single load and store.  Sending a block passes ownership of it to the
+ * receiver, which must give it back to its pool once it has finished with it.
+ * The sender must not touch a block after sending it.
+ */
+
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#ifndef INC_FREERTOS_H
+	#error "#include FreeRTOS.h" must appear in source files before "#include block_pool.h"
+#endif
+
+#include "queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Type by which block pools are referenced.
+ */
+typedef void * xBlockPoolHandle;
+
+/* Each block is rounded up to a whole number of portBYTE_ALIGNMENT, so every
+block is aligned, and is at least big enough to hold the pointer that links
+it into the free list. */
+#define blockpoolBLOCK_SIZE( xBlockSize )	( ( ( ( xBlockSize ) < sizeof( void * ) ? sizeof( void * ) : ( xBlockSize ) ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* The bytes of storage that xBlockPoolCreateStatic() needs for a pool. */
+#define blockpoolSTORAGE_BYTES( xBlockSize, uxBlockCount )	( blockpoolBLOCK_SIZE( xBlockSize ) * ( uxBlockCount ) )
+
+/**
+ * xBlockPoolHandle xBlockPoolCreate( size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount );
+ *
+ * Create a pool of uxBlockCount blocks of at least xBlockSize bytes each.
+ *
+ * Returns the handle of the pool, or NULL if it could not be allocated.
+ */
+xBlockPoolHandle xBlockPoolCreate( size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount ) PRIVILEGED_FUNCTION;
+
+/**
+ * xBlockPoolHandle xBlockPoolCreateStatic( size_t xBlockSize,
+ * 											unsigned portBASE_TYPE uxBlockCount,
+ * 											unsigned char *pucPoolStorage,
+ * 											xStaticBlockPool *pxStaticBlockPool );
+ *
+ * Creates a pool as xBlockPoolCreate() does, but in pxStaticBlockPool and
+ * pucPoolStorage rather than in memory allocated from the heap.
+ * pucPoolStorage must be aligned to portBYTE_ALIGNMENT and at least
+ * blockpoolSTORAGE_BYTES( xBlockSize, uxBlockCount ) bytes long.  Only
+ * available when configSUPPORT_STATIC_ALLOCATION is set to 1 in
+ * FreeRTOSConfig.h.
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xBlockPoolHandle xBlockPoolCreateStatic( size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount, unsigned char *pucPoolStorage, xStaticBlockPool *pxStaticBlockPool ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * void vBlockPoolDelete( xBlockPoolHandle xBlockPool );
+ *
+ * Delete a pool, freeing its memory if it was allocated from the heap.  Every
+ * block must have been given back first.
+ */
+void vBlockPoolDelete( xBlockPoolHandle xBlockPool ) PRIVILEGED_FUNCTION;
+
+/**
+ * void *pvBlockPoolAlloc( xBlockPoolHandle xBlockPool );
+ * void *pvBlockPoolAllocFromISR( xBlockPoolHandle xBlockPool );
+ *
+ * Take a block from the pool.  Neither blocks - NULL is returned at once if
+ * every block is in use.
+ */
+void *pvBlockPoolAlloc( xBlockPoolHandle xBlockPool ) PRIVILEGED_FUNCTION;
+void *pvBlockPoolAllocFromISR( xBlockPoolHandle xBlockPool ) PRIVILEGED_FUNCTION;
+
+/**
+ * void vBlockPoolFree( xBlockPoolHandle xBlockPool, void *pvBlock );
+ * void vBlockPoolFreeFromISR( xBlockPoolHandle xBlockPool, void *pvBlock );
+ *
+ * Give a block taken from the pool back to it.
+ */
+void vBlockPoolFree( xBlockPoolHandle xBlockPool, void *pvBlock ) PRIVILEGED_FUNCTION;
+void vBlockPoolFreeFromISR( xBlockPoolHandle xBlockPool, void *pvBlock ) PRIVILEGED_FUNCTION;
+
+/**
+ * unsigned portBASE_TYPE uxBlockPoolGetFreeCount( xBlockPoolHandle xBlockPool );
+ * unsigned portBASE_TYPE uxBlockPoolGetMinimumFreeCount( xBlockPoolHandle xBlockPool );
+ *
+ * The number of blocks that are free now, and the fewest there have been
+ * since the pool was created, which shows whether the pool is big enough.
+ */
+unsigned portBASE_TYPE uxBlockPoolGetFreeCount( xBlockPoolHandle xBlockPool ) PRIVILEGED_FUNCTION;
+unsigned portBASE_TYPE uxBlockPoolGetMinimumFreeCount( xBlockPoolHandle xBlockPool ) PRIVILEGED_FUNCTION;
+
+/**
+ * xQueueHandle xBlockPoolQueueCreate( unsigned portBASE_TYPE uxQueueLength );
+ *
+ * Create a queue that can hold uxQueueLength block pointers.  Any queue with
+ * items of sizeof( void * ) bytes will do, so xQueueCreateStatic() can be
+ * used in the same way.
+ */
+#define xBlockPoolQueueCreate( uxQueueLength ) xQueueCreate( ( uxQueueLength ), sizeof( void * ) )
+
+/**
+ * signed portBASE_TYPE xBlockPoolSend( xQueueHandle xQueue, void *pvBlock, portTickType xTicksToWait );
+ * signed portBASE_TYPE xBlockPoolSendFromISR( xQueueHandle xQueue, void *pvBlock, signed portBASE_TYPE *pxHigherPriorityTaskWoken );
+ *
+ * Send a block to the back of a pointer queue, as xQueueSendToBack() and
+ * xQueueSendToBackFromISR() do.  Only if pdPASS is returned does the
+ * receiver own the block - otherwise it still belongs to the sender.
+ */
+signed portBASE_TYPE xBlockPoolSend( xQueueHandle xQueue, void *pvBlock, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+signed portBASE_TYPE xBlockPoolSendFromISR( xQueueHandle xQueue, void *pvBlock, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * void *pvBlockPoolReceive( xQueueHandle xQueue, portTickType xTicksToWait );
+ *
+ * Receive a block from a pointer queue, waiting for up to xTicksToWait ticks
+ * for one to be sent.  Returns the block, which now belongs to the caller, or
+ * NULL if none arrived.
+ */
+void *pvBlockPoolReceive( xQueueHandle xQueue, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BLOCK_POOL_H */
@@ -78,13 +78,14 @@ only for ports that are using the MPU. */
 		#define xTaskGetTickCount				MPU_xTaskGetTickCount
 		#define uxTaskGetNumberOfTasks			MPU_uxTaskGetNumberOfTasks
 		#define vTaskList						MPU_vTaskList
-		#define vTaskGetRunTimeStats			MPU_vTaskGetRunTimeStats
+		#define uxTaskGetRunTimeStats			MPU_uxTaskGetRunTimeStats
 		#define vTaskStartTrace					MPU_vTaskStartTrace
 		#define ulTaskEndTrace					MPU_ulTaskEndTrace
 		#define vTaskSetApplicationTaskTag		MPU_vTaskSetApplicationTaskTag
 		#define xTaskGetApplicationTaskTag		MPU_xTaskGetApplicationTaskTag
 		#define xTaskCallApplicationTaskHook	MPU_xTaskCallApplicationTaskHook
 		#define uxTaskGetStackHighWaterMark		MPU_uxTaskGetStackHighWaterMark
+		#define uxTaskGetStackStats				MPU_uxTaskGetStackStats
 		#define xTaskGetCurrentTaskHandle		MPU_xTaskGetCurrentTaskHandle
 		#define xTaskGetSchedulerState			MPU_xTaskGetSchedulerState
 
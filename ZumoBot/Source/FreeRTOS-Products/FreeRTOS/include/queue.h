@@ -84,6 +84,7 @@ typedef void * xQueueHandle;
 #define queueQUEUE_TYPE_COUNTING_SEMAPHORE	( 2U )
 #define queueQUEUE_TYPE_BINARY_SEMAPHORE	( 3U )
 #define queueQUEUE_TYPE_RECURSIVE_MUTEX		( 4U )
+#define queueQUEUE_TYPE_SET					( 5U )
 
 /**
  * queue. h
@@ -143,6 +144,51 @@ typedef void * xQueueHandle;
  */
 #define xQueueCreate( uxQueueLength, uxItemSize ) xQueueGenericCreate( uxQueueLength, uxItemSize, queueQUEUE_TYPE_BASE )
 
+/**
+ * queue. h
+ * <pre>
+ xQueueHandle xQueueCreateStatic(
+							  unsigned portBASE_TYPE uxQueueLength,
+							  unsigned portBASE_TYPE uxItemSize,
+							  unsigned char *pucQueueStorage,
+							  xStaticQueue *pxQueueBuffer
+						  );
+ * </pre>
+ *
+ * Create a new queue as xQueueCreate() does, but in memory given by the
+ * caller rather than memory allocated from the heap.  Only available when
+ * configSUPPORT_STATIC_ALLOCATION is set to 1 in FreeRTOSConfig.h.
+ *
+ * Both buffers must exist for as long as the queue does.  vQueueDelete()
+ * does not free them.
+ *
+ * @param pucQueueStorage An array of at least ( uxQueueLength * uxItemSize )
+ * bytes, in which the queued items are held.  Can be NULL if uxItemSize is 0.
+ *
+ * @param pxQueueBuffer Used to hold the queue structure.
+ *
+ * @return The handle of the created queue, or NULL if a parameter was
+ * invalid.
+ *
+ * Example usage:
+   <pre>
+ #define QUEUE_LENGTH 10
+
+ static unsigned char ucStorage[ QUEUE_LENGTH * sizeof( unsigned long ) ];
+ static xStaticQueue xQueueBuffer;
+
+ void vATask( void *pvParameters )
+ {
+ xQueueHandle xQueue;
+
+	xQueue = xQueueCreateStatic( QUEUE_LENGTH, sizeof( unsigned long ), ucStorage, &xQueueBuffer );
+ }
+ </pre>
+ * \defgroup xQueueCreateStatic xQueueCreateStatic
+ * \ingroup QueueManagement
+ */
+#define xQueueCreateStatic( uxQueueLength, uxItemSize, pucQueueStorage, pxQueueBuffer ) xQueueGenericCreateStatic( ( uxQueueLength ), ( uxItemSize ), ( pucQueueStorage ), ( pxQueueBuffer ), queueQUEUE_TYPE_BASE )
+
 /**
  * queue. h
  * <pre>
@@ -1228,6 +1274,16 @@ xQueueHandle xQueueCreateMutex( unsigned char ucQueueType );
 xQueueHandle xQueueCreateCountingSemaphore( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount );
 void* xQueueGetMutexHolder( xQueueHandle xSemaphore );
 
+/*
+ * For internal use only.  Use xSemaphoreCreateMutexStatic() or
+ * xSemaphoreCreateCountingStatic() instead of calling these functions
+ * directly.
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xQueueHandle xQueueCreateMutexStatic( unsigned char ucQueueType, xStaticQueue *pxQueueBuffer );
+	xQueueHandle xQueueCreateCountingSemaphoreStatic( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount, xStaticQueue *pxQueueBuffer );
+#endif
+
 /*
  * For internal use only.  Use xSemaphoreTakeMutexRecursive() or
  * xSemaphoreGiveMutexRecursive() instead of calling these functions directly.
@@ -1273,6 +1329,86 @@ portBASE_TYPE xQueueGiveMutexRecursive( xQueueHandle pxMutex );
  */
 xQueueHandle xQueueGenericCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char ucQueueType );
 
+/*
+ * Generic version of the static queue creation function, which is in turn
+ * called by xQueueCreateStatic() and the static semaphore macros.
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xQueueHandle xQueueGenericCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueue *pxQueueBuffer, unsigned char ucQueueType );
+#endif
+
+/*
+ * Queue sets let a task block on several queues and semaphores at once.  The
+ * queues and semaphores are added to a set, and the task blocks on the set
+ * rather than on any one of them.  Each time an item is sent to a member, or
+ * a member semaphore is given, the handle of the member is sent to the set.
+ * xQueueSelectFromSet() receives the handle, which the task then reads or
+ * takes with a block time of 0, which must succeed.
+ *
+ * A handle is sent to the set for every item, so the length of the set must
+ * be at least the total length of its members - a binary semaphore counts
+ * as 1.  A task must not block on a member directly, and every item sent to a
+ * member must be read through the set.  Mutexes cannot be added to a set.
+ *
+ * Only available when configUSE_QUEUE_SETS is set to 1 in FreeRTOSConfig.h.
+ */
+typedef xQueueHandle xQueueSetHandle;
+typedef xQueueHandle xQueueSetMemberHandle;
+
+/**
+ * xQueueSetHandle xQueueCreateSet( unsigned portBASE_TYPE uxEventQueueLength );
+ *
+ * Create a queue set that can hold uxEventQueueLength member handles.
+ * Returns the handle of the set, or NULL if it could not be allocated.
+ *
+ * xQueueSetHandle xQueueCreateSetStatic( unsigned portBASE_TYPE uxEventQueueLength,
+ * 										unsigned char *pucQueueStorage,
+ * 										xStaticQueue *pxQueueBuffer );
+ *
+ * Creates a set as xQueueCreateSet() does, but in pxQueueBuffer and
+ * pucQueueStorage rather than in memory allocated from the heap.
+ * pucQueueStorage must be at least
+ * uxEventQueueLength * sizeof( xQueueSetMemberHandle ) bytes long.
+ */
+#if ( configUSE_QUEUE_SETS == 1 )
+	xQueueSetHandle xQueueCreateSet( unsigned portBASE_TYPE uxEventQueueLength );
+
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		#define xQueueCreateSetStatic( uxEventQueueLength, pucQueueStorage, pxQueueBuffer ) xQueueGenericCreateStatic( ( uxEventQueueLength ), sizeof( xQueueSetMemberHandle ), ( pucQueueStorage ), ( pxQueueBuffer ), queueQUEUE_TYPE_SET )
+	#endif
+#endif
+
+/**
+ * portBASE_TYPE xQueueAddToSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet );
+ * portBASE_TYPE xQueueRemoveFromSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet );
+ *
+ * Add a queue or semaphore to a set, or remove it from the set again.  A
+ * queue can only be in one set, and must be empty - a semaphore must not be
+ * available - when it is added or removed.  Returns pdPASS, or pdFAIL if
+ * the queue or semaphore could not be added or removed.
+ */
+#if ( configUSE_QUEUE_SETS == 1 )
+	portBASE_TYPE xQueueAddToSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet );
+	portBASE_TYPE xQueueRemoveFromSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet );
+#endif
+
+/**
+ * xQueueSetMemberHandle xQueueSelectFromSet( xQueueSetHandle xQueueSet, portTickType xBlockTimeTicks );
+ *
+ * Block for up to xBlockTimeTicks ticks for a member of the set to be sent
+ * to or given.  Returns the handle of the member, which then holds at least
+ * one item, or NULL if the block time expired.
+ *
+ * xQueueSetMemberHandle xQueueSelectFromSetFromISR( xQueueSetHandle xQueueSet );
+ *
+ * A version of xQueueSelectFromSet() that can be called from an interrupt
+ * service routine.  It never blocks.
+ */
+#if ( configUSE_QUEUE_SETS == 1 )
+	xQueueSetMemberHandle xQueueSelectFromSet( xQueueSetHandle xQueueSet, portTickType xBlockTimeTicks );
+	xQueueSetMemberHandle xQueueSelectFromSetFromISR( xQueueSetHandle xQueueSet );
+#endif
+
 /* Not public API functions. */
 void vQueueWaitForMessageRestricted( xQueueHandle pxQueue, portTickType xTicksToWait );
 portBASE_TYPE xQueueGenericReset( xQueueHandle pxQueue, portBASE_TYPE xNewQueue );
@@ -82,6 +82,22 @@ task.h is included from an application file. */
 #define	queueSEND_TO_BACK				( 0 )
 #define	queueSEND_TO_FRONT				( 1 )
 
+/* Copies an item into or out of the queue storage.  Items the size of a
+pointer, such as the blocks of a block pool passed by reference, are copied
+with a memcpy() of fixed size, which the compiler turns into a single load and
+store rather than a call to the library. */
+#define queueCOPY_ITEM( pvDestination, pvSource, uxItemSize )					\
+{																				\
+	if( ( uxItemSize ) == ( unsigned portBASE_TYPE ) sizeof( void * ) )		\
+	{																			\
+		memcpy( ( pvDestination ), ( pvSource ), sizeof( void * ) );			\
+	}																			\
+	else																		\
+	{																			\
+		memcpy( ( pvDestination ), ( pvSource ), ( unsigned ) ( uxItemSize ) );	\
+	}																			\
+}
+
 /* Effectively make a union out of the xQUEUE structure. */
 #define pxMutexHolder					pcTail
 #define uxQueueType						pcHead
@@ -100,6 +116,7 @@ zero. */
 #define queueQUEUE_TYPE_COUNTING_SEMAPHORE	( 2U )
 #define queueQUEUE_TYPE_BINARY_SEMAPHORE	( 3U )
 #define queueQUEUE_TYPE_RECURSIVE_MUTEX		( 4U )
+#define queueQUEUE_TYPE_SET					( 5U )
 
 /*
  * Definition of the queue used by the scheduler.
@@ -123,11 +140,19 @@ typedef struct QueueDefinition
 	signed portBASE_TYPE xRxLock;			/*< Stores the number of items received from the queue (removed from the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
 	signed portBASE_TYPE xTxLock;			/*< Stores the number of items transmitted to the queue (added to the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
 
+	#if ( configUSE_QUEUE_SETS == 1 )
+		struct QueueDefinition *pxQueueSetContainer;	/*< The queue set the queue is a member of, or NULL if it is not in a set. */
+	#endif
+
 	#if ( configUSE_TRACE_FACILITY == 1 )
 		unsigned char ucQueueNumber;
 		unsigned char ucQueueType;
 	#endif
 
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char ucStaticallyAllocated;	/*< pdTRUE if the structure and storage were given by the application, so must not be freed. */
+	#endif
+
 } xQUEUE;
 /*-----------------------------------------------------------*/
 
@@ -166,6 +191,20 @@ unsigned char ucQueueGetQueueType( xQueueHandle pxQueue ) PRIVILEGED_FUNCTION;
 portBASE_TYPE xQueueGenericReset( xQueueHandle pxQueue, portBASE_TYPE xNewQueue ) PRIVILEGED_FUNCTION;
 xTaskHandle xQueueGetMutexHolder( xQueueHandle xSemaphore ) PRIVILEGED_FUNCTION;
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xQueueHandle xQueueGenericCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueue *pxQueueBuffer, unsigned char ucQueueType ) PRIVILEGED_FUNCTION;
+	xQueueHandle xQueueCreateMutexStatic( unsigned char ucQueueType, xStaticQueue *pxQueueBuffer ) PRIVILEGED_FUNCTION;
+	xQueueHandle xQueueCreateCountingSemaphoreStatic( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount, xStaticQueue *pxQueueBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
+#if ( configUSE_QUEUE_SETS == 1 )
+	xQueueHandle xQueueCreateSet( unsigned portBASE_TYPE uxEventQueueLength ) PRIVILEGED_FUNCTION;
+	portBASE_TYPE xQueueAddToSet( xQueueHandle xQueueOrSemaphore, xQueueHandle xQueueSet ) PRIVILEGED_FUNCTION;
+	portBASE_TYPE xQueueRemoveFromSet( xQueueHandle xQueueOrSemaphore, xQueueHandle xQueueSet ) PRIVILEGED_FUNCTION;
+	xQueueHandle xQueueSelectFromSet( xQueueHandle xQueueSet, portTickType xBlockTimeTicks ) PRIVILEGED_FUNCTION;
+	xQueueHandle xQueueSelectFromSetFromISR( xQueueHandle xQueueSet ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * Co-routine queue functions differ from task queue functions.  Co-routines are
  * an optional component.
@@ -237,6 +276,25 @@ static void prvCopyDataToQueue( xQUEUE *pxQueue, const void *pvItemToQueue, port
  * Copies an item out of a queue.
  */
 static void prvCopyDataFromQueue( xQUEUE * const pxQueue, const void *pvBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Sets up a newly created queue structure as a mutex, whether its memory
+ * came from the heap or from the application.
+ */
+#if ( configUSE_MUTEXES == 1 )
+	static void prvInitialiseMutex( xQUEUE *pxNewQueue, unsigned char ucQueueType ) PRIVILEGED_FUNCTION;
+#endif
+
+/*
+ * Posts the handle of a queue that is a member of a queue set to the set,
+ * after an item was sent to the queue, and unblocks a task waiting on the set
+ * if the set is not locked.  Returns pdTRUE if the unblocked task has a
+ * priority above the calling task.  Must be called from a critical section,
+ * or with interrupts masked.
+ */
+#if ( configUSE_QUEUE_SETS == 1 )
+	static signed portBASE_TYPE prvNotifyQueueSetContainer( const xQUEUE * const pxQueue, portBASE_TYPE xCopyPosition ) PRIVILEGED_FUNCTION;
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -296,6 +354,16 @@ portBASE_TYPE xReturn = pdPASS;
 		/* Ensure the event queues start with the correct state. */
 		vListInitialise( &( pxQueue->xTasksWaitingToSend ) );
 		vListInitialise( &( pxQueue->xTasksWaitingToReceive ) );
+
+		/* Resetting a queue leaves it in the set it was added to. */
+		#if ( configUSE_QUEUE_SETS == 1 )
+		{
+			if( xNewQueue == pdTRUE )
+			{
+				pxQueue->pxQueueSetContainer = NULL;
+			}
+		}
+		#endif
 	}
 
 	return xReturn;
@@ -336,6 +404,12 @@ xQueueHandle xReturn = NULL;
 				}
 				#endif /* configUSE_TRACE_FACILITY */
 
+				#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+				{
+					pxNewQueue->ucStaticallyAllocated = ( unsigned char ) pdFALSE;
+				}
+				#endif
+
 				traceQUEUE_CREATE( pxNewQueue );
 				xReturn = pxNewQueue;
 			}
@@ -353,52 +427,77 @@ xQueueHandle xReturn = NULL;
 }
 /*-----------------------------------------------------------*/
 
-#if ( configUSE_MUTEXES == 1 )
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
 
-	xQueueHandle xQueueCreateMutex( unsigned char ucQueueType )
+	xQueueHandle xQueueGenericCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueue *pxQueueBuffer, unsigned char ucQueueType )
 	{
-	xQUEUE *pxNewQueue;
+	xQUEUE *pxNewQueue = NULL;
 
-		/* Prevent compiler warnings about unused parameters if
-		configUSE_TRACE_FACILITY does not equal 1. */
+		/* Remove compiler warnings about unused parameters should
+		configUSE_TRACE_FACILITY not be set to 1. */
 		( void ) ucQueueType;
 
-		/* Allocate the new queue structure. */
-		pxNewQueue = ( xQUEUE * ) pvPortMalloc( sizeof( xQUEUE ) );
-		if( pxNewQueue != NULL )
+		/* xStaticQueue must have the same size as the structure it stands in
+		for. */
+		configASSERT( sizeof( xStaticQueue ) == sizeof( xQUEUE ) );
+
+		if( ( uxQueueLength > ( unsigned portBASE_TYPE ) 0 ) && ( pxQueueBuffer != NULL ) && ( ( pucQueueStorage != NULL ) || ( uxItemSize == ( unsigned portBASE_TYPE ) 0 ) ) )
 		{
-			/* Information required for priority inheritance. */
-			pxNewQueue->pxMutexHolder = NULL;
-			pxNewQueue->uxQueueType = queueQUEUE_IS_MUTEX;
-
-			/* Queues used as a mutex no data is actually copied into or out
-			of the queue. */
-			pxNewQueue->pcWriteTo = NULL;
-			pxNewQueue->pcReadFrom = NULL;
-
-			/* Each mutex has a length of 1 (like a binary semaphore) and
-			an item size of 0 as nothing is actually copied into or out
-			of the mutex. */
-			pxNewQueue->uxMessagesWaiting = ( unsigned portBASE_TYPE ) 0U;
-			pxNewQueue->uxLength = ( unsigned portBASE_TYPE ) 1U;
-			pxNewQueue->uxItemSize = ( unsigned portBASE_TYPE ) 0U;
-			pxNewQueue->xRxLock = queueUNLOCKED;
-			pxNewQueue->xTxLock = queueUNLOCKED;
+			pxNewQueue = ( xQUEUE * ) pxQueueBuffer;
 
+			if( uxItemSize == ( unsigned portBASE_TYPE ) 0 )
+			{
+				/* Nothing is ever copied into the storage area, but pcHead
+				must not be NULL as a NULL pcHead marks a mutex, so point it
+				at the structure itself. */
+				pxNewQueue->pcHead = ( signed char * ) pxNewQueue;
+			}
+			else
+			{
+				/* Unlike xQueueGenericCreate(), no byte is added to the
+				storage as pcTail is only ever compared against. */
+				pxNewQueue->pcHead = ( signed char * ) pucQueueStorage;
+			}
+
+			pxNewQueue->uxLength = uxQueueLength;
+			pxNewQueue->uxItemSize = uxItemSize;
+			xQueueGenericReset( pxNewQueue, pdTRUE );
 			#if ( configUSE_TRACE_FACILITY == 1 )
 			{
 				pxNewQueue->ucQueueType = ucQueueType;
 			}
-			#endif
+			#endif /* configUSE_TRACE_FACILITY */
+
+			pxNewQueue->ucStaticallyAllocated = ( unsigned char ) pdTRUE;
 
-			/* Ensure the event queues start with the correct state. */
-			vListInitialise( &( pxNewQueue->xTasksWaitingToSend ) );
-			vListInitialise( &( pxNewQueue->xTasksWaitingToReceive ) );
+			traceQUEUE_CREATE( pxNewQueue );
+		}
+
+		configASSERT( pxNewQueue );
+
+		return pxNewQueue;
+	}
 
-			traceCREATE_MUTEX( pxNewQueue );
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
 
-			/* Start with the semaphore in the expected state. */
-			xQueueGenericSend( pxNewQueue, NULL, ( portTickType ) 0U, queueSEND_TO_BACK );
+#if ( configUSE_MUTEXES == 1 )
+
+	xQueueHandle xQueueCreateMutex( unsigned char ucQueueType )
+	{
+	xQUEUE *pxNewQueue;
+
+		/* Allocate the new queue structure. */
+		pxNewQueue = ( xQUEUE * ) pvPortMalloc( sizeof( xQUEUE ) );
+		if( pxNewQueue != NULL )
+		{
+			#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			{
+				pxNewQueue->ucStaticallyAllocated = ( unsigned char ) pdFALSE;
+			}
+			#endif
+
+			prvInitialiseMutex( pxNewQueue, ucQueueType );
 		}
 		else
 		{
@@ -412,6 +511,78 @@ xQueueHandle xReturn = NULL;
 #endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
 
+#if ( ( configUSE_MUTEXES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+
+	xQueueHandle xQueueCreateMutexStatic( unsigned char ucQueueType, xStaticQueue *pxQueueBuffer )
+	{
+	xQUEUE *pxNewQueue = ( xQUEUE * ) pxQueueBuffer;
+
+		configASSERT( sizeof( xStaticQueue ) == sizeof( xQUEUE ) );
+		configASSERT( pxNewQueue );
+
+		if( pxNewQueue != NULL )
+		{
+			pxNewQueue->ucStaticallyAllocated = ( unsigned char ) pdTRUE;
+			prvInitialiseMutex( pxNewQueue, ucQueueType );
+		}
+
+		return pxNewQueue;
+	}
+
+#endif /* configUSE_MUTEXES && configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_MUTEXES == 1 )
+
+	static void prvInitialiseMutex( xQUEUE *pxNewQueue, unsigned char ucQueueType )
+	{
+		/* Prevent compiler warnings about unused parameters if
+		configUSE_TRACE_FACILITY does not equal 1. */
+		( void ) ucQueueType;
+
+		/* Information required for priority inheritance. */
+		pxNewQueue->pxMutexHolder = NULL;
+		pxNewQueue->uxQueueType = queueQUEUE_IS_MUTEX;
+
+		/* Queues used as a mutex no data is actually copied into or out
+		of the queue. */
+		pxNewQueue->pcWriteTo = NULL;
+		pxNewQueue->pcReadFrom = NULL;
+
+		/* Each mutex has a length of 1 (like a binary semaphore) and
+		an item size of 0 as nothing is actually copied into or out
+		of the mutex. */
+		pxNewQueue->uxMessagesWaiting = ( unsigned portBASE_TYPE ) 0U;
+		pxNewQueue->uxLength = ( unsigned portBASE_TYPE ) 1U;
+		pxNewQueue->uxItemSize = ( unsigned portBASE_TYPE ) 0U;
+		pxNewQueue->xRxLock = queueUNLOCKED;
+		pxNewQueue->xTxLock = queueUNLOCKED;
+
+		#if ( configUSE_TRACE_FACILITY == 1 )
+		{
+			pxNewQueue->ucQueueType = ucQueueType;
+		}
+		#endif
+
+		/* Ensure the event queues start with the correct state. */
+		vListInitialise( &( pxNewQueue->xTasksWaitingToSend ) );
+		vListInitialise( &( pxNewQueue->xTasksWaitingToReceive ) );
+
+		#if ( configUSE_QUEUE_SETS == 1 )
+		{
+			pxNewQueue->pxQueueSetContainer = NULL;
+		}
+		#endif
+
+		traceCREATE_MUTEX( pxNewQueue );
+
+		/* Start with the semaphore in the expected state. */
+		xQueueGenericSend( pxNewQueue, NULL, ( portTickType ) 0U, queueSEND_TO_BACK );
+	}
+
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_MUTEXES == 1 )
 
 	void* xQueueGetMutexHolder( xQueueHandle xSemaphore )
@@ -548,6 +719,31 @@ xQueueHandle xReturn = NULL;
 #endif /* configUSE_COUNTING_SEMAPHORES */
 /*-----------------------------------------------------------*/
 
+#if ( ( configUSE_COUNTING_SEMAPHORES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+
+	xQueueHandle xQueueCreateCountingSemaphoreStatic( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount, xStaticQueue *pxQueueBuffer )
+	{
+	xQueueHandle pxHandle;
+
+		pxHandle = xQueueGenericCreateStatic( ( unsigned portBASE_TYPE ) uxCountValue, queueSEMAPHORE_QUEUE_ITEM_LENGTH, NULL, pxQueueBuffer, queueQUEUE_TYPE_COUNTING_SEMAPHORE );
+
+		if( pxHandle != NULL )
+		{
+			pxHandle->uxMessagesWaiting = uxInitialCount;
+
+			traceCREATE_COUNTING_SEMAPHORE();
+		}
+		else
+		{
+			traceCREATE_COUNTING_SEMAPHORE_FAILED();
+		}
+
+		return pxHandle;
+	}
+
+#endif /* configUSE_COUNTING_SEMAPHORES && configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
 signed portBASE_TYPE xQueueGenericSend( xQueueHandle pxQueue, const void * const pvItemToQueue, portTickType xTicksToWait, portBASE_TYPE xCopyPosition )
 {
 signed portBASE_TYPE xEntryTimeSet = pdFALSE;
@@ -570,19 +766,33 @@ xTimeOutType xTimeOut;
 				traceQUEUE_SEND( pxQueue );
 				prvCopyDataToQueue( pxQueue, pvItemToQueue, xCopyPosition );
 
-				/* If there was a task waiting for data to arrive on the
-				queue then unblock it now. */
-				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+				#if ( configUSE_QUEUE_SETS == 1 )
+				if( pxQueue->pxQueueSetContainer != NULL )
 				{
-					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) == pdTRUE )
+					/* The task that reads the queue waits on the set it is
+					in, not on the queue itself. */
+					if( prvNotifyQueueSetContainer( pxQueue, xCopyPosition ) != pdFALSE )
 					{
-						/* The unblocked task has a priority higher than
-						our own so yield immediately.  Yes it is ok to do
-						this from within the critical section - the kernel
-						takes care of that. */
 						portYIELD_WITHIN_API();
 					}
 				}
+				else
+				#endif /* configUSE_QUEUE_SETS */
+				{
+					/* If there was a task waiting for data to arrive on the
+					queue then unblock it now. */
+					if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+					{
+						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) == pdTRUE )
+						{
+							/* The unblocked task has a priority higher than
+							our own so yield immediately.  Yes it is ok to do
+							this from within the critical section - the kernel
+							takes care of that. */
+							portYIELD_WITHIN_API();
+						}
+					}
+				}
 
 				taskEXIT_CRITICAL();
 
@@ -899,15 +1109,27 @@ unsigned portBASE_TYPE uxSavedInterruptStatus;
 			be done when the queue is unlocked later. */
 			if( pxQueue->xTxLock == queueUNLOCKED )
 			{
-				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+				#if ( configUSE_QUEUE_SETS == 1 )
+				if( pxQueue->pxQueueSetContainer != NULL )
 				{
-					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+					if( prvNotifyQueueSetContainer( pxQueue, xCopyPosition ) != pdFALSE )
 					{
-						/* The task waiting has a higher priority so record that a
-						context	switch is required. */
 						*pxHigherPriorityTaskWoken = pdTRUE;
 					}
 				}
+				else
+				#endif /* configUSE_QUEUE_SETS */
+				{
+					if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+					{
+						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+						{
+							/* The task waiting has a higher priority so record that a
+							context	switch is required. */
+							*pxHigherPriorityTaskWoken = pdTRUE;
+						}
+					}
+				}
 			}
 			else
 			{
@@ -1167,8 +1389,16 @@ void vQueueDelete( xQueueHandle pxQueue )
 
 	traceQUEUE_DELETE( pxQueue );
 	vQueueUnregisterQueue( pxQueue );
-	vPortFree( pxQueue->pcHead );
-	vPortFree( pxQueue );
+
+	/* The memory of a queue created in buffers given by the application
+	belongs to the application. */
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		if( pxQueue->ucStaticallyAllocated == ( unsigned char ) pdFALSE )
+	#endif
+	{
+		vPortFree( pxQueue->pcHead );
+		vPortFree( pxQueue );
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -1219,7 +1449,7 @@ static void prvCopyDataToQueue( xQUEUE *pxQueue, const void *pvItemToQueue, port
 	}
 	else if( xPosition == queueSEND_TO_BACK )
 	{
-		memcpy( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, ( unsigned ) pxQueue->uxItemSize );
+		queueCOPY_ITEM( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, pxQueue->uxItemSize );
 		pxQueue->pcWriteTo += pxQueue->uxItemSize;
 		if( pxQueue->pcWriteTo >= pxQueue->pcTail )
 		{
@@ -1228,7 +1458,7 @@ static void prvCopyDataToQueue( xQUEUE *pxQueue, const void *pvItemToQueue, port
 	}
 	else
 	{
-		memcpy( ( void * ) pxQueue->pcReadFrom, pvItemToQueue, ( unsigned ) pxQueue->uxItemSize );
+		queueCOPY_ITEM( ( void * ) pxQueue->pcReadFrom, pvItemToQueue, pxQueue->uxItemSize );
 		pxQueue->pcReadFrom -= pxQueue->uxItemSize;
 		if( pxQueue->pcReadFrom < pxQueue->pcHead )
 		{
@@ -1249,7 +1479,7 @@ static void prvCopyDataFromQueue( xQUEUE * const pxQueue, const void *pvBuffer )
 		{
 			pxQueue->pcReadFrom = pxQueue->pcHead;
 		}
-		memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->pcReadFrom, ( unsigned ) pxQueue->uxItemSize );
+		queueCOPY_ITEM( ( void * ) pvBuffer, ( void * ) pxQueue->pcReadFrom, pxQueue->uxItemSize );
 	}
 }
 /*-----------------------------------------------------------*/
@@ -1267,6 +1497,21 @@ static void prvUnlockQueue( xQueueHandle pxQueue )
 		/* See if data was added to the queue while it was locked. */
 		while( pxQueue->xTxLock > queueLOCKED_UNMODIFIED )
 		{
+			/* Data posted to a member of a set while it was locked is
+			posted to the set now, once for each item. */
+			#if ( configUSE_QUEUE_SETS == 1 )
+			if( pxQueue->pxQueueSetContainer != NULL )
+			{
+				if( prvNotifyQueueSetContainer( pxQueue, queueSEND_TO_BACK ) != pdFALSE )
+				{
+					vTaskMissedYield();
+				}
+
+				--( pxQueue->xTxLock );
+			}
+			else
+			#endif /* configUSE_QUEUE_SETS */
+
 			/* Data was posted while the queue was locked.  Are any tasks
 			blocked waiting for data to become available? */
 			if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
@@ -1476,7 +1721,7 @@ signed portBASE_TYPE xReturn;
 				pxQueue->pcReadFrom = pxQueue->pcHead;
 			}
 			--( pxQueue->uxMessagesWaiting );
-			memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->pcReadFrom, ( unsigned ) pxQueue->uxItemSize );
+			queueCOPY_ITEM( ( void * ) pvBuffer, ( void * ) pxQueue->pcReadFrom, pxQueue->uxItemSize );
 
 			xReturn = pdPASS;
 
@@ -1551,7 +1796,7 @@ signed portBASE_TYPE xReturn;
 			pxQueue->pcReadFrom = pxQueue->pcHead;
 		}
 		--( pxQueue->uxMessagesWaiting );
-		memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->pcReadFrom, ( unsigned ) pxQueue->uxItemSize );
+		queueCOPY_ITEM( ( void * ) pvBuffer, ( void * ) pxQueue->pcReadFrom, pxQueue->uxItemSize );
 
 		if( ( *pxCoRoutineWoken ) == pdFALSE )
 		{
@@ -1650,4 +1895,145 @@ signed portBASE_TYPE xReturn;
 	}
 
 #endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	xQueueHandle xQueueCreateSet( unsigned portBASE_TYPE uxEventQueueLength )
+	{
+		/* A set is a queue of the handles of the members that have been sent
+		to, so a task can block on all of them by blocking on the set. */
+		return xQueueGenericCreate( uxEventQueueLength, sizeof( xQUEUE * ), queueQUEUE_TYPE_SET );
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	portBASE_TYPE xQueueAddToSet( xQueueHandle xQueueOrSemaphore, xQueueHandle xQueueSet )
+	{
+	portBASE_TYPE xReturn;
+
+		configASSERT( xQueueOrSemaphore );
+		configASSERT( xQueueSet );
+
+		taskENTER_CRITICAL();
+		{
+			/* A queue can only be in one set.  It must also be empty, as the
+			set only holds a handle for each item sent while the queue is a
+			member, and a handle must be read from the set for every item
+			read from the queue. */
+			if( ( xQueueOrSemaphore->pxQueueSetContainer != NULL ) || ( xQueueOrSemaphore->uxMessagesWaiting != ( unsigned portBASE_TYPE ) 0U ) )
+			{
+				xReturn = pdFAIL;
+			}
+			else
+			{
+				xQueueOrSemaphore->pxQueueSetContainer = xQueueSet;
+				xReturn = pdPASS;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	portBASE_TYPE xQueueRemoveFromSet( xQueueHandle xQueueOrSemaphore, xQueueHandle xQueueSet )
+	{
+	portBASE_TYPE xReturn;
+
+		configASSERT( xQueueOrSemaphore );
+		configASSERT( xQueueSet );
+
+		taskENTER_CRITICAL();
+		{
+			/* The queue must be empty, so the set holds no handle of it. */
+			if( ( xQueueOrSemaphore->pxQueueSetContainer != xQueueSet ) || ( xQueueOrSemaphore->uxMessagesWaiting != ( unsigned portBASE_TYPE ) 0U ) )
+			{
+				xReturn = pdFAIL;
+			}
+			else
+			{
+				xQueueOrSemaphore->pxQueueSetContainer = NULL;
+				xReturn = pdPASS;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	xQueueHandle xQueueSelectFromSet( xQueueHandle xQueueSet, portTickType xBlockTimeTicks )
+	{
+	xQueueHandle xReturn = NULL;
+
+		( void ) xQueueGenericReceive( xQueueSet, &xReturn, xBlockTimeTicks, pdFALSE );
+		return xReturn;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	xQueueHandle xQueueSelectFromSetFromISR( xQueueHandle xQueueSet )
+	{
+	xQueueHandle xReturn = NULL;
+	signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+		/* Nothing ever blocks sending to a set, as it is long enough for
+		every item its members can hold, so no task can be woken. */
+		( void ) xQueueReceiveFromISR( xQueueSet, &xReturn, &xHigherPriorityTaskWoken );
+		return xReturn;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	static signed portBASE_TYPE prvNotifyQueueSetContainer( const xQUEUE * const pxQueue, portBASE_TYPE xCopyPosition )
+	{
+	xQUEUE *pxQueueSetContainer = pxQueue->pxQueueSetContainer;
+	signed portBASE_TYPE xReturn = pdFALSE;
+
+		/* The set must be at least as long as the total length of its
+		members, or this handle would be lost. */
+		configASSERT( pxQueueSetContainer->uxMessagesWaiting < pxQueueSetContainer->uxLength );
+
+		if( pxQueueSetContainer->uxMessagesWaiting < pxQueueSetContainer->uxLength )
+		{
+			traceQUEUE_SEND( pxQueueSetContainer );
+
+			/* The handle, not the item, is copied to the set. */
+			prvCopyDataToQueue( pxQueueSetContainer, &pxQueue, xCopyPosition );
+
+			if( pxQueueSetContainer->xTxLock == queueUNLOCKED )
+			{
+				if( listLIST_IS_EMPTY( &( pxQueueSetContainer->xTasksWaitingToReceive ) ) == pdFALSE )
+				{
+					xReturn = xTaskRemoveFromEventList( &( pxQueueSetContainer->xTasksWaitingToReceive ) );
+				}
+			}
+			else
+			{
+				/* The task that unlocks the set unblocks the waiting task. */
+				++( pxQueueSetContainer->xTxLock );
+			}
+		}
+
+		return xReturn;
+	}
 
+#endif /* configUSE_QUEUE_SETS */
@@ -0,0 +1,484 @@
+/*
+ * Single writer, single reader stream buffers.  See stream_buffer.h.
+ *
+ * The ring holds xLength bytes, one more than the size asked for, so that a
+ * full buffer (the head one behind the tail) can be told from an empty one
+ * (the head equal to the tail) without a count that both sides would have to
+ * update.  The writer only ever writes xHead, and the reader only ever writes
+ * xTail.
+ *
+ * A side that is about to block first stores its handle in the stream
+ * buffer, then looks at the index of the other side again before it waits.
+ * The other side moves its index before it looks for a handle.  So either the
+ * blocking side sees the new index and does not wait, or the other side sees
+ * the handle and notifies it.  A notification that arrives after the waiting
+ * side has stopped waiting for some other reason is harmless - the count is
+ * cleared by the next wait, which then finds nothing to do and waits again.
+ */
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* xTaskGetCurrentTaskHandle() is also built when mutexes are used. */
+#if ( INCLUDE_xTaskGetCurrentTaskHandle != 1 ) && ( configUSE_MUTEXES != 1 )
+	#error Stream buffers need xTaskGetCurrentTaskHandle(), so INCLUDE_xTaskGetCurrentTaskHandle must be set to 1 in FreeRTOSConfig.h.
+#endif
+
+/*
+ * Definition of the stream buffer structure.  xStaticStreamBuffer in
+ * FreeRTOS.h must be kept the same size.
+ */
+typedef struct xSTREAM_BUFFER
+{
+	volatile size_t xTail;					/*< The index of the next byte to read.  Only written by the reader. */
+	volatile size_t xHead;					/*< The index of the next byte to write.  Only written by the writer. */
+	size_t xLength;							/*< The size of the ring, one more than the number of bytes it can hold. */
+	volatile size_t xTriggerLevelBytes;		/*< The number of bytes that must be waiting before a blocked reader is woken. */
+
+	volatile xTaskHandle xTaskWaitingToReceive;	/*< The reader, while it is blocked on an empty buffer, otherwise NULL. */
+	volatile xTaskHandle xTaskWaitingToSend;	/*< The writer, while it is blocked on a full buffer, otherwise NULL. */
+	unsigned char *pucBuffer;				/*< The ring itself. */
+
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char ucStaticallyAllocated;	/*< pdTRUE if the structure and storage were given by the application, so must not be freed. */
+	#endif
+
+} xSTREAM_BUFFER;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Set up a stream buffer in memory that has already been obtained.
+ */
+static void prvInitialiseNewStreamBuffer( xSTREAM_BUFFER *pxStreamBuffer, unsigned char *pucBuffer, size_t xBufferSizeBytes, size_t xTriggerLevelBytes ) PRIVILEGED_FUNCTION;
+
+/*
+ * The number of bytes waiting to be read.
+ */
+static size_t prvBytesInBuffer( const xSTREAM_BUFFER *pxStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copy as much of pucData into the ring as there is space for, and publish
+ * the new head.  Returns the number of bytes written.  Only called by the
+ * writer.
+ */
+static size_t prvWriteBytes( xSTREAM_BUFFER *pxStreamBuffer, const unsigned char *pucData, size_t xCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copy as many waiting bytes into pucData as it has space for, and publish
+ * the new tail.  Returns the number of bytes read.  Only called by the
+ * reader.
+ */
+static size_t prvReadBytes( xSTREAM_BUFFER *pxStreamBuffer, unsigned char *pucData, size_t xCount ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+xStreamBufferHandle xStreamBufferCreate( size_t xBufferSizeBytes, size_t xTriggerLevelBytes )
+{
+xSTREAM_BUFFER *pxNewStreamBuffer;
+
+	configASSERT( xBufferSizeBytes > 0 );
+
+	/* The structure and the ring are allocated together, the ring following
+	the structure. */
+	pxNewStreamBuffer = ( xSTREAM_BUFFER * ) pvPortMalloc( sizeof( xSTREAM_BUFFER ) + xBufferSizeBytes + ( size_t ) 1 );
+
+	if( pxNewStreamBuffer != NULL )
+	{
+		prvInitialiseNewStreamBuffer( pxNewStreamBuffer, ( ( unsigned char * ) pxNewStreamBuffer ) + sizeof( xSTREAM_BUFFER ), xBufferSizeBytes, xTriggerLevelBytes );
+
+		#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+			pxNewStreamBuffer->ucStaticallyAllocated = ( unsigned char ) pdFALSE;
+		}
+		#endif
+	}
+
+	configASSERT( pxNewStreamBuffer );
+
+	return ( xStreamBufferHandle ) pxNewStreamBuffer;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xStreamBufferHandle xStreamBufferCreateStatic( size_t xBufferSizeBytes, size_t xTriggerLevelBytes, unsigned char *pucStreamBufferStorage, xStaticStreamBuffer *pxStaticStreamBuffer )
+	{
+	xSTREAM_BUFFER *pxNewStreamBuffer = ( xSTREAM_BUFFER * ) pxStaticStreamBuffer;
+
+		/* xStaticStreamBuffer must be kept in step with xSTREAM_BUFFER. */
+		configASSERT( sizeof( xStaticStreamBuffer ) == sizeof( xSTREAM_BUFFER ) );
+		configASSERT( xBufferSizeBytes > 0 );
+		configASSERT( pucStreamBufferStorage );
+		configASSERT( pxStaticStreamBuffer );
+
+		prvInitialiseNewStreamBuffer( pxNewStreamBuffer, pucStreamBufferStorage, xBufferSizeBytes, xTriggerLevelBytes );
+		pxNewStreamBuffer->ucStaticallyAllocated = ( unsigned char ) pdTRUE;
+
+		return ( xStreamBufferHandle ) pxNewStreamBuffer;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+void vStreamBufferDelete( xStreamBufferHandle xStreamBuffer )
+{
+xSTREAM_BUFFER *pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+
+	configASSERT( pxStreamBuffer );
+
+	/* The memory of a stream buffer created in buffers given by the
+	application belongs to the application. */
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		if( pxStreamBuffer->ucStaticallyAllocated == ( unsigned char ) pdFALSE )
+	#endif
+	{
+		vPortFree( pxStreamBuffer );
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSend( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, portTickType xTicksToWait )
+{
+xSTREAM_BUFFER *pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+const unsigned char *pucData = ( const unsigned char * ) pvTxData;
+size_t xWritten = 0, xCount;
+xTaskHandle xReceiver;
+xTimeOutType xTimeOut;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( !( ( pvTxData == NULL ) && ( xDataLengthBytes > 0 ) ) );
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	for( ;; )
+	{
+		xCount = prvWriteBytes( pxStreamBuffer, &( pucData[ xWritten ] ), xDataLengthBytes - xWritten );
+
+		if( xCount > 0 )
+		{
+			xWritten += xCount;
+
+			/* Wake the reader if it is waiting and there is now enough for it
+			to read.  The data is sent in parts if it does not fit, so this is
+			done after each part, as the rest cannot be written until the
+			reader has made space for it. */
+			xReceiver = pxStreamBuffer->xTaskWaitingToReceive;
+
+			if( ( xReceiver != NULL ) && ( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes ) )
+			{
+				( void ) xTaskNotifyGive( xReceiver );
+			}
+		}
+
+		if( ( xWritten == xDataLengthBytes ) || ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE ) )
+		{
+			break;
+		}
+
+		/* The buffer is full.  Wait for the reader to make space, unless it
+		did so after the write above. */
+		pxStreamBuffer->xTaskWaitingToSend = xTaskGetCurrentTaskHandle();
+		portMEMORY_BARRIER();
+
+		if( xStreamBufferSpacesAvailable( xStreamBuffer ) == 0 )
+		{
+			( void ) ulTaskNotifyTake( pdTRUE, xTicksToWait );
+		}
+
+		pxStreamBuffer->xTaskWaitingToSend = NULL;
+	}
+
+	return xWritten;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSendFromISR( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+xSTREAM_BUFFER *pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xWritten;
+xTaskHandle xReceiver;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( !( ( pvTxData == NULL ) && ( xDataLengthBytes > 0 ) ) );
+
+	xWritten = prvWriteBytes( pxStreamBuffer, ( const unsigned char * ) pvTxData, xDataLengthBytes );
+
+	if( xWritten > 0 )
+	{
+		xReceiver = pxStreamBuffer->xTaskWaitingToReceive;
+
+		if( ( xReceiver != NULL ) && ( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes ) )
+		{
+			vTaskNotifyGiveFromISR( xReceiver, pxHigherPriorityTaskWoken );
+		}
+	}
+
+	return xWritten;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceive( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, portTickType xTicksToWait )
+{
+xSTREAM_BUFFER *pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xRead;
+xTaskHandle xSender;
+xTimeOutType xTimeOut;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( !( ( pvRxData == NULL ) && ( xBufferLengthBytes > 0 ) ) );
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	while( prvBytesInBuffer( pxStreamBuffer ) == 0 )
+	{
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+		{
+			break;
+		}
+
+		/* Wait for the writer to reach the trigger level, unless it wrote
+		something after the buffer was last looked at. */
+		pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+		portMEMORY_BARRIER();
+
+		if( prvBytesInBuffer( pxStreamBuffer ) == 0 )
+		{
+			( void ) ulTaskNotifyTake( pdTRUE, xTicksToWait );
+		}
+
+		pxStreamBuffer->xTaskWaitingToReceive = NULL;
+	}
+
+	xRead = prvReadBytes( pxStreamBuffer, ( unsigned char * ) pvRxData, xBufferLengthBytes );
+
+	if( xRead > 0 )
+	{
+		xSender = pxStreamBuffer->xTaskWaitingToSend;
+
+		if( xSender != NULL )
+		{
+			( void ) xTaskNotifyGive( xSender );
+		}
+	}
+
+	return xRead;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceiveFromISR( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+xSTREAM_BUFFER *pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xRead;
+xTaskHandle xSender;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( !( ( pvRxData == NULL ) && ( xBufferLengthBytes > 0 ) ) );
+
+	xRead = prvReadBytes( pxStreamBuffer, ( unsigned char * ) pvRxData, xBufferLengthBytes );
+
+	if( xRead > 0 )
+	{
+		xSender = pxStreamBuffer->xTaskWaitingToSend;
+
+		if( xSender != NULL )
+		{
+			vTaskNotifyGiveFromISR( xSender, pxHigherPriorityTaskWoken );
+		}
+	}
+
+	return xRead;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferBytesAvailable( xStreamBufferHandle xStreamBuffer )
+{
+	configASSERT( xStreamBuffer );
+
+	return prvBytesInBuffer( ( xSTREAM_BUFFER * ) xStreamBuffer );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSpacesAvailable( xStreamBufferHandle xStreamBuffer )
+{
+xSTREAM_BUFFER *pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+
+	configASSERT( pxStreamBuffer );
+
+	return ( pxStreamBuffer->xLength - ( size_t ) 1 ) - prvBytesInBuffer( pxStreamBuffer );
+}
+/*-----------------------------------------------------------*/
+
+void vStreamBufferSetTriggerLevel( xStreamBufferHandle xStreamBuffer, size_t xTriggerLevelBytes )
+{
+xSTREAM_BUFFER *pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+
+	configASSERT( pxStreamBuffer );
+
+	/* A trigger level of 0 would wake the reader with nothing to read, and
+	one larger than the buffer would never be reached. */
+	if( xTriggerLevelBytes == 0 )
+	{
+		xTriggerLevelBytes = 1;
+	}
+	else if( xTriggerLevelBytes > ( pxStreamBuffer->xLength - ( size_t ) 1 ) )
+	{
+		xTriggerLevelBytes = pxStreamBuffer->xLength - ( size_t ) 1;
+	}
+
+	pxStreamBuffer->xTriggerLevelBytes = xTriggerLevelBytes;
+}
+/*-----------------------------------------------------------*/
+
+void vStreamBufferDiscard( xStreamBufferHandle xStreamBuffer )
+{
+xSTREAM_BUFFER *pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+xTaskHandle xSender;
+
+	configASSERT( pxStreamBuffer );
+
+	/* Everything up to the head is read.  The writer may move the head at any
+	time, so whatever it writes after this point is kept. */
+	pxStreamBuffer->xTail = pxStreamBuffer->xHead;
+
+	xSender = pxStreamBuffer->xTaskWaitingToSend;
+
+	if( xSender != NULL )
+	{
+		( void ) xTaskNotifyGive( xSender );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewStreamBuffer( xSTREAM_BUFFER *pxStreamBuffer, unsigned char *pucBuffer, size_t xBufferSizeBytes, size_t xTriggerLevelBytes )
+{
+	pxStreamBuffer->xTail = 0;
+	pxStreamBuffer->xHead = 0;
+	pxStreamBuffer->xLength = xBufferSizeBytes + ( size_t ) 1;
+	pxStreamBuffer->xTaskWaitingToReceive = NULL;
+	pxStreamBuffer->xTaskWaitingToSend = NULL;
+	pxStreamBuffer->pucBuffer = pucBuffer;
+
+	vStreamBufferSetTriggerLevel( ( xStreamBufferHandle ) pxStreamBuffer, xTriggerLevelBytes );
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvBytesInBuffer( const xSTREAM_BUFFER *pxStreamBuffer )
+{
+size_t xCount;
+
+	/* Each index is read once, as the other side may be moving it. */
+	xCount = pxStreamBuffer->xHead;
+	xCount -= pxStreamBuffer->xTail;
+
+	if( xCount >= pxStreamBuffer->xLength )
+	{
+		/* The head has wrapped and the tail has not. */
+		xCount += pxStreamBuffer->xLength;
+	}
+
+	return xCount;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvWriteBytes( xSTREAM_BUFFER *pxStreamBuffer, const unsigned char *pucData, size_t xCount )
+{
+size_t xHead = pxStreamBuffer->xHead, xSpace, xFirst;
+
+	xSpace = ( pxStreamBuffer->xLength - ( size_t ) 1 ) - prvBytesInBuffer( pxStreamBuffer );
+
+	if( xCount > xSpace )
+	{
+		xCount = xSpace;
+	}
+
+	if( xCount > 0 )
+	{
+		/* Up to the end of the ring, then any that is left from the start. */
+		xFirst = pxStreamBuffer->xLength - xHead;
+
+		if( xFirst > xCount )
+		{
+			xFirst = xCount;
+		}
+
+		memcpy( &( pxStreamBuffer->pucBuffer[ xHead ] ), pucData, xFirst );
+
+		if( xCount > xFirst )
+		{
+			memcpy( pxStreamBuffer->pucBuffer, &( pucData[ xFirst ] ), xCount - xFirst );
+		}
+
+		xHead += xCount;
+
+		if( xHead >= pxStreamBuffer->xLength )
+		{
+			xHead -= pxStreamBuffer->xLength;
+		}
+
+		/* The bytes must be in the ring before the reader can see the new
+		head. */
+		portMEMORY_BARRIER();
+		pxStreamBuffer->xHead = xHead;
+		portMEMORY_BARRIER();
+	}
+
+	return xCount;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvReadBytes( xSTREAM_BUFFER *pxStreamBuffer, unsigned char *pucData, size_t xCount )
+{
+size_t xTail = pxStreamBuffer->xTail, xAvailable, xFirst;
+
+	xAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+	if( xCount > xAvailable )
+	{
+		xCount = xAvailable;
+	}
+
+	if( xCount > 0 )
+	{
+		/* The head was read before the bytes it covers. */
+		portMEMORY_BARRIER();
+
+		xFirst = pxStreamBuffer->xLength - xTail;
+
+		if( xFirst > xCount )
+		{
+			xFirst = xCount;
+		}
+
+		memcpy( pucData, &( pxStreamBuffer->pucBuffer[ xTail ] ), xFirst );
+
+		if( xCount > xFirst )
+		{
+			memcpy( &( pucData[ xFirst ] ), pxStreamBuffer->pucBuffer, xCount - xFirst );
+		}
+
+		xTail += xCount;
+
+		if( xTail >= pxStreamBuffer->xLength )
+		{
+			xTail -= pxStreamBuffer->xLength;
+		}
+
+		/* The bytes must be copied out before the writer can reuse them. */
+		portMEMORY_BARRIER();
+		pxStreamBuffer->xTail = xTail;
+		portMEMORY_BARRIER();
+	}
+
+	return xCount;
+}
+/*-----------------------------------------------------------*/
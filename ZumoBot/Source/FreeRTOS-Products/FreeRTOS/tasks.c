@@ -113,11 +113,39 @@ typedef struct tskTaskControlBlock
 	#endif
 
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
-		unsigned long ulRunTimeCounter;		/*< Used for calculating how much CPU time each task is utilising. */
+		unsigned long long ullRunTimeCounter;	/*< The run time counter counts the task has run for, kept in 64 bits so it does not overflow. */
+		unsigned long ulMaxBurst;			/*< The longest the task has run for before another task was switched in. */
+		unsigned long ulSwitchesIn;			/*< The number of times the task has been switched in. */
+	#endif
+
+	#if ( INCLUDE_uxTaskGetStackStats == 1 )
+		unsigned short usStackDepth;			/*< The size of the stack in words, as given when the task was created. */
+	#endif
+
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+		volatile unsigned long ulNotifiedValue;	/*< The value sent by xTaskNotify() and friends. */
+		volatile unsigned char ucNotifyState;	/*< One of the taskNOTIFICATION_ states below. */
+	#endif
+
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char ucStaticallyAllocated;	/*< pdTRUE if the TCB and stack were given by xTaskCreateStatic(), so must not be freed. */
 	#endif
 
 } tskTCB;
 
+/*
+ * The values of ucNotifyState.
+ */
+#define taskNOT_WAITING_NOTIFICATION	( ( unsigned char ) 0 )
+#define taskWAITING_NOTIFICATION		( ( unsigned char ) 1 )
+#define taskNOTIFICATION_RECEIVED		( ( unsigned char ) 2 )
+
+/*
+ * The slots of the delay wheel.  A wake time selects the slot of its low
+ * bits.
+ */
+#define tskDELAY_WHEEL_SLOTS			( ( portTickType ) 1U << configDELAY_WHEEL_BITS )
+#define tskDELAY_WHEEL_MASK				( tskDELAY_WHEEL_SLOTS - ( portTickType ) 1U )
 
 /*
  * Some kernel aware debuggers require data to be viewed to be global, rather
@@ -137,6 +165,13 @@ PRIVILEGED_DATA static xList xDelayedTaskList1;							/*< Delayed tasks. */
 PRIVILEGED_DATA static xList xDelayedTaskList2;							/*< Delayed tasks (two lists are used - one for delays that have overflowed the current tick count. */
 PRIVILEGED_DATA static xList * volatile pxDelayedTaskList ;				/*< Points to the delayed task list currently being used. */
 PRIVILEGED_DATA static xList * volatile pxOverflowDelayedTaskList;		/*< Points to the delayed task list currently being used to hold tasks that have overflowed the current tick count. */
+
+#if ( configUSE_DELAY_WHEEL == 1 )
+
+	PRIVILEGED_DATA static xList xDelayWheel[ tskDELAY_WHEEL_SLOTS ];	/*< Delayed tasks due within one turn of the wheel, each in the slot of its wake time. */
+
+#endif
+
 PRIVILEGED_DATA static xList xPendingReadyList;							/*< Tasks that have been readied while the scheduler was suspended.  They will be moved to the ready queue when the scheduler is resumed. */
 
 #if ( INCLUDE_vTaskDelete == 1 )
@@ -158,6 +193,14 @@ PRIVILEGED_DATA static xList xPendingReadyList;							/*< Tasks that have been r
 	
 #endif
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	/* The idle task is created in these rather than on the heap. */
+	PRIVILEGED_DATA static xStaticTask xIdleTaskBuffer;
+	PRIVILEGED_DATA static portSTACK_TYPE xIdleTaskStack[ tskIDLE_STACK_SIZE ];
+
+#endif
+
 /* File private variables. --------------------------------*/
 PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxCurrentNumberOfTasks 	= ( unsigned portBASE_TYPE ) 0U;
 PRIVILEGED_DATA static volatile portTickType xTickCount 						= ( portTickType ) 0U;
@@ -173,9 +216,19 @@ PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType )
 
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
-	PRIVILEGED_DATA static char pcStatsString[ 50 ] ;
 	PRIVILEGED_DATA static unsigned long ulTaskSwitchedInTime = 0UL;	/*< Holds the value of a timer/counter the last time a task was switched in. */
-	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long ulTotalRunTime ) PRIVILEGED_FUNCTION;
+	PRIVILEGED_DATA static unsigned long ulTaskBurstTime = 0UL;			/*< How long the running task has run since another task was last switched in. */
+	PRIVILEGED_DATA static unsigned long long ullTotalRunTime = 0ULL;	/*< The run time counter counts since the scheduler was started, up to the last context switch. */
+	static unsigned portBASE_TYPE prvGetRunTimeStatsForTasksInList( xTaskRunTimeStats *pxStats, unsigned portBASE_TYPE uxMaxTasks, xList *pxList, unsigned long ulRunningTime ) PRIVILEGED_FUNCTION;
+
+	/* Read the run time counter into ulCounter.  Only the difference between
+	two readings is used, which is correct across the counter wrapping as long
+	as no task runs for a whole wrap without being switched out. */
+	#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+		#define taskGET_RUN_TIME_COUNTER_VALUE( ulCounter ) portALT_GET_RUN_TIME_COUNTER_VALUE( ulCounter )
+	#else
+		#define taskGET_RUN_TIME_COUNTER_VALUE( ulCounter ) ( ulCounter ) = portGET_RUN_TIME_COUNTER_VALUE()
+	#endif
 
 #endif
 
@@ -197,6 +250,70 @@ PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType )
 
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
+
+	/* uxTopReadyPriority holds the priority of the highest priority ready
+	state task, or a lower priority if the tasks at that priority have since
+	left the ready state. */
+	#define taskRECORD_READY_PRIORITY( uxPriority )														\
+	{																									\
+		if( ( uxPriority ) > uxTopReadyPriority )														\
+		{																								\
+			uxTopReadyPriority = ( uxPriority );														\
+		}																								\
+	}
+
+	/* Find the highest priority queue that contains ready tasks, walking down
+	from uxTopReadyPriority, then select the next task from it.
+	listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the tasks of the
+	same priority get an equal share of the processor time. */
+	#define taskSELECT_HIGHEST_PRIORITY_TASK()															\
+	{																									\
+		while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) )						\
+		{																								\
+			configASSERT( uxTopReadyPriority );															\
+			--uxTopReadyPriority;																		\
+		}																								\
+																										\
+		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopReadyPriority ] ) );		\
+	}
+
+	/* uxTopReadyPriority is lowered lazily by taskSELECT_HIGHEST_PRIORITY_TASK(),
+	so there is nothing to do when a task leaves a ready list. */
+	#define taskRESET_READY_PRIORITY( uxPriority )
+
+#else
+
+	/* uxTopReadyPriority holds a bitmap with bit n set while the ready list
+	of priority n is not empty, so the highest priority ready task is found
+	with one count leading zeros instruction whatever the priorities in
+	use. */
+	#define taskRECORD_READY_PRIORITY( uxPriority )	portRECORD_READY_PRIORITY( uxPriority, uxTopReadyPriority )
+
+	#define taskSELECT_HIGHEST_PRIORITY_TASK()															\
+	{																									\
+	unsigned portBASE_TYPE uxTopPriority;																\
+																										\
+		portGET_HIGHEST_PRIORITY( uxTopPriority, uxTopReadyPriority );									\
+		configASSERT( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ uxTopPriority ] ) ) > 0 );			\
+		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );			\
+	}
+
+	/* Called after a task is removed from a list.  If the task was the last
+	in the ready list of its priority the bit of that priority is cleared.  It
+	does no harm if the task was in another list, as the bit is then already
+	clear whenever the ready list is empty. */
+	#define taskRESET_READY_PRIORITY( uxPriority )														\
+	{																									\
+		if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ ( uxPriority ) ] ) ) == 0 )					\
+		{																								\
+			portRESET_READY_PRIORITY( ( uxPriority ), ( uxTopReadyPriority ) );							\
+		}																								\
+	}
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+/*-----------------------------------------------------------*/
+
 /*
  * Place the task represented by pxTCB into the appropriate ready queue for
  * the task.  It is inserted at the end of the list.  One quirk of this is
@@ -205,13 +322,12 @@ PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType )
  * executing task has been rescheduled.
  */
 #define prvAddTaskToReadyQueue( pxTCB )																					\
-	if( ( pxTCB )->uxPriority > uxTopReadyPriority )																	\
-	{																													\
-		uxTopReadyPriority = ( pxTCB )->uxPriority;																		\
-	}																													\
+	taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );																	\
 	vListInsertEnd( ( xList * ) &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xGenericListItem ) )
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_DELAY_WHEEL == 0 )
+
 /*
  * Macro that looks at the list of tasks that are currently delayed to see if
  * any require waking.
@@ -271,6 +387,64 @@ portTickType xItemValue;																\
 		}																				\
 	}																					\
 }
+
+#else
+
+/*
+ * Macro that wakes the tasks that are due at the new tick count.
+ *
+ * A task is only placed in the delay wheel when it is due before the tick
+ * count comes round to the same slot again, so every task in the slot of the
+ * tick count is due now, and the tasks in the other slots are not looked at.
+ * Tasks due further ahead wait in the delayed list, in the order of their
+ * wake time, and are moved into the wheel as soon as they are due within one
+ * turn of it.  xNextTaskUnblockTime is the wake time of the first of them.
+ * Either way the time taken depends only on the number of tasks that move,
+ * not on the number that are delayed.
+ */
+#define prvCheckDelayedTasks()															\
+{																						\
+portTickType xItemValue;																\
+xList *pxSlot;																			\
+																						\
+	while( ( portTickType ) ( xNextTaskUnblockTime - xTickCount ) < tskDELAY_WHEEL_SLOTS )	\
+	{																					\
+		if( listLIST_IS_EMPTY( pxDelayedTaskList ) != pdFALSE )							\
+		{																				\
+			xNextTaskUnblockTime = portMAX_DELAY;										\
+			break;																		\
+		}																				\
+																						\
+		pxTCB = ( tskTCB * ) listGET_OWNER_OF_HEAD_ENTRY( pxDelayedTaskList );			\
+		xItemValue = listGET_LIST_ITEM_VALUE( &( pxTCB->xGenericListItem ) );			\
+																						\
+		if( ( portTickType ) ( xItemValue - xTickCount ) >= tskDELAY_WHEEL_SLOTS )		\
+		{																				\
+			xNextTaskUnblockTime = xItemValue;											\
+			break;																		\
+		}																				\
+																						\
+		vListRemove( &( pxTCB->xGenericListItem ) );									\
+		vListInsertEnd( ( xList * ) &( xDelayWheel[ xItemValue & tskDELAY_WHEEL_MASK ] ), &( pxTCB->xGenericListItem ) );	\
+	}																					\
+																						\
+	pxSlot = ( xList * ) &( xDelayWheel[ xTickCount & tskDELAY_WHEEL_MASK ] );			\
+	while( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )										\
+	{																					\
+		pxTCB = ( tskTCB * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );						\
+		configASSERT( listGET_LIST_ITEM_VALUE( &( pxTCB->xGenericListItem ) ) == xTickCount );	\
+		vListRemove( &( pxTCB->xGenericListItem ) );									\
+																						\
+		/* Is the task waiting on an event also? */									\
+		if( pxTCB->xEventListItem.pvContainer != NULL )									\
+		{																				\
+			vListRemove( &( pxTCB->xEventListItem ) );									\
+		}																				\
+		prvAddTaskToReadyQueue( pxTCB );												\
+	}																					\
+}
+
+#endif /* configUSE_DELAY_WHEEL */
 /*-----------------------------------------------------------*/
 
 /*
@@ -338,12 +512,51 @@ static void prvCheckTasksWaitingTermination( void ) PRIVILEGED_FUNCTION;
  */
 static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake ) PRIVILEGED_FUNCTION;
 
+/*
+ * Return the number of ticks until a task is next due to unblock, or 0 if a
+ * task other than the idle task is ready to run, so the idle task knows how
+ * long it can sleep for.
+ */
+#if ( configUSE_TICKLESS_IDLE == 1 )
+	static portTickType prvGetExpectedIdleTime( void ) PRIVILEGED_FUNCTION;
+#endif
+
+/*
+ * Return the number of ticks until a task is next due to unblock, whether it
+ * is in the delay wheel or the delayed list.
+ */
+#if ( configUSE_TICKLESS_IDLE == 1 )
+	static portTickType prvGetTicksToNextUnblock( void ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * Allocates memory from the heap for a TCB and associated stack.  Checks the
  * allocation was successful.
  */
 static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer ) PRIVILEGED_FUNCTION;
 
+/*
+ * Called by xTaskGenericCreate() and xTaskCreateStatic() once the TCB and
+ * stack of the new task exist.  Initialises them and adds the task to its
+ * ready list.
+ */
+static void prvInitialiseNewTask( tskTCB *pxNewTCB, pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, const xMemoryRegion * const xRegions ) PRIVILEGED_FUNCTION;
+
+/*
+ * Used by the task notification functions.  prvBlockForNotification() moves
+ * the calling task from its ready list to the delayed list, or to the
+ * suspended list if xTicksToWait is portMAX_DELAY.  prvUpdateNotifiedValue()
+ * performs eAction on the notification value of pxTCB, and returns pdFAIL if
+ * the value could not be written.  Both must be called with interrupts
+ * masked.
+ */
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	static void prvBlockForNotification( portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+	static signed portBASE_TYPE prvUpdateNotifiedValue( tskTCB * const pxTCB, unsigned long ulValue, eNotifyAction eAction, unsigned char ucOriginalState ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * Called from vTaskList.  vListTasks details all the tasks currently under
  * control of the scheduler.  The tasks may be in one of a number of lists.
@@ -364,12 +577,22 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
  * This function determines the 'high water mark' of the task stack by
  * determining how much of the stack remains at the original preset value.
  */
-#if ( ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) )
+#if ( ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) || ( INCLUDE_uxTaskGetStackStats == 1 ) )
 
 	static unsigned short usTaskCheckFreeStackSpace( const unsigned char * pucStackByte ) PRIVILEGED_FUNCTION;
 
 #endif
 
+/*
+ * Copy the stack depth and high water mark of each task in pxList into
+ * pxStats, up to uxMaxTasks of them.  Returns the number copied.
+ */
+#if ( INCLUDE_uxTaskGetStackStats == 1 )
+
+	static unsigned portBASE_TYPE prvGetStackStatsForTasksInList( xTaskStackStats *pxStats, unsigned portBASE_TYPE uxMaxTasks, xList *pxList ) PRIVILEGED_FUNCTION;
+
+#endif
+
 
 /*lint +e956 */
 
@@ -393,151 +616,192 @@ tskTCB * pxNewTCB;
 
 	if( pxNewTCB != NULL )
 	{
-		portSTACK_TYPE *pxTopOfStack;
+		#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+			pxNewTCB->ucStaticallyAllocated = ( unsigned char ) pdFALSE;
+		}
+		#endif
 
-		#if( portUSING_MPU_WRAPPERS == 1 )
-			/* Should the task be created in privileged mode? */
-			portBASE_TYPE xRunPrivileged;
-			if( ( uxPriority & portPRIVILEGE_BIT ) != 0U )
-			{
-				xRunPrivileged = pdTRUE;
-			}
-			else
-			{
-				xRunPrivileged = pdFALSE;
-			}
-			uxPriority &= ~portPRIVILEGE_BIT;
-		#endif /* portUSING_MPU_WRAPPERS == 1 */
+		prvInitialiseNewTask( pxNewTCB, pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, xRegions );
+		xReturn = pdPASS;
+	}
+	else
+	{
+		xReturn = errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+		traceTASK_CREATE_FAILED();
+	}
 
-		/* Calculate the top of stack address.  This depends on whether the
-		stack grows from high memory to low (as per the 80x86) or visa versa.
-		portSTACK_GROWTH is used to make the result positive or negative as
-		required by the port. */
-		#if( portSTACK_GROWTH < 0 )
-		{
-			pxTopOfStack = pxNewTCB->pxStack + ( usStackDepth - ( unsigned short ) 1 );
-			pxTopOfStack = ( portSTACK_TYPE * ) ( ( ( portPOINTER_SIZE_TYPE ) pxTopOfStack ) & ( ( portPOINTER_SIZE_TYPE ) ~portBYTE_ALIGNMENT_MASK  ) );
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
 
-			/* Check the alignment of the calculated top of stack is correct. */
-			configASSERT( ( ( ( unsigned long ) pxTopOfStack & ( unsigned long ) portBYTE_ALIGNMENT_MASK ) == 0UL ) );
-		}
-		#else
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xTaskHandle xTaskCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, portSTACK_TYPE *puxStackBuffer, xStaticTask *pxTaskBuffer )
+	{
+	tskTCB *pxNewTCB = NULL;
+
+		configASSERT( pxTaskCode );
+		configASSERT( ( uxPriority < configMAX_PRIORITIES ) );
+		configASSERT( puxStackBuffer );
+		configASSERT( pxTaskBuffer );
+
+		/* xStaticTask must have the same size as the TCB it stands in for. */
+		configASSERT( sizeof( xStaticTask ) == sizeof( tskTCB ) );
+
+		if( ( puxStackBuffer != NULL ) && ( pxTaskBuffer != NULL ) )
 		{
-			pxTopOfStack = pxNewTCB->pxStack;
-			
-			/* Check the alignment of the stack buffer is correct. */
-			configASSERT( ( ( ( unsigned long ) pxNewTCB->pxStack & ( unsigned long ) portBYTE_ALIGNMENT_MASK ) == 0UL ) );
+			pxNewTCB = ( tskTCB * ) pxTaskBuffer;
+			pxNewTCB->pxStack = puxStackBuffer;
+			pxNewTCB->ucStaticallyAllocated = ( unsigned char ) pdTRUE;
 
-			/* If we want to use stack checking on architectures that use
-			a positive stack growth direction then we also need to store the
-			other extreme of the stack space. */
-			pxNewTCB->pxEndOfStack = pxNewTCB->pxStack + ( usStackDepth - 1 );
+			/* Just to help debugging, as prvAllocateTCBAndStack(). */
+			memset( pxNewTCB->pxStack, ( int ) tskSTACK_FILL_BYTE, ( size_t ) usStackDepth * sizeof( portSTACK_TYPE ) );
+
+			prvInitialiseNewTask( pxNewTCB, pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, NULL, NULL );
 		}
-		#endif
 
-		/* Setup the newly allocated TCB with the initial state of the task. */
-		prvInitialiseTCBVariables( pxNewTCB, pcName, uxPriority, xRegions, usStackDepth );
+		return ( xTaskHandle ) pxNewTCB;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewTask( tskTCB *pxNewTCB, pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, const xMemoryRegion * const xRegions )
+{
+	portSTACK_TYPE *pxTopOfStack;
 
-		/* Initialize the TCB stack to look as if the task was already running,
-		but had been interrupted by the scheduler.  The return address is set
-		to the start of the task function. Once the stack has been initialised
-		the	top of stack variable is updated. */
-		#if( portUSING_MPU_WRAPPERS == 1 )
+	#if( portUSING_MPU_WRAPPERS == 1 )
+		/* Should the task be created in privileged mode? */
+		portBASE_TYPE xRunPrivileged;
+		if( ( uxPriority & portPRIVILEGE_BIT ) != 0U )
 		{
-			pxNewTCB->pxTopOfStack = pxPortInitialiseStack( pxTopOfStack, pxTaskCode, pvParameters, xRunPrivileged );
+			xRunPrivileged = pdTRUE;
 		}
-		#else
+		else
 		{
-			pxNewTCB->pxTopOfStack = pxPortInitialiseStack( pxTopOfStack, pxTaskCode, pvParameters );
+			xRunPrivileged = pdFALSE;
 		}
-		#endif
+		uxPriority &= ~portPRIVILEGE_BIT;
+	#endif /* portUSING_MPU_WRAPPERS == 1 */
 
-		/* Check the alignment of the initialised stack. */
-		portALIGNMENT_ASSERT_pxCurrentTCB( ( ( ( unsigned long ) pxNewTCB->pxTopOfStack & ( unsigned long ) portBYTE_ALIGNMENT_MASK ) == 0UL ) );
+	/* Calculate the top of stack address.  This depends on whether the
+	stack grows from high memory to low (as per the 80x86) or visa versa.
+	portSTACK_GROWTH is used to make the result positive or negative as
+	required by the port. */
+	#if( portSTACK_GROWTH < 0 )
+	{
+		pxTopOfStack = pxNewTCB->pxStack + ( usStackDepth - ( unsigned short ) 1 );
+		pxTopOfStack = ( portSTACK_TYPE * ) ( ( ( portPOINTER_SIZE_TYPE ) pxTopOfStack ) & ( ( portPOINTER_SIZE_TYPE ) ~portBYTE_ALIGNMENT_MASK  ) );
 
-		if( ( void * ) pxCreatedTask != NULL )
-		{
-			/* Pass the TCB out - in an anonymous way.  The calling function/
-			task can use this as a handle to delete the task later if
-			required.*/
-			*pxCreatedTask = ( xTaskHandle ) pxNewTCB;
-		}
+		/* Check the alignment of the calculated top of stack is correct. */
+		configASSERT( ( ( ( unsigned long ) pxTopOfStack & ( unsigned long ) portBYTE_ALIGNMENT_MASK ) == 0UL ) );
+	}
+	#else
+	{
+		pxTopOfStack = pxNewTCB->pxStack;
 		
-		/* We are going to manipulate the task queues to add this task to a
-		ready list, so must make sure no interrupts occur. */
-		taskENTER_CRITICAL();
+		/* Check the alignment of the stack buffer is correct. */
+		configASSERT( ( ( ( unsigned long ) pxNewTCB->pxStack & ( unsigned long ) portBYTE_ALIGNMENT_MASK ) == 0UL ) );
+
+		/* If we want to use stack checking on architectures that use
+		a positive stack growth direction then we also need to store the
+		other extreme of the stack space. */
+		pxNewTCB->pxEndOfStack = pxNewTCB->pxStack + ( usStackDepth - 1 );
+	}
+	#endif
+
+	/* Setup the newly allocated TCB with the initial state of the task. */
+	prvInitialiseTCBVariables( pxNewTCB, pcName, uxPriority, xRegions, usStackDepth );
+
+	/* Initialize the TCB stack to look as if the task was already running,
+	but had been interrupted by the scheduler.  The return address is set
+	to the start of the task function. Once the stack has been initialised
+	the	top of stack variable is updated. */
+	#if( portUSING_MPU_WRAPPERS == 1 )
+	{
+		pxNewTCB->pxTopOfStack = pxPortInitialiseStack( pxTopOfStack, pxTaskCode, pvParameters, xRunPrivileged );
+	}
+	#else
+	{
+		pxNewTCB->pxTopOfStack = pxPortInitialiseStack( pxTopOfStack, pxTaskCode, pvParameters );
+	}
+	#endif
+
+	/* Check the alignment of the initialised stack. */
+	portALIGNMENT_ASSERT_pxCurrentTCB( ( ( ( unsigned long ) pxNewTCB->pxTopOfStack & ( unsigned long ) portBYTE_ALIGNMENT_MASK ) == 0UL ) );
+
+	if( ( void * ) pxCreatedTask != NULL )
+	{
+		/* Pass the TCB out - in an anonymous way.  The calling function/
+		task can use this as a handle to delete the task later if
+		required.*/
+		*pxCreatedTask = ( xTaskHandle ) pxNewTCB;
+	}
+	
+	/* We are going to manipulate the task queues to add this task to a
+	ready list, so must make sure no interrupts occur. */
+	taskENTER_CRITICAL();
+	{
+		uxCurrentNumberOfTasks++;
+		if( pxCurrentTCB == NULL )
 		{
-			uxCurrentNumberOfTasks++;
-			if( pxCurrentTCB == NULL )
-			{
-				/* There are no other tasks, or all the other tasks are in
-				the suspended state - make this the current task. */
-				pxCurrentTCB =  pxNewTCB;
+			/* There are no other tasks, or all the other tasks are in
+			the suspended state - make this the current task. */
+			pxCurrentTCB =  pxNewTCB;
 
-				if( uxCurrentNumberOfTasks == ( unsigned portBASE_TYPE ) 1 )
-				{
-					/* This is the first task to be created so do the preliminary
-					initialisation required.  We will not recover if this call
-					fails, but we will report the failure. */
-					prvInitialiseTaskLists();
-				}
+			if( uxCurrentNumberOfTasks == ( unsigned portBASE_TYPE ) 1 )
+			{
+				/* This is the first task to be created so do the preliminary
+				initialisation required.  We will not recover if this call
+				fails, but we will report the failure. */
+				prvInitialiseTaskLists();
 			}
-			else
+		}
+		else
+		{
+			/* If the scheduler is not already running, make this task the
+			current task if it is the highest priority task to be created
+			so far. */
+			if( xSchedulerRunning == pdFALSE )
 			{
-				/* If the scheduler is not already running, make this task the
-				current task if it is the highest priority task to be created
-				so far. */
-				if( xSchedulerRunning == pdFALSE )
+				if( pxCurrentTCB->uxPriority <= uxPriority )
 				{
-					if( pxCurrentTCB->uxPriority <= uxPriority )
-					{
-						pxCurrentTCB = pxNewTCB;
-					}
+					pxCurrentTCB = pxNewTCB;
 				}
 			}
+		}
 
-			/* Remember the top priority to make context switching faster.  Use
-			the priority in pxNewTCB as this has been capped to a valid value. */
-			if( pxNewTCB->uxPriority > uxTopUsedPriority )
-			{
-				uxTopUsedPriority = pxNewTCB->uxPriority;
-			}
+		/* Remember the top priority to make context switching faster.  Use
+		the priority in pxNewTCB as this has been capped to a valid value. */
+		if( pxNewTCB->uxPriority > uxTopUsedPriority )
+		{
+			uxTopUsedPriority = pxNewTCB->uxPriority;
+		}
 
-			#if ( configUSE_TRACE_FACILITY == 1 )
-			{
-				/* Add a counter into the TCB for tracing only. */
-				pxNewTCB->uxTCBNumber = uxTCBNumber;
-			}
-			#endif
-			uxTCBNumber++;
+		#if ( configUSE_TRACE_FACILITY == 1 )
+		{
+			/* Add a counter into the TCB for tracing only. */
+			pxNewTCB->uxTCBNumber = uxTCBNumber;
+		}
+		#endif
+		uxTCBNumber++;
 
-			prvAddTaskToReadyQueue( pxNewTCB );
+		prvAddTaskToReadyQueue( pxNewTCB );
 
-			xReturn = pdPASS;
-			traceTASK_CREATE( pxNewTCB );
-		}
-		taskEXIT_CRITICAL();
-	}
-	else
-	{
-		xReturn = errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
-		traceTASK_CREATE_FAILED();
+		traceTASK_CREATE( pxNewTCB );
 	}
+	taskEXIT_CRITICAL();
 
-	if( xReturn == pdPASS )
+	if( xSchedulerRunning != pdFALSE )
 	{
-		if( xSchedulerRunning != pdFALSE )
+		/* If the created task is of a higher priority than the current task
+		then it should run now. */
+		if( pxCurrentTCB->uxPriority < uxPriority )
 		{
-			/* If the created task is of a higher priority than the current task
-			then it should run now. */
-			if( pxCurrentTCB->uxPriority < uxPriority )
-			{
-				portYIELD_WITHIN_API();
-			}
+			portYIELD_WITHIN_API();
 		}
 	}
-
-	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
@@ -564,6 +828,7 @@ tskTCB * pxNewTCB;
 			the termination list and free up any memory allocated by the
 			scheduler for the TCB and stack. */
 			vListRemove( &( pxTCB->xGenericListItem ) );
+			taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 			/* Is the task waiting on an event also? */
 			if( pxTCB->xEventListItem.pvContainer != NULL )
@@ -656,6 +921,7 @@ tskTCB * pxNewTCB;
 				ourselves to the blocked list as the same list item is used for
 				both lists. */
 				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 				prvAddCurrentTaskToDelayedList( xTimeToWake );
 			}
 		}
@@ -702,6 +968,7 @@ tskTCB * pxNewTCB;
 				ourselves to the blocked list as the same list item is used for
 				both lists. */
 				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 				prvAddCurrentTaskToDelayedList( xTimeToWake );
 			}
 			xAlreadyYielded = xTaskResumeAll();
@@ -833,6 +1100,7 @@ tskTCB * pxNewTCB;
 					it to it's new ready list.  As we are in a critical section we
 					can do this even if the scheduler is suspended. */
 					vListRemove( &( pxTCB->xGenericListItem ) );
+					taskRESET_READY_PRIORITY( uxCurrentPriority );
 					prvAddTaskToReadyQueue( pxTCB );
 				}
 
@@ -870,6 +1138,7 @@ tskTCB * pxNewTCB;
 
 			/* Remove task from the ready/delayed list and place in the	suspended list. */
 			vListRemove( &( pxTCB->xGenericListItem ) );
+			taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 			/* Is the task waiting on an event also? */
 			if( pxTCB->xEventListItem.pvContainer != NULL )
@@ -1044,7 +1313,21 @@ void vTaskStartScheduler( void )
 portBASE_TYPE xReturn;
 
 	/* Add the idle task at the lowest priority. */
-	#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	{
+		xTaskHandle xIdle;
+
+		/* The idle task is always there, so is not worth a heap block. */
+		xIdle = xTaskCreateStatic( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), xIdleTaskStack, &xIdleTaskBuffer );
+		xReturn = ( xIdle != NULL ) ? pdPASS : pdFAIL;
+
+		#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+		{
+			xIdleTaskHandle = xIdle;
+		}
+		#endif
+	}
+	#elif ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
 	{
 		/* Create the idle task, storing its handle in xIdleTaskHandle so it can
 		be returned by the xTaskGetIdleTaskHandle() function. */
@@ -1085,6 +1368,15 @@ portBASE_TYPE xReturn;
 		macro must be defined to configure the timer/counter used to generate
 		the run time counter time base. */
 		portCONFIGURE_TIMER_FOR_RUN_TIME_STATS();
+
+		#if ( configGENERATE_RUN_TIME_STATS == 1 )
+		{
+			/* The counter may have been running since long before, so the
+			first task is only charged from here. */
+			taskGET_RUN_TIME_COUNTER_VALUE( ulTaskSwitchedInTime );
+			( pxCurrentTCB->ulSwitchesIn )++;
+		}
+		#endif
 		
 		/* Setting up the timer tick is hardware specific and thus in the
 		portable interface. */
@@ -1300,6 +1592,20 @@ unsigned portBASE_TYPE uxTaskGetNumberOfTasks( void )
 				prvListTaskWithinSingleList( pcWriteBuffer, ( xList * ) pxOverflowDelayedTaskList, tskBLOCKED_CHAR );
 			}
 
+			#if ( configUSE_DELAY_WHEEL == 1 )
+			{
+			portTickType xSlot;
+
+				for( xSlot = ( portTickType ) 0U; xSlot < tskDELAY_WHEEL_SLOTS; xSlot++ )
+				{
+					if( listLIST_IS_EMPTY( &( xDelayWheel[ xSlot ] ) ) == pdFALSE )
+					{
+						prvListTaskWithinSingleList( pcWriteBuffer, ( xList * ) &( xDelayWheel[ xSlot ] ), tskBLOCKED_CHAR );
+					}
+				}
+			}
+			#endif
+
 			#if( INCLUDE_vTaskDelete == 1 )
 			{
 				if( listLIST_IS_EMPTY( &xTasksWaitingTermination ) == pdFALSE )
@@ -1326,32 +1632,22 @@ unsigned portBASE_TYPE uxTaskGetNumberOfTasks( void )
 
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
-	void vTaskGetRunTimeStats( signed char *pcWriteBuffer )
+	unsigned portBASE_TYPE uxTaskGetRunTimeStats( xTaskRunTimeStats *pxStats, unsigned portBASE_TYPE uxMaxTasks, unsigned long long *pullTotalRunTime )
 	{
-	unsigned portBASE_TYPE uxQueue;
-	unsigned long ulTotalRunTime;
-
-		/* This is a VERY costly function that should be used for debug only.
-		It leaves interrupts disabled for a LONG time. */
+	unsigned portBASE_TYPE uxQueue, uxTask = ( unsigned portBASE_TYPE ) 0U;
+	unsigned long ulNow, ulRunningTime;
+	unsigned long long ullTotal;
 
+		/* The lists are only walked with the scheduler suspended, so no task
+		can be switched in or out while the stats are copied, but interrupts
+		are left enabled. */
 		vTaskSuspendAll();
 		{
-			#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
-				portALT_GET_RUN_TIME_COUNTER_VALUE( ulTotalRunTime );
-			#else
-				ulTotalRunTime = portGET_RUN_TIME_COUNTER_VALUE();
-			#endif
-
-			/* Divide ulTotalRunTime by 100 to make the percentage caluclations
-			simpler in the prvGenerateRunTimeStatsForTasksInList() function. */
-			ulTotalRunTime /= 100UL;
-			
-			/* Run through all the lists that could potentially contain a TCB,
-			generating a table of run timer percentages in the provided
-			buffer. */
-
-			*pcWriteBuffer = ( signed char ) 0x00;
-			strcat( ( char * ) pcWriteBuffer, ( const char * ) "\r\n" );
+			/* The running task has not yet been charged for the time since it
+			was last switched in. */
+			taskGET_RUN_TIME_COUNTER_VALUE( ulNow );
+			ulRunningTime = ulNow - ulTaskSwitchedInTime;
+			ullTotal = ullTotalRunTime + ( unsigned long long ) ulRunningTime;
 
 			uxQueue = uxTopUsedPriority + ( unsigned portBASE_TYPE ) 1U;
 
@@ -1361,25 +1657,39 @@ unsigned portBASE_TYPE uxTaskGetNumberOfTasks( void )
 
 				if( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxQueue ] ) ) == pdFALSE )
 				{
-					prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) &( pxReadyTasksLists[ uxQueue ] ), ulTotalRunTime );
+					uxTask += prvGetRunTimeStatsForTasksInList( &( pxStats[ uxTask ] ), uxMaxTasks - uxTask, ( xList * ) &( pxReadyTasksLists[ uxQueue ] ), ulRunningTime );
 				}
 			}while( uxQueue > ( unsigned short ) tskIDLE_PRIORITY );
 
 			if( listLIST_IS_EMPTY( pxDelayedTaskList ) == pdFALSE )
 			{
-				prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) pxDelayedTaskList, ulTotalRunTime );
+				uxTask += prvGetRunTimeStatsForTasksInList( &( pxStats[ uxTask ] ), uxMaxTasks - uxTask, ( xList * ) pxDelayedTaskList, ulRunningTime );
 			}
 
 			if( listLIST_IS_EMPTY( pxOverflowDelayedTaskList ) == pdFALSE )
 			{
-				prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) pxOverflowDelayedTaskList, ulTotalRunTime );
+				uxTask += prvGetRunTimeStatsForTasksInList( &( pxStats[ uxTask ] ), uxMaxTasks - uxTask, ( xList * ) pxOverflowDelayedTaskList, ulRunningTime );
+			}
+
+			#if ( configUSE_DELAY_WHEEL == 1 )
+			{
+			portTickType xSlot;
+
+				for( xSlot = ( portTickType ) 0U; xSlot < tskDELAY_WHEEL_SLOTS; xSlot++ )
+				{
+					if( listLIST_IS_EMPTY( &( xDelayWheel[ xSlot ] ) ) == pdFALSE )
+					{
+						uxTask += prvGetRunTimeStatsForTasksInList( &( pxStats[ uxTask ] ), uxMaxTasks - uxTask, ( xList * ) &( xDelayWheel[ xSlot ] ), ulRunningTime );
+					}
+				}
 			}
+			#endif
 
 			#if ( INCLUDE_vTaskDelete == 1 )
 			{
 				if( listLIST_IS_EMPTY( &xTasksWaitingTermination ) == pdFALSE )
 				{
-					prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, &xTasksWaitingTermination, ulTotalRunTime );
+					uxTask += prvGetRunTimeStatsForTasksInList( &( pxStats[ uxTask ] ), uxMaxTasks - uxTask, &xTasksWaitingTermination, ulRunningTime );
 				}
 			}
 			#endif
@@ -1388,47 +1698,142 @@ unsigned portBASE_TYPE uxTaskGetNumberOfTasks( void )
 			{
 				if( listLIST_IS_EMPTY( &xSuspendedTaskList ) == pdFALSE )
 				{
-					prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, &xSuspendedTaskList, ulTotalRunTime );
+					uxTask += prvGetRunTimeStatsForTasksInList( &( pxStats[ uxTask ] ), uxMaxTasks - uxTask, &xSuspendedTaskList, ulRunningTime );
 				}
 			}
 			#endif
 		}
 		xTaskResumeAll();
-	}
 
-#endif
-/*----------------------------------------------------------*/
+		/* The shares are worked out after the scheduler is resumed, as the 64
+		bit divisions are slow on a 32 bit part. */
+		for( uxQueue = ( unsigned portBASE_TYPE ) 0U; uxQueue < uxTask; uxQueue++ )
+		{
+			if( ullTotal > 0ULL )
+			{
+				pxStats[ uxQueue ].ulHundredthsOfAPercent = ( unsigned long ) ( ( pxStats[ uxQueue ].ullRunTime * 10000ULL ) / ullTotal );
+			}
+			else
+			{
+				pxStats[ uxQueue ].ulHundredthsOfAPercent = 0UL;
+			}
+		}
 
-#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+		if( pullTotalRunTime != NULL )
+		{
+			*pullTotalRunTime = ullTotal;
+		}
 
-	xTaskHandle xTaskGetIdleTaskHandle( void )
-	{
-		/* If xTaskGetIdleTaskHandle() is called before the scheduler has been
-		started, then xIdleTaskHandle will be NULL. */
-		configASSERT( ( xIdleTaskHandle != NULL ) );
-		return xIdleTaskHandle;
+		return uxTask;
 	}
-	
-#endif
 
-/*-----------------------------------------------------------
- * SCHEDULER INTERNALS AVAILABLE FOR PORTING PURPOSES
- * documented in task.h
- *----------------------------------------------------------*/
+#endif
+/*----------------------------------------------------------*/
 
-void vTaskIncrementTick( void )
-{
-tskTCB * pxTCB;
+#if ( INCLUDE_uxTaskGetStackStats == 1 )
 
-	/* Called by the portable layer each time a tick interrupt occurs.
-	Increments the tick then checks to see if the new tick value will cause any
-	tasks to be unblocked. */
-	if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+	unsigned portBASE_TYPE uxTaskGetStackStats( xTaskStackStats *pxStats, unsigned portBASE_TYPE uxMaxTasks )
 	{
-		++xTickCount;
-		if( xTickCount == ( portTickType ) 0U )
+	unsigned portBASE_TYPE uxQueue, uxTask = ( unsigned portBASE_TYPE ) 0U;
+
+		/* As uxTaskGetRunTimeStats(), the lists are walked with the scheduler
+		suspended.  Each stack is searched from its end for the first word
+		that has been written, so this takes longer the more stack is left
+		unused. */
+		vTaskSuspendAll();
 		{
-			xList *pxTemp;
+			uxQueue = uxTopUsedPriority + ( unsigned portBASE_TYPE ) 1U;
+
+			do
+			{
+				uxQueue--;
+
+				if( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxQueue ] ) ) == pdFALSE )
+				{
+					uxTask += prvGetStackStatsForTasksInList( &( pxStats[ uxTask ] ), uxMaxTasks - uxTask, ( xList * ) &( pxReadyTasksLists[ uxQueue ] ) );
+				}
+			}while( uxQueue > ( unsigned short ) tskIDLE_PRIORITY );
+
+			if( listLIST_IS_EMPTY( pxDelayedTaskList ) == pdFALSE )
+			{
+				uxTask += prvGetStackStatsForTasksInList( &( pxStats[ uxTask ] ), uxMaxTasks - uxTask, ( xList * ) pxDelayedTaskList );
+			}
+
+			if( listLIST_IS_EMPTY( pxOverflowDelayedTaskList ) == pdFALSE )
+			{
+				uxTask += prvGetStackStatsForTasksInList( &( pxStats[ uxTask ] ), uxMaxTasks - uxTask, ( xList * ) pxOverflowDelayedTaskList );
+			}
+
+			#if ( configUSE_DELAY_WHEEL == 1 )
+			{
+			portTickType xSlot;
+
+				for( xSlot = ( portTickType ) 0U; xSlot < tskDELAY_WHEEL_SLOTS; xSlot++ )
+				{
+					if( listLIST_IS_EMPTY( &( xDelayWheel[ xSlot ] ) ) == pdFALSE )
+					{
+						uxTask += prvGetStackStatsForTasksInList( &( pxStats[ uxTask ] ), uxMaxTasks - uxTask, ( xList * ) &( xDelayWheel[ xSlot ] ) );
+					}
+				}
+			}
+			#endif
+
+			#if ( INCLUDE_vTaskDelete == 1 )
+			{
+				if( listLIST_IS_EMPTY( &xTasksWaitingTermination ) == pdFALSE )
+				{
+					uxTask += prvGetStackStatsForTasksInList( &( pxStats[ uxTask ] ), uxMaxTasks - uxTask, &xTasksWaitingTermination );
+				}
+			}
+			#endif
+
+			#if ( INCLUDE_vTaskSuspend == 1 )
+			{
+				if( listLIST_IS_EMPTY( &xSuspendedTaskList ) == pdFALSE )
+				{
+					uxTask += prvGetStackStatsForTasksInList( &( pxStats[ uxTask ] ), uxMaxTasks - uxTask, &xSuspendedTaskList );
+				}
+			}
+			#endif
+		}
+		xTaskResumeAll();
+
+		return uxTask;
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
+#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+
+	xTaskHandle xTaskGetIdleTaskHandle( void )
+	{
+		/* If xTaskGetIdleTaskHandle() is called before the scheduler has been
+		started, then xIdleTaskHandle will be NULL. */
+		configASSERT( ( xIdleTaskHandle != NULL ) );
+		return xIdleTaskHandle;
+	}
+	
+#endif
+
+/*-----------------------------------------------------------
+ * SCHEDULER INTERNALS AVAILABLE FOR PORTING PURPOSES
+ * documented in task.h
+ *----------------------------------------------------------*/
+
+void vTaskIncrementTick( void )
+{
+tskTCB * pxTCB;
+
+	/* Called by the portable layer each time a tick interrupt occurs.
+	Increments the tick then checks to see if the new tick value will cause any
+	tasks to be unblocked. */
+	if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+	{
+		++xTickCount;
+		if( xTickCount == ( portTickType ) 0U )
+		{
+			xList *pxTemp;
 
 			/* Tick count has overflowed so we need to swap the delay lists.
 			If there are any items in pxDelayedTaskList here then there is
@@ -1491,6 +1896,64 @@ tskTCB * pxTCB;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	void vTaskStepTick( portTickType xTicksToJump )
+	{
+		/* No task can have been due to unblock while the tick was stopped,
+		as the sleep ends at the latest when the next task is due. */
+		#if ( configUSE_DELAY_WHEEL == 0 )
+		{
+			configASSERT( ( xTickCount + xTicksToJump ) <= xNextTaskUnblockTime );
+		}
+		#else
+		{
+			/* The slots of the ticks jumped over are not looked at, so the
+			jump must stop short of the next wake time.  The port sleeps for
+			one tick less than the expected idle time, and the tick interrupt
+			pending when it wakes counts the last tick. */
+			configASSERT( xTicksToJump < prvGetTicksToNextUnblock() );
+		}
+		#endif
+		xTickCount += xTicksToJump;
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	eSleepModeStatus eTaskConfirmSleepModeStatus( void )
+	{
+	eSleepModeStatus eReturn = eStandardSleep;
+
+		if( listCURRENT_LIST_LENGTH( &xPendingReadyList ) != ( unsigned portBASE_TYPE ) 0U )
+		{
+			/* An interrupt readied a task while the scheduler was
+			suspended. */
+			eReturn = eAbortSleep;
+		}
+		else if( xMissedYield != pdFALSE )
+		{
+			/* A context switch was asked for while the scheduler was
+			suspended. */
+			eReturn = eAbortSleep;
+		}
+		#if ( INCLUDE_vTaskSuspend == 1 )
+		else if( listCURRENT_LIST_LENGTH( &xSuspendedTaskList ) == ( uxCurrentNumberOfTasks - ( unsigned portBASE_TYPE ) 1U ) )
+		{
+			/* Every task but the idle task is suspended, or blocked with no
+			timeout, which puts it on the suspended list too. */
+			eReturn = eNoTasksWaitingTimeout;
+		}
+		#endif /* INCLUDE_vTaskSuspend */
+
+		return eReturn;
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_APPLICATION_TASK_TAG == 1 )
 
 	void vTaskSetApplicationTaskTag( xTaskHandle xTask, pdTASK_HOOK_CODE pxHookFunction )
@@ -1580,6 +2043,10 @@ tskTCB * pxTCB;
 
 void vTaskSwitchContext( void )
 {
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+	tskTCB *pxPreviousTCB;
+#endif
+
 	if( uxSchedulerSuspended != ( unsigned portBASE_TYPE ) pdFALSE )
 	{
 		/* The scheduler is currently suspended - do not allow a context
@@ -1592,37 +2059,45 @@ void vTaskSwitchContext( void )
 	
 		#if ( configGENERATE_RUN_TIME_STATS == 1 )
 		{
-			unsigned long ulTempCounter;
-			
-				#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
-					portALT_GET_RUN_TIME_COUNTER_VALUE( ulTempCounter );
-				#else
-					ulTempCounter = portGET_RUN_TIME_COUNTER_VALUE();
-				#endif
-	
-				/* Add the amount of time the task has been running to the accumulated
-				time so far.  The time the task started running was stored in
-				ulTaskSwitchedInTime.  Note that there is no overflow protection here
-				so count values are only valid until the timer overflows.  Generally
-				this will be about 1 hour assuming a 1uS timer increment. */
-				pxCurrentTCB->ulRunTimeCounter += ( ulTempCounter - ulTaskSwitchedInTime );
-				ulTaskSwitchedInTime = ulTempCounter;
+		unsigned long ulTempCounter;
+
+			taskGET_RUN_TIME_COUNTER_VALUE( ulTempCounter );
+
+			/* Add the amount of time the task has been running to the
+			accumulated time so far.  The time the task started running was
+			stored in ulTaskSwitchedInTime.  Only the 32 bit difference is
+			taken from the counter, so the 64 bit totals stay correct however
+			often the counter wraps. */
+			ulTempCounter -= ulTaskSwitchedInTime;
+			ulTaskSwitchedInTime += ulTempCounter;
+			pxCurrentTCB->ullRunTimeCounter += ( unsigned long long ) ulTempCounter;
+			ullTotalRunTime += ( unsigned long long ) ulTempCounter;
+			ulTaskBurstTime += ulTempCounter;
+			pxPreviousTCB = pxCurrentTCB;
 		}
 		#endif
 	
 		taskFIRST_CHECK_FOR_STACK_OVERFLOW();
 		taskSECOND_CHECK_FOR_STACK_OVERFLOW();
 	
-		/* Find the highest priority queue that contains ready tasks. */
-		while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) )
+		taskSELECT_HIGHEST_PRIORITY_TASK();
+
+		#if ( configGENERATE_RUN_TIME_STATS == 1 )
 		{
-			configASSERT( uxTopReadyPriority );
-			--uxTopReadyPriority;
+			/* A task that is selected again, such as the only task at its
+			priority at the end of its time slice, carries on the same burst. */
+			if( pxCurrentTCB != pxPreviousTCB )
+			{
+				if( ulTaskBurstTime > pxPreviousTCB->ulMaxBurst )
+				{
+					pxPreviousTCB->ulMaxBurst = ulTaskBurstTime;
+				}
+
+				ulTaskBurstTime = 0UL;
+				( pxCurrentTCB->ulSwitchesIn )++;
+			}
 		}
-	
-		/* listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the tasks of the
-		same priority get an equal share of the processor time. */
-		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopReadyPriority ] ) );
+		#endif
 	
 		traceTASK_SWITCHED_IN();
 	}
@@ -1647,6 +2122,7 @@ portTickType xTimeToWake;
 	to the blocked list as the same list item is used for both lists.  We have
 	exclusive access to the ready lists as the scheduler is locked. */
 	vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+	taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 
 
 	#if ( INCLUDE_vTaskSuspend == 1 )
@@ -1701,6 +2177,7 @@ portTickType xTimeToWake;
 		blocked list as the same list item is used for both lists.  This
 		function is called form a critical section. */
 		vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+		taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 
 		/* Calculate the time at which the task should be woken if the event does
 		not occur.  This may overflow but this doesn't matter. */
@@ -1918,8 +2395,98 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 			vApplicationIdleHook();
 		}
 		#endif
+
+		#if ( configUSE_TICKLESS_IDLE == 1 )
+		{
+		portTickType xExpectedIdleTime;
+
+			/* Stop the tick and sleep until the next task is due, unless that
+			is too soon to be worth it.  The time is checked once without
+			suspending the scheduler, so the scheduler is not suspended and
+			resumed on every pass of the idle loop. */
+			xExpectedIdleTime = prvGetExpectedIdleTime();
+
+			if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+			{
+				vTaskSuspendAll();
+				{
+					/* A tick could have readied a task since the last check,
+					and ticks are not counted while the scheduler is
+					suspended, so check again. */
+					configASSERT( xNextTaskUnblockTime >= xTickCount );
+					xExpectedIdleTime = prvGetExpectedIdleTime();
+
+					if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+					{
+						portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime );
+					}
+				}
+				xTaskResumeAll();
+			}
+		}
+		#endif /* configUSE_TICKLESS_IDLE */
 	}
 } /*lint !e715 pvParameters is not accessed but all task functions require the same prototype. */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	static portTickType prvGetExpectedIdleTime( void )
+	{
+	portTickType xReturn;
+
+		if( pxCurrentTCB->uxPriority > tskIDLE_PRIORITY )
+		{
+			xReturn = 0;
+		}
+		else if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( unsigned portBASE_TYPE ) 1 )
+		{
+			/* Another task shares the idle priority, and is ready, so the
+			tick is needed to share the processor with it. */
+			xReturn = 0;
+		}
+		else
+		{
+			xReturn = prvGetTicksToNextUnblock();
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	static portTickType prvGetTicksToNextUnblock( void )
+	{
+	portTickType xReturn;
+
+		xReturn = xNextTaskUnblockTime - xTickCount;
+
+		#if ( configUSE_DELAY_WHEEL == 1 )
+		{
+		portTickType xTicks;
+
+			/* xNextTaskUnblockTime is only the first of the tasks still in
+			the delayed list, so look for an earlier one in the wheel.  The
+			slot of the tick count itself was emptied when the tick count
+			reached it. */
+			for( xTicks = ( portTickType ) 1U; ( xTicks < tskDELAY_WHEEL_SLOTS ) && ( xTicks < xReturn ); xTicks++ )
+			{
+				if( listLIST_IS_EMPTY( &( xDelayWheel[ ( xTickCount + xTicks ) & tskDELAY_WHEEL_MASK ] ) ) == pdFALSE )
+				{
+					xReturn = xTicks;
+				}
+			}
+		}
+		#endif
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
 
 
 
@@ -1983,7 +2550,22 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
 
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 	{
-		pxTCB->ulRunTimeCounter = 0UL;
+		pxTCB->ullRunTimeCounter = 0ULL;
+		pxTCB->ulMaxBurst = 0UL;
+		pxTCB->ulSwitchesIn = 0UL;
+	}
+	#endif
+
+	#if ( INCLUDE_uxTaskGetStackStats == 1 )
+	{
+		pxTCB->usStackDepth = usStackDepth;
+	}
+	#endif
+
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+	{
+		pxTCB->ulNotifiedValue = 0UL;
+		pxTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
 	}
 	#endif
 
@@ -2032,6 +2614,17 @@ unsigned portBASE_TYPE uxPriority;
 	vListInitialise( ( xList * ) &xDelayedTaskList2 );
 	vListInitialise( ( xList * ) &xPendingReadyList );
 
+	#if ( configUSE_DELAY_WHEEL == 1 )
+	{
+	portTickType xSlot;
+
+		for( xSlot = ( portTickType ) 0U; xSlot < tskDELAY_WHEEL_SLOTS; xSlot++ )
+		{
+			vListInitialise( ( xList * ) &( xDelayWheel[ xSlot ] ) );
+		}
+	}
+	#endif
+
 	#if ( INCLUDE_vTaskDelete == 1 )
 	{
 		vListInitialise( ( xList * ) &xTasksWaitingTermination );
@@ -2091,6 +2684,25 @@ static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake )
 	/* The list item will be inserted in wake time order. */
 	listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xGenericListItem ), xTimeToWake );
 
+	#if ( configUSE_DELAY_WHEEL == 1 )
+	if( xTimeToWake == xTickCount )
+	{
+		/* Blocking for no ticks, as the timer service task can.  The slot of
+		the tick count is only looked at again a whole turn later, so the task
+		goes in the next slot, and wakes at the next tick as it would from the
+		delayed list. */
+		xTimeToWake++;
+		listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xGenericListItem ), xTimeToWake );
+		vListInsertEnd( ( xList * ) &( xDelayWheel[ xTimeToWake & tskDELAY_WHEEL_MASK ] ), ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+	}
+	else if( ( portTickType ) ( xTimeToWake - xTickCount ) < tskDELAY_WHEEL_SLOTS )
+	{
+		/* Due within one turn of the wheel, so the task goes in the slot of
+		its wake time, without looking at any other delayed task. */
+		vListInsertEnd( ( xList * ) &( xDelayWheel[ xTimeToWake & tskDELAY_WHEEL_MASK ] ), ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+	}
+	else
+	#endif /* configUSE_DELAY_WHEEL */
 	if( xTimeToWake < xTickCount )
 	{
 		/* Wake time has overflowed.  Place this item in the overflow list. */
@@ -2178,76 +2790,92 @@ tskTCB *pxNewTCB;
 
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
-	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long ulTotalRunTime )
+	static unsigned portBASE_TYPE prvGetRunTimeStatsForTasksInList( xTaskRunTimeStats *pxStats, unsigned portBASE_TYPE uxMaxTasks, xList *pxList, unsigned long ulRunningTime )
 	{
 	volatile tskTCB *pxNextTCB, *pxFirstTCB;
-	unsigned long ulStatsAsPercentage;
+	unsigned portBASE_TYPE uxTask = ( unsigned portBASE_TYPE ) 0U;
 
-		/* Write the run time stats of all the TCB's in pxList into the buffer. */
+		/* Copy the run time stats of all the TCB's in pxList, as long as there
+		is room for them. */
 		listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
 		do
 		{
 			/* Get next TCB in from the list. */
 			listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList );
 
-			/* Divide by zero check. */
-			if( ulTotalRunTime > 0UL )
+			if( uxTask < uxMaxTasks )
 			{
-				/* Has the task run at all? */
-				if( pxNextTCB->ulRunTimeCounter == 0UL )
-				{
-					/* The task has used no CPU time at all. */
-					sprintf( pcStatsString, ( char * ) "%s\t\t0\t\t0%%\r\n", pxNextTCB->pcTaskName );
-				}
-				else
+				pxStats[ uxTask ].xHandle = ( xTaskHandle ) pxNextTCB;
+				pxStats[ uxTask ].pcTaskName = ( const signed char * ) pxNextTCB->pcTaskName;
+				pxStats[ uxTask ].uxPriority = pxNextTCB->uxPriority;
+				pxStats[ uxTask ].ullRunTime = pxNextTCB->ullRunTimeCounter;
+				pxStats[ uxTask ].ulMaxBurst = pxNextTCB->ulMaxBurst;
+				pxStats[ uxTask ].ulSwitchesIn = pxNextTCB->ulSwitchesIn;
+
+				/* The running task is charged up to now, and its current burst
+				may already be its longest. */
+				if( pxNextTCB == pxCurrentTCB )
 				{
-					/* What percentage of the total run time has the task used?
-					This will always be rounded down to the nearest integer.
-					ulTotalRunTime has already been divided by 100. */
-					ulStatsAsPercentage = pxNextTCB->ulRunTimeCounter / ulTotalRunTime;
+					pxStats[ uxTask ].ullRunTime += ( unsigned long long ) ulRunningTime;
 
-					if( ulStatsAsPercentage > 0UL )
+					if( ( ulTaskBurstTime + ulRunningTime ) > pxStats[ uxTask ].ulMaxBurst )
 					{
-						#ifdef portLU_PRINTF_SPECIFIER_REQUIRED
-						{
-							sprintf( pcStatsString, ( char * ) "%s\t\t%lu\t\t%lu%%\r\n", pxNextTCB->pcTaskName, pxNextTCB->ulRunTimeCounter, ulStatsAsPercentage );							
-						}
-						#else
-						{
-							/* sizeof( int ) == sizeof( long ) so a smaller
-							printf() library can be used. */
-							sprintf( pcStatsString, ( char * ) "%s\t\t%u\t\t%u%%\r\n", pxNextTCB->pcTaskName, ( unsigned int ) pxNextTCB->ulRunTimeCounter, ( unsigned int ) ulStatsAsPercentage );
-						}
-						#endif
-					}
-					else
-					{
-						/* If the percentage is zero here then the task has
-						consumed less than 1% of the total run time. */
-						#ifdef portLU_PRINTF_SPECIFIER_REQUIRED
-						{
-							sprintf( pcStatsString, ( char * ) "%s\t\t%lu\t\t<1%%\r\n", pxNextTCB->pcTaskName, pxNextTCB->ulRunTimeCounter );							
-						}
-						#else
-						{
-							/* sizeof( int ) == sizeof( long ) so a smaller
-							printf() library can be used. */
-							sprintf( pcStatsString, ( char * ) "%s\t\t%u\t\t<1%%\r\n", pxNextTCB->pcTaskName, ( unsigned int ) pxNextTCB->ulRunTimeCounter );
-						}
-						#endif
+						pxStats[ uxTask ].ulMaxBurst = ulTaskBurstTime + ulRunningTime;
 					}
 				}
 
-				strcat( ( char * ) pcWriteBuffer, ( char * ) pcStatsString );
+				uxTask++;
+			}
+
+		} while( pxNextTCB != pxFirstTCB );
+
+		return uxTask;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( INCLUDE_uxTaskGetStackStats == 1 )
+
+	static unsigned portBASE_TYPE prvGetStackStatsForTasksInList( xTaskStackStats *pxStats, unsigned portBASE_TYPE uxMaxTasks, xList *pxList )
+	{
+	volatile tskTCB *pxNextTCB, *pxFirstTCB;
+	unsigned portBASE_TYPE uxTask = ( unsigned portBASE_TYPE ) 0U;
+
+		listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
+		do
+		{
+			/* Get next TCB in from the list. */
+			listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList );
+
+			if( uxTask < uxMaxTasks )
+			{
+				pxStats[ uxTask ].xHandle = ( xTaskHandle ) pxNextTCB;
+				pxStats[ uxTask ].pcTaskName = ( const signed char * ) pxNextTCB->pcTaskName;
+				pxStats[ uxTask ].usStackDepth = pxNextTCB->usStackDepth;
+
+				#if ( portSTACK_GROWTH > 0 )
+				{
+					pxStats[ uxTask ].usLeastFree = usTaskCheckFreeStackSpace( ( unsigned char * ) pxNextTCB->pxEndOfStack );
+				}
+				#else
+				{
+					pxStats[ uxTask ].usLeastFree = usTaskCheckFreeStackSpace( ( unsigned char * ) pxNextTCB->pxStack );
+				}
+				#endif
+
+				uxTask++;
 			}
 
 		} while( pxNextTCB != pxFirstTCB );
+
+		return uxTask;
 	}
 
 #endif
 /*-----------------------------------------------------------*/
 
-#if ( ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) )
+#if ( ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) || ( INCLUDE_uxTaskGetStackStats == 1 ) )
 
 	static unsigned short usTaskCheckFreeStackSpace( const unsigned char * pucStackByte )
 	{
@@ -2304,9 +2932,16 @@ tskTCB *pxNewTCB;
 		portCLEAN_UP_TCB( pxTCB );
 
 		/* Free up the memory allocated by the scheduler for the task.  It is up to
-		the task to free any memory allocated at the application level. */
-		vPortFreeAligned( pxTCB->pxStack );
-		vPortFree( pxTCB );
+		the task to free any memory allocated at the application level.  The
+		memory of a task created by xTaskCreateStatic() belongs to the
+		application. */
+		#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			if( pxTCB->ucStaticallyAllocated == ( unsigned char ) pdFALSE )
+		#endif
+		{
+			vPortFreeAligned( pxTCB->pxStack );
+			vPortFree( pxTCB );
+		}
 	}
 
 #endif
@@ -2378,6 +3013,7 @@ tskTCB *pxNewTCB;
 			if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xGenericListItem ) ) != pdFALSE )
 			{
 				vListRemove( &( pxTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 				/* Inherit the priority before being moved into the new list. */
 				pxTCB->uxPriority = pxCurrentTCB->uxPriority;
@@ -2409,6 +3045,7 @@ tskTCB *pxNewTCB;
 				/* We must be the running task to be able to give the mutex back.
 				Remove ourselves from the ready list we currently appear in. */
 				vListRemove( &( pxTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 				/* Disinherit the priority before adding the task into the new
 				ready list. */
@@ -2462,3 +3099,275 @@ void vTaskExitCritical( void )
 
 
 
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	signed portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait )
+	{
+	signed portBASE_TYPE xReturn;
+
+		taskENTER_CRITICAL();
+		{
+			/* Only block if a notification is not already pending. */
+			if( pxCurrentTCB->ucNotifyState != taskNOTIFICATION_RECEIVED )
+			{
+				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnEntry;
+				pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+
+				if( xTicksToWait > ( portTickType ) 0 )
+				{
+					traceTASK_NOTIFY_WAIT_BLOCK();
+					prvBlockForNotification( xTicksToWait );
+
+					/* Yes it is ok to do this from within the critical
+					section - the switch happens when the critical section is
+					exited. */
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		taskENTER_CRITICAL();
+		{
+			traceTASK_NOTIFY_WAIT();
+
+			if( pulNotificationValue != NULL )
+			{
+				*pulNotificationValue = pxCurrentTCB->ulNotifiedValue;
+			}
+
+			/* If the state is still waiting the task either did not block or
+			timed out. */
+			if( pxCurrentTCB->ucNotifyState != taskNOTIFICATION_RECEIVED )
+			{
+				xReturn = pdFALSE;
+			}
+			else
+			{
+				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnExit;
+				xReturn = pdTRUE;
+			}
+
+			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait )
+	{
+	unsigned long ulReturn;
+
+		taskENTER_CRITICAL();
+		{
+			/* Only block if the count is not already non-zero. */
+			if( pxCurrentTCB->ulNotifiedValue == 0UL )
+			{
+				pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+
+				if( xTicksToWait > ( portTickType ) 0 )
+				{
+					traceTASK_NOTIFY_TAKE_BLOCK();
+					prvBlockForNotification( xTicksToWait );
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		taskENTER_CRITICAL();
+		{
+			traceTASK_NOTIFY_TAKE();
+			ulReturn = pxCurrentTCB->ulNotifiedValue;
+
+			if( ulReturn != 0UL )
+			{
+				if( xClearCountOnExit != pdFALSE )
+				{
+					pxCurrentTCB->ulNotifiedValue = 0UL;
+				}
+				else
+				{
+					pxCurrentTCB->ulNotifiedValue = ulReturn - 1UL;
+				}
+			}
+
+			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+		}
+		taskEXIT_CRITICAL();
+
+		return ulReturn;
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	signed portBASE_TYPE xTaskNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction )
+	{
+	tskTCB * const pxTCB = ( tskTCB * ) xTaskToNotify;
+	signed portBASE_TYPE xReturn;
+	unsigned char ucOriginalState;
+
+		configASSERT( xTaskToNotify );
+
+		taskENTER_CRITICAL();
+		{
+			ucOriginalState = pxTCB->ucNotifyState;
+			xReturn = prvUpdateNotifiedValue( pxTCB, ulValue, eAction, ucOriginalState );
+
+			traceTASK_NOTIFY();
+
+			/* If the task was blocked waiting for a notification it can be
+			moved straight to its ready list.  It is not on an event list. */
+			if( ucOriginalState == taskWAITING_NOTIFICATION )
+			{
+				vListRemove( &( pxTCB->xGenericListItem ) );
+				prvAddTaskToReadyQueue( pxTCB );
+
+				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				{
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	signed portBASE_TYPE xTaskNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	tskTCB * const pxTCB = ( tskTCB * ) xTaskToNotify;
+	signed portBASE_TYPE xReturn;
+	unsigned char ucOriginalState;
+	unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+		configASSERT( xTaskToNotify );
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			ucOriginalState = pxTCB->ucNotifyState;
+			xReturn = prvUpdateNotifiedValue( pxTCB, ulValue, eAction, ucOriginalState );
+
+			traceTASK_NOTIFY_FROM_ISR();
+
+			if( ucOriginalState == taskWAITING_NOTIFICATION )
+			{
+				if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+				{
+					vListRemove( &( pxTCB->xGenericListItem ) );
+					prvAddTaskToReadyQueue( pxTCB );
+				}
+				else
+				{
+					/* The delayed and ready lists cannot be accessed, so the
+					task is held in the pending ready list until the scheduler
+					is resumed.  The event list item is free, as the task is
+					not waiting on a queue. */
+					vListInsertEnd( ( xList * ) &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
+				}
+
+				if( ( pxTCB->uxPriority >= pxCurrentTCB->uxPriority ) && ( pxHigherPriorityTaskWoken != NULL ) )
+				{
+					*pxHigherPriorityTaskWoken = pdTRUE;
+				}
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	static void prvBlockForNotification( portTickType xTicksToWait )
+	{
+		/* The same list item is used for the ready and blocked lists. */
+		vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+		taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
+
+		#if ( INCLUDE_vTaskSuspend == 1 )
+		{
+			if( xTicksToWait == portMAX_DELAY )
+			{
+				/* Block indefinitely, so do not sit in a delayed list. */
+				vListInsertEnd( ( xList * ) &xSuspendedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+			}
+			else
+			{
+				prvAddCurrentTaskToDelayedList( xTickCount + xTicksToWait );
+			}
+		}
+		#else
+		{
+			prvAddCurrentTaskToDelayedList( xTickCount + xTicksToWait );
+		}
+		#endif
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	static signed portBASE_TYPE prvUpdateNotifiedValue( tskTCB * const pxTCB, unsigned long ulValue, eNotifyAction eAction, unsigned char ucOriginalState )
+	{
+	signed portBASE_TYPE xReturn = pdPASS;
+
+		switch( eAction )
+		{
+			case eSetBits :
+				pxTCB->ulNotifiedValue |= ulValue;
+				break;
+
+			case eIncrement :
+				( pxTCB->ulNotifiedValue )++;
+				break;
+
+			case eSetValueWithOverwrite :
+				pxTCB->ulNotifiedValue = ulValue;
+				break;
+
+			case eSetValueWithoutOverwrite :
+				if( ucOriginalState != taskNOTIFICATION_RECEIVED )
+				{
+					pxTCB->ulNotifiedValue = ulValue;
+				}
+				else
+				{
+					/* The value still holds a notification that has not been
+					read. */
+					xReturn = pdFAIL;
+				}
+				break;
+
+			case eNoAction :
+			default :
+				/* The task is notified without its value changing. */
+				break;
+		}
+
+		pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
@@ -72,6 +72,20 @@ configUSE_TIMERS is set to 1 in FreeRTOSConfig.h. */
 /* Misc definitions. */
 #define tmrNO_DELAY		( portTickType ) 0U
 
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+	/* Sent by xTimerGenericCommandDirect() when the timer service task has to
+	wake to look at the wheel again. */
+	#define tmrCOMMAND_WHEEL_WAKE	4
+
+	#define tmrWHEEL_SLOTS			( 1U << configTIMER_WHEEL_BITS )
+	#define tmrWHEEL_SLOT_MASK		( ( portTickType ) tmrWHEEL_SLOTS - 1U )
+
+	/* The number of ticks the levels of the wheel reach. */
+	#define tmrWHEEL_SPAN			( ( portTickType ) 1U << ( configTIMER_WHEEL_BITS * configTIMER_WHEEL_LEVELS ) )
+
+#endif
+
 /* The definition of the timers themselves. */
 typedef struct tmrTimerControl
 {
@@ -81,25 +95,85 @@ typedef struct tmrTimerControl
 	unsigned portBASE_TYPE	uxAutoReload;		/*<< Set to pdTRUE if the timer should be automatically restarted once expired.  Set to pdFALSE if the timer is, in effect, a one shot timer. */
 	void 					*pvTimerID;			/*<< An ID to identify the timer.  This allows the timer to be identified when the same callback is used for multiple timers. */
 	tmrTIMER_CALLBACK		pxCallbackFunction;	/*<< The function that will be called when the timer expires. */
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char		ucStaticallyAllocated;	/*<< pdTRUE if the timer was created by xTimerCreateStatic(), so must not be freed. */
+	#endif
 } xTIMER;
 
+/* The parameters of a command to a timer. */
+typedef struct tmrTimerParameters
+{
+	portTickType			xMessageValue;		/*<< An optional value used by a subset of commands, for example, when changing the period of a timer. */
+	xTIMER *				pxTimer;			/*<< The timer to which the command will be applied. */
+} xTIMER_PARAMETERS;
+
+#if ( INCLUDE_xTimerPendFunctionCall == 1 )
+
+	/* The parameters of a command to run a pended function. */
+	typedef struct tmrCallbackParameters
+	{
+		tmrPENDED_FUNCTION	pxCallbackFunction;	/*<< The function to run. */
+		void				*pvParameter1;		/*<< The first parameter of the function. */
+		unsigned long		ulParameter2;		/*<< The second parameter of the function. */
+	} xCALLBACK_PARAMETERS;
+
+#endif
+
 /* The definition of messages that can be sent and received on the timer
-queue. */
+queue.  Commands with a negative ID carry a function to run rather than a
+timer. */
 typedef struct tmrTimerQueueMessage
 {
 	portBASE_TYPE			xMessageID;			/*<< The command being sent to the timer service task. */
-	portTickType			xMessageValue;		/*<< An optional value used by a subset of commands, for example, when changing the period of a timer. */
-	xTIMER *				pxTimer;			/*<< The timer to which the command will be applied. */
+	union
+	{
+		xTIMER_PARAMETERS xTimerParameters;
+
+		#if ( INCLUDE_xTimerPendFunctionCall == 1 )
+			xCALLBACK_PARAMETERS xCallbackParameters;
+		#endif
+	} u;
 } xTIMER_MESSAGE;
 
 
-/* The list in which active timers are stored.  Timers are referenced in expire
-time order, with the nearest expiry time at the front of the list.  Only the
-timer service task is allowed to access xActiveTimerList. */
-PRIVILEGED_DATA static xList xActiveTimerList1;
-PRIVILEGED_DATA static xList xActiveTimerList2;
-PRIVILEGED_DATA static xList *pxCurrentTimerList;
-PRIVILEGED_DATA static xList *pxOverflowTimerList;
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+	/* The wheel in which active timers are stored.  A timer due less than
+	2^( configTIMER_WHEEL_BITS * ( n + 1 ) ) ticks after xWheelNextTick is in
+	level n, in the slot given by the bits of its expiry time that level
+	covers.  When a slot of level n is reached its timers are moved down to
+	lower levels, and when a slot of level 0 is reached its timers expire.
+	Timers due further ahead than the levels reach wait in xTimerWheelFar,
+	which is looked at each time the top level comes round.  Interrupts can
+	move timers themselves, so the wheel is only accessed with interrupts
+	masked. */
+	PRIVILEGED_DATA static xList xTimerWheel[ configTIMER_WHEEL_LEVELS ][ tmrWHEEL_SLOTS ];
+	PRIVILEGED_DATA static xList xTimerWheelFar;
+
+	/* The next tick the wheel has to process.  Every timer due before it has
+	expired.  Never more than one tick ahead of the tick count. */
+	PRIVILEGED_DATA static portTickType xWheelNextTick = ( portTickType ) 0U;
+
+	/* The number of timers in the wheel. */
+	PRIVILEGED_DATA static unsigned portBASE_TYPE uxWheelTimers = ( unsigned portBASE_TYPE ) 0U;
+
+	/* Whether the timer service task is blocked, and how many ticks after
+	xWheelNextTick it will wake, so xTimerGenericCommandDirect() knows whether
+	to wake it. */
+	PRIVILEGED_DATA static volatile portBASE_TYPE xWheelTaskBlocked = pdFALSE;
+	PRIVILEGED_DATA static portTickType xWheelWakeDistance = ( portTickType ) 0U;
+
+#else
+
+	/* The list in which active timers are stored.  Timers are referenced in expire
+	time order, with the nearest expiry time at the front of the list.  Only the
+	timer service task is allowed to access xActiveTimerList. */
+	PRIVILEGED_DATA static xList xActiveTimerList1;
+	PRIVILEGED_DATA static xList xActiveTimerList2;
+	PRIVILEGED_DATA static xList *pxCurrentTimerList;
+	PRIVILEGED_DATA static xList *pxOverflowTimerList;
+
+#endif
 
 /* A queue that is used to send commands to the timer service task. */
 PRIVILEGED_DATA static xQueueHandle xTimerQueue = NULL;
@@ -110,6 +184,17 @@ PRIVILEGED_DATA static xQueueHandle xTimerQueue = NULL;
 	
 #endif
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	/* The timer service task and its queue are created in these rather than
+	on the heap. */
+	PRIVILEGED_DATA static xStaticTask xTimerTaskBuffer;
+	PRIVILEGED_DATA static portSTACK_TYPE xTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
+	PRIVILEGED_DATA static xStaticQueue xTimerQueueBuffer;
+	PRIVILEGED_DATA static unsigned char ucTimerQueueStorage[ configTIMER_QUEUE_LENGTH * sizeof( xTIMER_MESSAGE ) ];
+
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -131,6 +216,67 @@ static void prvTimerTask( void *pvParameters ) PRIVILEGED_FUNCTION;
  */
 static void	prvProcessReceivedCommands( void ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+	/*
+	 * If the wheel has reached a slot that is due, process it.  Otherwise,
+	 * block the timer service task until either a slot is due or a command
+	 * is received.
+	 */
+	static void prvProcessWheelOrBlockTask( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Set *pxTicksToNext to the number of ticks after xWheelNextTick of the
+	 * next slot that has timers in it, and return pdTRUE, or return pdFALSE
+	 * if there are no active timers.  Call with interrupts masked.
+	 */
+	static portBASE_TYPE prvGetNextWheelTick( portTickType *pxTicksToNext ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * The wheel has reached xWheelNextTick, which has timers due.  Move the
+	 * timers of the higher level slots that start at it down the wheel, then
+	 * expire the timers of its level 0 slot, reloading the auto reload
+	 * timers.
+	 */
+	static void prvProcessWheelTick( portTickType xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Move the timers that are in pxSlot when it is called to the slots they
+	 * are now due in.
+	 */
+	static void prvCascadeWheelSlot( xList *pxSlot ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Take the timer out of the wheel if it is in it, then perform the
+	 * command.  Return pdTRUE if the timer service task has to be woken to
+	 * see the change.  Call with interrupts masked.
+	 */
+	static portBASE_TYPE prvApplyWheelCommand( xTIMER *pxTimer, portBASE_TYPE xCommandID, portTickType xOptionalValue, portTickType xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Put a timer that is not in the wheel into it, to expire at
+	 * xNextExpiryTime.  If that is before the wheel has got to, the timer
+	 * expires with the next tick processed.  Returns the number of ticks
+	 * after xWheelNextTick of the slot the timer was put in.  Call with
+	 * interrupts masked.
+	 */
+	static portTickType prvInsertTimerInWheel( xTIMER *pxTimer, portTickType xNextExpiryTime, portTickType xTimeNow, portTickType xCommandTime ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Put a timer due at or after xWheelNextTick into the slot it belongs in,
+	 * returning the number of ticks after xWheelNextTick the slot is reached.
+	 * Call with interrupts masked.
+	 */
+	static portTickType prvPlaceTimerInWheel( xTIMER *pxTimer, portTickType xExpiryTime ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Add the timer to the end of pxSlot, so timers moved on from a slot
+	 * that come back to it are not seen again in the same pass.
+	 */
+	static void prvAppendTimerToSlot( xList *pxSlot, xTIMER *pxTimer ) PRIVILEGED_FUNCTION;
+
+#else
+
 /*
  * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
  * depending on if the expire time causes a timer counter overflow.
@@ -169,6 +315,14 @@ static portTickType prvGetNextExpireTime( portBASE_TYPE *pxListWasEmpty ) PRIVIL
  */
 static void prvProcessTimerOrBlockTask( portTickType xNextExpireTime, portBASE_TYPE xListWasEmpty ) PRIVILEGED_FUNCTION;
 
+#endif /* configUSE_TIMER_WHEEL */
+
+/*
+ * Called by xTimerCreate() and xTimerCreateStatic() to set up the members of
+ * a new timer.
+ */
+static void prvInitialiseNewTimer( xTIMER *pxNewTimer, const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction ) PRIVILEGED_FUNCTION;
+
 /*-----------------------------------------------------------*/
 
 portBASE_TYPE xTimerCreateTimerTask( void )
@@ -183,7 +337,22 @@ portBASE_TYPE xReturn = pdFAIL;
 
 	if( xTimerQueue != NULL )
 	{
-		#if ( INCLUDE_xTimerGetTimerDaemonTaskHandle == 1 )
+		#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+			xTaskHandle xTimerTask;
+
+			/* The timer task is always there, so is not worth a heap
+			block. */
+			xTimerTask = xTaskCreateStatic( prvTimerTask, ( const signed char * ) "Tmr Svc", ( unsigned short ) configTIMER_TASK_STACK_DEPTH, NULL, ( unsigned portBASE_TYPE ) configTIMER_TASK_PRIORITY, xTimerTaskStack, &xTimerTaskBuffer );
+			xReturn = ( xTimerTask != NULL ) ? pdPASS : pdFAIL;
+
+			#if ( INCLUDE_xTimerGetTimerDaemonTaskHandle == 1 )
+			{
+				xTimerTaskHandle = xTimerTask;
+			}
+			#endif
+		}
+		#elif ( INCLUDE_xTimerGetTimerDaemonTaskHandle == 1 )
 		{
 			/* Create the timer task, storing its handle in xTimerTaskHandle so
 			it can be returned by the xTimerGetTimerDaemonTaskHandle() function. */
@@ -217,19 +386,13 @@ xTIMER *pxNewTimer;
 		pxNewTimer = ( xTIMER * ) pvPortMalloc( sizeof( xTIMER ) );
 		if( pxNewTimer != NULL )
 		{
-			/* Ensure the infrastructure used by the timer service task has been
-			created/initialised. */
-			prvCheckForValidListAndQueue();
-	
-			/* Initialise the timer structure members using the function parameters. */
-			pxNewTimer->pcTimerName = pcTimerName;
-			pxNewTimer->xTimerPeriodInTicks = xTimerPeriodInTicks;
-			pxNewTimer->uxAutoReload = uxAutoReload;
-			pxNewTimer->pvTimerID = pvTimerID;
-			pxNewTimer->pxCallbackFunction = pxCallbackFunction;
-			vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
-			
-			traceTIMER_CREATE( pxNewTimer );
+			#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			{
+				pxNewTimer->ucStaticallyAllocated = ( unsigned char ) pdFALSE;
+			}
+			#endif
+
+			prvInitialiseNewTimer( pxNewTimer, pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction );
 		}
 		else
 		{
@@ -241,6 +404,50 @@ xTIMER *pxNewTimer;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xTimerHandle xTimerCreateStatic( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction, xStaticTimer *pxTimerBuffer )
+	{
+	xTIMER *pxNewTimer = NULL;
+
+		configASSERT( ( xTimerPeriodInTicks > 0 ) );
+		configASSERT( pxTimerBuffer );
+
+		/* xStaticTimer must have the same size as the structure it stands in
+		for. */
+		configASSERT( sizeof( xStaticTimer ) == sizeof( xTIMER ) );
+
+		if( ( xTimerPeriodInTicks != ( portTickType ) 0U ) && ( pxTimerBuffer != NULL ) )
+		{
+			pxNewTimer = ( xTIMER * ) pxTimerBuffer;
+			pxNewTimer->ucStaticallyAllocated = ( unsigned char ) pdTRUE;
+			prvInitialiseNewTimer( pxNewTimer, pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction );
+		}
+
+		return ( xTimerHandle ) pxNewTimer;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewTimer( xTIMER *pxNewTimer, const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction )
+{
+	/* Ensure the infrastructure used by the timer service task has been
+	created/initialised. */
+	prvCheckForValidListAndQueue();
+
+	/* Initialise the timer structure members using the function parameters. */
+	pxNewTimer->pcTimerName = pcTimerName;
+	pxNewTimer->xTimerPeriodInTicks = xTimerPeriodInTicks;
+	pxNewTimer->uxAutoReload = uxAutoReload;
+	pxNewTimer->pvTimerID = pvTimerID;
+	pxNewTimer->pxCallbackFunction = pxCallbackFunction;
+	vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
+
+	traceTIMER_CREATE( pxNewTimer );
+}
+/*-----------------------------------------------------------*/
+
 portBASE_TYPE xTimerGenericCommand( xTimerHandle xTimer, portBASE_TYPE xCommandID, portTickType xOptionalValue, signed portBASE_TYPE *pxHigherPriorityTaskWoken, portTickType xBlockTime )
 {
 portBASE_TYPE xReturn = pdFAIL;
@@ -252,8 +459,8 @@ xTIMER_MESSAGE xMessage;
 	{
 		/* Send a command to the timer service task to start the xTimer timer. */
 		xMessage.xMessageID = xCommandID;
-		xMessage.xMessageValue = xOptionalValue;
-		xMessage.pxTimer = ( xTIMER * ) xTimer;
+		xMessage.u.xTimerParameters.xMessageValue = xOptionalValue;
+		xMessage.u.xTimerParameters.pxTimer = ( xTIMER * ) xTimer;
 
 		if( pxHigherPriorityTaskWoken == NULL )
 		{
@@ -278,6 +485,52 @@ xTIMER_MESSAGE xMessage;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+	portBASE_TYPE xTimerGenericCommandDirect( xTimerHandle xTimer, portBASE_TYPE xCommandID, portTickType xOptionalValue, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	portBASE_TYPE xReturn = pdFAIL, xWake;
+	xTIMER_MESSAGE xMessage;
+	portTickType xTimeNow;
+	unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+		/* Only the timer service task can free a timer, as its callback
+		might be running. */
+		configASSERT( ( xCommandID != tmrCOMMAND_DELETE ) );
+
+		if( xTimerQueue != NULL )
+		{
+			/* Read before interrupts are masked, as reading the tick count
+			from an interrupt masks and unmasks them. */
+			xTimeNow = xTaskGetTickCountFromISR();
+
+			uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+			{
+				xWake = prvApplyWheelCommand( ( xTIMER * ) xTimer, xCommandID, xOptionalValue, xTimeNow );
+			}
+			portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+			if( xWake != pdFALSE )
+			{
+				/* The timer is due before the timer service task would wake.
+				If the queue is full the task has commands waiting, so will
+				look at the wheel anyway. */
+				xMessage.xMessageID = tmrCOMMAND_WHEEL_WAKE;
+				xMessage.u.xTimerParameters.xMessageValue = ( portTickType ) 0U;
+				xMessage.u.xTimerParameters.pxTimer = NULL;
+				( void ) xQueueSendToBackFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
+			}
+
+			xReturn = pdPASS;
+			traceTIMER_COMMAND_SEND( xTimer, xCommandID, xOptionalValue, xReturn );
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
 #if ( INCLUDE_xTimerGetTimerDaemonTaskHandle == 1 )
 
 	xTaskHandle xTimerGetTimerDaemonTaskHandle( void )
@@ -291,6 +544,63 @@ xTIMER_MESSAGE xMessage;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( INCLUDE_xTimerPendFunctionCall == 1 )
+
+	portBASE_TYPE xTimerPendFunctionCallFromISR( tmrPENDED_FUNCTION xFunctionToPend, void *pvParameter1, unsigned long ulParameter2, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	xTIMER_MESSAGE xMessage;
+	portBASE_TYPE xReturn = pdFAIL;
+
+		/* The function is run by the timer service task, so there must be
+		one to send it to. */
+		if( xTimerQueue != NULL )
+		{
+			xMessage.xMessageID = tmrCOMMAND_EXECUTE_CALLBACK_FROM_ISR;
+			xMessage.u.xCallbackParameters.pxCallbackFunction = xFunctionToPend;
+			xMessage.u.xCallbackParameters.pvParameter1 = pvParameter1;
+			xMessage.u.xCallbackParameters.ulParameter2 = ulParameter2;
+
+			xReturn = xQueueSendToBackFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
+		}
+
+		tracePEND_FUNC_CALL_FROM_ISR( xFunctionToPend, pvParameter1, ulParameter2, xReturn );
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	portBASE_TYPE xTimerPendFunctionCall( tmrPENDED_FUNCTION xFunctionToPend, void *pvParameter1, unsigned long ulParameter2, portTickType xTicksToWait )
+	{
+	xTIMER_MESSAGE xMessage;
+	portBASE_TYPE xReturn = pdFAIL;
+
+		if( xTimerQueue != NULL )
+		{
+			xMessage.xMessageID = tmrCOMMAND_EXECUTE_CALLBACK;
+			xMessage.u.xCallbackParameters.pxCallbackFunction = xFunctionToPend;
+			xMessage.u.xCallbackParameters.pvParameter1 = pvParameter1;
+			xMessage.u.xCallbackParameters.ulParameter2 = ulParameter2;
+
+			/* As for the timer commands, only block once the scheduler is
+			running. */
+			if( xTaskGetSchedulerState() != taskSCHEDULER_RUNNING )
+			{
+				xTicksToWait = tmrNO_DELAY;
+			}
+
+			xReturn = xQueueSendToBack( xTimerQueue, &xMessage, xTicksToWait );
+		}
+
+		tracePEND_FUNC_CALL( xFunctionToPend, pvParameter1, ulParameter2, xReturn );
+
+		return xReturn;
+	}
+
+#endif /* INCLUDE_xTimerPendFunctionCall */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TIMER_WHEEL == 0 )
+
 static void prvProcessExpiredTimer( portTickType xNextExpireTime, portTickType xTimeNow )
 {
 xTIMER *pxTimer;
@@ -325,25 +635,40 @@ portBASE_TYPE xResult;
 	/* Call the timer callback. */
 	pxTimer->pxCallbackFunction( ( xTimerHandle ) pxTimer );
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void prvTimerTask( void *pvParameters )
 {
-portTickType xNextExpireTime;
-portBASE_TYPE xListWasEmpty;
+#if ( configUSE_TIMER_WHEEL == 0 )
+	portTickType xNextExpireTime;
+	portBASE_TYPE xListWasEmpty;
+#endif
 
 	/* Just to avoid compiler warnings. */
 	( void ) pvParameters;
 
 	for( ;; )
 	{
-		/* Query the timers list to see if it contains any timers, and if so,
-		obtain the time at which the next timer will expire. */
-		xNextExpireTime = prvGetNextExpireTime( &xListWasEmpty );
+		#if ( configUSE_TIMER_WHEEL == 1 )
+		{
+			/* If the wheel has reached a slot with timers in it, process it.
+			Otherwise, block this task until either it does, or a command is
+			received. */
+			prvProcessWheelOrBlockTask();
+		}
+		#else
+		{
+			/* Query the timers list to see if it contains any timers, and if so,
+			obtain the time at which the next timer will expire. */
+			xNextExpireTime = prvGetNextExpireTime( &xListWasEmpty );
 
-		/* If a timer has expired, process it.  Otherwise, block this task
-		until either a timer does expire, or a command is received. */
-		prvProcessTimerOrBlockTask( xNextExpireTime, xListWasEmpty );
+			/* If a timer has expired, process it.  Otherwise, block this task
+			until either a timer does expire, or a command is received. */
+			prvProcessTimerOrBlockTask( xNextExpireTime, xListWasEmpty );
+		}
+		#endif
 		
 		/* Empty the command queue. */
 		prvProcessReceivedCommands();		
@@ -351,6 +676,399 @@ portBASE_TYPE xListWasEmpty;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+static void prvProcessWheelOrBlockTask( void )
+{
+portTickType xTimeNow, xTicksToNext, xWheelLag;
+portBASE_TYPE xProcessTick = pdFALSE;
+
+	vTaskSuspendAll();
+	{
+		xTimeNow = xTaskGetTickCount();
+
+		taskENTER_CRITICAL();
+		{
+			if( prvGetNextWheelTick( &xTicksToNext ) == pdFALSE )
+			{
+				/* There are no active timers, so the wheel can catch up with
+				the tick count.  Look again when it would have turned all
+				the way round, so it never falls far behind. */
+				xWheelNextTick = xTimeNow + ( portTickType ) 1U;
+				xTicksToNext = tmrWHEEL_SPAN - ( portTickType ) 1U;
+			}
+
+			/* xWheelNextTick is at most one tick ahead of the tick count, so
+			the lag is never negative. */
+			xWheelLag = ( xTimeNow + ( portTickType ) 1U ) - xWheelNextTick;
+
+			if( xTicksToNext < xWheelLag )
+			{
+				/* The slots before the one due are empty, so the wheel can
+				jump straight to it. */
+				xWheelNextTick += xTicksToNext;
+				xProcessTick = pdTRUE;
+			}
+			else
+			{
+				xWheelWakeDistance = xTicksToNext;
+				xWheelTaskBlocked = pdTRUE;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xProcessTick != pdFALSE )
+		{
+			( void ) xTaskResumeAll();
+			prvProcessWheelTick( xTimeNow );
+		}
+		else
+		{
+			/* Block until the slot is due, or until either a command or a
+			message to wake arrives. */
+			vQueueWaitForMessageRestricted( xTimerQueue, ( xTicksToNext + ( portTickType ) 1U ) - xWheelLag );
+
+			if( xTaskResumeAll() == pdFALSE )
+			{
+				portYIELD_WITHIN_API();
+			}
+
+			xWheelTaskBlocked = pdFALSE;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvGetNextWheelTick( portTickType *pxTicksToNext )
+{
+portTickType xTicksToNext, xTicksToSlot, xBlock, xBlockMask;
+unsigned portBASE_TYPE uxLevel, uxSlot, uxFirstSlot, uxShift;
+
+	if( uxWheelTimers == ( unsigned portBASE_TYPE ) 0U )
+	{
+		return pdFALSE;
+	}
+
+	/* The far list is looked at each time the top level comes round, which
+	is now if xWheelNextTick is at the start of a turn. */
+	xTicksToNext = tmrWHEEL_SPAN;
+
+	if( listLIST_IS_EMPTY( &xTimerWheelFar ) == pdFALSE )
+	{
+		xTicksToNext = ( tmrWHEEL_SPAN - ( xWheelNextTick & ( tmrWHEEL_SPAN - ( portTickType ) 1U ) ) ) & ( tmrWHEEL_SPAN - ( portTickType ) 1U );
+	}
+
+	for( uxLevel = 0U; uxLevel < ( unsigned portBASE_TYPE ) configTIMER_WHEEL_LEVELS; uxLevel++ )
+	{
+		uxShift = uxLevel * ( unsigned portBASE_TYPE ) configTIMER_WHEEL_BITS;
+		xBlock = xWheelNextTick >> uxShift;
+		xBlockMask = ( ( portTickType ) 1U << uxShift ) - ( portTickType ) 1U;
+
+		/* The slot of a higher level that xWheelNextTick is in has already
+		been moved down, unless xWheelNextTick is at its start. */
+		uxFirstSlot = ( ( xWheelNextTick & xBlockMask ) == ( portTickType ) 0U ) ? 0U : 1U;
+
+		for( uxSlot = uxFirstSlot; uxSlot < ( uxFirstSlot + tmrWHEEL_SLOTS ); uxSlot++ )
+		{
+			xTicksToSlot = ( ( xBlock + ( portTickType ) uxSlot ) << uxShift ) - xWheelNextTick;
+
+			if( xTicksToSlot >= xTicksToNext )
+			{
+				/* The slots left in this level are reached later. */
+				break;
+			}
+
+			if( listLIST_IS_EMPTY( &( xTimerWheel[ uxLevel ][ ( xBlock + ( portTickType ) uxSlot ) & tmrWHEEL_SLOT_MASK ] ) ) == pdFALSE )
+			{
+				xTicksToNext = xTicksToSlot;
+				break;
+			}
+		}
+	}
+
+	*pxTicksToNext = xTicksToNext;
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessWheelTick( portTickType xTimeNow )
+{
+portTickType xTick, xExpiryTime;
+unsigned portBASE_TYPE uxLevel, uxShift;
+xList *pxSlot;
+xTIMER *pxTimer;
+
+	/* Only this task moves xWheelNextTick on. */
+	xTick = xWheelNextTick;
+
+	/* Move down the timers of each level whose slot starts at this tick,
+	from the top level down, as the timers of a higher level can move into
+	the slot of a lower level that also starts now. */
+	for( uxLevel = ( unsigned portBASE_TYPE ) configTIMER_WHEEL_LEVELS; uxLevel > 0U; uxLevel-- )
+	{
+		uxShift = uxLevel * ( unsigned portBASE_TYPE ) configTIMER_WHEEL_BITS;
+
+		if( ( xTick & ( ( ( portTickType ) 1U << uxShift ) - ( portTickType ) 1U ) ) == ( portTickType ) 0U )
+		{
+			if( uxLevel == ( unsigned portBASE_TYPE ) configTIMER_WHEEL_LEVELS )
+			{
+				prvCascadeWheelSlot( &xTimerWheelFar );
+			}
+			else
+			{
+				prvCascadeWheelSlot( &( xTimerWheel[ uxLevel ][ ( xTick >> uxShift ) & tmrWHEEL_SLOT_MASK ] ) );
+			}
+		}
+	}
+
+	/* Expire the timers due now one at a time, so interrupts are only
+	masked for as long as one timer takes. */
+	pxSlot = &( xTimerWheel[ 0 ][ xTick & tmrWHEEL_SLOT_MASK ] );
+
+	for( ;; )
+	{
+		pxTimer = NULL;
+
+		taskENTER_CRITICAL();
+		{
+			if( listLIST_IS_EMPTY( pxSlot ) != pdFALSE )
+			{
+				xWheelNextTick = xTick + ( portTickType ) 1U;
+			}
+			else
+			{
+				pxTimer = ( xTIMER * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+				vListRemove( &( pxTimer->xTimerListItem ) );
+				uxWheelTimers--;
+
+				/* The reload is relative to the time the timer was due, not
+				to now, so an auto reload timer does not drift. */
+				if( pxTimer->uxAutoReload == ( unsigned portBASE_TYPE ) pdTRUE )
+				{
+					xExpiryTime = listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) );
+					( void ) prvInsertTimerInWheel( pxTimer, ( xExpiryTime + pxTimer->xTimerPeriodInTicks ), xTimeNow, xExpiryTime );
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( pxTimer == NULL )
+		{
+			break;
+		}
+
+		traceTIMER_EXPIRED( pxTimer );
+		pxTimer->pxCallbackFunction( ( xTimerHandle ) pxTimer );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvCascadeWheelSlot( xList *pxSlot )
+{
+unsigned portBASE_TYPE uxToMove;
+xTIMER *pxTimer;
+
+	/* Timers in the far list can go back into it, so only as many timers as
+	are in the slot now are moved, one at a time to keep interrupts masked
+	for no longer than one timer takes. */
+	taskENTER_CRITICAL();
+	{
+		uxToMove = listCURRENT_LIST_LENGTH( pxSlot );
+	}
+	taskEXIT_CRITICAL();
+
+	while( uxToMove > ( unsigned portBASE_TYPE ) 0U )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+			{
+				pxTimer = ( xTIMER * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+				vListRemove( &( pxTimer->xTimerListItem ) );
+				( void ) prvPlaceTimerInWheel( pxTimer, listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) ) );
+				uxToMove--;
+			}
+			else
+			{
+				/* An interrupt stopped the timers left. */
+				uxToMove = ( unsigned portBASE_TYPE ) 0U;
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvApplyWheelCommand( xTIMER *pxTimer, portBASE_TYPE xCommandID, portTickType xOptionalValue, portTickType xTimeNow )
+{
+portTickType xTicksToSlot = portMAX_DELAY;
+portBASE_TYPE xWake = pdFALSE;
+
+	if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE )
+	{
+		vListRemove( &( pxTimer->xTimerListItem ) );
+		uxWheelTimers--;
+	}
+
+	switch( xCommandID )
+	{
+		case tmrCOMMAND_START :
+			/* Start or restart a timer. */
+			xTicksToSlot = prvInsertTimerInWheel( pxTimer, ( xOptionalValue + pxTimer->xTimerPeriodInTicks ), xTimeNow, xOptionalValue );
+			break;
+
+		case tmrCOMMAND_CHANGE_PERIOD :
+			pxTimer->xTimerPeriodInTicks = xOptionalValue;
+			configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
+			xTicksToSlot = prvInsertTimerInWheel( pxTimer, ( xTimeNow + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTimeNow );
+			break;
+
+		default :
+			/* Stopped or deleted, so nothing more to do to the wheel. */
+			break;
+	}
+
+	if( ( xWheelTaskBlocked != pdFALSE ) && ( xTicksToSlot < xWheelWakeDistance ) )
+	{
+		xWheelTaskBlocked = pdFALSE;
+		xWake = pdTRUE;
+	}
+
+	return xWake;
+}
+/*-----------------------------------------------------------*/
+
+static portTickType prvInsertTimerInWheel( xTIMER *pxTimer, portTickType xNextExpiryTime, portTickType xTimeNow, portTickType xCommandTime )
+{
+portTickType xWheelLag, xCommandAge, xTicksToSlot;
+
+	/* Both are measured back from the tick after xTimeNow, so neither is
+	negative.  The command time is before xWheelNextTick by more than the
+	period if the timer expired before the wheel got to it. */
+	xWheelLag = ( xTimeNow + ( portTickType ) 1U ) - xWheelNextTick;
+	xCommandAge = ( xTimeNow + ( portTickType ) 1U ) - xCommandTime;
+
+	if( ( xCommandAge > xWheelLag ) && ( ( xCommandAge - xWheelLag ) > pxTimer->xTimerPeriodInTicks ) )
+	{
+		/* Expire the timer with the next tick the wheel processes.  The
+		expiry time is kept for the reload of an auto reload timer. */
+		listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
+		listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+		prvAppendTimerToSlot( &( xTimerWheel[ 0 ][ xWheelNextTick & tmrWHEEL_SLOT_MASK ] ), pxTimer );
+		xTicksToSlot = ( portTickType ) 0U;
+	}
+	else
+	{
+		xTicksToSlot = prvPlaceTimerInWheel( pxTimer, xNextExpiryTime );
+	}
+
+	uxWheelTimers++;
+
+	return xTicksToSlot;
+}
+/*-----------------------------------------------------------*/
+
+static portTickType prvPlaceTimerInWheel( xTIMER *pxTimer, portTickType xExpiryTime )
+{
+portTickType xTicksToExpiry, xTicksToSlot;
+unsigned portBASE_TYPE uxLevel, uxShift;
+
+	listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xExpiryTime );
+	listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+
+	xTicksToExpiry = xExpiryTime - xWheelNextTick;
+
+	if( xTicksToExpiry >= tmrWHEEL_SPAN )
+	{
+		/* Looked at again when the top level next comes round. */
+		prvAppendTimerToSlot( &xTimerWheelFar, pxTimer );
+		xTicksToSlot = tmrWHEEL_SPAN - ( xWheelNextTick & ( tmrWHEEL_SPAN - ( portTickType ) 1U ) );
+	}
+	else
+	{
+		/* The lowest level that reaches the expiry time.  The slot is
+		reached at the start of the block of ticks it covers, which is after
+		xWheelNextTick, or the timer would be in a lower level. */
+		uxLevel = 0U;
+		uxShift = 0U;
+
+		while( ( xTicksToExpiry >> ( uxShift + ( unsigned portBASE_TYPE ) configTIMER_WHEEL_BITS ) ) != ( portTickType ) 0U )
+		{
+			uxLevel++;
+			uxShift += ( unsigned portBASE_TYPE ) configTIMER_WHEEL_BITS;
+		}
+
+		prvAppendTimerToSlot( &( xTimerWheel[ uxLevel ][ ( xExpiryTime >> uxShift ) & tmrWHEEL_SLOT_MASK ] ), pxTimer );
+		xTicksToSlot = ( ( xExpiryTime >> uxShift ) << uxShift ) - xWheelNextTick;
+	}
+
+	return xTicksToSlot;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAppendTimerToSlot( xList *pxSlot, xTIMER *pxTimer )
+{
+	/* vListInsertEnd() inserts after the index of the list. */
+	pxSlot->pxIndex = pxSlot->xListEnd.pxPrevious;
+	vListInsertEnd( pxSlot, &( pxTimer->xTimerListItem ) );
+}
+/*-----------------------------------------------------------*/
+
+static void	prvProcessReceivedCommands( void )
+{
+xTIMER_MESSAGE xMessage;
+xTIMER *pxTimer;
+portTickType xTimeNow;
+
+	while( xQueueReceive( xTimerQueue, &xMessage, tmrNO_DELAY ) != pdFAIL )
+	{
+		#if ( INCLUDE_xTimerPendFunctionCall == 1 )
+		{
+			/* A pended function call has no timer.  Run the function and go
+			on to the next command. */
+			if( xMessage.xMessageID < ( portBASE_TYPE ) 0 )
+			{
+				configASSERT( ( xMessage.u.xCallbackParameters.pxCallbackFunction != NULL ) );
+				xMessage.u.xCallbackParameters.pxCallbackFunction( xMessage.u.xCallbackParameters.pvParameter1, xMessage.u.xCallbackParameters.ulParameter2 );
+				continue;
+			}
+		}
+		#endif
+
+		pxTimer = xMessage.u.xTimerParameters.pxTimer;
+
+		traceTIMER_COMMAND_RECEIVED( pxTimer, xMessage.xMessageID, xMessage.u.xTimerParameters.xMessageValue );
+
+		/* A message to wake has no timer.  It only makes this task look at
+		the wheel again. */
+		if( pxTimer != NULL )
+		{
+			xTimeNow = xTaskGetTickCount();
+
+			taskENTER_CRITICAL();
+			{
+				( void ) prvApplyWheelCommand( pxTimer, xMessage.xMessageID, xMessage.u.xTimerParameters.xMessageValue, xTimeNow );
+			}
+			taskEXIT_CRITICAL();
+
+			if( xMessage.xMessageID == tmrCOMMAND_DELETE )
+			{
+				/* The timer is out of the wheel, so just free up the memory,
+				unless it belongs to the application. */
+				#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+					if( pxTimer->ucStaticallyAllocated == ( unsigned char ) pdFALSE )
+				#endif
+				{
+					vPortFree( pxTimer );
+				}
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+#else
+
 static void prvProcessTimerOrBlockTask( portTickType xNextExpireTime, portBASE_TYPE xListWasEmpty )
 {
 portTickType xTimeNow;
@@ -503,7 +1221,20 @@ portTickType xTimeNow;
 
 	while( xQueueReceive( xTimerQueue, &xMessage, tmrNO_DELAY ) != pdFAIL )
 	{
-		pxTimer = xMessage.pxTimer;
+		#if ( INCLUDE_xTimerPendFunctionCall == 1 )
+		{
+			/* A pended function call has no timer.  Run the function and go
+			on to the next command. */
+			if( xMessage.xMessageID < ( portBASE_TYPE ) 0 )
+			{
+				configASSERT( ( xMessage.u.xCallbackParameters.pxCallbackFunction != NULL ) );
+				xMessage.u.xCallbackParameters.pxCallbackFunction( xMessage.u.xCallbackParameters.pvParameter1, xMessage.u.xCallbackParameters.ulParameter2 );
+				continue;
+			}
+		}
+		#endif
+
+		pxTimer = xMessage.u.xTimerParameters.pxTimer;
 
 		/* Is the timer already in a list of active timers?  When the command
 		is trmCOMMAND_PROCESS_TIMER_OVERFLOW, the timer will be NULL as the
@@ -517,13 +1248,13 @@ portTickType xTimeNow;
 			}
 		}
 
-		traceTIMER_COMMAND_RECEIVED( pxTimer, xMessage.xMessageID, xMessage.xMessageValue );
+		traceTIMER_COMMAND_RECEIVED( pxTimer, xMessage.xMessageID, xMessage.u.xTimerParameters.xMessageValue );
 		
 		switch( xMessage.xMessageID )
 		{
 			case tmrCOMMAND_START :	
 				/* Start or restart a timer. */
-				if( prvInsertTimerInActiveList( pxTimer,  xMessage.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessage.xMessageValue ) == pdTRUE )
+				if( prvInsertTimerInActiveList( pxTimer,  xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessage.u.xTimerParameters.xMessageValue ) == pdTRUE )
 				{
 					/* The timer expired before it was added to the active timer
 					list.  Process it now. */
@@ -531,7 +1262,7 @@ portTickType xTimeNow;
 
 					if( pxTimer->uxAutoReload == ( unsigned portBASE_TYPE ) pdTRUE )
 					{
-						xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START, xMessage.xMessageValue + pxTimer->xTimerPeriodInTicks, NULL, tmrNO_DELAY );
+						xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START, xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, NULL, tmrNO_DELAY );
 						configASSERT( xResult );
 						( void ) xResult;
 					}
@@ -544,15 +1275,21 @@ portTickType xTimeNow;
 				break;
 
 			case tmrCOMMAND_CHANGE_PERIOD :
-				pxTimer->xTimerPeriodInTicks = xMessage.xMessageValue;
+				pxTimer->xTimerPeriodInTicks = xMessage.u.xTimerParameters.xMessageValue;
 				configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
 				prvInsertTimerInActiveList( pxTimer, ( xTimeNow + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTimeNow );
 				break;
 
 			case tmrCOMMAND_DELETE :
 				/* The timer has already been removed from the active list,
-				just free up the memory. */
-				vPortFree( pxTimer );
+				just free up the memory, unless it belongs to the
+				application. */
+				#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+					if( pxTimer->ucStaticallyAllocated == ( unsigned char ) pdFALSE )
+				#endif
+				{
+					vPortFree( pxTimer );
+				}
 				break;
 
 			default	:			
@@ -618,10 +1355,16 @@ portBASE_TYPE xResult;
 	pxCurrentTimerList = pxOverflowTimerList;
 	pxOverflowTimerList = pxTemp;
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void prvCheckForValidListAndQueue( void )
 {
+#if ( configUSE_TIMER_WHEEL == 1 )
+	unsigned portBASE_TYPE uxLevel, uxSlot;
+#endif
+
 	/* Check that the list from which active timers are referenced, and the
 	queue used to communicate with the timer service, have been
 	initialised. */
@@ -629,11 +1372,35 @@ static void prvCheckForValidListAndQueue( void )
 	{
 		if( xTimerQueue == NULL )
 		{
-			vListInitialise( &xActiveTimerList1 );
-			vListInitialise( &xActiveTimerList2 );
-			pxCurrentTimerList = &xActiveTimerList1;
-			pxOverflowTimerList = &xActiveTimerList2;
-			xTimerQueue = xQueueCreate( ( unsigned portBASE_TYPE ) configTIMER_QUEUE_LENGTH, sizeof( xTIMER_MESSAGE ) );
+			#if ( configUSE_TIMER_WHEEL == 1 )
+			{
+				for( uxLevel = 0U; uxLevel < ( unsigned portBASE_TYPE ) configTIMER_WHEEL_LEVELS; uxLevel++ )
+				{
+					for( uxSlot = 0U; uxSlot < tmrWHEEL_SLOTS; uxSlot++ )
+					{
+						vListInitialise( &( xTimerWheel[ uxLevel ][ uxSlot ] ) );
+					}
+				}
+
+				vListInitialise( &xTimerWheelFar );
+			}
+			#else
+			{
+				vListInitialise( &xActiveTimerList1 );
+				vListInitialise( &xActiveTimerList2 );
+				pxCurrentTimerList = &xActiveTimerList1;
+				pxOverflowTimerList = &xActiveTimerList2;
+			}
+			#endif
+			#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			{
+				xTimerQueue = xQueueCreateStatic( ( unsigned portBASE_TYPE ) configTIMER_QUEUE_LENGTH, sizeof( xTIMER_MESSAGE ), ucTimerQueueStorage, &xTimerQueueBuffer );
+			}
+			#else
+			{
+				xTimerQueue = xQueueCreate( ( unsigned portBASE_TYPE ) configTIMER_QUEUE_LENGTH, sizeof( xTIMER_MESSAGE ) );
+			}
+			#endif
 		}
 	}
 	taskEXIT_CRITICAL();
@@ -649,8 +1416,9 @@ xTIMER *pxTimer = ( xTIMER * ) xTimer;
 	taskENTER_CRITICAL();
 	{
 		/* Checking to see if it is in the NULL list in effect checks to see if
-		it is referenced from either the current or the overflow timer lists in
-		one go, but the logic has to be reversed, hence the '!'. */
+		it is referenced from either the current or the overflow timer lists,
+		or from any slot of the wheel, in one go, but the logic has to be
+		reversed, hence the '!'. */
 		xTimerIsInActiveList = !( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) );
 	}
 	taskEXIT_CRITICAL();
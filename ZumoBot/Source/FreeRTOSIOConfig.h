@@ -57,6 +57,7 @@
 	#define ioconfigUSE_UART_TX_CHAR_QUEUE					1
 	#define ioconfigUSE_UART_CIRCULAR_BUFFER_RX				1
 	#define ioconfigUSE_UART_RX_CHAR_QUEUE					1
+	#define ioconfigDEFER_UART_RX_CHAR_QUEUE				1	/* The interrupt only empties the FIFO, the timer service task queues the characters. */
 
 #define ioconfigINCLUDE_SSP									1
 	#define ioconfigUSE_SSP_POLLED_TX						1
@@ -73,6 +74,12 @@
 	#define ioconfigUSE_I2C_CIRCULAR_BUFFER_RX				1
 	#define ioconfigUSE_I2C_TX_CHAR_QUEUE					1
 
+/* Time the UART interrupt, for the "profile" command of a build with
+-DprofilerENABLED=1. */
+#include "Profiler.h"
+#define ioconfigUART_ISR_ENTER()							profilerBEGIN( profilerUART_ISR )
+#define ioconfigUART_ISR_EXIT()								profilerEND( profilerUART_ISR )
+
 
 
 
@@ -0,0 +1,235 @@
+/*
+ * Burst mode ADC sampling of the IR distance sensors, moved into RAM by the
+ * GPDMA.  See ADC-DMA-sampler.h.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include "LPC17xx.h"
+#include "lpc17xx_adc.h"
+#include "lpc17xx_gpdma.h"
+
+/* Zumo includes. */
+#include "ADC-DMA-sampler.h"
+#include "Cycle-counter.h"
+#include "Profiler.h"
+
+/* The ring holds two blocks, one being filled by the DMA while the other is
+averaged. */
+#define adcsamplerRING_ROUNDS		( adcsamplerSAMPLES_PER_BLOCK * 2 )
+
+/* The registers of the DMA channel in use.  The channel register blocks are
+0x20 bytes apart. */
+#define adcsamplerDMA_CHANNEL_REGS	( ( LPC_GPDMACH_TypeDef * ) ( LPC_GPDMACH0_BASE + ( adcsamplerDMA_CHANNEL * 0x20UL ) ) )
+#define adcsamplerDMA_CHANNEL_MASK	( GPDMA_DMACIntTCStat_Ch( adcsamplerDMA_CHANNEL ) )
+
+/* Each DMA request copies the data registers of all the sampled channels in
+one burst, so both the source and the destination addresses increment. */
+#define adcsamplerLLI_CONTROL		( GPDMA_DMACCxControl_TransferSize( adcsamplerNUM_CHANNELS ) \
+									| GPDMA_DMACCxControl_SBSize( GPDMA_BSIZE_4 ) \
+									| GPDMA_DMACCxControl_DBSize( GPDMA_BSIZE_4 ) \
+									| GPDMA_DMACCxControl_SWidth( GPDMA_WIDTH_WORD ) \
+									| GPDMA_DMACCxControl_DWidth( GPDMA_WIDTH_WORD ) \
+									| GPDMA_DMACCxControl_SI \
+									| GPDMA_DMACCxControl_DI )
+
+/* The filtered values are held with this many fractional bits. */
+#define adcsamplerFILTER_FRACTION_BITS	( 4 )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Average the block that starts at ring round ulFirstRound.  Called from the
+ * DMA interrupt.
+ */
+static void prvProcessBlock( uint32_t ulFirstRound );
+
+/*-----------------------------------------------------------*/
+
+/* The raw ADC data register values written by the DMA.  Each round holds one
+sample of every channel. */
+static volatile uint32_t ulSampleRing[ adcsamplerRING_ROUNDS ][ adcsamplerNUM_CHANNELS ];
+
+/* One linked list item per round.  The last item links back to the first, so
+the DMA never stops.  The last item of each half raises the terminal count
+interrupt. */
+static GPDMA_LLI_Type xLinkedList[ adcsamplerRING_ROUNDS ];
+
+/* The results of the most recently completed block. */
+static volatile uint16_t usAverages[ adcsamplerNUM_CHANNELS ];
+static volatile int32_t lFiltered[ adcsamplerNUM_CHANNELS ];
+
+/* The task to notify each time a block completes.  Set by the first call to
+xADCSamplerWaitForBlock(). */
+static volatile xTaskHandle xWaitingTask = NULL;
+
+static xADCSamplerStats xStats = { 0UL, 0UL, 0UL, 0UL };
+
+/*-----------------------------------------------------------*/
+
+void vADCSamplerStart( void )
+{
+uint32_t ulRound;
+LPC_GPDMACH_TypeDef * const pxChannel = adcsamplerDMA_CHANNEL_REGS;
+
+	vCycleCounterEnable();
+
+	for( ulRound = 0UL; ulRound < adcsamplerRING_ROUNDS; ulRound++ )
+	{
+		xLinkedList[ ulRound ].SrcAddr = ( uint32_t ) &( LPC_ADC->ADDR0 );
+		xLinkedList[ ulRound ].DstAddr = ( uint32_t ) &( ulSampleRing[ ulRound ][ 0 ] );
+		xLinkedList[ ulRound ].NextLLI = ( uint32_t ) &( xLinkedList[ ( ulRound + 1UL ) % adcsamplerRING_ROUNDS ] );
+		xLinkedList[ ulRound ].Control = adcsamplerLLI_CONTROL;
+
+		if( ( ( ulRound + 1UL ) % adcsamplerSAMPLES_PER_BLOCK ) == 0UL )
+		{
+			/* Last round of a half. */
+			xLinkedList[ ulRound ].Control |= GPDMA_DMACCxControl_I;
+		}
+	}
+
+	/* The DMA request is raised by the done flag of the last channel in the
+	burst sequence, so there is one request per round.  The global done flag
+	must not raise requests too.  The ADC interrupt itself is never enabled in
+	the NVIC. */
+	ADC_IntConfig( LPC_ADC, ADC_ADGINTEN, DISABLE );
+	ADC_IntConfig( LPC_ADC, ( ADC_TYPE_INT_OPT ) ( adcsamplerNUM_CHANNELS - 1 ), ENABLE );
+
+	GPDMA_Init();
+
+	/* GPDMA_Setup() only supports reading the ADC global data register, which
+	cannot supply all the channels in one burst, so the channel is loaded
+	with the first linked list item directly. */
+	pxChannel->DMACCSrcAddr = xLinkedList[ 0 ].SrcAddr;
+	pxChannel->DMACCDestAddr = xLinkedList[ 0 ].DstAddr;
+	pxChannel->DMACCLLI = xLinkedList[ 0 ].NextLLI;
+	pxChannel->DMACCControl = xLinkedList[ 0 ].Control;
+	pxChannel->DMACCConfig = GPDMA_DMACCxConfig_SrcPeripheral( GPDMA_CONN_ADC )
+							| GPDMA_DMACCxConfig_TransferType( GPDMA_TRANSFERTYPE_P2M )
+							| GPDMA_DMACCxConfig_IE
+							| GPDMA_DMACCxConfig_ITC;
+
+	LPC_GPDMA->DMACConfig = GPDMA_DMACConfig_E;
+	while( ( LPC_GPDMA->DMACConfig & GPDMA_DMACConfig_E ) == 0UL );
+
+	NVIC_SetPriority( DMA_IRQn, adcsamplerINTERRUPT_PRIORITY );
+	NVIC_EnableIRQ( DMA_IRQn );
+
+	GPDMA_ChannelCmd( adcsamplerDMA_CHANNEL, ENABLE );
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usADCSamplerGetAverage( uint8_t ucChannel )
+{
+	configASSERT( ucChannel < adcsamplerNUM_CHANNELS );
+	return usAverages[ ucChannel ];
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usADCSamplerGetFiltered( uint8_t ucChannel )
+{
+	configASSERT( ucChannel < adcsamplerNUM_CHANNELS );
+	return ( uint16_t ) ( lFiltered[ ucChannel ] >> adcsamplerFILTER_FRACTION_BITS );
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xADCSamplerWaitForBlock( portTickType xTicksToWait )
+{
+	xWaitingTask = xTaskGetCurrentTaskHandle();
+	return ( ulTaskNotifyTake( pdTRUE, xTicksToWait ) != 0UL ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+void vADCSamplerGetStats( xADCSamplerStats *pxStats )
+{
+	taskENTER_CRITICAL();
+	{
+		*pxStats = xStats;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessBlock( uint32_t ulFirstRound )
+{
+uint32_t ulRound, ulChannel;
+uint32_t ulSums[ adcsamplerNUM_CHANNELS ] = { 0UL };
+int32_t lAverage;
+
+	for( ulRound = ulFirstRound; ulRound < ( ulFirstRound + adcsamplerSAMPLES_PER_BLOCK ); ulRound++ )
+	{
+		for( ulChannel = 0UL; ulChannel < adcsamplerNUM_CHANNELS; ulChannel++ )
+		{
+			ulSums[ ulChannel ] += ADC_DR_RESULT( ulSampleRing[ ulRound ][ ulChannel ] );
+		}
+	}
+
+	for( ulChannel = 0UL; ulChannel < adcsamplerNUM_CHANNELS; ulChannel++ )
+	{
+		lAverage = ( int32_t ) ( ulSums[ ulChannel ] / adcsamplerSAMPLES_PER_BLOCK );
+		usAverages[ ulChannel ] = ( uint16_t ) lAverage;
+
+		/* First order low pass filter, in fixed point. */
+		lAverage <<= adcsamplerFILTER_FRACTION_BITS;
+		lFiltered[ ulChannel ] += ( lAverage - lFiltered[ ulChannel ] ) >> adcsamplerFILTER_SHIFT;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void DMA_IRQHandler( void )
+{
+LPC_GPDMACH_TypeDef * const pxChannel = adcsamplerDMA_CHANNEL_REGS;
+portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+uint32_t ulStartCycles, ulCycles, ulNextItem, ulFillingRound;
+
+	ulStartCycles = ulCycleCounterRead();
+	profilerBEGIN( profilerADC_DMA_ISR );
+
+	if( ( LPC_GPDMA->DMACIntTCStat & adcsamplerDMA_CHANNEL_MASK ) != 0UL )
+	{
+		LPC_GPDMA->DMACIntTCClear = adcsamplerDMA_CHANNEL_MASK;
+
+		/* The LLI register holds the item that follows the round currently
+		being filled.  Whichever half that round is in, the other half is
+		complete.  Working it out from the hardware, rather than toggling a
+		variable, means a late interrupt cannot leave the two out of step. */
+		ulNextItem = ( pxChannel->DMACCLLI - ( uint32_t ) &( xLinkedList[ 0 ] ) ) / sizeof( GPDMA_LLI_Type );
+		ulFillingRound = ( ulNextItem + adcsamplerRING_ROUNDS - 1UL ) % adcsamplerRING_ROUNDS;
+
+		if( ulFillingRound < adcsamplerSAMPLES_PER_BLOCK )
+		{
+			prvProcessBlock( adcsamplerSAMPLES_PER_BLOCK );
+		}
+		else
+		{
+			prvProcessBlock( 0UL );
+		}
+
+		xStats.ulBlocksCompleted++;
+
+		if( xWaitingTask != NULL )
+		{
+			vTaskNotifyGiveFromISR( xWaitingTask, &xHigherPriorityTaskWoken );
+		}
+	}
+
+	if( ( LPC_GPDMA->DMACIntErrStat & adcsamplerDMA_CHANNEL_MASK ) != 0UL )
+	{
+		LPC_GPDMA->DMACIntErrClr = adcsamplerDMA_CHANNEL_MASK;
+		xStats.ulDMAErrors++;
+	}
+
+	profilerEND( profilerADC_DMA_ISR );
+	ulCycles = ulCycleCounterRead() - ulStartCycles;
+	xStats.ulLastISRCycles = ulCycles;
+	if( ulCycles > xStats.ulMaxISRCycles )
+	{
+		xStats.ulMaxISRCycles = ulCycles;
+	}
+
+	portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
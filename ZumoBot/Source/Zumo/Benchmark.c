@@ -0,0 +1,1425 @@
+/*
+ * Times the hardware access functions, the context switch, the wake of a task
+ * from an interrupt, the passing of bytes from an interrupt to a task, the
+ * passing of frames between tasks and the co-routine yield, and reports the
+ * time spent asleep, in the tick interrupt and in each task.  See Benchmark.h.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+#include "block_pool.h"
+#include "croutine.h"
+
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+
+/* Library includes. */
+#include "LPC17xx.h"
+#include "lpc17xx_adc.h"
+#include "lpc17xx_gpio.h"
+#include "lpc17xx_pwm.h"
+
+/* Zumo includes. */
+#include "Benchmark.h"
+#include "Cycle-counter.h"
+#include "Hal.h"
+#include "Motor-control.h"
+#include "Motors.h"
+
+/* The channels and port that are written and read without any effect. */
+#define benchmarkPWM_CHANNEL		( 5 )
+#define benchmarkGPIO_PORT			( 0 )
+#define benchmarkADC_CHANNEL		( 7 )
+
+#define benchmarkNUM_FUNCTIONS		( sizeof( xFunctions ) / sizeof( xBenchFunction ) )
+
+/* The priorities of the two tasks that switch between each other.  Every
+priority in between is left without ready tasks. */
+#define benchmarkSWITCH_LOW_PRIORITY	( tskIDLE_PRIORITY + 1 )
+#define benchmarkSWITCH_HIGH_PRIORITY	( configMAX_PRIORITIES - 1 )
+#define benchmarkSWITCH_STACK_SIZE		( configMINIMAL_STACK_SIZE )
+
+/* The interrupt pended by the "isr" command, which is otherwise unused, and
+the ways it wakes the receiving task. */
+#define benchmarkISR_IRQn				( I2S_IRQn )
+#define benchmarkISR_NOTIFY				( 0UL )
+#define benchmarkISR_QUEUE				( 1UL )
+#define benchmarkISR_NUM_WAYS			( 2UL )
+
+/* The ways the interrupt of the "stream" command passes bytes to the
+receiving task, numbered on from the ways of the "isr" command as the same
+interrupt is used. */
+#define benchmarkSTREAM_BUFFER			( 2UL )
+#define benchmarkSTREAM_QUEUE			( 3UL )
+#define benchmarkSTREAM_NUM_WAYS		( 2UL )
+
+/* The bytes written by each interrupt of the "stream" command, as many as
+the UART receive FIFO holds, and the space there is for them. */
+#define benchmarkSTREAM_BLOCK_BYTES		( 16UL )
+#define benchmarkSTREAM_BUFFER_BYTES	( 4UL * benchmarkSTREAM_BLOCK_BYTES )
+
+/* The ways the "pool" command passes frames, the number of frame sizes it
+tries, and the frames that can be waiting at once. */
+#define benchmarkPOOL_BY_VALUE			( 0UL )
+#define benchmarkPOOL_BY_POINTER		( 1UL )
+#define benchmarkPOOL_NUM_WAYS			( 2UL )
+#define benchmarkPOOL_NUM_SIZES			( sizeof( ulFrameSizes ) / sizeof( uint32_t ) )
+#define benchmarkPOOL_MAX_FRAME_BYTES	( 256UL )
+#define benchmarkPOOL_QUEUE_LENGTH		( 2 )
+
+/* The most tasks the "tasks" command lists. */
+#define benchmarkTASKS_MAX_TASKS		( 16 )
+
+/* The "coroutine" command yields between two co-routines. */
+#define benchmarkNUM_CO_ROUTINES		( 2 )
+
+/*-----------------------------------------------------------*/
+
+/* A function timed by the "bench" command. */
+typedef struct xBENCH_FUNCTION
+{
+	const char *pcName;
+	void ( *pxFunction )( void );
+} xBenchFunction;
+
+/* The fewest, total and most cycles of a set of measurements. */
+typedef struct xBENCH_RESULT
+{
+	uint32_t ulMin;
+	uint32_t ulTotal;
+	uint32_t ulMax;
+} xBenchResult;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The functions timed.  Each calls one hardware access function, with the
+ * arguments it would have in use.  prvNothing() measures the cost of the
+ * measurement itself.
+ */
+static void prvNothing( void );
+static void prvSetDuties( void );
+static void prvMotorDerecho( void );
+static void prvMotorIzquierdo( void );
+static void prvPWMMatchUpdate( void );
+static void prvSetPWM( void );
+static void prvHalPWM( void );
+static void prvGPIOSetValue( void );
+static void prvHalGPIOSet( void );
+static void prvGPIOReadValue( void );
+static void prvHalGPIORead( void );
+static void prvADCChannelGetData( void );
+static void prvHalADCRead( void );
+
+/*
+ * Implements the "bench" command.  Outputs one line per call.
+ */
+static portBASE_TYPE prvBenchCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+/*
+ * Implements the "switch" command.  Runs the measurement on the first call,
+ * then outputs one line per call.
+ */
+static portBASE_TYPE prvSwitchCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+/*
+ * The two tasks of the "switch" command.  The low priority task wakes the
+ * high priority task, which records how long it took to start running, then
+ * suspends itself again, and the low priority task records how long it took
+ * to get back.
+ */
+static void prvSwitchLowTask( void *pvParameters );
+static void prvSwitchHighTask( void *pvParameters );
+
+#if configUSE_CO_ROUTINES == 1
+
+	/*
+	 * Implements the "coroutine" command.  Runs the measurement on the first
+	 * call, then outputs one line per call.
+	 */
+	static portBASE_TYPE prvCoRoutineCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+	/*
+	 * The two co-routines and the two tasks of the "coroutine" command.  Each
+	 * pair yields to each other, and each records how long it took to get back
+	 * from the other.
+	 */
+	static void prvYieldCoRoutine( xCoRoutineHandle xHandle, unsigned portBASE_TYPE uxIndex );
+	static void prvYieldTask( void *pvParameters );
+
+	/*
+	 * Add ulCycles to *pxResult, unless it is the first yield of the
+	 * measurement, which may have been from another task, or the yields
+	 * already number benchmarkCALLS.
+	 */
+	static void prvRecordYield( xBenchResult *pxResult, uint32_t ulCycles );
+
+#endif
+
+/*
+ * Implements the "isr" command.  Runs the measurement on the first call,
+ * then outputs one line per call.
+ */
+static portBASE_TYPE prvISRCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+/*
+ * The task woken by the interrupt of the "isr" command.  The parameter is
+ * benchmarkISR_NOTIFY or benchmarkISR_QUEUE.
+ */
+static void prvISRReceiverTask( void *pvParameters );
+
+/*
+ * Implements the "stream" command.  Runs the measurement on the first call,
+ * then outputs one line per call.
+ */
+static portBASE_TYPE prvStreamCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+/*
+ * The task that reads the bytes written by the interrupt of the "stream"
+ * command.  The parameter is benchmarkSTREAM_BUFFER or benchmarkSTREAM_QUEUE.
+ */
+static void prvStreamReceiverTask( void *pvParameters );
+
+/*
+ * Implements the "pool" command.  Runs the measurement on the first call,
+ * then outputs one line per call.
+ */
+static portBASE_TYPE prvPoolCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+/*
+ * The task that receives the frames sent by the "pool" command.  The
+ * parameter is benchmarkPOOL_BY_VALUE or benchmarkPOOL_BY_POINTER.
+ */
+static void prvPoolReceiverTask( void *pvParameters );
+
+#if configUSE_TICKLESS_IDLE == 1
+
+	/*
+	 * Implements the "sleep" command.
+	 */
+	static portBASE_TYPE prvSleepCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+#endif
+
+#if configGENERATE_TICK_STATS == 1
+
+	/*
+	 * Implements the "tick" command.
+	 */
+	static portBASE_TYPE prvTickCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+#endif
+
+#if configGENERATE_RUN_TIME_STATS == 1
+
+	/*
+	 * Implements the "tasks" command.  Outputs one line per call.
+	 */
+	static portBASE_TYPE prvTasksCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+#endif
+
+/*
+ * Add ulCycles to *pxResult.
+ */
+static void prvRecord( xBenchResult *pxResult, uint32_t ulCycles );
+
+/*-----------------------------------------------------------*/
+
+static const xCommandLineInput xBenchCommand =
+{
+	( const int8_t * const ) "bench",
+	( const int8_t * const ) "bench: Times the hardware access functions, in CPU cycles per call\r\n",
+	prvBenchCommand,
+	0
+};
+
+static const xCommandLineInput xSwitchCommand =
+{
+	( const int8_t * const ) "switch",
+	( const int8_t * const ) "switch: Times the context switch between the lowest and highest task priorities, in CPU cycles\r\n",
+	prvSwitchCommand,
+	0
+};
+
+#if configUSE_CO_ROUTINES == 1
+
+	static const xCommandLineInput xCoRoutineCommand =
+	{
+		( const int8_t * const ) "coroutine",
+		( const int8_t * const ) "coroutine: Compares the yield and the heap used by two co-routines and by two tasks\r\n",
+		prvCoRoutineCommand,
+		0
+	};
+
+#endif
+
+static const xCommandLineInput xISRCommand =
+{
+	( const int8_t * const ) "isr",
+	( const int8_t * const ) "isr: Times the wake of a task from an interrupt by a task notification and by a queue, in CPU cycles\r\n",
+	prvISRCommand,
+	0
+};
+
+static const xCommandLineInput xStreamCommand =
+{
+	( const int8_t * const ) "stream",
+	( const int8_t * const ) "stream: Times passing bytes from an interrupt to a task through a stream buffer and through a queue\r\n",
+	prvStreamCommand,
+	0
+};
+
+static const xCommandLineInput xPoolCommand =
+{
+	( const int8_t * const ) "pool",
+	( const int8_t * const ) "pool: Times passing frames between tasks by value through a queue and by pointer from a block pool\r\n",
+	prvPoolCommand,
+	0
+};
+
+#if configUSE_TICKLESS_IDLE == 1
+
+	static const xCommandLineInput xSleepCommand =
+	{
+		( const int8_t * const ) "sleep",
+		( const int8_t * const ) "sleep: Shows the time spent asleep over one second, and the cycles taken to wake\r\n",
+		prvSleepCommand,
+		0
+	};
+
+#endif
+
+#if configGENERATE_TICK_STATS == 1
+
+	static const xCommandLineInput xTickCommand =
+	{
+		( const int8_t * const ) "tick",
+		( const int8_t * const ) "tick: Shows the cycles taken by the tick interrupt over one second\r\n",
+		prvTickCommand,
+		0
+	};
+
+#endif
+
+#if configGENERATE_RUN_TIME_STATS == 1
+
+	static const xCommandLineInput xTasksCommand =
+	{
+		( const int8_t * const ) "tasks",
+		( const int8_t * const ) "tasks: Shows the CPU time, longest run and context switches of each task since start up\r\n",
+		prvTasksCommand,
+		0
+	};
+
+#endif
+
+static const xBenchFunction xFunctions[] =
+{
+	{ "(measurement)", prvNothing },
+	{ "vMotorsSetDuties", prvSetDuties },
+	{ "motorDerecho", prvMotorDerecho },
+	{ "motorIzquierdo", prvMotorIzquierdo },
+	{ "PWM_MatchUpdate", prvPWMMatchUpdate },
+	{ "setPWM", prvSetPWM },
+	{ "vHalPWMSetMatch+Latch", prvHalPWM },
+	{ "GPIO_SetValue", prvGPIOSetValue },
+	{ "vHalGPIOSet", prvHalGPIOSet },
+	{ "GPIO_ReadValue", prvGPIOReadValue },
+	{ "ulHalGPIORead", prvHalGPIORead },
+	{ "ADC_ChannelGetData", prvADCChannelGetData },
+	{ "ulHalADCRead", prvHalADCRead }
+};
+
+/* The values the timed functions write back, read before each call. */
+static xMotorControlStats xMotors;
+static uint32_t ulPWMMatch;
+
+/* Where the timed functions put what they read, so the reads are not
+optimised away. */
+static volatile uint32_t ulSink;
+
+/* Used by the "switch" and "isr" commands.  ulSwitchStart is written by the
+task or interrupt that switches out and read by the task that switches in. */
+static volatile uint32_t ulSwitchStart;
+static xBenchResult xWake, xBlock;
+static xTaskHandle xHighTask = NULL;
+static xSemaphoreHandle xSwitchDone = NULL;
+
+#if configUSE_CO_ROUTINES == 1
+
+	/* Used by the "coroutine" command.  The co-routines are created on the
+	first run and never deleted, so the heap they use is measured then.  Each
+	is flagged once created, so a run that could only create one of them
+	creates just the other one next time rather than a duplicate. */
+	static xBenchResult xCoRoutineYield, xTaskYield;
+	static volatile uint32_t ulYields;
+	static size_t xCoRoutineHeapBytes = 0;
+	static portBASE_TYPE xCoRoutineCreated[ benchmarkNUM_CO_ROUTINES ] = { pdFALSE, pdFALSE };
+
+#endif
+
+/* Used by the "isr" command. */
+static xBenchResult xISRWakes[ benchmarkISR_NUM_WAYS ];
+static volatile uint32_t ulISRWay = benchmarkISR_NOTIFY;
+static xTaskHandle xISRReceiver = NULL;
+static xQueueHandle xISRQueue = NULL;
+
+/* Used by the "stream" command. */
+static const uint8_t ucStreamBlock[ benchmarkSTREAM_BLOCK_BYTES ] = { 0 };
+static uint32_t ulStreamCycles[ benchmarkSTREAM_NUM_WAYS ];
+static volatile uint32_t ulStreamReceived;
+static xStreamBufferHandle xStreamBuffer = NULL;
+static xQueueHandle xStreamQueue = NULL;
+
+/* Used by the "pool" command.  The frames are not on the stacks of the tasks
+as the larger ones would not fit. */
+static const uint32_t ulFrameSizes[] = { 64UL, 256UL };
+static uint32_t ulPoolCycles[ benchmarkPOOL_NUM_WAYS * benchmarkPOOL_NUM_SIZES ];
+static uint8_t ucPoolFrame[ benchmarkPOOL_MAX_FRAME_BYTES ];
+static uint8_t ucPoolReceived[ benchmarkPOOL_MAX_FRAME_BYTES ];
+static uint32_t ulPoolFrameBytes;
+static xBlockPoolHandle xPool = NULL;
+static xQueueHandle xPoolQueue = NULL;
+
+/*-----------------------------------------------------------*/
+
+void vBenchmarkRegisterCommand( void )
+{
+	FreeRTOS_CLIRegisterCommand( &xBenchCommand );
+	FreeRTOS_CLIRegisterCommand( &xSwitchCommand );
+	FreeRTOS_CLIRegisterCommand( &xISRCommand );
+	FreeRTOS_CLIRegisterCommand( &xStreamCommand );
+	FreeRTOS_CLIRegisterCommand( &xPoolCommand );
+
+	#if configUSE_CO_ROUTINES == 1
+	{
+		FreeRTOS_CLIRegisterCommand( &xCoRoutineCommand );
+	}
+	#endif
+
+	#if configUSE_TICKLESS_IDLE == 1
+	{
+		FreeRTOS_CLIRegisterCommand( &xSleepCommand );
+	}
+	#endif
+
+	#if configGENERATE_TICK_STATS == 1
+	{
+		FreeRTOS_CLIRegisterCommand( &xTickCommand );
+	}
+	#endif
+
+	#if configGENERATE_RUN_TIME_STATS == 1
+	{
+		FreeRTOS_CLIRegisterCommand( &xTasksCommand );
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvNothing( void )
+{
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetDuties( void )
+{
+	vMotorsSetDuties( xMotors.lLeftDuty, xMotors.lRightDuty );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMotorDerecho( void )
+{
+	motorDerecho( ( xMotors.lRightDuty < 0L ) ? ATRAS : ADELANTE, ( int ) ( ( xMotors.lRightDuty < 0L ) ? -xMotors.lRightDuty : xMotors.lRightDuty ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMotorIzquierdo( void )
+{
+	motorIzquierdo( ( xMotors.lLeftDuty < 0L ) ? ATRAS : ADELANTE, ( int ) ( ( xMotors.lLeftDuty < 0L ) ? -xMotors.lLeftDuty : xMotors.lLeftDuty ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPWMMatchUpdate( void )
+{
+	PWM_MatchUpdate( LPC_PWM1, benchmarkPWM_CHANNEL, ulPWMMatch, PWM_MATCH_UPDATE_NEXT_RST );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetPWM( void )
+{
+	setPWM( benchmarkPWM_CHANNEL, ulPWMMatch );
+}
+/*-----------------------------------------------------------*/
+
+static void prvHalPWM( void )
+{
+	vHalPWMSetMatch( benchmarkPWM_CHANNEL, ulPWMMatch );
+	vHalPWMLatch( 1UL << benchmarkPWM_CHANNEL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvGPIOSetValue( void )
+{
+	GPIO_SetValue( benchmarkGPIO_PORT, 0UL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvHalGPIOSet( void )
+{
+	vHalGPIOSet( benchmarkGPIO_PORT, 0UL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvGPIOReadValue( void )
+{
+	ulSink = GPIO_ReadValue( benchmarkGPIO_PORT );
+}
+/*-----------------------------------------------------------*/
+
+static void prvHalGPIORead( void )
+{
+	ulSink = ulHalGPIORead( benchmarkGPIO_PORT, 0xffffffffUL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvADCChannelGetData( void )
+{
+	ulSink = ADC_ChannelGetData( LPC_ADC, benchmarkADC_CHANNEL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvHalADCRead( void )
+{
+	ulSink = ulHalADCRead( benchmarkADC_CHANNEL );
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvBenchCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+{
+static uint32_t ulLine = 0UL;
+static uint32_t ulOverhead = 0UL;
+const xBenchFunction *pxBench;
+uint32_t ulCall, ulStart, ulCycles, ulMin = 0xffffffffUL, ulMax = 0UL, ulTotal = 0UL;
+portBASE_TYPE xReturn = pdTRUE;
+
+	( void ) xWriteBufferLen;
+	( void ) pcCommandString;
+
+	if( ulLine == 0UL )
+	{
+		sprintf( ( char * ) pcWriteBuffer, "%u calls each, less the measurement\r\nFunction                    Min       Mean        Max\r\n", ( unsigned int ) benchmarkCALLS );
+	}
+	else
+	{
+		pxBench = &( xFunctions[ ulLine - 1UL ] );
+
+		for( ulCall = 0UL; ulCall < benchmarkCALLS; ulCall++ )
+		{
+			/* Nothing else can change the values written back while they
+			are. */
+			taskENTER_CRITICAL();
+			{
+				vMotorControlGetStats( &xMotors );
+				ulPWMMatch = halPWM1_MATCH( benchmarkPWM_CHANNEL );
+
+				ulStart = ulCycleCounterRead();
+				pxBench->pxFunction();
+				ulCycles = ulCycleCounterRead() - ulStart;
+			}
+			taskEXIT_CRITICAL();
+
+			if( ulLine > 1UL )
+			{
+				ulCycles = ( ulCycles > ulOverhead ) ? ( ulCycles - ulOverhead ) : 0UL;
+			}
+
+			ulTotal += ulCycles;
+			if( ulCycles < ulMin )
+			{
+				ulMin = ulCycles;
+			}
+			if( ulCycles > ulMax )
+			{
+				ulMax = ulCycles;
+			}
+		}
+
+		/* The fastest measurement of nothing is taken off the rest. */
+		if( ulLine == 1UL )
+		{
+			ulOverhead = ulMin;
+		}
+
+		sprintf( ( char * ) pcWriteBuffer, "%-23s %7u    %7u    %7u\r\n", pxBench->pcName, ( unsigned int ) ulMin,
+				( unsigned int ) ( ulTotal / benchmarkCALLS ), ( unsigned int ) ulMax );
+
+		if( ulLine == benchmarkNUM_FUNCTIONS )
+		{
+			xReturn = pdFALSE;
+		}
+	}
+
+	if( xReturn == pdFALSE )
+	{
+		ulLine = 0UL;
+	}
+	else
+	{
+		ulLine++;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvSwitchCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+{
+static uint32_t ulLine = 0UL;
+xTaskHandle xLowTask = NULL;
+const xBenchResult *pxResult;
+portBASE_TYPE xReturn = pdTRUE;
+
+	( void ) xWriteBufferLen;
+	( void ) pcCommandString;
+
+	if( ulLine == 0UL )
+	{
+		if( xSwitchDone == NULL )
+		{
+			vSemaphoreCreateBinary( xSwitchDone );
+			xSemaphoreTake( xSwitchDone, 0 );
+		}
+
+		xWake.ulMin = xBlock.ulMin = 0xffffffffUL;
+		xWake.ulTotal = xBlock.ulTotal = 0UL;
+		xWake.ulMax = xBlock.ulMax = 0UL;
+
+		/* The high priority task runs as soon as it is created, and suspends
+		itself straight away.  The low priority task only runs once this task
+		blocks on xSwitchDone. */
+		xTaskCreate( prvSwitchHighTask, ( signed char * ) "SwHi", benchmarkSWITCH_STACK_SIZE, NULL, benchmarkSWITCH_HIGH_PRIORITY, &xHighTask );
+		xTaskCreate( prvSwitchLowTask, ( signed char * ) "SwLo", benchmarkSWITCH_STACK_SIZE, NULL, benchmarkSWITCH_LOW_PRIORITY, &xLowTask );
+
+		if( ( xHighTask == NULL ) || ( xLowTask == NULL ) )
+		{
+			sprintf( ( char * ) pcWriteBuffer, "Not enough heap to create the tasks\r\n" );
+			xReturn = pdFALSE;
+		}
+		else
+		{
+			xSemaphoreTake( xSwitchDone, portMAX_DELAY );
+			sprintf( ( char * ) pcWriteBuffer, "%u switches each way between priorities %u and %u\r\nSwitch                      Min       Mean        Max\r\n",
+					( unsigned int ) benchmarkCALLS, ( unsigned int ) benchmarkSWITCH_LOW_PRIORITY, ( unsigned int ) benchmarkSWITCH_HIGH_PRIORITY );
+		}
+
+		if( xHighTask != NULL )
+		{
+			vTaskDelete( xHighTask );
+			xHighTask = NULL;
+		}
+
+		if( xLowTask != NULL )
+		{
+			vTaskDelete( xLowTask );
+		}
+	}
+	else
+	{
+		pxResult = ( ulLine == 1UL ) ? &xWake : &xBlock;
+		sprintf( ( char * ) pcWriteBuffer, "%-23s %7u    %7u    %7u\r\n", ( ulLine == 1UL ) ? "wake (vTaskResume)" : "block (vTaskSuspend)",
+				( unsigned int ) pxResult->ulMin, ( unsigned int ) ( pxResult->ulTotal / benchmarkCALLS ), ( unsigned int ) pxResult->ulMax );
+
+		if( ulLine == 2UL )
+		{
+			xReturn = pdFALSE;
+		}
+	}
+
+	if( xReturn == pdFALSE )
+	{
+		ulLine = 0UL;
+	}
+	else
+	{
+		ulLine++;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchLowTask( void *pvParameters )
+{
+uint32_t ulCall;
+
+	( void ) pvParameters;
+
+	for( ulCall = 0UL; ulCall < benchmarkCALLS; ulCall++ )
+	{
+		/* The high priority task runs from within vTaskResume(), and the
+		cycles are read again when it has suspended itself. */
+		ulSwitchStart = ulCycleCounterRead();
+		vTaskResume( xHighTask );
+		prvRecord( &xBlock, ulCycleCounterRead() - ulSwitchStart );
+	}
+
+	xSemaphoreGive( xSwitchDone );
+	vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchHighTask( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	/* The task is only ever resumed by the low priority task, which sets
+	ulSwitchStart first. */
+	for( ;; )
+	{
+		ulSwitchStart = ulCycleCounterRead();
+		vTaskSuspend( NULL );
+		prvRecord( &xWake, ulCycleCounterRead() - ulSwitchStart );
+	}
+}
+/*-----------------------------------------------------------*/
+
+#if configUSE_CO_ROUTINES == 1
+
+	static portBASE_TYPE prvCoRoutineCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+	{
+	static uint32_t ulLine = 0UL;
+	static size_t xTaskHeapBytes;
+	xTaskHandle xFirstTask = NULL, xSecondTask = NULL;
+	const xBenchResult *pxResult;
+	size_t xFreeBefore;
+	portBASE_TYPE xReturn = pdTRUE, xCoRoutinesReady = pdTRUE;
+	unsigned portBASE_TYPE uxIndex;
+
+		( void ) xWriteBufferLen;
+		( void ) pcCommandString;
+
+		if( ulLine == 0UL )
+		{
+			if( xSwitchDone == NULL )
+			{
+				vSemaphoreCreateBinary( xSwitchDone );
+				xSemaphoreTake( xSwitchDone, 0 );
+			}
+
+			xCoRoutineYield.ulMin = xTaskYield.ulMin = 0xffffffffUL;
+			xCoRoutineYield.ulTotal = xTaskYield.ulTotal = 0UL;
+			xCoRoutineYield.ulMax = xTaskYield.ulMax = 0UL;
+
+			for( uxIndex = 0; uxIndex < benchmarkNUM_CO_ROUTINES; uxIndex++ )
+			{
+				if( xCoRoutineCreated[ uxIndex ] == pdFALSE )
+				{
+					xFreeBefore = xPortGetFreeHeapSize();
+
+					if( xCoRoutineCreate( prvYieldCoRoutine, 0, uxIndex ) == pdPASS )
+					{
+						xCoRoutineCreated[ uxIndex ] = pdTRUE;
+						xCoRoutineHeapBytes += xFreeBefore - xPortGetFreeHeapSize();
+					}
+					else
+					{
+						xCoRoutinesReady = pdFALSE;
+					}
+				}
+			}
+
+			if( xCoRoutinesReady != pdFALSE )
+			{
+				/* The co-routines only run when scheduled, and are scheduled
+				from here, so share the stack of this task. */
+				ulYields = 0UL;
+				while( ulYields <= benchmarkCALLS )
+				{
+					vCoRoutineSchedule();
+				}
+			}
+
+			/* The tasks give xSwitchDone when they finish, and on failure
+			nothing takes it, so they are only created once the co-routines
+			have run.  Both are created before either runs, so the first yield
+			is always to the other, and if only one could be created it is
+			deleted before it runs. */
+			if( xCoRoutinesReady != pdFALSE )
+			{
+				ulYields = 0UL;
+				xFreeBefore = xPortGetFreeHeapSize();
+				vTaskSuspendAll();
+				{
+					xTaskCreate( prvYieldTask, ( signed char * ) "Yld1", benchmarkSWITCH_STACK_SIZE, NULL, benchmarkSWITCH_HIGH_PRIORITY, &xFirstTask );
+					xTaskCreate( prvYieldTask, ( signed char * ) "Yld2", benchmarkSWITCH_STACK_SIZE, NULL, benchmarkSWITCH_HIGH_PRIORITY, &xSecondTask );
+
+					if( ( xFirstTask == NULL ) || ( xSecondTask == NULL ) )
+					{
+						if( xFirstTask != NULL )
+						{
+							vTaskDelete( xFirstTask );
+							xFirstTask = NULL;
+						}
+
+						if( xSecondTask != NULL )
+						{
+							vTaskDelete( xSecondTask );
+							xSecondTask = NULL;
+						}
+					}
+				}
+				xTaskResumeAll();
+				xTaskHeapBytes = xFreeBefore - xPortGetFreeHeapSize();
+			}
+
+			if( ( xFirstTask == NULL ) || ( xSecondTask == NULL ) || ( xCoRoutinesReady == pdFALSE ) )
+			{
+				sprintf( ( char * ) pcWriteBuffer, "Not enough heap to create the co-routines and tasks\r\n" );
+				xReturn = pdFALSE;
+			}
+			else
+			{
+				xSemaphoreTake( xSwitchDone, portMAX_DELAY );
+				sprintf( ( char * ) pcWriteBuffer, "%u yields between two co-routines and between two tasks of priority %u\r\nYield                       Min       Mean        Max    Heap each\r\n",
+						( unsigned int ) benchmarkCALLS, ( unsigned int ) benchmarkSWITCH_HIGH_PRIORITY );
+			}
+
+			if( xFirstTask != NULL )
+			{
+				vTaskDelete( xFirstTask );
+			}
+
+			if( xSecondTask != NULL )
+			{
+				vTaskDelete( xSecondTask );
+			}
+		}
+		else
+		{
+			pxResult = ( ulLine == 1UL ) ? &xCoRoutineYield : &xTaskYield;
+			sprintf( ( char * ) pcWriteBuffer, "%-23s %7u    %7u    %7u    %7u B\r\n", ( ulLine == 1UL ) ? "co-routine (crDELAY 0)" : "task (taskYIELD)",
+					( unsigned int ) pxResult->ulMin, ( unsigned int ) ( pxResult->ulTotal / benchmarkCALLS ), ( unsigned int ) pxResult->ulMax,
+					( unsigned int ) ( ( ulLine == 1UL ) ? ( xCoRoutineHeapBytes / benchmarkNUM_CO_ROUTINES ) : ( xTaskHeapBytes / 2 ) ) );
+
+			if( ulLine == 2UL )
+			{
+				xReturn = pdFALSE;
+			}
+		}
+
+		if( xReturn == pdFALSE )
+		{
+			ulLine = 0UL;
+		}
+		else
+		{
+			ulLine++;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvYieldCoRoutine( xCoRoutineHandle xHandle, unsigned portBASE_TYPE uxIndex )
+	{
+		( void ) uxIndex;
+
+		/* Nothing on the stack lasts over crDELAY(), so the start of the
+		yield is kept in ulSwitchStart. */
+		crSTART( xHandle );
+
+		for( ;; )
+		{
+			ulSwitchStart = ulCycleCounterRead();
+			crDELAY( xHandle, 0 );
+			prvRecordYield( &xCoRoutineYield, ulCycleCounterRead() - ulSwitchStart );
+		}
+
+		crEND();
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvYieldTask( void *pvParameters )
+	{
+		( void ) pvParameters;
+
+		for( ;; )
+		{
+			ulSwitchStart = ulCycleCounterRead();
+			taskYIELD();
+			prvRecordYield( &xTaskYield, ulCycleCounterRead() - ulSwitchStart );
+
+			if( ulYields > benchmarkCALLS )
+			{
+				/* Both tasks give the semaphore, but the command task is of
+				lower priority so only takes it once both are suspended. */
+				xSemaphoreGive( xSwitchDone );
+				vTaskSuspend( NULL );
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvRecordYield( xBenchResult *pxResult, uint32_t ulCycles )
+	{
+		if( ( ulYields != 0UL ) && ( ulYields <= benchmarkCALLS ) )
+		{
+			prvRecord( pxResult, ulCycles );
+		}
+
+		ulYields++;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configUSE_CO_ROUTINES */
+
+static portBASE_TYPE prvISRCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+{
+static uint32_t ulLine = 0UL;
+static const char * const pcWays[ benchmarkISR_NUM_WAYS ] = { "vTaskNotifyGiveFromISR", "xQueueSendFromISR" };
+uint32_t ulWay, ulCall;
+const xBenchResult *pxResult;
+portBASE_TYPE xReturn = pdTRUE;
+
+	( void ) xWriteBufferLen;
+	( void ) pcCommandString;
+
+	if( ulLine == 0UL )
+	{
+		if( xISRQueue == NULL )
+		{
+			xISRQueue = xQueueCreate( 1, sizeof( uint32_t ) );
+		}
+
+		sprintf( ( char * ) pcWriteBuffer, "%u wakes each of a priority %u task\r\nWoken by                    Min       Mean        Max\r\n",
+				( unsigned int ) benchmarkCALLS, ( unsigned int ) benchmarkSWITCH_HIGH_PRIORITY );
+
+		NVIC_SetPriority( benchmarkISR_IRQn, benchmarkISR_INTERRUPT_PRIORITY );
+		NVIC_EnableIRQ( benchmarkISR_IRQn );
+
+		for( ulWay = 0UL; ulWay < benchmarkISR_NUM_WAYS; ulWay++ )
+		{
+			xISRWakes[ ulWay ].ulMin = 0xffffffffUL;
+			xISRWakes[ ulWay ].ulTotal = 0UL;
+			xISRWakes[ ulWay ].ulMax = 0UL;
+			ulISRWay = ulWay;
+
+			/* The receiver runs as soon as it is created, and blocks. */
+			xISRReceiver = NULL;
+			xTaskCreate( prvISRReceiverTask, ( signed char * ) "IsrRx", benchmarkSWITCH_STACK_SIZE, ( void * ) ulWay, benchmarkSWITCH_HIGH_PRIORITY, &xISRReceiver );
+
+			if( ( xISRReceiver == NULL ) || ( xISRQueue == NULL ) )
+			{
+				sprintf( ( char * ) pcWriteBuffer, "Not enough heap to create the task and queue\r\n" );
+				xReturn = pdFALSE;
+				break;
+			}
+
+			/* Each interrupt runs as soon as it is pended, and the receiver
+			runs, and blocks again, before the interrupted task continues. */
+			for( ulCall = 0UL; ulCall < benchmarkCALLS; ulCall++ )
+			{
+				NVIC_SetPendingIRQ( benchmarkISR_IRQn );
+			}
+
+			vTaskDelete( xISRReceiver );
+			xISRReceiver = NULL;
+		}
+
+		NVIC_DisableIRQ( benchmarkISR_IRQn );
+	}
+	else
+	{
+		pxResult = &( xISRWakes[ ulLine - 1UL ] );
+		sprintf( ( char * ) pcWriteBuffer, "%-23s %7u    %7u    %7u\r\n", pcWays[ ulLine - 1UL ],
+				( unsigned int ) pxResult->ulMin, ( unsigned int ) ( pxResult->ulTotal / benchmarkCALLS ), ( unsigned int ) pxResult->ulMax );
+
+		if( ulLine == benchmarkISR_NUM_WAYS )
+		{
+			xReturn = pdFALSE;
+		}
+	}
+
+	if( xReturn == pdFALSE )
+	{
+		ulLine = 0UL;
+	}
+	else
+	{
+		ulLine++;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvISRReceiverTask( void *pvParameters )
+{
+uint32_t ulValue;
+
+	for( ;; )
+	{
+		if( ( uint32_t ) pvParameters == benchmarkISR_NOTIFY )
+		{
+			ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+		}
+		else
+		{
+			xQueueReceive( xISRQueue, &ulValue, portMAX_DELAY );
+		}
+
+		prvRecord( &( xISRWakes[ ( uint32_t ) pvParameters ] ), ulCycleCounterRead() - ulSwitchStart );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvStreamCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+{
+static uint32_t ulLine = 0UL;
+static const char * const pcWays[ benchmarkSTREAM_NUM_WAYS ] = { "xStreamBufferSendFromISR", "xQueueSendFromISR" };
+const uint32_t ulBytes = benchmarkCALLS * benchmarkSTREAM_BLOCK_BYTES;
+uint32_t ulWay, ulCall, ulStart, ulBytesPerSecond;
+xTaskHandle xReceiver;
+portBASE_TYPE xReturn = pdTRUE;
+
+	( void ) xWriteBufferLen;
+	( void ) pcCommandString;
+
+	if( ulLine == 0UL )
+	{
+		if( xStreamBuffer == NULL )
+		{
+			xStreamBuffer = xStreamBufferCreate( benchmarkSTREAM_BUFFER_BYTES, 1 );
+		}
+
+		if( xStreamQueue == NULL )
+		{
+			xStreamQueue = xQueueCreate( benchmarkSTREAM_BUFFER_BYTES, sizeof( uint8_t ) );
+		}
+
+		sprintf( ( char * ) pcWriteBuffer, "%u interrupts each writing %u bytes to a priority %u task\r\nWritten by          Cycles/byte       kB/s      kbaud\r\n",
+				( unsigned int ) benchmarkCALLS, ( unsigned int ) benchmarkSTREAM_BLOCK_BYTES, ( unsigned int ) benchmarkSWITCH_HIGH_PRIORITY );
+
+		NVIC_SetPriority( benchmarkISR_IRQn, benchmarkISR_INTERRUPT_PRIORITY );
+		NVIC_EnableIRQ( benchmarkISR_IRQn );
+
+		for( ulWay = 0UL; ulWay < benchmarkSTREAM_NUM_WAYS; ulWay++ )
+		{
+			ulISRWay = benchmarkSTREAM_BUFFER + ulWay;
+			ulStreamReceived = 0UL;
+
+			/* The receiver runs as soon as it is created, and blocks. */
+			xReceiver = NULL;
+			xTaskCreate( prvStreamReceiverTask, ( signed char * ) "StrRx", benchmarkSWITCH_STACK_SIZE, ( void * ) ulISRWay, benchmarkSWITCH_HIGH_PRIORITY, &xReceiver );
+
+			if( ( xReceiver == NULL ) || ( xStreamBuffer == NULL ) || ( xStreamQueue == NULL ) )
+			{
+				sprintf( ( char * ) pcWriteBuffer, "Not enough heap to create the task, stream buffer and queue\r\n" );
+				xReturn = pdFALSE;
+				break;
+			}
+
+			/* The receiver reads each block before the interrupted task
+			continues, so the time covers every byte being written and read. */
+			ulStart = ulCycleCounterRead();
+
+			for( ulCall = 0UL; ulCall < benchmarkCALLS; ulCall++ )
+			{
+				NVIC_SetPendingIRQ( benchmarkISR_IRQn );
+			}
+
+			ulStreamCycles[ ulWay ] = ulCycleCounterRead() - ulStart;
+			configASSERT( ulStreamReceived == ulBytes );
+
+			vTaskDelete( xReceiver );
+		}
+
+		NVIC_DisableIRQ( benchmarkISR_IRQn );
+	}
+	else
+	{
+		/* The most bytes a second that could be passed with the CPU doing
+		nothing else, and the baud rate of a UART receiving that many, with a
+		start and a stop bit to each byte. */
+		ulBytesPerSecond = ( uint32_t ) ( ( ( uint64_t ) configCPU_CLOCK_HZ * ulBytes ) / ulStreamCycles[ ulLine - 1UL ] );
+		sprintf( ( char * ) pcWriteBuffer, "%-24s %6u    %7u    %7u\r\n", pcWays[ ulLine - 1UL ], ( unsigned int ) ( ulStreamCycles[ ulLine - 1UL ] / ulBytes ),
+				( unsigned int ) ( ulBytesPerSecond / 1000UL ), ( unsigned int ) ( ulBytesPerSecond / 100UL ) );
+
+		if( ulLine == benchmarkSTREAM_NUM_WAYS )
+		{
+			xReturn = pdFALSE;
+		}
+	}
+
+	if( xReturn == pdFALSE )
+	{
+		ulLine = 0UL;
+	}
+	else
+	{
+		ulLine++;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStreamReceiverTask( void *pvParameters )
+{
+uint8_t ucBytes[ benchmarkSTREAM_BUFFER_BYTES ];
+
+	for( ;; )
+	{
+		if( ( uint32_t ) pvParameters == benchmarkSTREAM_BUFFER )
+		{
+			ulStreamReceived += xStreamBufferReceive( xStreamBuffer, ucBytes, sizeof( ucBytes ), portMAX_DELAY );
+		}
+		else
+		{
+			/* Wait for the first byte, then take the rest without blocking. */
+			xQueueReceive( xStreamQueue, &( ucBytes[ 0 ] ), portMAX_DELAY );
+
+			do
+			{
+				ulStreamReceived++;
+			} while( xQueueReceive( xStreamQueue, &( ucBytes[ 0 ] ), 0 ) == pdPASS );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvPoolCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+{
+static uint32_t ulLine = 0UL;
+static const char * const pcWays[ benchmarkPOOL_NUM_WAYS ] = { "by value", "by pointer" };
+uint32_t ulResult, ulWay, ulSize, ulCall, ulStart;
+uint8_t *pucFrame;
+xTaskHandle xReceiver;
+portBASE_TYPE xReturn = pdTRUE;
+
+	( void ) xWriteBufferLen;
+	( void ) pcCommandString;
+
+	if( ulLine == 0UL )
+	{
+		sprintf( ( char * ) pcWriteBuffer, "%u frames each to a priority %u task\r\nFrame                    Cycles       kB/s\r\n",
+				( unsigned int ) benchmarkCALLS, ( unsigned int ) benchmarkSWITCH_HIGH_PRIORITY );
+
+		for( ulResult = 0UL; ulResult < ( benchmarkPOOL_NUM_WAYS * benchmarkPOOL_NUM_SIZES ); ulResult++ )
+		{
+			ulSize = ulResult / benchmarkPOOL_NUM_WAYS;
+			ulWay = ulResult % benchmarkPOOL_NUM_WAYS;
+			ulPoolFrameBytes = ulFrameSizes[ ulSize ];
+
+			/* Both ways have room for the same number of frames.  They are
+			created for each measurement, and deleted after it, as the queue
+			of the larger frames takes a lot of heap. */
+			if( ulWay == benchmarkPOOL_BY_VALUE )
+			{
+				xPoolQueue = xQueueCreate( benchmarkPOOL_QUEUE_LENGTH, ulPoolFrameBytes );
+			}
+			else
+			{
+				xPool = xBlockPoolCreate( ulPoolFrameBytes, benchmarkPOOL_QUEUE_LENGTH );
+				xPoolQueue = xBlockPoolQueueCreate( benchmarkPOOL_QUEUE_LENGTH );
+			}
+
+			/* The receiver runs as soon as it is created, and blocks. */
+			xReceiver = NULL;
+
+			if( ( xPoolQueue != NULL ) && ( ( ulWay == benchmarkPOOL_BY_VALUE ) || ( xPool != NULL ) ) )
+			{
+				xTaskCreate( prvPoolReceiverTask, ( signed char * ) "PoolRx", benchmarkSWITCH_STACK_SIZE, ( void * ) ulWay, benchmarkSWITCH_HIGH_PRIORITY, &xReceiver );
+			}
+
+			if( xReceiver != NULL )
+			{
+				/* Each frame is filled in place, then received, used and
+				released before this task continues. */
+				ulStart = ulCycleCounterRead();
+
+				for( ulCall = 0UL; ulCall < benchmarkCALLS; ulCall++ )
+				{
+					if( ulWay == benchmarkPOOL_BY_VALUE )
+					{
+						memset( ucPoolFrame, ( int ) ulCall, ulPoolFrameBytes );
+						xQueueSendToBack( xPoolQueue, ucPoolFrame, portMAX_DELAY );
+					}
+					else
+					{
+						pucFrame = ( uint8_t * ) pvBlockPoolAlloc( xPool );
+						configASSERT( pucFrame );
+						memset( pucFrame, ( int ) ulCall, ulPoolFrameBytes );
+						xBlockPoolSend( xPoolQueue, pucFrame, portMAX_DELAY );
+					}
+				}
+
+				ulPoolCycles[ ulResult ] = ( ulCycleCounterRead() - ulStart ) / benchmarkCALLS;
+
+				vTaskDelete( xReceiver );
+			}
+			else
+			{
+				sprintf( ( char * ) pcWriteBuffer, "Not enough heap to create the task, queue and pool\r\n" );
+				xReturn = pdFALSE;
+			}
+
+			if( xPoolQueue != NULL )
+			{
+				vQueueDelete( xPoolQueue );
+				xPoolQueue = NULL;
+			}
+
+			if( xPool != NULL )
+			{
+				vBlockPoolDelete( xPool );
+				xPool = NULL;
+			}
+
+			if( xReturn == pdFALSE )
+			{
+				break;
+			}
+		}
+	}
+	else
+	{
+		ulResult = ulLine - 1UL;
+		ulSize = ulFrameSizes[ ulResult / benchmarkPOOL_NUM_WAYS ];
+		sprintf( ( char * ) pcWriteBuffer, "%3u bytes %-13s %7u    %7u\r\n", ( unsigned int ) ulSize, pcWays[ ulResult % benchmarkPOOL_NUM_WAYS ],
+				( unsigned int ) ulPoolCycles[ ulResult ], ( unsigned int ) ( ( ( uint64_t ) configCPU_CLOCK_HZ * ulSize ) / ( ulPoolCycles[ ulResult ] * 1000UL ) ) );
+
+		if( ulLine == ( benchmarkPOOL_NUM_WAYS * benchmarkPOOL_NUM_SIZES ) )
+		{
+			xReturn = pdFALSE;
+		}
+	}
+
+	if( xReturn == pdFALSE )
+	{
+		ulLine = 0UL;
+	}
+	else
+	{
+		ulLine++;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPoolReceiverTask( void *pvParameters )
+{
+uint8_t *pucFrame;
+
+	for( ;; )
+	{
+		/* The first and last bytes are read as the frame would be used. */
+		if( ( uint32_t ) pvParameters == benchmarkPOOL_BY_VALUE )
+		{
+			xQueueReceive( xPoolQueue, ucPoolReceived, portMAX_DELAY );
+			ulSink = ucPoolReceived[ 0 ] + ucPoolReceived[ ulPoolFrameBytes - 1UL ];
+		}
+		else
+		{
+			pucFrame = ( uint8_t * ) pvBlockPoolReceive( xPoolQueue, portMAX_DELAY );
+			ulSink = pucFrame[ 0 ] + pucFrame[ ulPoolFrameBytes - 1UL ];
+			vBlockPoolFree( xPool, pucFrame );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void I2S_IRQHandler( void )
+{
+portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+uint32_t ulValue = 0UL, ulByte;
+
+	/* The time is taken just before the call that wakes the receiver. */
+	ulSwitchStart = ulCycleCounterRead();
+
+	if( ulISRWay == benchmarkISR_NOTIFY )
+	{
+		vTaskNotifyGiveFromISR( xISRReceiver, &xHigherPriorityTaskWoken );
+	}
+	else if( ulISRWay == benchmarkISR_QUEUE )
+	{
+		xQueueSendFromISR( xISRQueue, &ulValue, &xHigherPriorityTaskWoken );
+	}
+	else if( ulISRWay == benchmarkSTREAM_BUFFER )
+	{
+		/* One copy of the whole block. */
+		xStreamBufferSendFromISR( xStreamBuffer, ucStreamBlock, sizeof( ucStreamBlock ), &xHigherPriorityTaskWoken );
+	}
+	else
+	{
+		/* One call per byte, as the UART driver's character queue does. */
+		for( ulByte = 0UL; ulByte < benchmarkSTREAM_BLOCK_BYTES; ulByte++ )
+		{
+			xQueueSendFromISR( xStreamQueue, &( ucStreamBlock[ ulByte ] ), &xHigherPriorityTaskWoken );
+		}
+	}
+
+	portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecord( xBenchResult *pxResult, uint32_t ulCycles )
+{
+	pxResult->ulTotal += ulCycles;
+
+	if( ulCycles < pxResult->ulMin )
+	{
+		pxResult->ulMin = ulCycles;
+	}
+
+	if( ulCycles > pxResult->ulMax )
+	{
+		pxResult->ulMax = ulCycles;
+	}
+}
+/*-----------------------------------------------------------*/
+
+#if configUSE_TICKLESS_IDLE == 1
+
+	static portBASE_TYPE prvSleepCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+	{
+	xPortSleepStats xBefore, xAfter;
+	uint32_t ulSleeps, ulAsleepMicroseconds, ulWakeCycles;
+
+		( void ) xWriteBufferLen;
+		( void ) pcCommandString;
+
+		/* Reading the statistics resets the most cycles taken to wake. */
+		vPortGetSleepStats( &xBefore );
+		vTaskDelay( configTICK_RATE_HZ );
+		vPortGetSleepStats( &xAfter );
+
+		ulSleeps = xAfter.ulSleeps - xBefore.ulSleeps;
+		ulAsleepMicroseconds = ( uint32_t ) ( ( ( xAfter.ullSleepCounts - xBefore.ullSleepCounts ) * 1000000ULL ) / configCPU_CLOCK_HZ );
+		ulWakeCycles = 0UL;
+
+		if( ulSleeps != 0UL )
+		{
+			ulWakeCycles = ( xAfter.ulWakeCycles - xBefore.ulWakeCycles ) / ulSleeps;
+		}
+
+		sprintf( ( char * ) pcWriteBuffer, "Over one second\r\nSleeps           %7u\r\nAborted          %7u\r\nWoken by tick    %7u\r\nTicks suppressed %7u\r\nAsleep us        %7u\r\nAwake us         %7u\r\nWake cycles mean %7u\r\nWake cycles most %7u\r\n",
+				( unsigned int ) ulSleeps, ( unsigned int ) ( xAfter.ulAborts - xBefore.ulAborts ), ( unsigned int ) ( xAfter.ulTickWakes - xBefore.ulTickWakes ),
+				( unsigned int ) ( xAfter.ulTicksSuppressed - xBefore.ulTicksSuppressed ), ( unsigned int ) ulAsleepMicroseconds,
+				( unsigned int ) ( ( ulAsleepMicroseconds < 1000000UL ) ? ( 1000000UL - ulAsleepMicroseconds ) : 0UL ),
+				( unsigned int ) ulWakeCycles, ( unsigned int ) xAfter.ulMaxWakeCycles );
+
+		return pdFALSE;
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+#if configGENERATE_TICK_STATS == 1
+
+	static portBASE_TYPE prvTickCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+	{
+	xPortTickStats xBefore, xAfter;
+	uint32_t ulTicks, ulMeanCycles;
+
+		( void ) xWriteBufferLen;
+		( void ) pcCommandString;
+
+		/* Reading the statistics resets the most cycles taken by one tick. */
+		vPortGetTickStats( &xBefore );
+		vTaskDelay( configTICK_RATE_HZ );
+		vPortGetTickStats( &xAfter );
+
+		ulTicks = xAfter.ulTicks - xBefore.ulTicks;
+		ulMeanCycles = 0UL;
+
+		if( ulTicks != 0UL )
+		{
+			ulMeanCycles = ( xAfter.ulCycles - xBefore.ulCycles ) / ulTicks;
+		}
+
+		#if configUSE_DELAY_WHEEL == 1
+		{
+			sprintf( ( char * ) pcWriteBuffer, "Delay wheel of %u slots\r\n", ( unsigned int ) ( 1UL << configDELAY_WHEEL_BITS ) );
+		}
+		#else
+		{
+			sprintf( ( char * ) pcWriteBuffer, "Sorted delayed list\r\n" );
+		}
+		#endif
+
+		sprintf( ( char * ) pcWriteBuffer + strlen( ( char * ) pcWriteBuffer ), "Over one second\r\nTicks            %7u\r\nCycles mean      %7u\r\nCycles most      %7u\r\nMost ns          %7u\r\n",
+				( unsigned int ) ulTicks, ( unsigned int ) ulMeanCycles, ( unsigned int ) xAfter.ulMaxCycles,
+				( unsigned int ) ( ( ( uint64_t ) xAfter.ulMaxCycles * 1000000000ULL ) / configCPU_CLOCK_HZ ) );
+
+		return pdFALSE;
+	}
+
+#endif /* configGENERATE_TICK_STATS */
+/*-----------------------------------------------------------*/
+
+#if configGENERATE_RUN_TIME_STATS == 1
+
+	static portBASE_TYPE prvTasksCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+	{
+	static xTaskRunTimeStats xStats[ benchmarkTASKS_MAX_TASKS ];
+	static unsigned long long ullTotal;
+	static unsigned portBASE_TYPE uxTasks, uxLine = 0U;
+	xTaskRunTimeStats *pxTask;
+	portBASE_TYPE xReturn = pdTRUE;
+
+		( void ) xWriteBufferLen;
+		( void ) pcCommandString;
+
+		if( uxLine == 0U )
+		{
+			/* Every line comes from the same copy of the statistics. */
+			uxTasks = uxTaskGetRunTimeStats( xStats, benchmarkTASKS_MAX_TASKS, &ullTotal );
+
+			sprintf( ( char * ) pcWriteBuffer, "Over %u ms\r\nTask         Pri    Run ms    CPU %%   Most us   Switches\r\n", ( unsigned int ) ( ullTotal / 1000ULL ) );
+		}
+		else if( uxLine <= uxTasks )
+		{
+			pxTask = &( xStats[ uxLine - 1U ] );
+
+			sprintf( ( char * ) pcWriteBuffer, "%-*s %3u %9u %5u.%02u %9u %10u\r\n",
+					configMAX_TASK_NAME_LEN, ( const char * ) pxTask->pcTaskName,
+					( unsigned int ) pxTask->uxPriority,
+					( unsigned int ) ( pxTask->ullRunTime / 1000ULL ),
+					( unsigned int ) ( pxTask->ulHundredthsOfAPercent / 100UL ),
+					( unsigned int ) ( pxTask->ulHundredthsOfAPercent % 100UL ),
+					( unsigned int ) pxTask->ulMaxBurst,
+					( unsigned int ) pxTask->ulSwitchesIn );
+		}
+		else
+		{
+			/* Any tasks that did not fit were left out. */
+			sprintf( ( char * ) pcWriteBuffer, "%u of %u tasks\r\n", ( unsigned int ) uxTasks, ( unsigned int ) uxTaskGetNumberOfTasks() );
+			xReturn = pdFALSE;
+		}
+
+		if( xReturn == pdFALSE )
+		{
+			uxLine = 0U;
+		}
+		else
+		{
+			uxLine++;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+/*-----------------------------------------------------------*/
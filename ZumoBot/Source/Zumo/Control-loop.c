@@ -0,0 +1,220 @@
+/*
+ * Fixed rate control task, with period jitter and execution time
+ * histograms.  See Control-loop.h.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+
+/* Zumo includes. */
+#include "Control-loop.h"
+#include "Timebase.h"
+#include "Profiler.h"
+
+#define controlloopPERIOD_US				( ( uint32_t ) controlloopPERIOD_MS * 1000UL )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The task that calls the step function.
+ */
+static void prvControlLoopTask( void *pvParameters );
+
+/*
+ * Count ulValue in the bin of pulBins it falls into.
+ */
+static void prvCountInBin( uint32_t *pulBins, uint32_t ulBinWidth, uint32_t ulValue );
+
+/*
+ * Implements the "control-stats" command.  Outputs one line per call.
+ */
+static portBASE_TYPE prvControlStatsCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+/*-----------------------------------------------------------*/
+
+static const xCommandLineInput xControlStatsCommand =
+{
+	( const int8_t * const ) "control-stats",
+	( const int8_t * const ) "control-stats: Displays the control loop period jitter and execution time histograms\r\n",
+	prvControlStatsCommand,
+	0
+};
+
+static xControlLoopStats xStats;
+
+/* The task is created in these rather than on the heap. */
+static xStaticTask xControlLoopTaskBuffer;
+static portSTACK_TYPE xControlLoopStack[ controlloopTASK_STACK_SIZE ];
+
+/*-----------------------------------------------------------*/
+
+void vControlLoopStart( pdCONTROL_STEP pxStep )
+{
+	configASSERT( pxStep );
+
+	FreeRTOS_CLIRegisterCommand( &xControlStatsCommand );
+	xTaskCreateStatic( prvControlLoopTask, ( signed char * ) "Ctrl", controlloopTASK_STACK_SIZE, ( void * ) pxStep, controlloopTASK_PRIORITY, xControlLoopStack, &xControlLoopTaskBuffer );
+}
+/*-----------------------------------------------------------*/
+
+void vControlLoopGetStats( xControlLoopStats *pxStats )
+{
+	taskENTER_CRITICAL();
+	{
+		*pxStats = xStats;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlLoopTask( void *pvParameters )
+{
+pdCONTROL_STEP pxStep = ( pdCONTROL_STEP ) pvParameters;
+portTickType xLastWakeTime;
+uint32_t ulStart, ulLastStart, ulJitter, ulExecution;
+portBASE_TYPE xFirstPeriod = pdTRUE, xOverrun;
+
+	xLastWakeTime = xTaskGetTickCount();
+	ulLastStart = ulTimebaseMicroseconds();
+
+	for( ;; )
+	{
+		vTaskDelayUntil( &xLastWakeTime, controlloopPERIOD_TICKS );
+
+		ulStart = ulTimebaseMicroseconds();
+		profilerBEGIN( profilerCONTROL_STEP );
+		pxStep();
+		profilerEND( profilerCONTROL_STEP );
+		ulExecution = ulTimebaseMicroseconds() - ulStart;
+
+		/* How far the time since the last step started is from the nominal
+		period, whichever side it falls. */
+		ulJitter = ulStart - ulLastStart;
+		if( ulJitter > controlloopPERIOD_US )
+		{
+			ulJitter -= controlloopPERIOD_US;
+		}
+		else
+		{
+			ulJitter = controlloopPERIOD_US - ulJitter;
+		}
+		ulLastStart = ulStart;
+
+		/* xLastWakeTime is still the time this step should have started. */
+		xOverrun = ( ( xTaskGetTickCount() - xLastWakeTime ) >= controlloopPERIOD_TICKS );
+
+		taskENTER_CRITICAL();
+		{
+			xStats.ulPeriods++;
+
+			if( xOverrun != pdFALSE )
+			{
+				xStats.ulOverruns++;
+			}
+
+			if( ulExecution > xStats.ulMaxExecutionMicroseconds )
+			{
+				xStats.ulMaxExecutionMicroseconds = ulExecution;
+			}
+			prvCountInBin( xStats.ulExecutionBins, controlloopEXECUTION_BIN_US, ulExecution );
+
+			/* There is no previous step to measure the first period from. */
+			if( xFirstPeriod == pdFALSE )
+			{
+				if( ulJitter > xStats.ulMaxJitterMicroseconds )
+				{
+					xStats.ulMaxJitterMicroseconds = ulJitter;
+				}
+				prvCountInBin( xStats.ulJitterBins, controlloopJITTER_BIN_US, ulJitter );
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		xFirstPeriod = pdFALSE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvCountInBin( uint32_t *pulBins, uint32_t ulBinWidth, uint32_t ulValue )
+{
+uint32_t ulBin;
+
+	ulBin = ulValue / ulBinWidth;
+
+	if( ulBin >= controlloopHISTOGRAM_BINS )
+	{
+		ulBin = controlloopHISTOGRAM_BINS - 1;
+	}
+
+	pulBins[ ulBin ]++;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvControlStatsCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+{
+static xControlLoopStats xSnapshot;
+static uint32_t ulLine = 0UL;
+uint32_t ulBin;
+portBASE_TYPE xReturn = pdTRUE;
+
+	( void ) xWriteBufferLen;
+	( void ) pcCommandString;
+
+	if( ulLine == 0UL )
+	{
+		/* Every line comes from the same copy of the statistics. */
+		vControlLoopGetStats( &xSnapshot );
+
+		sprintf( ( char * ) pcWriteBuffer, "Period %u ms, %u steps, %u overruns, max jitter %u us, max execution %u us\r\n\r\nJitter (us)      Steps  Execution (us)      Steps\r\n",
+				( unsigned int ) controlloopPERIOD_MS,
+				( unsigned int ) xSnapshot.ulPeriods,
+				( unsigned int ) xSnapshot.ulOverruns,
+				( unsigned int ) xSnapshot.ulMaxJitterMicroseconds,
+				( unsigned int ) xSnapshot.ulMaxExecutionMicroseconds );
+	}
+	else
+	{
+		ulBin = ulLine - 1UL;
+
+		if( ulBin < ( controlloopHISTOGRAM_BINS - 1 ) )
+		{
+			sprintf( ( char * ) pcWriteBuffer, "%5u - %5u %10u  %5u - %5u   %10u\r\n",
+					( unsigned int ) ( ulBin * controlloopJITTER_BIN_US ),
+					( unsigned int ) ( ( ( ulBin + 1UL ) * controlloopJITTER_BIN_US ) - 1UL ),
+					( unsigned int ) xSnapshot.ulJitterBins[ ulBin ],
+					( unsigned int ) ( ulBin * controlloopEXECUTION_BIN_US ),
+					( unsigned int ) ( ( ( ulBin + 1UL ) * controlloopEXECUTION_BIN_US ) - 1UL ),
+					( unsigned int ) xSnapshot.ulExecutionBins[ ulBin ] );
+		}
+		else
+		{
+			/* The last bin, which has no upper limit. */
+			sprintf( ( char * ) pcWriteBuffer, "%5u +       %10u  %5u +         %10u\r\n",
+					( unsigned int ) ( ulBin * controlloopJITTER_BIN_US ),
+					( unsigned int ) xSnapshot.ulJitterBins[ ulBin ],
+					( unsigned int ) ( ulBin * controlloopEXECUTION_BIN_US ),
+					( unsigned int ) xSnapshot.ulExecutionBins[ ulBin ] );
+
+			xReturn = pdFALSE;
+		}
+	}
+
+	if( xReturn == pdFALSE )
+	{
+		ulLine = 0UL;
+	}
+	else
+	{
+		ulLine++;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
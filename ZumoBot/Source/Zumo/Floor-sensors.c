@@ -0,0 +1,319 @@
+/*
+ * Interrupt driven QTR-RC floor sensor reading.  See Floor-sensors.h.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include "LPC17xx.h"
+#include "lpc17xx_gpio.h"
+#include "lpc17xx_timer.h"
+
+/* Zumo includes. */
+#include "Floor-sensors.h"
+#include "Hal.h"
+#include "Profiler.h"
+
+#define floorsensorsPORT			( 2 )
+#define floorsensorsPIN_MASK		( ( ( 1UL << floorsensorsNUM_SENSORS ) - 1UL ) << floorsensorsFIRST_PIN )
+#define floorsensorsEMITTER_MASK	( 1UL << floorsensorsEMITTER_PIN )
+
+/* The match channel of TIMER1 that sequences the readings. */
+#define floorsensorsMATCH_CHANNEL	( 0 )
+
+/* A match value must be at least this far ahead of the counter when it is
+written, otherwise the counter could pass it before the write takes effect. */
+#define floorsensorsMIN_LEAD_US		( 2L )
+
+/* The phases of one reading. */
+#define floorsensorsRESTING			( 0 )
+#define floorsensorsCHARGING		( 1 )
+#define floorsensorsMEASURING		( 2 )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Make the next match interrupt occur when TIMER1 reaches ulTime, or as soon
+ * as possible if ulTime has already passed.
+ */
+static void prvScheduleMatch( uint32_t ulTime );
+
+/*
+ * Switch the emitters on and start charging all the sensors.
+ */
+static void prvStartCharge( void );
+
+/*
+ * Stop the sensors charging and start timing their discharge.
+ */
+static void prvRelease( void );
+
+/*
+ * Publish the reading in progress and schedule the start of the next one.
+ */
+static void prvCompleteReading( portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+/*-----------------------------------------------------------*/
+
+/* The phase of the reading in progress. */
+static volatile uint32_t ulPhase = floorsensorsRESTING;
+
+/* TIMER1 counts at the time the reading in progress started and at the time
+the sensors were released. */
+static uint32_t ulCycleStart = 0UL, ulReleaseTime = 0UL;
+
+/* The sensors that have not yet discharged, as a mask of P2 bits. */
+static uint32_t ulPendingPins = 0UL;
+
+/* The reading in progress, and the last completed reading. */
+static uint16_t usInProgress[ floorsensorsNUM_SENSORS ];
+static xFloorReading xLatest;
+
+/* The task to notify each time a reading completes.  Set by the first call
+to xFloorSensorsWaitForReading(). */
+static volatile xTaskHandle xWaitingTask = NULL;
+
+/*-----------------------------------------------------------*/
+
+void vFloorSensorsStart( void )
+{
+TIM_TIMERCFG_Type xTimerConfig;
+TIM_MATCHCFG_Type xMatchConfig;
+uint32_t ulSensor;
+
+	/* Until the first reading completes report black, which never triggers
+	an edge escape. */
+	for( ulSensor = 0UL; ulSensor < floorsensorsNUM_SENSORS; ulSensor++ )
+	{
+		xLatest.usDischargeMicroseconds[ ulSensor ] = ( uint16_t ) floorsensorsTIMEOUT_US;
+	}
+	xLatest.ulSequence = 0UL;
+
+	GPIO_SetDir( floorsensorsPORT, floorsensorsEMITTER_MASK | floorsensorsPIN_MASK, 1 );
+	GPIO_ClearValue( floorsensorsPORT, floorsensorsEMITTER_MASK | floorsensorsPIN_MASK );
+
+	/* TIMER1 counts microseconds and is never reset, so it can timestamp
+	edges as well as sequence the readings. */
+	xTimerConfig.PrescaleOption = TIM_PRESCALE_USVAL;
+	xTimerConfig.PrescaleValue = 1UL;
+	TIM_Init( LPC_TIM1, TIM_TIMER_MODE, &xTimerConfig );
+
+	xMatchConfig.MatchChannel = floorsensorsMATCH_CHANNEL;
+	xMatchConfig.IntOnMatch = ENABLE;
+	xMatchConfig.StopOnMatch = DISABLE;
+	xMatchConfig.ResetOnMatch = DISABLE;
+	xMatchConfig.ExtMatchOutputType = TIM_EXTMATCH_NOTHING;
+	xMatchConfig.MatchValue = floorsensorsPERIOD_US;
+	TIM_ConfigMatch( LPC_TIM1, &xMatchConfig );
+
+	ulPhase = floorsensorsRESTING;
+
+	NVIC_SetPriority( TIMER1_IRQn, floorsensorsINTERRUPT_PRIORITY );
+	NVIC_EnableIRQ( TIMER1_IRQn );
+	NVIC_SetPriority( EINT3_IRQn, floorsensorsINTERRUPT_PRIORITY );
+	NVIC_EnableIRQ( EINT3_IRQn );
+
+	TIM_Cmd( LPC_TIM1, ENABLE );
+}
+/*-----------------------------------------------------------*/
+
+void vFloorSensorsGetReading( xFloorReading *pxReading )
+{
+	taskENTER_CRITICAL();
+	{
+		*pxReading = xLatest;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usFloorSensorsGetMicroseconds( uint32_t ulPin )
+{
+	configASSERT( ( ulPin >= floorsensorsFIRST_PIN ) && ( ulPin < ( floorsensorsFIRST_PIN + floorsensorsNUM_SENSORS ) ) );
+	return xLatest.usDischargeMicroseconds[ ulPin - floorsensorsFIRST_PIN ];
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xFloorSensorsWaitForReading( portTickType xTicksToWait )
+{
+	xWaitingTask = xTaskGetCurrentTaskHandle();
+	return ( ulTaskNotifyTake( pdTRUE, xTicksToWait ) != 0UL ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvScheduleMatch( uint32_t ulTime )
+{
+	if( ( int32_t ) ( ulTime - LPC_TIM1->TC ) < floorsensorsMIN_LEAD_US )
+	{
+		ulTime = LPC_TIM1->TC + ( uint32_t ) floorsensorsMIN_LEAD_US;
+	}
+
+	LPC_TIM1->MR0 = ulTime;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStartCharge( void )
+{
+	/* Start from the time the match was scheduled for, not the time the
+	interrupt ran, so the period does not drift. */
+	ulCycleStart = LPC_TIM1->MR0;
+
+	vHalGPIOSet( floorsensorsPORT, floorsensorsEMITTER_MASK );
+	vHalGPIOOutput( floorsensorsPORT, floorsensorsPIN_MASK );
+	vHalGPIOSet( floorsensorsPORT, floorsensorsPIN_MASK );
+
+	ulPhase = floorsensorsCHARGING;
+	prvScheduleMatch( ulCycleStart + floorsensorsCHARGE_US );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRelease( void )
+{
+uint32_t ulSensor;
+
+	for( ulSensor = 0UL; ulSensor < floorsensorsNUM_SENSORS; ulSensor++ )
+	{
+		usInProgress[ ulSensor ] = ( uint16_t ) floorsensorsTIMEOUT_US;
+	}
+	ulPendingPins = floorsensorsPIN_MASK;
+
+	/* Arm the falling edge interrupts before the pins stop being driven, so
+	a fast discharge cannot be missed. */
+	LPC_GPIOINT->IO2IntClr = floorsensorsPIN_MASK;
+	LPC_GPIOINT->IO2IntEnF |= floorsensorsPIN_MASK;
+
+	vHalGPIOInput( floorsensorsPORT, floorsensorsPIN_MASK );
+	vHalGPIOClear( floorsensorsPORT, floorsensorsPIN_MASK );
+	ulReleaseTime = LPC_TIM1->TC;
+
+	ulPhase = floorsensorsMEASURING;
+	prvScheduleMatch( ulReleaseTime + floorsensorsTIMEOUT_US );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCompleteReading( portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+uint32_t ulSensor;
+
+	LPC_GPIOINT->IO2IntEnF &= ~floorsensorsPIN_MASK;
+	LPC_GPIOINT->IO2IntClr = floorsensorsPIN_MASK;
+
+	/* The emitters are only needed while the sensors discharge. */
+	vHalGPIOClear( floorsensorsPORT, floorsensorsEMITTER_MASK );
+
+	for( ulSensor = 0UL; ulSensor < floorsensorsNUM_SENSORS; ulSensor++ )
+	{
+		xLatest.usDischargeMicroseconds[ ulSensor ] = usInProgress[ ulSensor ];
+	}
+	xLatest.ulSequence++;
+
+	/* If all the sensors discharged before the timeout, the timeout match may
+	have occurred while the GPIO interrupt was running.  It is no longer
+	wanted.  It is cleared before the next match is scheduled, which can be
+	as little as floorsensorsMIN_LEAD_US away, so that match is never cleared
+	with it. */
+	LPC_TIM1->IR = TIM_IR_CLR( floorsensorsMATCH_CHANNEL );
+	NVIC_ClearPendingIRQ( TIMER1_IRQn );
+
+	ulPhase = floorsensorsRESTING;
+	prvScheduleMatch( ulCycleStart + floorsensorsPERIOD_US );
+
+	vApplicationFloorReadingHook( &xLatest, pxHigherPriorityTaskWoken );
+
+	if( xWaitingTask != NULL )
+	{
+		vTaskNotifyGiveFromISR( xWaitingTask, pxHigherPriorityTaskWoken );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void TIMER1_IRQHandler( void )
+{
+portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	profilerBEGIN( profilerFLOOR_TIMER_ISR );
+
+	if( ( LPC_TIM1->IR & TIM_IR_CLR( floorsensorsMATCH_CHANNEL ) ) != 0UL )
+	{
+		LPC_TIM1->IR = TIM_IR_CLR( floorsensorsMATCH_CHANNEL );
+
+		switch( ulPhase )
+		{
+			case floorsensorsCHARGING :
+
+				prvRelease();
+				break;
+
+
+			case floorsensorsMEASURING :
+
+				/* Any sensor still pending keeps the timeout value. */
+				prvCompleteReading( &xHigherPriorityTaskWoken );
+				break;
+
+
+			default :
+
+				prvStartCharge();
+				break;
+		}
+	}
+
+	profilerEND( profilerFLOOR_TIMER_ISR );
+
+	portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+void EINT3_IRQHandler( void )
+{
+portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+uint32_t ulNow, ulFallen, ulElapsed, ulSensor;
+
+	/* Read the time first, before anything else adds latency. */
+	ulNow = LPC_TIM1->TC;
+
+	profilerBEGIN( profilerFLOOR_EDGE_ISR );
+
+	ulFallen = LPC_GPIOINT->IO2IntStatF & floorsensorsPIN_MASK;
+	LPC_GPIOINT->IO2IntClr = ulFallen;
+
+	if( ulPhase == floorsensorsMEASURING )
+	{
+		ulFallen &= ulPendingPins;
+		ulElapsed = ulNow - ulReleaseTime;
+
+		for( ulSensor = 0UL; ulSensor < floorsensorsNUM_SENSORS; ulSensor++ )
+		{
+			if( ( ulFallen & ( 1UL << ( ulSensor + floorsensorsFIRST_PIN ) ) ) != 0UL )
+			{
+				usInProgress[ ulSensor ] = ( uint16_t ) ulElapsed;
+			}
+		}
+
+		/* Each pin only needs its first edge. */
+		ulPendingPins &= ~ulFallen;
+		LPC_GPIOINT->IO2IntEnF &= ~ulFallen;
+
+		if( ulPendingPins == 0UL )
+		{
+			prvCompleteReading( &xHigherPriorityTaskWoken );
+		}
+	}
+
+	/* Any port 0 edges belong to the application. */
+	ulFallen = LPC_GPIOINT->IO0IntStatF;
+
+	if( ulFallen != 0UL )
+	{
+		LPC_GPIOINT->IO0IntClr = ulFallen;
+		vApplicationPort0FallingEdgeHook( ulFallen, &xHigherPriorityTaskWoken );
+	}
+
+	profilerEND( profilerFLOOR_EDGE_ISR );
+
+	portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
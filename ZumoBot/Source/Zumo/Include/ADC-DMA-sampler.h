@@ -0,0 +1,82 @@
+#ifndef ADC_DMA_SAMPLER_H
+#define ADC_DMA_SAMPLER_H
+
+/*
+ * Background sampling of the IR distance sensors on ADC channels 0 to 3.
+ *
+ * The ADC runs in burst mode, converting the four channels one after the
+ * other at a fixed rate.  Each time channel 3 completes, the ADC raises a DMA
+ * request and the GPDMA copies the four data registers into a ring of
+ * samples.  The ring is split into two halves.  The DMA interrupt only fires
+ * when a half is full, so the CPU does no work per sample - it averages a
+ * whole block at a time while the DMA fills the other half.
+ */
+
+/* The number of ADC channels sampled, starting from channel 0. */
+#define adcsamplerNUM_CHANNELS				( 4 )
+
+/* Total conversions per second, shared between all the channels.  Each
+channel is therefore sampled at adcsamplerCONVERSION_RATE_HZ /
+adcsamplerNUM_CHANNELS. */
+#define adcsamplerCONVERSION_RATE_HZ		( 16000UL )
+
+/* The number of samples of each channel averaged into one block.  A new block
+is available every adcsamplerSAMPLES_PER_BLOCK * adcsamplerNUM_CHANNELS /
+adcsamplerCONVERSION_RATE_HZ seconds (4ms with the values above). */
+#define adcsamplerSAMPLES_PER_BLOCK			( 16 )
+
+/* The weight of each new block in the filtered value, as a right shift.  A
+shift of 2 gives each block a weight of 1/4. */
+#define adcsamplerFILTER_SHIFT				( 2 )
+
+/* The GPDMA channel used to move the samples.  Channel 0 has the highest
+priority. */
+#define adcsamplerDMA_CHANNEL				( 0 )
+
+/* The DMA interrupt uses FreeRTOS API functions, so must not have a priority
+above configMAX_LIBRARY_INTERRUPT_PRIORITY. */
+#define adcsamplerINTERRUPT_PRIORITY		( configMAX_LIBRARY_INTERRUPT_PRIORITY + 1 )
+
+typedef struct xADC_SAMPLER_STATS
+{
+	uint32_t ulBlocksCompleted;		/* Number of blocks averaged since the sampler started. */
+	uint32_t ulDMAErrors;			/* Number of DMA error interrupts. */
+	uint32_t ulLastISRCycles;		/* CPU cycles spent processing the most recent block. */
+	uint32_t ulMaxISRCycles;		/* The most CPU cycles ever spent processing a block. */
+} xADCSamplerStats;
+
+/*
+ * Configure the DMA channel and start filling the sample ring.  The ADC must
+ * already have been initialised, with channels 0 to 3 enabled and burst mode
+ * selected, by initADC().
+ */
+void vADCSamplerStart( void );
+
+/*
+ * Return the mean of the samples of channel ucChannel in the most recently
+ * completed block.  This only reads a stored value, so can be called as often
+ * as required.
+ */
+uint16_t usADCSamplerGetAverage( uint8_t ucChannel );
+
+/*
+ * Return the low pass filtered value of channel ucChannel.  The filter is
+ * updated once per block.
+ */
+uint16_t usADCSamplerGetFiltered( uint8_t ucChannel );
+
+/*
+ * Block the calling task until a block completes after the last time the
+ * function returned pdPASS, or xTicksToWait expires.  The first call waits
+ * for the next block.  The interrupt wakes the task with a direct to task
+ * notification, so only one task can wait for blocks, and it must not wait
+ * for other notifications.
+ */
+portBASE_TYPE xADCSamplerWaitForBlock( portTickType xTicksToWait );
+
+/*
+ * Copy the sampler statistics into *pxStats.
+ */
+void vADCSamplerGetStats( xADCSamplerStats *pxStats );
+
+#endif /* ADC_DMA_SAMPLER_H */
@@ -0,0 +1,109 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+/*
+ * The "bench" command of the UART command console, which times the functions
+ * that write to the hardware from the motor control interrupt and the floor
+ * sensor interrupts.  Each is called benchmarkCALLS times, and the fewest,
+ * mean and most DWT cycles per call are displayed, less the cycles taken to
+ * time an empty function.
+ *
+ * The inline functions of Hal.h are timed next to the NXP driver library
+ * functions that do the same, so the two can be compared.  Every function is
+ * called in a way that leaves the hardware as it was - the motors and PWM1
+ * channel 5 are given the values they already have, the GPIO writes have an
+ * empty pin mask, and ADC channel 7, which is not converted, is read.
+ *
+ * The "switch" command times the context switch.  A task of priority
+ * benchmarkSWITCH_LOW_PRIORITY resumes a task of the highest priority
+ * benchmarkCALLS times, which suspends itself again each time.  "wake" is
+ * the time from before vTaskResume() to the high priority task running, and
+ * "block" the time from before vTaskSuspend() to the low priority task
+ * running again.  Every priority in between has no ready tasks while the
+ * command runs, which is the worst case for a scheduler that searches the
+ * ready lists one priority at a time - compare a build with
+ * configUSE_PORT_OPTIMISED_TASK_SELECTION set to 0.  Interrupts are not
+ * masked, so the most cycles can include an interrupt.
+ *
+ * The "isr" command times the wake of a task from an interrupt.  The unused
+ * I2S interrupt is pended benchmarkCALLS times, and wakes a task of the
+ * highest priority first with vTaskNotifyGiveFromISR() and then with
+ * xQueueSendFromISR() to a queue of one item.  The time is from the call in
+ * the interrupt to the task running.
+ *
+ * The "stream" command times passing bytes from an interrupt to a task.  The
+ * I2S interrupt is pended benchmarkCALLS times, and each time writes 16
+ * bytes, as many as the UART receive FIFO holds, for a task of the highest
+ * priority to read - first with one xStreamBufferSendFromISR() call, and then
+ * with an xQueueSendFromISR() call for each byte to a queue of bytes.  The
+ * cycles per byte cover the interrupt, the wake of the task and the read.
+ * From them the most bytes a second that could be passed with the CPU doing
+ * nothing else are shown, and the baud rate of a UART that would receive as
+ * many, at 10 bits to a byte.  A UART at 1Mbaud receives 100kB/s, and needs
+ * a good margin over that to leave time for anything else.
+ *
+ * The "pool" command times passing frames of 64 and 256 bytes from one task
+ * to a task of the highest priority, benchmarkCALLS times each way.  By
+ * value, the sender fills a frame of its own and the queue copies it in and
+ * then out to the receiver.  By pointer, the sender takes a block from a
+ * block pool, fills it in place and sends its address, and the receiver gives
+ * it back to the pool once used.  The cycles are for each frame, from filling
+ * it to its being released, and the kB/s the most that could be passed with
+ * the CPU doing nothing else.
+ *
+ * With configUSE_CO_ROUTINES set to 1, the "coroutine" command compares a
+ * co-routine with a task.  Two co-routines, scheduled by the command task on
+ * its own stack, yield to each other with crDELAY( xHandle, 0 ) benchmarkCALLS
+ * times, and then two tasks of priority benchmarkSWITCH_HIGH_PRIORITY do the
+ * same with taskYIELD().  The cycles are from the yield to the other running,
+ * and the heap is what xPortGetFreeHeapSize() lost when each pair was
+ * created - a task takes its TCB and a stack of benchmarkSWITCH_STACK_SIZE
+ * words, a co-routine only its control block.  A co-routine cannot block
+ * inside a function it calls, and only runs when vCoRoutineSchedule() is
+ * called, so suits small loops that poll rather than wait on interrupts.
+ *
+ * With configUSE_TICKLESS_IDLE set to 1, the "sleep" command shows how the
+ * idle task slept over one second - the times it went to sleep, the times
+ * it gave up because a task became ready first, the times the tick ended the
+ * sleep rather than another interrupt, and the ticks it did not take.  The
+ * microseconds asleep and awake, multiplied by the current drawn asleep and
+ * awake, give the energy used in the second.  The wake cycles are from the
+ * processor leaving WFI to the interrupt that woke it being able to run.
+ *
+ * With configGENERATE_TICK_STATS set to 1, the "tick" command shows the
+ * cycles the tick interrupt took over one second, the mean and the most for
+ * one tick.  The interrupts that use the kernel API, such as the PWM and ADC
+ * interrupts, are held off for that long.  Build with configUSE_DELAY_WHEEL
+ * set to 0 and to 1 to compare the sorted delayed list with the delay wheel.
+ *
+ * With configGENERATE_RUN_TIME_STATS set to 1, the "tasks" command lists,
+ * from uxTaskGetRunTimeStats(), the time each task has run for since the
+ * scheduler started and its share of the CPU, the longest it ran for before
+ * another task was switched in, and the times it was switched in.  The times
+ * are counted by the microsecond counter of Timebase.h.  At most
+ * benchmarkTASKS_MAX_TASKS tasks are listed.
+ */
+
+#define benchmarkCALLS				( 1000UL )
+
+/* The priority of the interrupt pended by the "isr" command, below every
+interrupt in use. */
+#define benchmarkISR_INTERRUPT_PRIORITY		( configMAX_LIBRARY_INTERRUPT_PRIORITY + 3 )
+
+/*
+ * Register the commands described above.  vMotorControlStart() must already
+ * have been called.
+ *
+ *   bench      cycles of the Hal.h functions and the library functions
+ *   switch     cycles of a context switch
+ *   isr        cycles from an interrupt to the task it wakes
+ *   stream     cycles per byte passed from an interrupt to a task
+ *   pool       cycles per frame passed by value and by pointer
+ *   coroutine  cycles and heap of a co-routine and of a task
+ *   sleep      sleeps, wakes and ticks skipped by the idle task
+ *   tick       cycles taken by the tick interrupt
+ *   tasks      CPU time taken by each task
+ */
+void vBenchmarkRegisterCommand( void );
+
+#endif /* BENCHMARK_H */
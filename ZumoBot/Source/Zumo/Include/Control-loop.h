@@ -0,0 +1,61 @@
+#ifndef CONTROL_LOOP_H
+#define CONTROL_LOOP_H
+
+/*
+ * A fixed rate control task.
+ *
+ * The task wakes every controlloopPERIOD_MS using vTaskDelayUntil(), so the
+ * period does not drift with the time the step takes, and calls the step
+ * function it was started with.  Each period is timed with the microsecond
+ * timebase.  The difference between the measured and the nominal period (the
+ * jitter) and the time the step took to execute are both counted in
+ * histograms, which can be displayed with the "control-stats" command of the
+ * UART command console.
+ */
+
+/* The period of the loop.  Anything down to one tick can be used - check the
+histograms before making it shorter. */
+#define controlloopPERIOD_MS				( 10 )
+#define controlloopPERIOD_TICKS				( controlloopPERIOD_MS / portTICK_RATE_MS )
+
+/* Below the sumo behaviour task, so the edge of the ring is still acted on
+as soon as it is seen.  Time spent handling an edge shows up as jitter. */
+#define controlloopTASK_PRIORITY			( configMAX_PRIORITIES - 3 )
+#ifdef stacksizesCTRL
+	#define controlloopTASK_STACK_SIZE		stacksizesCTRL
+#else
+	#define controlloopTASK_STACK_SIZE		( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+/* The histograms have controlloopHISTOGRAM_BINS bins of the given width.  The
+last bin also counts everything too long for the others. */
+#define controlloopHISTOGRAM_BINS			( 16 )
+#define controlloopJITTER_BIN_US			( 10UL )
+#define controlloopEXECUTION_BIN_US			( 10UL )
+
+typedef struct xCONTROL_LOOP_STATS
+{
+	uint32_t ulPeriods;								/* Steps executed. */
+	uint32_t ulOverruns;							/* Steps that ended after the next one should have started. */
+	uint32_t ulMaxJitterMicroseconds;
+	uint32_t ulMaxExecutionMicroseconds;
+	uint32_t ulJitterBins[ controlloopHISTOGRAM_BINS ];
+	uint32_t ulExecutionBins[ controlloopHISTOGRAM_BINS ];
+} xControlLoopStats;
+
+/* The function called once per period. */
+typedef void ( *pdCONTROL_STEP )( void );
+
+/*
+ * Create the control task, which calls pxStep every controlloopPERIOD_MS, and
+ * register the "control-stats" command.  The timebase must already have been
+ * started.
+ */
+void vControlLoopStart( pdCONTROL_STEP pxStep );
+
+/*
+ * Copy the control loop statistics into *pxStats.
+ */
+void vControlLoopGetStats( xControlLoopStats *pxStats );
+
+#endif /* CONTROL_LOOP_H */
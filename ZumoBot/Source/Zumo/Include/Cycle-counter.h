@@ -0,0 +1,45 @@
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include <stdint.h>
+
+/*
+ * Access to the Cortex-M3 DWT cycle counter.  The CMSIS version in use does
+ * not define the DWT block, so the registers are accessed directly, in the
+ * same way the run time stats code in main.c accesses the SysTick registers.
+ *
+ * The counter runs at the core clock (configCPU_CLOCK_HZ), so it wraps every
+ * ~43 seconds at 100MHz.  Differences between two readings taken less than
+ * one wrap apart are always correct when computed with unsigned arithmetic.
+ */
+
+#define cyclecounterDEMCR			( *( ( volatile uint32_t * ) 0xe000edfcUL ) )
+#define cyclecounterDWT_CTRL		( *( ( volatile uint32_t * ) 0xe0001000UL ) )
+#define cyclecounterDWT_CYCCNT		( *( ( volatile uint32_t * ) 0xe0001004UL ) )
+
+#define cyclecounterDEMCR_TRCENA	( 1UL << 24UL )
+#define cyclecounterCYCCNTENA		( 1UL << 0UL )
+
+/*
+ * Enable the trace block and start the cycle counter.  Safe to call more
+ * than once.
+ */
+static inline void vCycleCounterEnable( void )
+{
+	if( ( cyclecounterDWT_CTRL & cyclecounterCYCCNTENA ) == 0UL )
+	{
+		cyclecounterDEMCR |= cyclecounterDEMCR_TRCENA;
+		cyclecounterDWT_CYCCNT = 0UL;
+		cyclecounterDWT_CTRL |= cyclecounterCYCCNTENA;
+	}
+}
+
+/*
+ * Return the current value of the free running cycle counter.
+ */
+static inline uint32_t ulCycleCounterRead( void )
+{
+	return cyclecounterDWT_CYCCNT;
+}
+
+#endif /* CYCLE_COUNTER_H */
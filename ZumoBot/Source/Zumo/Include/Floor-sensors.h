@@ -0,0 +1,86 @@
+#ifndef FLOOR_SENSORS_H
+#define FLOOR_SENSORS_H
+
+/*
+ * Interrupt driven reading of the QTR-RC reflectance sensors under the robot.
+ *
+ * Each sensor is a capacitor that is charged by driving its pin high, then
+ * discharged through a phototransistor once the pin is made an input.  The
+ * brighter the floor, the sooner the pin reads low.  All three sensors are
+ * charged and released together.  TIMER1 runs freely at 1MHz and a match
+ * interrupt sequences the charge, release and timeout phases, while the
+ * GPIO falling edge interrupts timestamp each pin as it discharges.  No task
+ * ever waits for a sensor.
+ */
+
+/* The sensors are on P2.10, P2.11 and P2.12. */
+#define floorsensorsNUM_SENSORS				( 3 )
+#define floorsensorsFIRST_PIN				( 10 )
+
+/* The IR emitters are switched by P2.7. */
+#define floorsensorsEMITTER_PIN				( 7 )
+
+/* How long the sensor capacitors are charged for. */
+#define floorsensorsCHARGE_US				( 10UL )
+
+/* Sensors that have not discharged this long after being released are
+reported as floorsensorsTIMEOUT_US - the floor is black. */
+#define floorsensorsTIMEOUT_US				( 2000UL )
+
+/* Time between the start of two consecutive readings. */
+#define floorsensorsPERIOD_US				( 2500UL )
+
+/* TIMER1 and the GPIO (EINT3) interrupts use FreeRTOS API functions, so must
+not have a priority above configMAX_LIBRARY_INTERRUPT_PRIORITY. */
+#define floorsensorsINTERRUPT_PRIORITY		( configMAX_LIBRARY_INTERRUPT_PRIORITY + 1 )
+
+typedef struct xFLOOR_READING
+{
+	uint16_t usDischargeMicroseconds[ floorsensorsNUM_SENSORS ];	/* Indexed by pin number - floorsensorsFIRST_PIN. */
+	uint32_t ulSequence;											/* Incremented each time a reading completes. */
+} xFloorReading;
+
+/*
+ * Configure the sensor pins, TIMER1 and the GPIO interrupts, then start
+ * reading the sensors continuously.
+ */
+void vFloorSensorsStart( void );
+
+/*
+ * Copy the most recently completed reading into *pxReading.  Does not block.
+ */
+void vFloorSensorsGetReading( xFloorReading *pxReading );
+
+/*
+ * Return the discharge time, in microseconds, of the sensor on P2.ulPin from
+ * the most recently completed reading.  Does not block.
+ */
+uint16_t usFloorSensorsGetMicroseconds( uint32_t ulPin );
+
+/*
+ * Block the calling task until a reading completes after the last time the
+ * function returned pdPASS, or xTicksToWait expires.  The first call waits
+ * for the next reading.  The interrupt wakes the task with a direct to task
+ * notification, so only one task can wait for readings, and it must not wait
+ * for other notifications.
+ */
+portBASE_TYPE xFloorSensorsWaitForReading( portTickType xTicksToWait );
+
+/*
+ * Called from the floor sensor interrupt each time a reading completes, so
+ * the application can react to the floor without waiting for a task to run.
+ * Must be provided by the application.  Must not block, and must only use
+ * the FromISR versions of the FreeRTOS API functions.
+ */
+void vApplicationFloorReadingHook( const xFloorReading *pxReading, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+/*
+ * The GPIO interrupts of both ports share EINT3, whose handler is in
+ * Floor-sensors.c, so falling edges on port 0 pins are passed to this hook
+ * with the pins that fell, after their interrupts have been cleared.  Must be
+ * provided by the application, with the same restrictions as
+ * vApplicationFloorReadingHook().
+ */
+void vApplicationPort0FallingEdgeHook( uint32_t ulFallen, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+#endif /* FLOOR_SENSORS_H */
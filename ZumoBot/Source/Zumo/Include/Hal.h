@@ -0,0 +1,103 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+
+#include "LPC17xx.h"
+
+/*
+ * Register level access to the GPIO, PWM1 and ADC, for code that runs often
+ * enough for the cost of the NXP driver library to matter.
+ *
+ * The driver library functions are out of line and check their parameters,
+ * and PWM_MatchUpdate() selects the match register with a switch.  These are
+ * static inline functions instead, and the port, pin and channel are meant to
+ * be compile time constants - the register address is then worked out by the
+ * compiler, and each access is a single load or store (plus loading the
+ * address and value, which the compiler hoists where it can).  They still
+ * work with variable arguments, only more slowly.  Nothing is checked, so
+ * configASSERT() the arguments in the caller if they are not constants.
+ *
+ * The driver library is still used to configure the peripherals, where the
+ * cost does not matter.  The "bench" command of the UART command console
+ * compares the two.
+ */
+
+/* The GPIO port blocks are 0x20 bytes apart, from LPC_GPIO0_BASE. */
+#define halGPIO( ulPort )				( ( LPC_GPIO_TypeDef * ) ( LPC_GPIO0_BASE + ( ( uint32_t ) ( ulPort ) * 0x20UL ) ) )
+#define halPIN( ulPin )					( 1UL << ( ulPin ) )
+
+/* The PWM1 match registers are in two blocks, MR0 to MR3 and MR4 to MR6. */
+#define halPWM1_MATCH( ulChannel )		( *( ( ( ulChannel ) < 4 ) ? &( ( &( LPC_PWM1->MR0 ) )[ ( ulChannel ) ] ) : &( ( &( LPC_PWM1->MR4 ) )[ ( ulChannel ) - 4 ] ) ) )
+
+/* The ADC channel data registers, ADDR0 to ADDR7, and the result field. */
+#define halADC_DATA( ulChannel )		( ( &( LPC_ADC->ADDR0 ) )[ ( ulChannel ) ] )
+#define halADC_RESULT( ulData )			( ( ( ulData ) >> 4UL ) & 0xfffUL )
+
+/*
+ * Drive the pins of ulPort in ulMask high or low.  Only the pins in ulMask
+ * are affected.
+ */
+static inline void vHalGPIOSet( const uint32_t ulPort, const uint32_t ulMask )
+{
+	halGPIO( ulPort )->FIOSET = ulMask;
+}
+
+static inline void vHalGPIOClear( const uint32_t ulPort, const uint32_t ulMask )
+{
+	halGPIO( ulPort )->FIOCLR = ulMask;
+}
+
+/*
+ * Return the level of the pins of ulPort in ulMask, with the other bits
+ * zero.
+ */
+static inline uint32_t ulHalGPIORead( const uint32_t ulPort, const uint32_t ulMask )
+{
+	return halGPIO( ulPort )->FIOPIN & ulMask;
+}
+
+/*
+ * Make the pins of ulPort in ulMask outputs or inputs.  A read-modify-write,
+ * so must not race with other writes to the same port direction register.
+ */
+static inline void vHalGPIOOutput( const uint32_t ulPort, const uint32_t ulMask )
+{
+	halGPIO( ulPort )->FIODIR |= ulMask;
+}
+
+static inline void vHalGPIOInput( const uint32_t ulPort, const uint32_t ulMask )
+{
+	halGPIO( ulPort )->FIODIR &= ~ulMask;
+}
+
+/*
+ * Write the PWM1 match register of ulChannel.  The new value is not used
+ * until it is latched by vHalPWMLatch().
+ */
+static inline void vHalPWMSetMatch( const uint32_t ulChannel, const uint32_t ulValue )
+{
+	halPWM1_MATCH( ulChannel ) = ulValue;
+}
+
+/*
+ * Latch the match registers of the channels set in ulChannels (bit n for
+ * channel n) at the start of the next PWM period.  The latch enable register
+ * is read and written, rather than just written, so a channel already waiting
+ * to be latched is not lost.
+ */
+static inline void vHalPWMLatch( const uint32_t ulChannels )
+{
+	LPC_PWM1->LER |= ulChannels;
+}
+
+/*
+ * Return the last conversion result of ADC channel ulChannel, without
+ * checking that it is complete.
+ */
+static inline uint32_t ulHalADCRead( const uint32_t ulChannel )
+{
+	return halADC_RESULT( halADC_DATA( ulChannel ) );
+}
+
+#endif /* HAL_H */
@@ -0,0 +1,123 @@
+#ifndef MOTOR_CONTROL_H
+#define MOTOR_CONTROL_H
+
+/*
+ * Closed loop wheel speed control, using the motor shaft encoders.
+ *
+ * The right encoder is read by the QEI, which counts both edges of both
+ * phases and knows the direction.  The LPC1769 only has one QEI, so channel A
+ * of the left encoder drives CAP2.0 and TIMER2 counts its rising edges - a
+ * quarter of the resolution, with the direction taken from the direction the
+ * motor is being driven.
+ *
+ * The QEI velocity timer interrupts every motorcontrolPERIOD_US, and the
+ * interrupt runs a fixed point PID for each wheel and writes both duties to
+ * the PWM together.  At that rate the encoders only move a few counts per
+ * period, so rather than acting on the speed measured over one period, each
+ * wheel tracks a target position that advances by the speed setpoint every
+ * period.  The P and I terms act on the position error, and the D term on the
+ * speed error, measured through a low pass filter.  A feed forward term gives
+ * each wheel the duty its setpoint needs on a charged battery, so the PID
+ * only corrects the difference.  While a duty is limited, neither the target
+ * position nor the integral runs further ahead of the wheel.
+ *
+ * Speeds are in millimetres per second, positive forwards.  The heading is
+ * in milliradians, anticlockwise positive, and is worked out from the
+ * encoders, so it is relative to the heading when the controller started.
+ */
+
+/* The encoders give 12 counts per motor revolution, counting both edges of
+both phases.  With the 75:1 gearbox and 39mm wheels, that is 136um of travel
+per QEI count, and four times as much per TIMER2 count. */
+#define motorcontrolRIGHT_UM_PER_COUNT		( 136L )
+#define motorcontrolLEFT_UM_PER_COUNT		( 544L )
+
+/* The distance between the centres of the tracks. */
+#define motorcontrolTRACK_MM				( 85L )
+
+/* The speed each wheel reaches at full duty on a charged battery, which sets
+the feed forward gain. */
+#define motorcontrolFULL_SPEED_MM_S			( 600L )
+
+/* The control period.  Must be a whole number of microseconds that divides
+into one second. */
+#define motorcontrolPERIOD_US				( 1000UL )
+
+/* The PID gains.  Each term is the gain multiplied by the error, shifted
+right by the shift of the term - the position error is in um, its integral
+in um periods, and the speed error in um per period.  The gains are given for
+a duty out of 256, and scaled to motorsPWM_PERIOD. */
+#define motorcontrolKP						( ( 24L * motorsPWM_PERIOD ) / 256L )
+#define motorcontrolKP_SHIFT				( 8 )
+#define motorcontrolKI						( ( 32L * motorsPWM_PERIOD ) / 256L )
+#define motorcontrolKI_SHIFT				( 16 )
+#define motorcontrolKD						( ( 96L * motorsPWM_PERIOD ) / 256L )
+#define motorcontrolKD_SHIFT				( 8 )
+
+/* The target position of a wheel never gets further than this ahead of or
+behind the wheel, so a stalled wheel does not wind up a large error. */
+#define motorcontrolMAX_LAG_UM				( 5000L )
+
+/* In heading mode the turn, in mm/s of each wheel, is the heading error in
+milliradians multiplied by motorcontrolHEADING_GAIN and shifted right by
+motorcontrolHEADING_SHIFT, limited to motorcontrolMAX_TURN_MM_S.  A heading
+is reached once the error is below motorcontrolHEADING_TOLERANCE. */
+#define motorcontrolHEADING_GAIN			( 3L )
+#define motorcontrolHEADING_SHIFT			( 2 )
+#define motorcontrolMAX_TURN_MM_S			( 400L )
+#define motorcontrolHEADING_TOLERANCE		( 35L )
+
+/* The QEI interrupt does not use the FreeRTOS API, but the setpoints are
+written from tasks inside critical sections, which only mask interrupts at or
+below configMAX_LIBRARY_INTERRUPT_PRIORITY.  It is below the floor sensors,
+which timestamp pin edges. */
+#define motorcontrolINTERRUPT_PRIORITY		( configMAX_LIBRARY_INTERRUPT_PRIORITY + 2 )
+
+typedef struct xMOTOR_CONTROL_STATS
+{
+	uint32_t ulPeriods;				/* Control periods since the controller started. */
+	int32_t lLeftSpeed;				/* Measured speeds, in mm/s. */
+	int32_t lRightSpeed;
+	int32_t lLeftDuty;				/* The last duty written, out of motorsPWM_PERIOD, negative for reverse. */
+	int32_t lRightDuty;
+	uint32_t ulSaturatedPeriods;	/* Periods in which either duty was limited. */
+	uint32_t ulLastISRCycles;		/* CPU cycles spent in the most recent control period. */
+	uint32_t ulMaxISRCycles;		/* The most CPU cycles ever spent in a control period. */
+} xMotorControlStats;
+
+/*
+ * Configure the encoder inputs, the QEI and TIMER2, and start the control
+ * interrupt with both wheels stopped.  inicializarMotores() must already have
+ * been called.  Once started, the functions of Motors.h must not be called
+ * directly.
+ */
+void vMotorControlStart( void );
+
+/*
+ * Drive each wheel at the given speed.
+ */
+void vMotorControlSetSpeeds( int32_t lLeftMMPerSecond, int32_t lRightMMPerSecond );
+
+/*
+ * Drive at lMMPerSecond while turning to lHeading, in milliradians.  A speed
+ * of zero pivots on the spot.
+ */
+void vMotorControlSetHeading( int32_t lMMPerSecond, int32_t lHeading );
+
+/*
+ * Return the heading, in milliradians, measured from the encoders.
+ */
+int32_t lMotorControlGetHeading( void );
+
+/*
+ * Return pdTRUE if the heading set by the last call to
+ * vMotorControlSetHeading() has been reached.
+ */
+portBASE_TYPE xMotorControlHeadingReached( void );
+
+/*
+ * Copy the controller statistics into *pxStats.
+ */
+void vMotorControlGetStats( xMotorControlStats *pxStats );
+
+#endif /* MOTOR_CONTROL_H */
@@ -0,0 +1,87 @@
+#ifndef MOTORS_H
+#define MOTORS_H
+
+#include <stdint.h>
+
+/*
+ * The two drive motors.  PWM1 channel 3 drives the right motor and PWM1
+ * channel 4 the left motor.  P0.5 and P0.10 select the direction of the right
+ * and left motors respectively.
+ *
+ * The PWM counter runs from the undivided core clock, so the carrier is above
+ * the audible range and a duty still has more than ten bits of resolution.
+ * The counts in one period are worked out from the peripheral clock when the
+ * motors are initialised, so a change to the PLL or PCLKSEL setting changes
+ * neither the carrier frequency nor the meaning of a duty.
+ * New duties are written to the match registers and only enabled in the
+ * latch enable register, so they take effect at the start of the next PWM
+ * period rather than part way through one.  vMotorsSetDuties() enables both
+ * channels with one write, so both motors always change in the same period.
+ *
+ * Setting motorsBACKEND to motorsBACKEND_MCPWM drives the motors from the
+ * motor control PWM instead - MCOA0 (P1.19) for the right motor and MCOA1
+ * (P1.25) for the left.  Its channels 0 and 1 run in step, and updates of
+ * both are held back while the new duties are written, for the same effect.
+ */
+
+#define	ADELANTE	1
+#define	ATRAS		0
+
+#define motorsBACKEND_PWM1			( 0 )
+#define motorsBACKEND_MCPWM			( 1 )
+
+#ifndef motorsBACKEND
+	#define motorsBACKEND			motorsBACKEND_PWM1
+#endif
+
+/* The PWM1 match channels of the motors, or the MCPWM channels when that is
+used. */
+#if motorsBACKEND == motorsBACKEND_MCPWM
+	#define motorsRIGHT_PWM_CHANNEL	( 0 )
+	#define motorsLEFT_PWM_CHANNEL	( 1 )
+#else
+	#define motorsRIGHT_PWM_CHANNEL	( 3 )
+	#define motorsLEFT_PWM_CHANNEL	( 4 )
+#endif
+
+/* The carrier frequency, and the full scale of a duty.  The duty of a motor
+is out of motorsPWM_PERIOD whatever the PWM clock, and is scaled to the counts
+in one period of the clock the PWM actually runs from.  With a 100MHz core
+clock the two are the same. */
+#define motorsPWM_FREQUENCY_HZ		( 20000L )
+#define motorsPWM_PERIOD			( 5000L )
+
+/* The fewest counts in one period, for ten bits of duty resolution.
+inicializarMotores() asserts the PWM clock gives at least this many. */
+#define motorsPWM_MIN_PERIOD_COUNTS	( 1024UL )
+
+/*
+ * Configure the PWM and the direction pins.  The motors are stopped on
+ * return.
+ */
+void inicializarMotores();
+
+/*
+ * Set the duty of both motors, out of motorsPWM_PERIOD, negative for
+ * reverse.  Both take effect at the start of the next PWM period.  A change
+ * of direction takes effect immediately, so the old duty can drive the motor
+ * the new way for up to one PWM period.
+ */
+void vMotorsSetDuties( int32_t lLeftDuty, int32_t lRightDuty );
+
+/*
+ * Set the direction (ADELANTE or ATRAS) and the PWM duty, out of
+ * motorsPWM_PERIOD, of the right and left motors.  The duty takes effect at
+ * the start of the next PWM period.
+ */
+void motorDerecho(int direccion, int PWM);
+void motorIzquierdo(int direccion, int PWM);
+
+/*
+ * Low level PWM1 access, used by inicializarMotores().  setPWM() latches the
+ * new match value at the start of the next PWM period.
+ */
+void configurePWMpin(const unsigned int pin);
+void setPWM(const unsigned int channel, const unsigned int value);
+
+#endif /* MOTORS_H */
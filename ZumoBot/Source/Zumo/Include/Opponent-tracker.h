@@ -0,0 +1,78 @@
+#ifndef OPPONENT_TRACKER_H
+#define OPPONENT_TRACKER_H
+
+/*
+ * Keeps an estimate of where the opponent is, from all four IR distance
+ * sensors.
+ *
+ * The sensors on ADC channels 0 to 3 point forwards, 30 degrees to the left,
+ * 30 degrees to the right and backwards.  Each channel is compared with its
+ * own baseline, the reading with nothing in the beam, and a channel that is
+ * more than opponenttrackerTHRESHOLD above its baseline sees the opponent.
+ * The strongest channel gives the bearing of the opponent.  If the front
+ * sensor and one of the 30 degree sensors both see it, the bearing is
+ * interpolated between the two by their signal strengths.  The distance is
+ * looked up from the reading of the strongest channel.
+ *
+ * The bearing is kept as a heading in the frame of lMotorControlGetHeading(),
+ * not relative to the robot, so it stays valid while the robot turns - the
+ * robot can be turned straight to it with vMotorControlSetHeading().  Each
+ * new sighting is averaged into the estimate, and an estimate not refreshed
+ * for opponenttrackerLOST_MS is dropped.
+ *
+ * The tracker is only used from the control task, so nothing is protected.
+ */
+
+/* The difference from the baseline at which a channel sees the opponent.
+With the sensors in use that is about 430mm away. */
+#define opponenttrackerTHRESHOLD			( 150L )
+
+/* The baseline of every channel starts at opponenttrackerBASELINE_COUNTS,
+the reading with nothing in the beam.  While a reading is less than
+opponenttrackerBASELINE_HOLD above its baseline, the baseline follows it
+through a low pass filter with a weight of 1 / 2^opponenttrackerBASELINE_SHIFT
+per update, but rises no faster than opponenttrackerBASELINE_MAX_RISE counts
+per second.  A stronger reading may be the opponent coming into range, so
+holds the baseline where it is.  Otherwise an opponent that approaches slowly
+is followed by the baseline and never crosses the threshold.  A reading below
+the baseline moves it down straight away. */
+#define opponenttrackerBASELINE_COUNTS		( 310L )
+#define opponenttrackerBASELINE_SHIFT		( 4 )
+#define opponenttrackerBASELINE_HOLD		( opponenttrackerTHRESHOLD / 4L )
+#define opponenttrackerBASELINE_MAX_RISE	( 1L )
+
+/* The weight of each new sighting in the estimate, as a right shift. */
+#define opponenttrackerFILTER_SHIFT			( 1 )
+
+/* How long an estimate is kept without a new sighting. */
+#define opponenttrackerLOST_MS				( 500UL )
+
+/* The direction of each sensor, in milliradians anticlockwise from the
+front of the robot. */
+#define opponenttrackerFRONT_MRAD			( 0L )
+#define opponenttrackerLEFT_MRAD			( 524L )
+#define opponenttrackerRIGHT_MRAD			( -524L )
+#define opponenttrackerREAR_MRAD			( 3142L )
+
+typedef struct xOPPONENT_ESTIMATE
+{
+	portBASE_TYPE xValid;		/* pdFALSE if there is no estimate, in which case the other members are not used. */
+	int32_t lHeading;			/* The heading, in milliradians, that points at the opponent. */
+	int32_t lDistanceMM;		/* From the front of the robot. */
+	uint32_t ulAgeMS;			/* Since the opponent was last seen. */
+	uint8_t ucChannels;			/* The channels that saw the opponent in the last update, bit n for channel n. */
+} xOpponentEstimate;
+
+/*
+ * Read the latest block of samples from the ADC sampler and update the
+ * estimate.  lHeading is the heading of the robot, and ulElapsedMS the time
+ * since the last update.  Returns pdTRUE if the opponent was seen.
+ */
+portBASE_TYPE xOpponentTrackerUpdate( int32_t lHeading, uint32_t ulElapsedMS );
+
+/*
+ * Copy the estimate into *pxEstimate.
+ */
+void vOpponentTrackerGetEstimate( xOpponentEstimate *pxEstimate );
+
+#endif /* OPPONENT_TRACKER_H */
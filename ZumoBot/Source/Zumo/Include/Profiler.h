@@ -0,0 +1,91 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+/*
+ * Cycle counts of named code scopes.
+ *
+ * Code between profilerBEGIN( x ) and profilerEND( x ) is timed with the DWT
+ * cycle counter each time it runs, and the count, shortest, longest and total
+ * cycles of each scope are kept in a static table, with a histogram of the
+ * cycles in powers of two.  The "profile" command of the UART command console
+ * lists them, with the mean.  The cost of reading the counter twice is
+ * measured when the profiler starts and taken off each time, so an empty
+ * scope reads close to 0.
+ *
+ * The profiler is left out unless built with profilerENABLED set to 1, for
+ * example with -DprofilerENABLED=1 - the macros and vProfilerStart() then
+ * compile to nothing, so the scopes can be left in the release build.
+ *
+ * Each scope keeps one start time, so must not be entered again before it
+ * ends - a scope in code that runs both from a task and from an interrupt, or
+ * that calls itself, needs one scope for each.  Scopes can nest.
+ */
+
+#ifndef profilerENABLED
+	#define profilerENABLED				0
+#endif
+
+/* The scopes.  Add a name to pcScopeNames in Profiler.c for each new one. */
+#define profilerFLOOR_TIMER_ISR			( 0UL )		/* The floor sensor charge and timeout interrupt. */
+#define profilerFLOOR_EDGE_ISR			( 1UL )		/* The floor sensor edge interrupt. */
+#define profilerADC_DMA_ISR				( 2UL )		/* The averaging of a block of ADC samples. */
+#define profilerQEI_ISR					( 3UL )		/* The wheel speed control step. */
+#define profilerMOTORS_SET_DUTIES		( 4UL )		/* The PWM and direction pin writes. */
+#define profilerCONTROL_STEP			( 5UL )		/* The whole sumo control step. */
+#define profilerOPPONENT_TRACKER		( 6UL )		/* The opponent tracker update, part of the control step. */
+#define profilerUART_ISR				( 7UL )		/* The UART interrupt of the command console. */
+#define profilerNUM_SCOPES				( 8UL )
+
+/* The histogram of each scope counts the times it took under 32 cycles, 32 to
+63, 64 to 127 and so on, with the last bin counting 8192 and over. */
+#define profilerHISTOGRAM_BINS			( 10UL )
+
+typedef struct xPROFILER_SCOPE
+{
+	const char *pcName;
+	uint32_t ulCount;
+	uint32_t ulMinCycles;
+	uint32_t ulMaxCycles;
+	uint64_t ullTotalCycles;
+	uint32_t ulBins[ profilerHISTOGRAM_BINS ];
+} xProfilerScope;
+
+#if profilerENABLED == 1
+
+	#include "Cycle-counter.h"
+
+	/* Written by profilerBEGIN(), in line, so the start is read as late as
+	possible. */
+	extern uint32_t ulProfilerStartCycles[ profilerNUM_SCOPES ];
+
+	#define profilerBEGIN( ulScope )	ulProfilerStartCycles[ ( ulScope ) ] = ulCycleCounterRead()
+	#define profilerEND( ulScope )		vProfilerEnd( ( ulScope ), ulCycleCounterRead() )
+
+	/*
+	 * Start the cycle counter, measure the cost of reading it and register
+	 * the "profile" command.  Call before the scheduler is started.
+	 */
+	void vProfilerStart( void );
+
+	/*
+	 * Add the time since the start of ulScope to its counts.  Called by
+	 * profilerEND().
+	 */
+	void vProfilerEnd( uint32_t ulScope, uint32_t ulEndCycles );
+
+	/*
+	 * Copy the counts of all profilerNUM_SCOPES scopes into pxScopes.
+	 */
+	void vProfilerGetScopes( xProfilerScope *pxScopes );
+
+#else
+
+	#define profilerBEGIN( ulScope )
+	#define profilerEND( ulScope )
+	#define vProfilerStart()
+
+#endif /* profilerENABLED */
+
+#endif /* PROFILER_H */
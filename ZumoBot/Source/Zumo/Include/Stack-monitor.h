@@ -0,0 +1,67 @@
+#ifndef STACK_MONITOR_H
+#define STACK_MONITOR_H
+
+/*
+ * The peak stack use of every task, and the stack depths that would fit it.
+ *
+ * A software timer reads the high water mark of every task each
+ * stackmonitorPERIOD_MS, and keeps the deepest each task has used its stack in
+ * a table by task name, so a task that is deleted and created again adds to
+ * the same row.  A task that deletes itself should call vStackMonitorCheck()
+ * first, as it may be gone before the timer runs.
+ *
+ * The "stacks" command of the UART command console lists the table, then
+ * prints a Stack-sizes.h with each depth set to the deepest use plus
+ * stackmonitorMARGIN_PERCENT and stackmonitorMARGIN_WORDS.  Run a bout on the
+ * target first - the Sim runs its tasks on host stacks, so has nothing to
+ * measure.
+ *
+ * The first time a task is left with less than stackmonitorWARN_PERCENT of its
+ * stack unused, vApplicationStackWarningHook() is called with the scheduler
+ * suspended, and the task is marked in the table.  The hook must not block.
+ *
+ * Built only when configUSE_STACK_MONITOR is set to 1 in FreeRTOSConfig.h,
+ * which needs INCLUDE_uxTaskGetStackStats.
+ */
+
+#ifndef stackmonitorPERIOD_MS
+	#define stackmonitorPERIOD_MS			( 100UL )
+#endif
+
+#ifndef stackmonitorMAX_TASKS
+	#define stackmonitorMAX_TASKS			( 16UL )
+#endif
+
+#ifndef stackmonitorWARN_PERCENT
+	#define stackmonitorWARN_PERCENT		( 20UL )
+#endif
+
+#ifndef stackmonitorMARGIN_PERCENT
+	#define stackmonitorMARGIN_PERCENT		( 25UL )
+#endif
+
+/* Added on top of the percentage, for the interrupt and context frames a task
+may not have met during the bout. */
+#ifndef stackmonitorMARGIN_WORDS
+	#define stackmonitorMARGIN_WORDS		( 16UL )
+#endif
+
+/*
+ * Create and start the timer that reads the high water marks and register the
+ * "stacks" command.  Call before the scheduler is started.
+ */
+void vStackMonitorStart( void );
+
+/*
+ * Read the high water mark of every task into the table now.  Called by the
+ * timer, and by tasks about to delete themselves.
+ */
+void vStackMonitorCheck( void );
+
+/*
+ * Defined by the application.  Called once for each task the first time it is
+ * left with less than stackmonitorWARN_PERCENT of its stack unused.
+ */
+void vApplicationStackWarningHook( xTaskHandle xTask, signed char *pcTaskName, unsigned portBASE_TYPE uxFreeWords );
+
+#endif /* STACK_MONITOR_H */
@@ -0,0 +1,14 @@
+#ifndef STACK_SIZES_H
+#define STACK_SIZES_H
+
+/*
+ * Stack depths in words, measured on the target by the stack monitor.
+ *
+ * Replace the contents of this file with the output of the "stacks" command
+ * of the UART command console after a bout (see Stack-monitor.h).  Each task
+ * that has a stacksizes definition here is created with that depth, and any
+ * task without one keeps the depth given where it is created.  Nothing has
+ * been measured yet, so every task keeps its own.
+ */
+
+#endif /* STACK_SIZES_H */
@@ -0,0 +1,121 @@
+#ifndef SUMO_BEHAVIOUR_H
+#define SUMO_BEHAVIOUR_H
+
+/*
+ * The sumo behaviour, as a single table driven state machine.
+ *
+ * One task owns the motors.  It blocks on a queue set holding the event queue
+ * and the start button semaphore, given by the button interrupt, so it
+ * sleeps until either has something for it.  Each event it
+ * receives is looked up in a table indexed by the current state and the
+ * event.  The table entry gives the next state and the action to perform on
+ * the transition.  Actions that need time to pass (a search step, a step of
+ * an escape manoeuvre) set a timeout instead of delaying, so the task is
+ * always ready to receive the next event.  Reaching the edge of the ring is
+ * therefore just another transition - the motors are reversed as soon as the
+ * task receives the edge event.
+ *
+ * Looking for the opponent is not event driven, so is done by
+ * vSumoControlStep(), which must be called at a fixed rate by the control
+ * loop.  The control step keeps the estimate of Opponent-tracker.h up to
+ * date.  While searching, it turns the robot straight to the estimated
+ * bearing of the opponent, and only turns on the spot when there is no
+ * estimate.  While attacking, it steers towards the opponent.
+ */
+
+/* The states of the behaviour. */
+#define sumoSTATE_WAITING				( 0 )	/* Waiting for the button to be pressed. */
+#define sumoSTATE_COUNTDOWN				( 1 )	/* Flashing the LED before the bout starts. */
+#define sumoSTATE_SEARCH				( 2 )	/* Turning on the spot looking for the opponent. */
+#define sumoSTATE_ATTACK				( 3 )	/* Driving straight at the opponent. */
+#define sumoSTATE_ESCAPE				( 4 )	/* Moving away from the edge of the ring. */
+#define sumoNUM_STATES					( 5 )
+
+/* The edge event is posted from the floor sensor interrupt, so the task that
+receives it must be higher priority than any other application task. */
+#define sumoTASK_PRIORITY				( configMAX_PRIORITIES - 2 )
+#ifdef stacksizesSUMO
+	#define sumoTASK_STACK_SIZE			stacksizesSUMO
+#else
+	#define sumoTASK_STACK_SIZE			( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+/* The number of events that can be waiting to be processed. */
+#define sumoEVENT_QUEUE_LENGTH			( 8 )
+
+/* Set to 1 to also measure, on every edge event, how long the old approach of
+creating a task to handle the event took to get the motors reversed.  Once the
+state machine has reversed the motors, a task with the 4KB stack of the old
+edge handling tasks is created on the heap with xTaskCreate(), and sets the
+same speeds again.  The time the event took to reach the behaviour task plus
+the time from the xTaskCreate() call to the new task setting the speeds is in
+the TaskSpawn members of xSumoStats, next to the edge to reverse latency of the
+state machine.  The "sumo-stats" command shows both.  The task is not created,
+and a failure is counted, when the heap cannot hold it.  Leave at 0 in a match
+build - every edge then costs a heap allocation. */
+#ifndef sumoMEASURE_TASK_SPAWN_LATENCY
+	#define sumoMEASURE_TASK_SPAWN_LATENCY	( 0 )
+#endif
+
+/* Set to 0 to search the old way, turning on the spot until the front
+distance sensor sees the opponent, for comparison with the tracker.  The time
+each search takes is in xSumoStats either way. */
+#ifndef sumoUSE_OPPONENT_TRACKER
+	#define sumoUSE_OPPONENT_TRACKER	( 1 )
+#endif
+
+typedef struct xSUMO_STATS
+{
+	uint32_t ulState;							/* The current state, one of the sumoSTATE_ constants. */
+	uint32_t ulEdgeEvents;						/* Edge events acted on. */
+	uint32_t ulEventsLost;						/* Events discarded because the queue was full. */
+	uint32_t ulLastEdgeToReverseMicroseconds;	/* Time from the edge being detected to the motors being reversed. */
+	uint32_t ulMinEdgeToReverseMicroseconds;
+	uint32_t ulMaxEdgeToReverseMicroseconds;
+	uint32_t ulTaskSpawns;						/* Edge events handled by a created task as well, see sumoMEASURE_TASK_SPAWN_LATENCY. */
+	uint32_t ulTaskSpawnFailures;				/* Edge events for which xTaskCreate() failed. */
+	uint32_t ulLastTaskSpawnMicroseconds;		/* Time from the edge being detected to the created task setting the speeds. */
+	uint32_t ulMinTaskSpawnMicroseconds;
+	uint32_t ulMaxTaskSpawnMicroseconds;
+	uint32_t ulAcquisitions;					/* Searches that found the opponent. */
+	uint32_t ulSearchTimeouts;					/* Searches that gave up after sumoSEARCH_MAX_MS. */
+	uint32_t ulLastAcquireMicroseconds;			/* Time from the start of a search to the opponent being found. */
+	uint32_t ulMaxAcquireMicroseconds;
+	uint32_t ulTotalAcquireMicroseconds;		/* Of all the acquisitions, for the mean.  Wraps after 71 minutes. */
+} xSumoStats;
+
+/*
+ * Create the event queue and the behaviour task, and register the
+ * "sumo-stats" command.  The motors, the ADC sampler and the timebase must
+ * already have been started.
+ */
+void vSumoBehaviourStart( void );
+
+/*
+ * Tell the behaviour that floor sensor ucSensor (0 to 2, left, right and
+ * centre) has just seen the white edge of the ring.  ulTimestamp is the value
+ * of the microsecond timebase when the edge was detected.  Only call from an
+ * interrupt.
+ */
+void vSumoPostEdgeFromISR( uint8_t ucSensor, uint32_t ulTimestamp, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+/*
+ * Tell the behaviour which port 0 pins have just fallen, so it knows when the
+ * start button (P0.11) is pressed.  The button interrupt is only enabled
+ * while the behaviour waits for it.  Only call from an interrupt.
+ */
+void vSumoPostPort0EdgesFromISR( uint32_t ulFallen, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+/*
+ * Update the opponent estimate, steer towards the opponent, and tell the
+ * behaviour when it is straight ahead.  The step function of the control
+ * loop.
+ */
+void vSumoControlStep( void );
+
+/*
+ * Copy the behaviour statistics into *pxStats.
+ */
+void vSumoGetStats( xSumoStats *pxStats );
+
+#endif /* SUMO_BEHAVIOUR_H */
@@ -0,0 +1,31 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include "LPC17xx.h"
+
+/*
+ * A free running microsecond counter, used to timestamp events and measure
+ * latencies that are too short for the tick count.  TIMER0 is clocked at 1MHz
+ * and never reset or stopped, so it wraps every ~71 minutes.  Differences
+ * between two readings taken less than one wrap apart are always correct when
+ * computed with unsigned arithmetic.  It is also the run time stats counter of
+ * the kernel, see FreeRTOSConfig.h.
+ */
+
+/*
+ * Configure and start TIMER0.  Must be called before the scheduler is
+ * started.  Does nothing if TIMER0 is already running, so the count is never
+ * reset once started.
+ */
+void vTimebaseStart( void );
+
+/*
+ * Return the current value of the microsecond counter.  Can be called from
+ * tasks and interrupts.
+ */
+static inline uint32_t ulTimebaseMicroseconds( void )
+{
+	return LPC_TIM0->TC;
+}
+
+#endif /* TIMEBASE_H */
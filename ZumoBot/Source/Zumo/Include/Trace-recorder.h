@@ -0,0 +1,160 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <stdint.h>
+
+/*
+ * A recorder of the kernel trace hooks.
+ *
+ * With configUSE_TRACE_RECORDER set to 1, FreeRTOSConfig.h includes this
+ * header, which defines the trace hooks of FreeRTOS.h so that each context
+ * switch, queue and semaphore operation, block, task notification, delay,
+ * suspend and resume is written as an 8 byte record to a ring buffer in RAM.
+ * Each record is stamped with the DWT cycle counter, so it is exact to the
+ * CPU cycle.  Once the buffer is full the oldest records are overwritten, so
+ * it always holds the last tracerecorderRECORDS events.  The tick interrupt
+ * is not recorded, as it would fill the buffer on its own.
+ *
+ * The "trace" command of the UART command console stops the recording,
+ * writes the buffer out as lines of hex, then clears it and starts again.
+ * Capture the console output to a file, and the tracejson tool built with the
+ * simulation (see ZumoBot/Sim/Trace-json.c) turns it into a Chrome trace
+ * that chrome://tracing or ui.perfetto.dev displays as a timeline, one track
+ * per task and one for the interrupts.  The output is:
+ *
+ *  trace <cycles per second> <records made> <records kept>
+ *  task <number> <priority> <name>		one line per task created
+ *  queue <number> <type>				one line per queue or semaphore created
+ *  rec <records>						tracerecorderRECORDS_PER_LINE records per line
+ *  end
+ *
+ * Each record is 16 hex digits - the cycle counter (8), the event (2), the
+ * task (2) and the object (4).  The task is the number the kernel gave the
+ * task the event is about, and for events that are not about another task,
+ * the task running when it happened.  The object is the queue number, or the
+ * priority for the events that change one.
+ *
+ * The hooks run with interrupts masked, inside the kernel, so the cost of
+ * each is kept to a few dozen cycles - which shows up in the "switch" and
+ * "isr" command times.  They are left out completely unless built with
+ * configUSE_TRACE_RECORDER set to 1, for example with
+ * -DconfigUSE_TRACE_RECORDER=1.
+ */
+
+/* The records kept, 8 bytes each. */
+#ifndef tracerecorderRECORDS
+	#define tracerecorderRECORDS		( 512UL )
+#endif
+
+/* The most tasks and queues that are named in the output.  Any further ones
+are only known by their number. */
+#define tracerecorderMAX_TASKS			( 16UL )
+#define tracerecorderMAX_QUEUES			( 32UL )
+
+/* The records on each "rec" line of the output. */
+#define tracerecorderRECORDS_PER_LINE	( 8UL )
+
+/* The events recorded. */
+#define tracerecorderSWITCHED_IN		( 0UL )		/* The task is switched in, the object is its priority. */
+#define tracerecorderTASK_CREATE		( 1UL )		/* The task is created, the object is its priority. */
+#define tracerecorderTASK_DELETE		( 2UL )
+#define tracerecorderTASK_DELAY			( 3UL )		/* The running task calls vTaskDelay() or vTaskDelayUntil(). */
+#define tracerecorderTASK_SUSPEND		( 4UL )
+#define tracerecorderTASK_RESUME		( 5UL )
+#define tracerecorderTASK_RESUME_FROM_ISR	( 6UL )
+#define tracerecorderPRIORITY_SET		( 7UL )		/* The task's priority is set, the object is the new priority. */
+#define tracerecorderPRIORITY_INHERIT	( 8UL )
+#define tracerecorderPRIORITY_DISINHERIT	( 9UL )
+#define tracerecorderQUEUE_CREATE		( 10UL )	/* The object is the queue number, plus its type times 256. */
+#define tracerecorderQUEUE_SEND			( 11UL )
+#define tracerecorderQUEUE_SEND_FAILED	( 12UL )
+#define tracerecorderQUEUE_RECEIVE		( 13UL )
+#define tracerecorderQUEUE_RECEIVE_FAILED	( 14UL )
+#define tracerecorderQUEUE_PEEK			( 15UL )
+#define tracerecorderQUEUE_BLOCK_SEND	( 16UL )	/* The running task blocks to send to the queue. */
+#define tracerecorderQUEUE_BLOCK_RECEIVE	( 17UL )
+#define tracerecorderQUEUE_SEND_FROM_ISR	( 18UL )
+#define tracerecorderQUEUE_SEND_FROM_ISR_FAILED	( 19UL )
+#define tracerecorderQUEUE_RECEIVE_FROM_ISR	( 20UL )
+#define tracerecorderNOTIFY				( 21UL )	/* The task is notified. */
+#define tracerecorderNOTIFY_FROM_ISR	( 22UL )
+#define tracerecorderNOTIFY_BLOCK		( 23UL )	/* The running task blocks to wait for a notification. */
+#define tracerecorderNOTIFY_RECEIVE		( 24UL )	/* The running task has waited for a notification. */
+#define tracerecorderNUM_EVENTS			( 25UL )
+
+/*
+ * Start recording, and register the "trace" command.  Call before the
+ * scheduler is started, and before any tasks or queues are created so they
+ * are all named in the output.
+ */
+void vTraceRecorderStart( void );
+
+/*
+ * Write line ulLine of the output, starting from 0, into pcBuffer, which must
+ * hold at least 140 characters.  Writing line 0 stops the recording.  Returns
+ * 1 if there are more lines to write, or 0 once the "end" line is written,
+ * when the buffer is cleared and the recording started again.
+ */
+uint32_t ulTraceRecorderWriteLine( char *pcBuffer, uint32_t ulLine );
+
+/*
+ * Called by the trace hooks.  vTraceRecorderTaskEvent() records an event
+ * about task ulTask, vTraceRecorderEvent() an event of the running task.
+ * vTraceRecorderTaskCreated() and ucTraceRecorderQueueCreated() also keep the
+ * task name and queue type, and ucTraceRecorderQueueCreated() returns the
+ * number given to the queue.
+ */
+void vTraceRecorderTaskEvent( uint32_t ulEvent, uint32_t ulTask, uint32_t ulObject );
+void vTraceRecorderEvent( uint32_t ulEvent, uint32_t ulObject );
+void vTraceRecorderTaskCreated( uint32_t ulTask, uint32_t ulPriority, const signed char *pcName );
+uint8_t ucTraceRecorderQueueCreated( uint32_t ulType );
+
+/*
+ * The trace hooks.  They are expanded inside tasks.c and queue.c, so use the
+ * members of the task and queue structures.  The task notification hooks use
+ * pxTCB, the task being notified, from the notify functions.  Tasks are known
+ * by their uxTCBNumber, and queues by the ucQueueNumber the recorder gives
+ * them.
+ *
+ * traceTASK_CREATE() is only defined if the configuration has not defined it
+ * already - a configuration that needs its own can call
+ * tracerecorderTASK_CREATE_HOOK() from it.
+ */
+#define tracerecorderTASK_CREATE_HOOK( pxNewTCB )	vTraceRecorderTaskCreated( ( pxNewTCB )->uxTCBNumber, ( pxNewTCB )->uxPriority, ( pxNewTCB )->pcTaskName )
+
+#ifndef traceTASK_CREATE
+	#define traceTASK_CREATE( pxNewTCB )	tracerecorderTASK_CREATE_HOOK( pxNewTCB )
+#endif
+
+#define traceTASK_SWITCHED_IN()						vTraceRecorderTaskEvent( tracerecorderSWITCHED_IN, pxCurrentTCB->uxTCBNumber, pxCurrentTCB->uxPriority )
+#define traceTASK_DELETE( pxTaskToDelete )			vTraceRecorderTaskEvent( tracerecorderTASK_DELETE, ( pxTaskToDelete )->uxTCBNumber, 0UL )
+#define traceTASK_DELAY()							vTraceRecorderEvent( tracerecorderTASK_DELAY, 0UL )
+#define traceTASK_DELAY_UNTIL()						vTraceRecorderEvent( tracerecorderTASK_DELAY, 0UL )
+#define traceTASK_SUSPEND( pxTaskToSuspend )		vTraceRecorderTaskEvent( tracerecorderTASK_SUSPEND, ( pxTaskToSuspend )->uxTCBNumber, 0UL )
+#define traceTASK_RESUME( pxTaskToResume )			vTraceRecorderTaskEvent( tracerecorderTASK_RESUME, ( pxTaskToResume )->uxTCBNumber, 0UL )
+#define traceTASK_RESUME_FROM_ISR( pxTaskToResume )	vTraceRecorderTaskEvent( tracerecorderTASK_RESUME_FROM_ISR, ( pxTaskToResume )->uxTCBNumber, 0UL )
+#define traceTASK_PRIORITY_SET( pxTask, uxNewPriority )	vTraceRecorderTaskEvent( tracerecorderPRIORITY_SET, ( pxTask )->uxTCBNumber, ( uxNewPriority ) )
+#define traceTASK_PRIORITY_INHERIT( pxTCBOfMutexHolder, uxInheritedPriority )	vTraceRecorderTaskEvent( tracerecorderPRIORITY_INHERIT, ( pxTCBOfMutexHolder )->uxTCBNumber, ( uxInheritedPriority ) )
+#define traceTASK_PRIORITY_DISINHERIT( pxTCBOfMutexHolder, uxOriginalPriority )	vTraceRecorderTaskEvent( tracerecorderPRIORITY_DISINHERIT, ( pxTCBOfMutexHolder )->uxTCBNumber, ( uxOriginalPriority ) )
+
+#define traceQUEUE_CREATE( pxNewQueue )				( pxNewQueue )->ucQueueNumber = ucTraceRecorderQueueCreated( ( pxNewQueue )->ucQueueType )
+#define traceCREATE_MUTEX( pxNewQueue )				( pxNewQueue )->ucQueueNumber = ucTraceRecorderQueueCreated( ( pxNewQueue )->ucQueueType )
+#define traceQUEUE_SEND( pxQueue )					vTraceRecorderEvent( tracerecorderQUEUE_SEND, ( pxQueue )->ucQueueNumber )
+#define traceQUEUE_SEND_FAILED( pxQueue )			vTraceRecorderEvent( tracerecorderQUEUE_SEND_FAILED, ( pxQueue )->ucQueueNumber )
+#define traceQUEUE_RECEIVE( pxQueue )				vTraceRecorderEvent( tracerecorderQUEUE_RECEIVE, ( pxQueue )->ucQueueNumber )
+#define traceQUEUE_RECEIVE_FAILED( pxQueue )		vTraceRecorderEvent( tracerecorderQUEUE_RECEIVE_FAILED, ( pxQueue )->ucQueueNumber )
+#define traceQUEUE_PEEK( pxQueue )					vTraceRecorderEvent( tracerecorderQUEUE_PEEK, ( pxQueue )->ucQueueNumber )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )		vTraceRecorderEvent( tracerecorderQUEUE_BLOCK_SEND, ( pxQueue )->ucQueueNumber )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )	vTraceRecorderEvent( tracerecorderQUEUE_BLOCK_RECEIVE, ( pxQueue )->ucQueueNumber )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )			vTraceRecorderEvent( tracerecorderQUEUE_SEND_FROM_ISR, ( pxQueue )->ucQueueNumber )
+#define traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue )	vTraceRecorderEvent( tracerecorderQUEUE_SEND_FROM_ISR_FAILED, ( pxQueue )->ucQueueNumber )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )		vTraceRecorderEvent( tracerecorderQUEUE_RECEIVE_FROM_ISR, ( pxQueue )->ucQueueNumber )
+
+#define traceTASK_NOTIFY()							vTraceRecorderTaskEvent( tracerecorderNOTIFY, pxTCB->uxTCBNumber, 0UL )
+#define traceTASK_NOTIFY_FROM_ISR()					vTraceRecorderTaskEvent( tracerecorderNOTIFY_FROM_ISR, pxTCB->uxTCBNumber, 0UL )
+#define traceTASK_NOTIFY_WAIT_BLOCK()				vTraceRecorderEvent( tracerecorderNOTIFY_BLOCK, 0UL )
+#define traceTASK_NOTIFY_TAKE_BLOCK()				vTraceRecorderEvent( tracerecorderNOTIFY_BLOCK, 0UL )
+#define traceTASK_NOTIFY_WAIT()						vTraceRecorderEvent( tracerecorderNOTIFY_RECEIVE, 0UL )
+#define traceTASK_NOTIFY_TAKE()						vTraceRecorderEvent( tracerecorderNOTIFY_RECEIVE, 0UL )
+
+#endif /* TRACE_RECORDER_H */
@@ -0,0 +1,395 @@
+/*
+ * Closed loop wheel speed control.  See Motor-control.h.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include "LPC17xx.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_pinsel.h"
+#include "lpc17xx_pwm.h"
+#include "lpc17xx_qei.h"
+
+/* Zumo includes. */
+#include "Motor-control.h"
+#include "Motors.h"
+#include "Cycle-counter.h"
+#include "Profiler.h"
+
+#define motorcontrolLEFT					( 0 )
+#define motorcontrolRIGHT					( 1 )
+#define motorcontrolNUM_WHEELS				( 2 )
+
+#define motorcontrolMODE_SPEED				( 0 )
+#define motorcontrolMODE_HEADING			( 1 )
+
+/* Converts mm/s to um per control period. */
+#define motorcontrolUM_PER_PERIOD( lMMPerSecond )	( ( ( lMMPerSecond ) * ( int32_t ) motorcontrolPERIOD_US ) / 1000L )
+
+/* The measured speeds are filtered with a weight of 1/4 for each period, and
+held with this many fractional bits. */
+#define motorcontrolSPEED_FILTER_SHIFT		( 2 )
+#define motorcontrolSPEED_FRACTION_BITS		( 4 )
+
+/* The integral is limited so its term alone cannot exceed full duty. */
+#define motorcontrolMAX_INTEGRAL			( ( ( int32_t ) motorsPWM_PERIOD << motorcontrolKI_SHIFT ) / motorcontrolKI )
+
+/* TIM_Init() writes the mode to the capture control register rather than
+the count control register, so cannot select counter mode.  The count control
+register is written directly instead - count rising edges on CAP2.0. */
+#define motorcontrolCTCR_COUNT_RISING_CAP0	( 0x01UL )
+
+/*-----------------------------------------------------------*/
+
+/* The state of the controller of one wheel.  Positions are in um, from
+wherever the wheel was when the controller started, and wrap after ~2km. */
+typedef struct xWHEEL
+{
+	int32_t lSetpoint;			/* um per period. */
+	int32_t lFeedForward;		/* Duty, out of motorsPWM_PERIOD. */
+	int32_t lTarget;
+	int32_t lPosition;
+	int32_t lIntegral;			/* um periods. */
+	int32_t lFilteredSpeed;		/* um per period, with motorcontrolSPEED_FRACTION_BITS fractional bits. */
+	int32_t lDuty;				/* The last duty written, negative for reverse. */
+	uint32_t ulLastCount;		/* The encoder count at the end of the last period. */
+} xWheel;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Set the setpoint and feed forward of pxWheel for lMMPerSecond.
+ */
+static void prvSetWheelSpeed( xWheel *pxWheel, int32_t lMMPerSecond );
+
+/*
+ * Add the distance travelled by pxWheel in the last period, in um, to its
+ * position and measured speed.
+ */
+static void prvMeasure( xWheel *pxWheel, int32_t lDeltaUM );
+
+/*
+ * Set the wheel speeds that turn towards the heading setpoint.
+ */
+static void prvControlHeading( void );
+
+/*
+ * Run one period of the PID of pxWheel, leaving the new duty in its lDuty.
+ * Returns pdTRUE if the duty had to be limited.
+ */
+static portBASE_TYPE prvControlWheel( xWheel *pxWheel );
+
+/*
+ * Return the heading, in milliradians, from the wheel positions.
+ */
+static int32_t prvHeading( void );
+
+/*-----------------------------------------------------------*/
+
+static xWheel xWheels[ motorcontrolNUM_WHEELS ] =
+{
+	{ 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0UL },
+	{ 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0UL }
+};
+
+static uint32_t ulMode = motorcontrolMODE_SPEED;
+
+/* The setpoints of heading mode. */
+static int32_t lHeadingSpeed = 0L, lHeadingTarget = 0L;
+static volatile portBASE_TYPE xHeadingReached = pdFALSE;
+
+static xMotorControlStats xStats;
+
+/*-----------------------------------------------------------*/
+
+void vMotorControlStart( void )
+{
+PINSEL_CFG_Type xPinConfig;
+QEI_CFG_Type xQEIConfig;
+QEI_RELOADCFG_Type xReloadConfig;
+
+	vCycleCounterEnable();
+
+	/* Both wheels start stopped. */
+	vMotorsSetDuties( 0L, 0L );
+
+	/* MCI0 and MCI1 (phases A and B of the right encoder) are on P1.20 and
+	P1.23.  CAP2.0 (phase A of the left encoder) is on P0.4. */
+	xPinConfig.OpenDrain = PINSEL_PINMODE_NORMAL;
+	xPinConfig.Pinmode = PINSEL_PINMODE_PULLUP;
+	xPinConfig.Funcnum = PINSEL_FUNC_1;
+	xPinConfig.Portnum = PINSEL_PORT_1;
+	xPinConfig.Pinnum = PINSEL_PIN_20;
+	PINSEL_ConfigPin( &xPinConfig );
+	xPinConfig.Pinnum = PINSEL_PIN_23;
+	PINSEL_ConfigPin( &xPinConfig );
+
+	xPinConfig.Funcnum = PINSEL_FUNC_3;
+	xPinConfig.Portnum = PINSEL_PORT_0;
+	xPinConfig.Pinnum = PINSEL_PIN_4;
+	PINSEL_ConfigPin( &xPinConfig );
+
+	/* The position counter wraps at 32 bits, so the difference between two
+	readings is the signed distance travelled. */
+	QEI_ConfigStructInit( &xQEIConfig );
+	QEI_Init( LPC_QEI, &xQEIConfig );
+	QEI_SetMaxPosition( LPC_QEI, 0xffffffffUL );
+
+	CLKPWR_ConfigPPWR( CLKPWR_PCONP_PCTIM2, ENABLE );
+	LPC_TIM2->TCR = 0x02UL;
+	LPC_TIM2->CTCR = motorcontrolCTCR_COUNT_RISING_CAP0;
+	LPC_TIM2->TCR = 0x01UL;
+
+	xWheels[ motorcontrolLEFT ].ulLastCount = LPC_TIM2->TC;
+	xWheels[ motorcontrolRIGHT ].ulLastCount = QEI_GetPosition( LPC_QEI );
+
+	/* The velocity timer interrupt runs the controller. */
+	xReloadConfig.ReloadOption = QEI_TIMERRELOAD_USVAL;
+	xReloadConfig.ReloadValue = motorcontrolPERIOD_US;
+	QEI_SetTimerReload( LPC_QEI, &xReloadConfig );
+	QEI_IntCmd( LPC_QEI, QEI_INTFLAG_TIM_Int, ENABLE );
+
+	NVIC_SetPriority( QEI_IRQn, motorcontrolINTERRUPT_PRIORITY );
+	NVIC_EnableIRQ( QEI_IRQn );
+}
+/*-----------------------------------------------------------*/
+
+void vMotorControlSetSpeeds( int32_t lLeftMMPerSecond, int32_t lRightMMPerSecond )
+{
+	taskENTER_CRITICAL();
+	{
+		ulMode = motorcontrolMODE_SPEED;
+		prvSetWheelSpeed( &( xWheels[ motorcontrolLEFT ] ), lLeftMMPerSecond );
+		prvSetWheelSpeed( &( xWheels[ motorcontrolRIGHT ] ), lRightMMPerSecond );
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vMotorControlSetHeading( int32_t lMMPerSecond, int32_t lHeading )
+{
+	taskENTER_CRITICAL();
+	{
+		ulMode = motorcontrolMODE_HEADING;
+		lHeadingSpeed = lMMPerSecond;
+		lHeadingTarget = lHeading;
+		xHeadingReached = pdFALSE;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+int32_t lMotorControlGetHeading( void )
+{
+int32_t lReturn;
+
+	taskENTER_CRITICAL();
+	{
+		lReturn = prvHeading();
+	}
+	taskEXIT_CRITICAL();
+
+	return lReturn;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xMotorControlHeadingReached( void )
+{
+	return xHeadingReached;
+}
+/*-----------------------------------------------------------*/
+
+void vMotorControlGetStats( xMotorControlStats *pxStats )
+{
+	taskENTER_CRITICAL();
+	{
+		*pxStats = xStats;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetWheelSpeed( xWheel *pxWheel, int32_t lMMPerSecond )
+{
+	pxWheel->lSetpoint = motorcontrolUM_PER_PERIOD( lMMPerSecond );
+	pxWheel->lFeedForward = ( lMMPerSecond * ( int32_t ) motorsPWM_PERIOD ) / motorcontrolFULL_SPEED_MM_S;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasure( xWheel *pxWheel, int32_t lDeltaUM )
+{
+	pxWheel->lPosition += lDeltaUM;
+
+	/* First order low pass filter, in fixed point. */
+	lDeltaUM <<= motorcontrolSPEED_FRACTION_BITS;
+	pxWheel->lFilteredSpeed += ( lDeltaUM - pxWheel->lFilteredSpeed ) >> motorcontrolSPEED_FILTER_SHIFT;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvHeading( void )
+{
+	/* um divided by mm gives milliradians. */
+	return ( xWheels[ motorcontrolRIGHT ].lPosition - xWheels[ motorcontrolLEFT ].lPosition ) / motorcontrolTRACK_MM;
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlHeading( void )
+{
+int32_t lError, lTurn;
+
+	lError = lHeadingTarget - prvHeading();
+
+	if( ( lError < motorcontrolHEADING_TOLERANCE ) && ( lError > -motorcontrolHEADING_TOLERANCE ) )
+	{
+		xHeadingReached = pdTRUE;
+	}
+
+	lTurn = ( lError * motorcontrolHEADING_GAIN ) >> motorcontrolHEADING_SHIFT;
+
+	if( lTurn > motorcontrolMAX_TURN_MM_S )
+	{
+		lTurn = motorcontrolMAX_TURN_MM_S;
+	}
+	else if( lTurn < -motorcontrolMAX_TURN_MM_S )
+	{
+		lTurn = -motorcontrolMAX_TURN_MM_S;
+	}
+
+	prvSetWheelSpeed( &( xWheels[ motorcontrolLEFT ] ), lHeadingSpeed - lTurn );
+	prvSetWheelSpeed( &( xWheels[ motorcontrolRIGHT ] ), lHeadingSpeed + lTurn );
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvControlWheel( xWheel *pxWheel )
+{
+int32_t lError, lSpeedError, lDuty;
+portBASE_TYPE xSaturated = pdFALSE;
+
+	pxWheel->lTarget += pxWheel->lSetpoint;
+	lError = pxWheel->lTarget - pxWheel->lPosition;
+
+	if( lError > motorcontrolMAX_LAG_UM )
+	{
+		lError = motorcontrolMAX_LAG_UM;
+		pxWheel->lTarget = pxWheel->lPosition + lError;
+	}
+	else if( lError < -motorcontrolMAX_LAG_UM )
+	{
+		lError = -motorcontrolMAX_LAG_UM;
+		pxWheel->lTarget = pxWheel->lPosition + lError;
+	}
+
+	lSpeedError = pxWheel->lSetpoint - ( pxWheel->lFilteredSpeed >> motorcontrolSPEED_FRACTION_BITS );
+
+	lDuty = pxWheel->lFeedForward;
+	lDuty += ( motorcontrolKP * lError ) >> motorcontrolKP_SHIFT;
+	lDuty += ( motorcontrolKI * pxWheel->lIntegral ) >> motorcontrolKI_SHIFT;
+	lDuty += ( motorcontrolKD * lSpeedError ) >> motorcontrolKD_SHIFT;
+
+	if( lDuty > motorsPWM_PERIOD )
+	{
+		lDuty = motorsPWM_PERIOD;
+		xSaturated = pdTRUE;
+	}
+	else if( lDuty < -motorsPWM_PERIOD )
+	{
+		lDuty = -motorsPWM_PERIOD;
+		xSaturated = pdTRUE;
+	}
+
+	/* Only integrate while the integral can still change the duty. */
+	if( ( xSaturated == pdFALSE ) || ( ( lError > 0L ) != ( lDuty > 0L ) ) )
+	{
+		pxWheel->lIntegral += lError;
+
+		if( pxWheel->lIntegral > motorcontrolMAX_INTEGRAL )
+		{
+			pxWheel->lIntegral = motorcontrolMAX_INTEGRAL;
+		}
+		else if( pxWheel->lIntegral < -motorcontrolMAX_INTEGRAL )
+		{
+			pxWheel->lIntegral = -motorcontrolMAX_INTEGRAL;
+		}
+	}
+	else if( ( pxWheel->lSetpoint > 0L ) == ( lDuty > 0L ) )
+	{
+		/* The wheel is behind its target and already at full duty, so hold
+		the target where it was.  Otherwise the lag runs out to
+		motorcontrolMAX_LAG_UM, where the P term alone is well over full
+		duty, and keeps the wheel saturated long after it could have
+		followed a lower setpoint. */
+		pxWheel->lTarget -= pxWheel->lSetpoint;
+	}
+
+	pxWheel->lDuty = lDuty;
+
+	return xSaturated;
+}
+/*-----------------------------------------------------------*/
+
+void QEI_IRQHandler( void )
+{
+xWheel * const pxLeft = &( xWheels[ motorcontrolLEFT ] );
+xWheel * const pxRight = &( xWheels[ motorcontrolRIGHT ] );
+uint32_t ulStartCycles, ulCycles, ulLeftCount, ulRightCount;
+int32_t lLeftDelta;
+portBASE_TYPE xSaturated;
+
+	ulStartCycles = ulCycleCounterRead();
+	profilerBEGIN( profilerQEI_ISR );
+
+	if( QEI_GetIntStatus( LPC_QEI, QEI_INTFLAG_TIM_Int ) == SET )
+	{
+		QEI_IntClear( LPC_QEI, QEI_INTFLAG_TIM_Int );
+
+		ulRightCount = QEI_GetPosition( LPC_QEI );
+		ulLeftCount = LPC_TIM2->TC;
+
+		prvMeasure( pxRight, ( int32_t ) ( ulRightCount - pxRight->ulLastCount ) * motorcontrolRIGHT_UM_PER_COUNT );
+		pxRight->ulLastCount = ulRightCount;
+
+		/* TIMER2 cannot tell which way the wheel turned, so assume it turned
+		the way it was being driven. */
+		lLeftDelta = ( int32_t ) ( ulLeftCount - pxLeft->ulLastCount ) * motorcontrolLEFT_UM_PER_COUNT;
+		if( pxLeft->lDuty < 0L )
+		{
+			lLeftDelta = -lLeftDelta;
+		}
+		prvMeasure( pxLeft, lLeftDelta );
+		pxLeft->ulLastCount = ulLeftCount;
+
+		if( ulMode == motorcontrolMODE_HEADING )
+		{
+			prvControlHeading();
+		}
+
+		xSaturated = prvControlWheel( pxLeft );
+		xSaturated |= prvControlWheel( pxRight );
+
+		/* Both duties change in the same PWM period. */
+		vMotorsSetDuties( pxLeft->lDuty, pxRight->lDuty );
+
+		xStats.ulPeriods++;
+		xStats.lLeftSpeed = ( ( pxLeft->lFilteredSpeed >> motorcontrolSPEED_FRACTION_BITS ) * 1000L ) / ( int32_t ) motorcontrolPERIOD_US;
+		xStats.lRightSpeed = ( ( pxRight->lFilteredSpeed >> motorcontrolSPEED_FRACTION_BITS ) * 1000L ) / ( int32_t ) motorcontrolPERIOD_US;
+		xStats.lLeftDuty = pxLeft->lDuty;
+		xStats.lRightDuty = pxRight->lDuty;
+
+		if( xSaturated != pdFALSE )
+		{
+			xStats.ulSaturatedPeriods++;
+		}
+	}
+
+	profilerEND( profilerQEI_ISR );
+	ulCycles = ulCycleCounterRead() - ulStartCycles;
+	xStats.ulLastISRCycles = ulCycles;
+	if( ulCycles > xStats.ulMaxISRCycles )
+	{
+		xStats.ulMaxISRCycles = ulCycles;
+	}
+}
+/*-----------------------------------------------------------*/
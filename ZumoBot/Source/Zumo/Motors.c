@@ -0,0 +1,365 @@
+/*
+ * The drive motors.  See Motors.h.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include "LPC17xx.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_mcpwm.h"
+#include "lpc17xx_pinsel.h"
+#include "lpc17xx_pwm.h"
+
+/* Zumo includes. */
+#include "Motors.h"
+#include "Hal.h"
+#include "Profiler.h"
+
+/* The direction pins, on port 0.  A high pin reverses the motor. */
+#define motorsDIRECTION_PORT		( 0 )
+#define motorsRIGHT_DIRECTION_MASK	( 1UL << 5UL )
+#define motorsLEFT_DIRECTION_MASK	( 1UL << 10UL )
+
+/* The MCPWM pulse width registers.  In edge aligned mode the output is
+active from the match value to the end of the period. */
+#define motorsMCPWM_MATCH( x )		( ( &( LPC_MCPWM->MCPW0 ) )[ ( x ) ] )
+
+/* The fraction bits of ulDutyScale. */
+#define motorsDUTY_SCALE_SHIFT		( 16UL )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Work out the counts in one PWM period, and the scale from a duty to them,
+ * from the frequency of the clock the PWM counter runs from.
+ */
+static void prvSetPeriod( uint32_t ulClockHz );
+
+/*
+ * Return the match value for lDuty, which is limited to motorsPWM_PERIOD.
+ */
+static uint32_t prvMatch( int32_t lDuty );
+
+/*
+ * Drive the direction pins in ulMask high, and the rest of the direction pins
+ * low.  The pins are only written when they change.
+ */
+static void prvSetDirections( uint32_t ulMask );
+
+/*
+ * Write match values and enable them together at the start of the next
+ * period.  ulChannels has a bit set for each channel being written.
+ */
+static void prvWriteMatches( uint32_t ulChannels, uint32_t ulLeftMatch, uint32_t ulRightMatch );
+
+/*-----------------------------------------------------------*/
+
+/* The direction pins that are high. */
+static uint32_t ulReverse = 0UL;
+
+/* The counts in one PWM period, and the factor that scales a duty out of
+motorsPWM_PERIOD to them, with motorsDUTY_SCALE_SHIFT fraction bits.  Set by
+prvSetPeriod(). */
+static uint32_t ulPeriodCounts = ( uint32_t ) motorsPWM_PERIOD;
+static uint32_t ulDutyScale = 1UL << motorsDUTY_SCALE_SHIFT;
+
+/*-----------------------------------------------------------*/
+
+void configurePWMpin(const unsigned int pin) {
+  const int channel = pin;
+
+  /* Configure each PWM channel: --------------------------------------------- */
+  /* - Single edge
+   * - PWM Duty on each PWM channel determined by
+   * the match on channel 0 to the match of that match channel.
+   * Example: PWM Duty on PWM channel 1 determined by
+   * the match on channel 0 to the match of match channel 1.
+   */
+
+  /* Configure PWM channel edge option
+   * Note: PWM Channel 1 is in single mode as default state and
+   * can not be changed to double edge mode */
+  if (channel > 1) {
+    PWM_ChannelConfig(LPC_PWM1, channel, PWM_CHANNEL_SINGLE_EDGE);
+  }
+
+  /* Configure match value for each match channel */
+  /* Set up match value */
+  PWM_MatchUpdate(LPC_PWM1, channel, 0, PWM_MATCH_UPDATE_NOW);
+
+  /* Configure match option */
+  PWM_MATCHCFG_Type PWMMatchCfgDat;
+  PWMMatchCfgDat.MatchChannel = channel;
+  PWMMatchCfgDat.IntOnMatch = DISABLE;
+  PWMMatchCfgDat.ResetOnMatch = DISABLE;
+  PWMMatchCfgDat.StopOnMatch = DISABLE;
+  PWM_ConfigMatch(LPC_PWM1, &PWMMatchCfgDat);
+
+  /* Enable PWM Channel Output */
+  PWM_ChannelCmd(LPC_PWM1, channel, ENABLE);
+
+
+}
+
+void setPWM(const unsigned int channel, const unsigned int value) {
+
+  /* Takes effect at the start of the next period, so the output does not
+   * glitch.  Does the same as PWM_MatchUpdate() with
+   * PWM_MATCH_UPDATE_NEXT_RST, without the parameter checks and the switch. */
+  vHalPWMSetMatch(channel, value);
+  vHalPWMLatch(1UL << channel);
+}
+
+void inicializarMotores()
+{
+#if motorsBACKEND == motorsBACKEND_MCPWM
+
+	  /* MCPWM section ---------------------------------------------------- */
+	  /* Channels 0 and 1 edge aligned, active high, counting the core clock.
+	   * A match value past the end of the period keeps the output low. */
+	  MCPWM_CHANNEL_CFG_Type MCPWMChannelCfg;
+	  MCPWM_Init(LPC_MCPWM);
+	  CLKPWR_SetPCLKDiv(CLKPWR_PCLKSEL_MC, CLKPWR_PCLKSEL_CCLK_DIV_1);
+	  prvSetPeriod(CLKPWR_GetPCLK(CLKPWR_PCLKSEL_MC));
+
+	  MCPWMChannelCfg.channelType = MCPWM_CHANNEL_EDGE_MODE;
+	  MCPWMChannelCfg.channelPolarity = MCPWM_CHANNEL_PASSIVE_LO;
+	  MCPWMChannelCfg.channelDeadtimeEnable = DISABLE;
+	  MCPWMChannelCfg.channelDeadtimeValue = 0;
+	  MCPWMChannelCfg.channelUpdateEnable = ENABLE;
+	  MCPWMChannelCfg.channelTimercounterValue = 0;
+	  MCPWMChannelCfg.channelPeriodValue = ulPeriodCounts - 1;
+	  MCPWMChannelCfg.channelPulsewidthValue = ulPeriodCounts;
+	  MCPWM_ConfigChannel(LPC_MCPWM, motorsRIGHT_PWM_CHANNEL, &MCPWMChannelCfg);
+	  MCPWM_ConfigChannel(LPC_MCPWM, motorsLEFT_PWM_CHANNEL, &MCPWMChannelCfg);
+
+	  /* MCOA0 on P1.19 and MCOA1 on P1.25. */
+	  PINSEL_CFG_Type MCPWMPinCfg;
+	  MCPWMPinCfg.Funcnum = PINSEL_FUNC_1;
+	  MCPWMPinCfg.OpenDrain = PINSEL_PINMODE_NORMAL;
+	  MCPWMPinCfg.Pinmode = PINSEL_PINMODE_PULLUP;
+	  MCPWMPinCfg.Portnum = PINSEL_PORT_1;
+	  MCPWMPinCfg.Pinnum = PINSEL_PIN_19;
+	  PINSEL_ConfigPin(&MCPWMPinCfg);
+	  MCPWMPinCfg.Pinnum = PINSEL_PIN_25;
+	  PINSEL_ConfigPin(&MCPWMPinCfg);
+
+	  /* Both channels are started with one write, so they run in step. */
+	  MCPWM_Start(LPC_MCPWM, ENABLE, ENABLE, DISABLE);
+
+#else
+
+	  /* PWM block section -------------------------------------------- */
+	  /* Initialize PWM peripheral, timer mode
+	   * PWM prescale value = 1 (absolute value - tick value) */
+	  PWM_TIMERCFG_Type PWMCfgDat;
+	  PWMCfgDat.PrescaleOption = PWM_TIMER_PRESCALE_TICKVAL;
+	  PWMCfgDat.PrescaleValue = 1;
+	  PWM_Init(LPC_PWM1, PWM_MODE_TIMER, (void *) &PWMCfgDat);
+
+	  /* PWM_Init() divides the clock by 4.  The full core clock gives the
+	   * resolution at an ultrasonic carrier. */
+	  CLKPWR_SetPCLKDiv(CLKPWR_PCLKSEL_PWM1, CLKPWR_PCLKSEL_CCLK_DIV_1);
+	  prvSetPeriod(CLKPWR_GetPCLK(CLKPWR_PCLKSEL_PWM1));
+
+	  /* Set match value for PWM match channel 0 = one period, update immediately */
+	  PWM_MatchUpdate(LPC_PWM1, 0, ulPeriodCounts, PWM_MATCH_UPDATE_NOW);
+	  /* PWM Timer/Counter will be reset when channel 0 matching
+	   * no interrupt when match
+	   * no stop when match */
+	  PWM_MATCHCFG_Type PWMMatchCfgDat;
+	  PWMMatchCfgDat.IntOnMatch = DISABLE;
+	  PWMMatchCfgDat.MatchChannel = 0;
+	  PWMMatchCfgDat.ResetOnMatch = ENABLE;
+	  PWMMatchCfgDat.StopOnMatch = DISABLE;
+	  PWM_ConfigMatch(LPC_PWM1, &PWMMatchCfgDat);
+
+	  configurePWMpin(motorsRIGHT_PWM_CHANNEL);
+	  configurePWMpin(motorsLEFT_PWM_CHANNEL);
+	  configurePWMpin(5);
+
+	  /* Reset and Start counter */
+	  PWM_ResetCounter(LPC_PWM1);
+	  PWM_CounterCmd(LPC_PWM1, ENABLE);
+	  PWM_Cmd(LPC_PWM1, ENABLE);
+
+#endif
+
+	// DECLARACION como salida el P2.0, P2.1, P2.2, P2.3
+//	LPC_GPIO2->FIODIR |=  (1 << 2) | (1 << 3); //1 = salida, 0 = entrada
+	LPC_GPIO0->FIODIR |=  (1 << 10) | (1 << 5); //1 = salida, 0 = entrada
+	vHalGPIOClear(motorsDIRECTION_PORT, motorsRIGHT_DIRECTION_MASK | motorsLEFT_DIRECTION_MASK);
+	ulReverse = 0UL;
+
+	// CONFIGURACION DEL FUNCIONAMIENTO DE LOS PINES.
+		PINSEL_CFG_Type PinCfg;
+			PinCfg.Funcnum = PINSEL_FUNC_1;
+			PinCfg.OpenDrain = PINSEL_PINMODE_NORMAL;
+			PinCfg.Pinmode = PINSEL_PINMODE_PULLUP;
+			PinCfg.Pinnum = PINSEL_PIN_2;
+			PinCfg.Portnum = PINSEL_PORT_2;
+			PINSEL_ConfigPin(&PinCfg);
+			PinCfg.Pinnum = PINSEL_PIN_3;
+			PINSEL_ConfigPin(&PinCfg);
+
+			PinCfg.Pinnum = PINSEL_PIN_4;
+			PINSEL_ConfigPin(&PinCfg);
+
+			PinCfg.Portnum = PINSEL_PORT_0;
+			PinCfg.Funcnum = PINSEL_FUNC_0;
+			PinCfg.Pinnum = PINSEL_PIN_10;
+			PINSEL_ConfigPin(&PinCfg);
+			PinCfg.Funcnum = PINSEL_FUNC_0;   //declaracion de la configuracion de los pines
+			PinCfg.Pinnum = PINSEL_PIN_5;
+			PINSEL_ConfigPin(&PinCfg);
+
+}
+
+void vMotorsSetDuties( int32_t lLeftDuty, int32_t lRightDuty )
+{
+uint32_t ulMask = 0UL;
+
+	profilerBEGIN( profilerMOTORS_SET_DUTIES );
+
+	if( lLeftDuty < 0L )
+	{
+		ulMask |= motorsLEFT_DIRECTION_MASK;
+		lLeftDuty = -lLeftDuty;
+	}
+
+	if( lRightDuty < 0L )
+	{
+		ulMask |= motorsRIGHT_DIRECTION_MASK;
+		lRightDuty = -lRightDuty;
+	}
+
+	prvSetDirections( ulMask );
+	prvWriteMatches( ( 1UL << motorsLEFT_PWM_CHANNEL ) | ( 1UL << motorsRIGHT_PWM_CHANNEL ), prvMatch( lLeftDuty ), prvMatch( lRightDuty ) );
+
+	profilerEND( profilerMOTORS_SET_DUTIES );
+}
+
+void motorDerecho(int direccion, int PWM)
+{
+
+	if(direccion == 0)
+	{
+		prvSetDirections( ulReverse | motorsRIGHT_DIRECTION_MASK );  // 1 al pin
+	}
+
+	if(direccion == 1)
+	{
+		prvSetDirections( ulReverse & ~motorsRIGHT_DIRECTION_MASK ); // 0 al pin
+	}
+
+	prvWriteMatches( 1UL << motorsRIGHT_PWM_CHANNEL, 0UL, prvMatch( PWM ) );
+}
+
+void motorIzquierdo(int direccion, int PWM)
+{
+	if(direccion == 0)
+	{
+		prvSetDirections( ulReverse | motorsLEFT_DIRECTION_MASK );  // 1 al pin
+	}
+
+	if(direccion == 1)
+	{
+		prvSetDirections( ulReverse & ~motorsLEFT_DIRECTION_MASK ); // 0 al pin
+	}
+
+	prvWriteMatches( 1UL << motorsLEFT_PWM_CHANNEL, prvMatch( PWM ), 0UL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetPeriod( uint32_t ulClockHz )
+{
+	ulPeriodCounts = ulClockHz / ( uint32_t ) motorsPWM_FREQUENCY_HZ;
+	configASSERT( ulPeriodCounts >= motorsPWM_MIN_PERIOD_COUNTS );
+
+	ulDutyScale = ( uint32_t ) ( ( ( uint64_t ) ulPeriodCounts << motorsDUTY_SCALE_SHIFT ) / ( uint64_t ) motorsPWM_PERIOD );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvMatch( int32_t lDuty )
+{
+uint32_t ulMatch;
+
+	if( lDuty > motorsPWM_PERIOD )
+	{
+		lDuty = motorsPWM_PERIOD;
+	}
+	else if( lDuty < 0L )
+	{
+		lDuty = 0L;
+	}
+
+	/* One multiply, no divide, as this is called from the motor control
+	interrupt. */
+	ulMatch = ( uint32_t ) ( ( ( uint64_t ) lDuty * ulDutyScale ) >> motorsDUTY_SCALE_SHIFT );
+
+#if motorsBACKEND == motorsBACKEND_MCPWM
+	return ulPeriodCounts - ulMatch;
+#else
+	return ulMatch;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetDirections( uint32_t ulMask )
+{
+	if( ( ulMask & ~ulReverse ) != 0UL )
+	{
+		vHalGPIOSet( motorsDIRECTION_PORT, ulMask & ~ulReverse );
+	}
+
+	if( ( ulReverse & ~ulMask ) != 0UL )
+	{
+		vHalGPIOClear( motorsDIRECTION_PORT, ulReverse & ~ulMask );
+	}
+
+	ulReverse = ulMask;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteMatches( uint32_t ulChannels, uint32_t ulLeftMatch, uint32_t ulRightMatch )
+{
+#if motorsBACKEND == motorsBACKEND_MCPWM
+
+	/* The MCPWM has no latch enable register.  Instead, the transfer of the
+	new values at the end of the period is disabled while they are written. */
+	LPC_MCPWM->MCCON_SET = MCPWM_CON_DISUP( motorsLEFT_PWM_CHANNEL ) | MCPWM_CON_DISUP( motorsRIGHT_PWM_CHANNEL );
+
+	if( ( ulChannels & ( 1UL << motorsLEFT_PWM_CHANNEL ) ) != 0UL )
+	{
+		motorsMCPWM_MATCH( motorsLEFT_PWM_CHANNEL ) = ulLeftMatch;
+	}
+
+	if( ( ulChannels & ( 1UL << motorsRIGHT_PWM_CHANNEL ) ) != 0UL )
+	{
+		motorsMCPWM_MATCH( motorsRIGHT_PWM_CHANNEL ) = ulRightMatch;
+	}
+
+	LPC_MCPWM->MCCON_CLR = MCPWM_CON_DISUP( motorsLEFT_PWM_CHANNEL ) | MCPWM_CON_DISUP( motorsRIGHT_PWM_CHANNEL );
+
+#else
+
+	if( ( ulChannels & ( 1UL << motorsLEFT_PWM_CHANNEL ) ) != 0UL )
+	{
+		vHalPWMSetMatch( motorsLEFT_PWM_CHANNEL, ulLeftMatch );
+	}
+
+	if( ( ulChannels & ( 1UL << motorsRIGHT_PWM_CHANNEL ) ) != 0UL )
+	{
+		vHalPWMSetMatch( motorsRIGHT_PWM_CHANNEL, ulRightMatch );
+	}
+
+	/* The new values are used from the next time the counter is reset by
+	MR0.  The latch enable bits clear themselves when that happens. */
+	vHalPWMLatch( ulChannels );
+
+#endif
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,253 @@
+/*
+ * Fuses the four IR distance sensors into an estimate of where the opponent
+ * is.  See Opponent-tracker.h.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Zumo includes. */
+#include "Opponent-tracker.h"
+#include "ADC-DMA-sampler.h"
+
+/* The channel of each sensor. */
+#define opponenttrackerFRONT				( 0 )
+#define opponenttrackerLEFT					( 1 )
+#define opponenttrackerRIGHT				( 2 )
+#define opponenttrackerREAR					( 3 )
+#define opponenttrackerNO_CHANNEL			( 0xff )
+
+#define opponenttrackerPI_MRAD				( 3142L )
+#define opponenttrackerTWO_PI_MRAD			( 6283L )
+
+#define opponenttrackerNUM_DISTANCES		( sizeof( xDistances ) / sizeof( xDistancePoint ) )
+
+/* The baselines are held with this many fractional bits, so they can rise by
+less than a count per update. */
+#define opponenttrackerBASELINE_FRACTION_BITS	( 8 )
+#define opponenttrackerBASELINE_ONE				( 1L << opponenttrackerBASELINE_FRACTION_BITS )
+
+/*-----------------------------------------------------------*/
+
+/* A point on the curve of reading against distance. */
+typedef struct xDISTANCE_POINT
+{
+	int32_t lCounts;
+	int32_t lDistanceMM;
+} xDistancePoint;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Return the distance that gives a reading of lCounts, interpolated between
+ * the points of xDistances.
+ */
+static int32_t prvDistance( int32_t lCounts );
+
+/*
+ * Return lAngle, in milliradians, moved into the range -pi to pi.
+ */
+static int32_t prvWrap( int32_t lAngle );
+
+/*-----------------------------------------------------------*/
+
+/* The reading of the sensors at distances from 100mm to 500mm, from the curve
+in the data sheet, closest first. */
+static const xDistancePoint xDistances[] =
+{
+	{ 2447L, 100L },
+	{ 1985L, 120L },
+	{ 1535L, 150L },
+	{ 1103L, 200L },
+	{ 853L, 250L },
+	{ 692L, 300L },
+	{ 579L, 350L },
+	{ 497L, 400L },
+	{ 434L, 450L },
+	{ 385L, 500L }
+};
+
+/* The direction of each sensor, indexed by channel. */
+static const int32_t lDirections[ adcsamplerNUM_CHANNELS ] =
+{
+	opponenttrackerFRONT_MRAD,
+	opponenttrackerLEFT_MRAD,
+	opponenttrackerRIGHT_MRAD,
+	opponenttrackerREAR_MRAD
+};
+
+/* The channel whose bearing can be interpolated with each channel, if both
+see the opponent.  The front channel is handled separately. */
+static const uint8_t ucNeighbours[ adcsamplerNUM_CHANNELS ] =
+{
+	opponenttrackerNO_CHANNEL,
+	opponenttrackerFRONT,
+	opponenttrackerFRONT,
+	opponenttrackerNO_CHANNEL
+};
+
+static int32_t lBaselines[ adcsamplerNUM_CHANNELS ] =
+{
+	opponenttrackerBASELINE_COUNTS * opponenttrackerBASELINE_ONE,
+	opponenttrackerBASELINE_COUNTS * opponenttrackerBASELINE_ONE,
+	opponenttrackerBASELINE_COUNTS * opponenttrackerBASELINE_ONE,
+	opponenttrackerBASELINE_COUNTS * opponenttrackerBASELINE_ONE
+};
+
+static xOpponentEstimate xEstimate = { pdFALSE, 0L, 0L, 0UL, 0U };
+
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xOpponentTrackerUpdate( int32_t lHeading, uint32_t ulElapsedMS )
+{
+int32_t lReadings[ adcsamplerNUM_CHANNELS ], lSignals[ adcsamplerNUM_CHANNELS ];
+int32_t lDifference, lBearing, lStrongest = 0L, lRise, lMaxRise;
+uint8_t ucChannel, ucBest = opponenttrackerNO_CHANNEL, ucNeighbour, ucChannels = 0U;
+
+	lMaxRise = ( opponenttrackerBASELINE_MAX_RISE * opponenttrackerBASELINE_ONE * ( int32_t ) ulElapsedMS ) / 1000L;
+
+	for( ucChannel = 0U; ucChannel < adcsamplerNUM_CHANNELS; ucChannel++ )
+	{
+		lReadings[ ucChannel ] = ( int32_t ) usADCSamplerGetAverage( ucChannel );
+		lDifference = lReadings[ ucChannel ] - ( lBaselines[ ucChannel ] >> opponenttrackerBASELINE_FRACTION_BITS );
+		lSignals[ ucChannel ] = lDifference;
+
+		if( lDifference >= opponenttrackerTHRESHOLD )
+		{
+			ucChannels |= ( uint8_t ) ( 1U << ucChannel );
+
+			if( lDifference > lStrongest )
+			{
+				lStrongest = lDifference;
+				ucBest = ucChannel;
+			}
+		}
+		else if( lDifference < 0L )
+		{
+			lBaselines[ ucChannel ] = lReadings[ ucChannel ] * opponenttrackerBASELINE_ONE;
+		}
+		else if( lDifference < opponenttrackerBASELINE_HOLD )
+		{
+			/* Nothing in the beam, so follow the reading slowly, and more
+			slowly than an opponent closing in would raise it. */
+			lRise = ( lDifference * opponenttrackerBASELINE_ONE ) >> opponenttrackerBASELINE_SHIFT;
+
+			if( lRise > lMaxRise )
+			{
+				lRise = lMaxRise;
+			}
+
+			lBaselines[ ucChannel ] += lRise;
+		}
+	}
+
+	xEstimate.ucChannels = ucChannels;
+
+	if( ucBest == opponenttrackerNO_CHANNEL )
+	{
+		if( xEstimate.xValid != pdFALSE )
+		{
+			xEstimate.ulAgeMS += ulElapsedMS;
+
+			if( xEstimate.ulAgeMS >= opponenttrackerLOST_MS )
+			{
+				xEstimate.xValid = pdFALSE;
+			}
+		}
+
+		return pdFALSE;
+	}
+
+	/* The bearing relative to the front of the robot. */
+	lBearing = lDirections[ ucBest ];
+
+	if( ucBest == opponenttrackerFRONT )
+	{
+		/* The front can be interpolated with either side, so use the stronger
+		of the two. */
+		ucNeighbour = ( lSignals[ opponenttrackerLEFT ] > lSignals[ opponenttrackerRIGHT ] ) ? opponenttrackerLEFT : opponenttrackerRIGHT;
+	}
+	else
+	{
+		ucNeighbour = ucNeighbours[ ucBest ];
+	}
+
+	if( ( ucNeighbour != opponenttrackerNO_CHANNEL ) && ( lSignals[ ucNeighbour ] >= opponenttrackerTHRESHOLD ) )
+	{
+		lBearing += ( ( lDirections[ ucNeighbour ] - lBearing ) * lSignals[ ucNeighbour ] ) / ( lStrongest + lSignals[ ucNeighbour ] );
+	}
+
+	/* Into the frame of the heading. */
+	lBearing += lHeading;
+
+	if( xEstimate.xValid == pdFALSE )
+	{
+		xEstimate.lHeading = lBearing;
+		xEstimate.lDistanceMM = prvDistance( lReadings[ ucBest ] );
+		xEstimate.xValid = pdTRUE;
+	}
+	else
+	{
+		/* The headings are not wrapped, so the estimate is moved the short
+		way round to the new bearing. */
+		xEstimate.lHeading += prvWrap( lBearing - xEstimate.lHeading ) >> opponenttrackerFILTER_SHIFT;
+		xEstimate.lDistanceMM += ( prvDistance( lReadings[ ucBest ] ) - xEstimate.lDistanceMM ) >> opponenttrackerFILTER_SHIFT;
+	}
+
+	xEstimate.ulAgeMS = 0UL;
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vOpponentTrackerGetEstimate( xOpponentEstimate *pxEstimate )
+{
+	*pxEstimate = xEstimate;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvDistance( int32_t lCounts )
+{
+const xDistancePoint *pxNear, *pxFar;
+uint32_t ulPoint;
+int32_t lReturn;
+
+	if( lCounts >= xDistances[ 0 ].lCounts )
+	{
+		lReturn = xDistances[ 0 ].lDistanceMM;
+	}
+	else
+	{
+		lReturn = xDistances[ opponenttrackerNUM_DISTANCES - 1UL ].lDistanceMM;
+
+		for( ulPoint = 1UL; ulPoint < opponenttrackerNUM_DISTANCES; ulPoint++ )
+		{
+			if( lCounts >= xDistances[ ulPoint ].lCounts )
+			{
+				pxNear = &( xDistances[ ulPoint - 1UL ] );
+				pxFar = &( xDistances[ ulPoint ] );
+				lReturn = pxFar->lDistanceMM - ( ( ( pxFar->lDistanceMM - pxNear->lDistanceMM ) * ( lCounts - pxFar->lCounts ) ) / ( pxNear->lCounts - pxFar->lCounts ) );
+				break;
+			}
+		}
+	}
+
+	return lReturn;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvWrap( int32_t lAngle )
+{
+	while( lAngle > opponenttrackerPI_MRAD )
+	{
+		lAngle -= opponenttrackerTWO_PI_MRAD;
+	}
+
+	while( lAngle < -opponenttrackerPI_MRAD )
+	{
+		lAngle += opponenttrackerTWO_PI_MRAD;
+	}
+
+	return lAngle;
+}
+/*-----------------------------------------------------------*/
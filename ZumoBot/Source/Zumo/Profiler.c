@@ -0,0 +1,265 @@
+/*
+ * Cycle counts of named code scopes.  See Profiler.h.  Compiled to nothing
+ * unless profilerENABLED is set to 1.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include "LPC17xx.h"
+
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+
+/* Zumo includes. */
+#include "Profiler.h"
+
+#if profilerENABLED == 1
+
+/* The counter is read back to back this many times to find the cost of
+reading it. */
+#define profilerCALIBRATION_READS		( 8UL )
+
+/* Times under this many cycles go in the first bin of the histogram. */
+#define profilerFIRST_BIN_CYCLES		( 32UL )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Implements the "profile" command.  Outputs one line per call.
+ */
+static portBASE_TYPE prvProfileCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+/*
+ * The bin of the histogram that ulCycles is counted in.
+ */
+static inline uint32_t prvHistogramBin( uint32_t ulCycles );
+
+/*-----------------------------------------------------------*/
+
+static const xCommandLineInput xProfileCommand =
+{
+	( const int8_t * const ) "profile",
+	( const int8_t * const ) "profile: Displays the count, shortest, mean and longest cycles of each profiled scope, and their histograms\r\n",
+	prvProfileCommand,
+	0
+};
+
+static const char * const pcScopeNames[ profilerNUM_SCOPES ] =
+{
+	"floor timer ISR", "floor edge ISR", "ADC DMA ISR", "QEI ISR", "set duties", "control step", "tracker", "UART ISR"
+};
+
+static const char * const pcBinNames[ profilerHISTOGRAM_BINS ] =
+{
+	"<32", "<64", "<128", "<256", "<512", "<1k", "<2k", "<4k", "<8k", ">=8k"
+};
+
+uint32_t ulProfilerStartCycles[ profilerNUM_SCOPES ];
+
+static xProfilerScope xScopes[ profilerNUM_SCOPES ];
+
+/* The cycles taken between the two counter reads of an empty scope. */
+static uint32_t ulOverheadCycles = 0UL;
+
+/*-----------------------------------------------------------*/
+
+void vProfilerStart( void )
+{
+uint32_t ulRead, ulCycles;
+
+	vCycleCounterEnable();
+
+	ulOverheadCycles = 0xffffffffUL;
+	for( ulRead = 0UL; ulRead < profilerCALIBRATION_READS; ulRead++ )
+	{
+		profilerBEGIN( 0UL );
+		ulCycles = ulCycleCounterRead() - ulProfilerStartCycles[ 0 ];
+
+		if( ulCycles < ulOverheadCycles )
+		{
+			ulOverheadCycles = ulCycles;
+		}
+	}
+
+	for( ulRead = 0UL; ulRead < profilerNUM_SCOPES; ulRead++ )
+	{
+		xScopes[ ulRead ].pcName = pcScopeNames[ ulRead ];
+		xScopes[ ulRead ].ulCount = 0UL;
+		xScopes[ ulRead ].ulMinCycles = 0xffffffffUL;
+		xScopes[ ulRead ].ulMaxCycles = 0UL;
+		xScopes[ ulRead ].ullTotalCycles = 0ULL;
+		memset( xScopes[ ulRead ].ulBins, 0x00, sizeof( xScopes[ ulRead ].ulBins ) );
+	}
+
+	FreeRTOS_CLIRegisterCommand( &xProfileCommand );
+}
+/*-----------------------------------------------------------*/
+
+void vProfilerEnd( uint32_t ulScope, uint32_t ulEndCycles )
+{
+xProfilerScope *pxScope = &( xScopes[ ulScope ] );
+uint32_t ulCycles, ulMask, ulBin;
+
+	ulCycles = ulEndCycles - ulProfilerStartCycles[ ulScope ];
+
+	if( ulCycles > ulOverheadCycles )
+	{
+		ulCycles -= ulOverheadCycles;
+	}
+	else
+	{
+		ulCycles = 0UL;
+	}
+
+	ulBin = prvHistogramBin( ulCycles );
+
+	/* Scopes end in interrupts as well as tasks, so the counts are updated
+	with the interrupts that use the kernel masked, for vProfilerGetScopes() to
+	see them all change together.  The mask is restored rather than cleared,
+	as the scope may end inside a critical section. */
+	ulMask = __get_BASEPRI();
+	portDISABLE_INTERRUPTS();
+	{
+		pxScope->ulCount++;
+		pxScope->ullTotalCycles += ulCycles;
+		pxScope->ulBins[ ulBin ]++;
+
+		if( ulCycles < pxScope->ulMinCycles )
+		{
+			pxScope->ulMinCycles = ulCycles;
+		}
+
+		if( ulCycles > pxScope->ulMaxCycles )
+		{
+			pxScope->ulMaxCycles = ulCycles;
+		}
+	}
+	__set_BASEPRI( ulMask );
+}
+/*-----------------------------------------------------------*/
+
+static inline uint32_t prvHistogramBin( uint32_t ulCycles )
+{
+uint32_t ulBin = 0UL;
+
+	if( ulCycles >= profilerFIRST_BIN_CYCLES )
+	{
+		/* 32 to 63 cycles have 6 significant bits and go in bin 1. */
+		ulBin = ( 32UL - ( uint32_t ) __CLZ( ulCycles ) ) - 5UL;
+
+		if( ulBin >= profilerHISTOGRAM_BINS )
+		{
+			ulBin = profilerHISTOGRAM_BINS - 1UL;
+		}
+	}
+
+	return ulBin;
+}
+/*-----------------------------------------------------------*/
+
+void vProfilerGetScopes( xProfilerScope *pxScopes )
+{
+uint32_t ulScope;
+
+	for( ulScope = 0UL; ulScope < profilerNUM_SCOPES; ulScope++ )
+	{
+		taskENTER_CRITICAL();
+		{
+			pxScopes[ ulScope ] = xScopes[ ulScope ];
+		}
+		taskEXIT_CRITICAL();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvProfileCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+{
+static xProfilerScope xSnapshot[ profilerNUM_SCOPES ];
+static uint32_t ulLine = 0UL;
+const xProfilerScope *pxScope;
+uint32_t ulBin;
+size_t xLength;
+portBASE_TYPE xReturn = pdTRUE;
+
+	( void ) xWriteBufferLen;
+	( void ) pcCommandString;
+
+	if( ulLine == 0UL )
+	{
+		/* Every line comes from the same copy of the counts. */
+		vProfilerGetScopes( xSnapshot );
+
+		sprintf( ( char * ) pcWriteBuffer, "Cycles at %u MHz, %u taken off each for the counter reads\r\n\r\n%-16s %10s %10s %10s %10s\r\n",
+				( unsigned int ) ( configCPU_CLOCK_HZ / 1000000UL ),
+				( unsigned int ) ulOverheadCycles,
+				"Scope", "Count", "Min", "Mean", "Max" );
+	}
+	else if( ulLine == ( profilerNUM_SCOPES + 1UL ) )
+	{
+		/* The histograms follow the table, a line for each scope. */
+		xLength = sprintf( ( char * ) pcWriteBuffer, "\r\n%-16s", "Histogram" );
+
+		for( ulBin = 0UL; ulBin < profilerHISTOGRAM_BINS; ulBin++ )
+		{
+			xLength += sprintf( ( char * ) &( pcWriteBuffer[ xLength ] ), " %7s", pcBinNames[ ulBin ] );
+		}
+
+		sprintf( ( char * ) &( pcWriteBuffer[ xLength ] ), "\r\n" );
+	}
+	else if( ulLine > ( profilerNUM_SCOPES + 1UL ) )
+	{
+		pxScope = &( xSnapshot[ ulLine - profilerNUM_SCOPES - 2UL ] );
+		xLength = sprintf( ( char * ) pcWriteBuffer, "%-16s", pxScope->pcName );
+
+		for( ulBin = 0UL; ulBin < profilerHISTOGRAM_BINS; ulBin++ )
+		{
+			xLength += sprintf( ( char * ) &( pcWriteBuffer[ xLength ] ), " %7u", ( unsigned int ) pxScope->ulBins[ ulBin ] );
+		}
+
+		sprintf( ( char * ) &( pcWriteBuffer[ xLength ] ), "\r\n" );
+
+		if( ulLine == ( ( profilerNUM_SCOPES * 2UL ) + 1UL ) )
+		{
+			xReturn = pdFALSE;
+		}
+	}
+	else
+	{
+		pxScope = &( xSnapshot[ ulLine - 1UL ] );
+
+		if( pxScope->ulCount == 0UL )
+		{
+			sprintf( ( char * ) pcWriteBuffer, "%-16s %10u %10s %10s %10s\r\n", pxScope->pcName, 0U, "-", "-", "-" );
+		}
+		else
+		{
+			sprintf( ( char * ) pcWriteBuffer, "%-16s %10u %10u %10u %10u\r\n",
+					pxScope->pcName,
+					( unsigned int ) pxScope->ulCount,
+					( unsigned int ) pxScope->ulMinCycles,
+					( unsigned int ) ( pxScope->ullTotalCycles / pxScope->ulCount ),
+					( unsigned int ) pxScope->ulMaxCycles );
+		}
+	}
+
+	if( xReturn == pdFALSE )
+	{
+		ulLine = 0UL;
+	}
+	else
+	{
+		ulLine++;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* profilerENABLED */
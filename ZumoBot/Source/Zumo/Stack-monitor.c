@@ -0,0 +1,266 @@
+/*
+ * The peak stack use of every task.  See Stack-monitor.h.  Compiled to
+ * nothing unless configUSE_STACK_MONITOR is set to 1.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+
+/* Zumo includes. */
+#include "Stack-monitor.h"
+
+#if configUSE_STACK_MONITOR == 1
+
+#if INCLUDE_uxTaskGetStackStats != 1
+	#error The stack monitor needs INCLUDE_uxTaskGetStackStats set to 1 in FreeRTOSConfig.h.
+#endif
+
+/* The peak stack use of the tasks of one name. */
+typedef struct xSTACK_PEAK
+{
+	char cName[ configMAX_TASK_NAME_LEN ];
+	unsigned short usStackDepth;
+	unsigned short usMostUsed;
+	portBASE_TYPE xWarned;
+} xStackPeak;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The timer callback.  Reads the high water marks.
+ */
+static void prvStackMonitorTimerCallback( xTimerHandle xTimer );
+
+/*
+ * Implements the "stacks" command.  Outputs one line per call.
+ */
+static portBASE_TYPE prvStacksCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+/*
+ * The depth to give a task that has used usMostUsed words of its stack.
+ */
+static unsigned long prvRightSize( unsigned short usMostUsed );
+
+/*-----------------------------------------------------------*/
+
+static const xCommandLineInput xStacksCommand =
+{
+	( const int8_t * const ) "stacks",
+	( const int8_t * const ) "stacks: Displays the peak stack use of each task, and a Stack-sizes.h that fits it\r\n",
+	prvStacksCommand,
+	0
+};
+
+static xStaticTimer xStackMonitorTimer;
+
+/* Filled by uxTaskGetStackStats(), only with the scheduler suspended. */
+static xTaskStackStats xStats[ stackmonitorMAX_TASKS ];
+
+static xStackPeak xPeaks[ stackmonitorMAX_TASKS ];
+static unsigned portBASE_TYPE uxPeaks = 0U;
+
+/*-----------------------------------------------------------*/
+
+void vStackMonitorStart( void )
+{
+xTimerHandle xTimer;
+
+	xTimer = xTimerCreateStatic( ( const signed char * ) "Stacks", stackmonitorPERIOD_MS / portTICK_RATE_MS, pdTRUE, NULL, prvStackMonitorTimerCallback, &xStackMonitorTimer );
+	configASSERT( xTimer );
+	xTimerStart( xTimer, 0 );
+
+	FreeRTOS_CLIRegisterCommand( &xStacksCommand );
+}
+/*-----------------------------------------------------------*/
+
+void vStackMonitorCheck( void )
+{
+unsigned portBASE_TYPE uxTasks, uxTask, uxPeak;
+xTaskStackStats *pxStats;
+xStackPeak *pxPeak;
+unsigned short usUsed;
+
+	/* Both the timer task and tasks about to delete themselves get here, so
+	the table is only touched with the scheduler suspended. */
+	vTaskSuspendAll();
+	{
+		uxTasks = uxTaskGetStackStats( xStats, stackmonitorMAX_TASKS );
+
+		for( uxTask = 0U; uxTask < uxTasks; uxTask++ )
+		{
+			pxStats = &( xStats[ uxTask ] );
+			usUsed = pxStats->usStackDepth - pxStats->usLeastFree;
+
+			for( uxPeak = 0U; uxPeak < uxPeaks; uxPeak++ )
+			{
+				if( strncmp( xPeaks[ uxPeak ].cName, ( const char * ) pxStats->pcTaskName, configMAX_TASK_NAME_LEN ) == 0 )
+				{
+					break;
+				}
+			}
+
+			if( uxPeak == uxPeaks )
+			{
+				if( uxPeaks == stackmonitorMAX_TASKS )
+				{
+					/* No room for another name. */
+					continue;
+				}
+
+				pxPeak = &( xPeaks[ uxPeaks ] );
+				strncpy( pxPeak->cName, ( const char * ) pxStats->pcTaskName, configMAX_TASK_NAME_LEN );
+				pxPeak->cName[ configMAX_TASK_NAME_LEN - 1 ] = '\0';
+				pxPeak->usMostUsed = 0U;
+				pxPeak->xWarned = pdFALSE;
+				uxPeaks++;
+			}
+			else
+			{
+				pxPeak = &( xPeaks[ uxPeak ] );
+			}
+
+			/* The depth of the latest task of the name. */
+			pxPeak->usStackDepth = pxStats->usStackDepth;
+
+			if( usUsed > pxPeak->usMostUsed )
+			{
+				pxPeak->usMostUsed = usUsed;
+			}
+
+			if( ( pxPeak->xWarned == pdFALSE ) && ( ( ( unsigned long ) pxStats->usLeastFree * 100UL ) < ( ( unsigned long ) pxStats->usStackDepth * stackmonitorWARN_PERCENT ) ) )
+			{
+				pxPeak->xWarned = pdTRUE;
+				vApplicationStackWarningHook( pxStats->xHandle, ( signed char * ) pxStats->pcTaskName, pxStats->usLeastFree );
+			}
+		}
+	}
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+static void prvStackMonitorTimerCallback( xTimerHandle xTimer )
+{
+	( void ) xTimer;
+
+	vStackMonitorCheck();
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long prvRightSize( unsigned short usMostUsed )
+{
+unsigned long ulDepth;
+
+	ulDepth = ( unsigned long ) usMostUsed;
+	ulDepth += ( ( ulDepth * stackmonitorMARGIN_PERCENT ) + 99UL ) / 100UL;
+	ulDepth += stackmonitorMARGIN_WORDS;
+
+	/* Keep the stack eight byte aligned. */
+	ulDepth = ( ulDepth + 1UL ) & ~1UL;
+
+	return ulDepth;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvStacksCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+{
+static xStackPeak xSnapshot[ stackmonitorMAX_TASKS ];
+static unsigned portBASE_TYPE uxSnapshotPeaks = 0U;
+static unsigned long ulLine = 0UL;
+const xStackPeak *pxPeak;
+char cMacro[ configMAX_TASK_NAME_LEN ];
+unsigned portBASE_TYPE uxChar;
+portBASE_TYPE xReturn = pdTRUE;
+
+	( void ) xWriteBufferLen;
+	( void ) pcCommandString;
+
+	if( ulLine == 0UL )
+	{
+		/* Every line comes from the same copy of the table, read afresh. */
+		vStackMonitorCheck();
+
+		vTaskSuspendAll();
+		{
+			memcpy( xSnapshot, xPeaks, sizeof( xSnapshot ) );
+			uxSnapshotPeaks = uxPeaks;
+		}
+		xTaskResumeAll();
+
+		sprintf( ( char * ) pcWriteBuffer, "Stack in words, ! when less than %u%% was left unused\r\n\r\n%-12s %6s %6s %6s\r\n",
+				( unsigned int ) stackmonitorWARN_PERCENT,
+				"Task", "Depth", "Used", "Free" );
+	}
+	else if( ulLine <= uxSnapshotPeaks )
+	{
+		pxPeak = &( xSnapshot[ ulLine - 1UL ] );
+
+		sprintf( ( char * ) pcWriteBuffer, "%-12s %6u %6u %6u %s\r\n",
+				pxPeak->cName,
+				( unsigned int ) pxPeak->usStackDepth,
+				( unsigned int ) pxPeak->usMostUsed,
+				( unsigned int ) ( pxPeak->usStackDepth - pxPeak->usMostUsed ),
+				( pxPeak->xWarned != pdFALSE ) ? "!" : "" );
+	}
+	else if( ulLine == ( uxSnapshotPeaks + 1UL ) )
+	{
+		sprintf( ( char * ) pcWriteBuffer, "\r\n#ifndef STACK_SIZES_H\r\n#define STACK_SIZES_H\r\n\r\n/* Generated by the \"stacks\" command - the deepest use of each task plus %u%% and %u words. */\r\n\r\n",
+				( unsigned int ) stackmonitorMARGIN_PERCENT,
+				( unsigned int ) stackmonitorMARGIN_WORDS );
+	}
+	else if( ulLine <= ( ( uxSnapshotPeaks * 2UL ) + 1UL ) )
+	{
+		pxPeak = &( xSnapshot[ ulLine - uxSnapshotPeaks - 2UL ] );
+
+		/* The task name, in capitals with anything else made '_'. */
+		for( uxChar = 0U; pxPeak->cName[ uxChar ] != '\0'; uxChar++ )
+		{
+			if( ( pxPeak->cName[ uxChar ] >= 'a' ) && ( pxPeak->cName[ uxChar ] <= 'z' ) )
+			{
+				cMacro[ uxChar ] = pxPeak->cName[ uxChar ] - 'a' + 'A';
+			}
+			else if( ( ( pxPeak->cName[ uxChar ] >= 'A' ) && ( pxPeak->cName[ uxChar ] <= 'Z' ) ) || ( ( pxPeak->cName[ uxChar ] >= '0' ) && ( pxPeak->cName[ uxChar ] <= '9' ) ) )
+			{
+				cMacro[ uxChar ] = pxPeak->cName[ uxChar ];
+			}
+			else
+			{
+				cMacro[ uxChar ] = '_';
+			}
+		}
+		cMacro[ uxChar ] = '\0';
+
+		sprintf( ( char * ) pcWriteBuffer, "#define stacksizes%-12s ( %luU )\t/* %u of %u used. */\r\n",
+				cMacro,
+				prvRightSize( pxPeak->usMostUsed ),
+				( unsigned int ) pxPeak->usMostUsed,
+				( unsigned int ) pxPeak->usStackDepth );
+	}
+	else
+	{
+		sprintf( ( char * ) pcWriteBuffer, "\r\n#endif /* STACK_SIZES_H */\r\n" );
+		xReturn = pdFALSE;
+	}
+
+	if( xReturn == pdFALSE )
+	{
+		ulLine = 0UL;
+	}
+	else
+	{
+		ulLine++;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_STACK_MONITOR */
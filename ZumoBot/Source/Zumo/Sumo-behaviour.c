@@ -0,0 +1,1011 @@
+/*
+ * Table driven sumo behaviour.  See Sumo-behaviour.h.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+
+/* Library includes. */
+#include "LPC17xx.h"
+
+/* Zumo includes. */
+#include "Sumo-behaviour.h"
+#include "Motor-control.h"
+#include "ADC-DMA-sampler.h"
+#include "Control-loop.h"
+#include "Opponent-tracker.h"
+#include "Timebase.h"
+#include "Profiler.h"
+#include "Stack-monitor.h"
+
+/* The events that drive the state machine.  sumoEVENT_NONE is returned by an
+action that does not generate a follow on event, and is never looked up. */
+#define sumoEVENT_NONE					( 0 )
+#define sumoEVENT_TIMEOUT				( 1 )	/* The timeout set by the last action expired. */
+#define sumoEVENT_EDGE					( 2 )	/* A floor sensor saw the edge of the ring. */
+#define sumoEVENT_BUTTON				( 3 )	/* The start button was pressed. */
+#define sumoEVENT_COUNTDOWN_DONE		( 4 )	/* The start countdown finished. */
+#define sumoEVENT_OPPONENT				( 5 )	/* The opponent was found. */
+#define sumoEVENT_ESCAPE_DONE			( 6 )	/* The last step of an escape manoeuvre finished. */
+#define sumoNUM_EVENTS					( 7 )
+
+/* The start button is on P0.11, and is low when pressed.  The LED is on
+P0.9.  The opponent LED is on P2.13. */
+#define sumoBUTTON_MASK					( 1UL << 11UL )
+#define sumoLED_MASK					( 1UL << 9UL )
+#define sumoOPPONENT_LED_MASK			( 1UL << 13UL )
+
+/* The task waits on a set of the event queue and the button semaphore, so
+the set must be long enough for both. */
+#define sumoEVENT_SET_LENGTH			( sumoEVENT_QUEUE_LENGTH + 1 )
+
+/* The LED is toggled sumoCOUNTDOWN_STEPS times, sumoCOUNTDOWN_STEP_MS apart,
+before the bout starts. */
+#define sumoCOUNTDOWN_STEPS				( 6 )
+#define sumoCOUNTDOWN_STEP_MS			( 500 / portTICK_RATE_MS )
+
+/* The search is run by vSumoControlStep(), once per control loop period.
+While the tracker has an estimate, the robot pivots to the heading of the
+opponent.  Otherwise it turns on the spot at sumoSEARCH_SPEED, towards the
+side the opponent was last seen on.  The opponent is found when the front
+distance sensor (ADC channel 0) sees it, within sumoAIM_TOLERANCE_MRAD of
+straight ahead, for sumoOPPONENT_CONFIRM_MS.  If the opponent is not found
+within sumoSEARCH_MAX_MS the robot attacks anyway.  Both times are converted
+to control loop periods, so they do not change when the period does.
+
+Without the tracker the search only turns on the spot, comparing the front
+distance sensor with its value when the search started.  The opponent is
+found when the difference exceeds sumoOPPONENT_THRESHOLD for
+sumoOPPONENT_CONFIRM_MS. */
+#define sumoSEARCH_SPEED				( 250L )
+#define sumoSEARCH_CHANNEL				( 0 )
+#define sumoOPPONENT_THRESHOLD			( 150L )
+#define sumoOPPONENT_LOST_THRESHOLD		( 10L )
+#define sumoOPPONENT_CONFIRM_MS			( 20UL )
+#define sumoSEARCH_MAX_MS				( 70000UL )
+#define sumoOPPONENT_CONFIRMATIONS		( sumoOPPONENT_CONFIRM_MS / controlloopPERIOD_MS )
+#define sumoSEARCH_MAX_STEPS			( sumoSEARCH_MAX_MS / controlloopPERIOD_MS )
+#define sumoAIM_TOLERANCE_MRAD			( 175L )
+
+/* While attacking, the robot steers to the estimated heading of the
+opponent, as long as one of the three front sensors (ADC channels 0 to 2)
+sees it within sumoATTACK_STEER_MRAD of straight ahead.  Further round than
+that, the sighting is more likely to be something else. */
+#define sumoATTACK_STEER_MRAD			( 700L )
+#define sumoFRONT_CHANNELS				( 0x07U )
+
+/* Wheel speeds in mm/s. */
+#define sumoATTACK_SPEED				( 550L )
+#define sumoESCAPE_SPEED				( 450L )
+
+/* The stack size given to each task created by the old edge handling. */
+#define sumoSPAWNED_TASK_STACK_SIZE		( 1000 )
+
+/* The heap the task needs besides its stack, for its TCB and the overhead of
+the allocator. */
+#define sumoSPAWNED_TASK_HEAP_MARGIN	( 256 )
+
+/*-----------------------------------------------------------*/
+
+/* An item on the event queue. */
+typedef struct xSUMO_EVENT
+{
+	uint8_t ucEvent;		/* One of the sumoEVENT_ constants. */
+	uint8_t ucSensor;		/* The floor sensor, for sumoEVENT_EDGE only. */
+	uint32_t ulTimestamp;	/* The timebase value when the event occurred, for sumoEVENT_EDGE only. */
+} xSumoEvent;
+
+/* An action returns the event, if any, that it generates itself. */
+typedef uint8_t ( *pdSUMO_ACTION )( const xSumoEvent *pxEvent );
+
+/* One entry of the state machine table.  An entry with no action leaves the
+state unchanged, so events that do not apply to a state are ignored. */
+typedef struct xSUMO_TRANSITION
+{
+	pdSUMO_ACTION pxAction;
+	uint8_t ucNextState;
+} xSumoTransition;
+
+/* One step of an escape manoeuvre. */
+typedef struct xESCAPE_STEP
+{
+	int16_t sRightSpeed;		/* mm/s, negative for reverse. */
+	int16_t sLeftSpeed;
+	portTickType xDuration;
+} xEscapeStep;
+
+typedef struct xESCAPE_MANOEUVRE
+{
+	const xEscapeStep *pxSteps;
+	uint32_t ulNumSteps;
+} xEscapeManoeuvre;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The task that runs the state machine.
+ */
+static void prvSumoTask( void *pvParameters );
+
+/*
+ * Implements the "sumo-stats" command.
+ */
+static portBASE_TYPE prvSumoStatsCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+/*
+ * Look up an event in the table, perform the action and change state.
+ * Follow on events generated by the action are dispatched before returning.
+ */
+static void prvDispatch( xSumoEvent *pxEvent );
+
+/*
+ * Set the time after which a sumoEVENT_TIMEOUT event is generated, or cancel
+ * it, and find how long is left before it expires.
+ */
+static void prvSetTimeout( portTickType xTicks );
+static void prvCancelTimeout( void );
+static portTickType prvTicksToTimeout( void );
+
+/*
+ * The transition actions.
+ */
+static uint8_t prvStartCountdown( const xSumoEvent *pxEvent );
+static uint8_t prvCountdownStep( const xSumoEvent *pxEvent );
+static uint8_t prvStartSearch( const xSumoEvent *pxEvent );
+static uint8_t prvStartAttack( const xSumoEvent *pxEvent );
+static uint8_t prvStartEscape( const xSumoEvent *pxEvent );
+static uint8_t prvStartRetreat( const xSumoEvent *pxEvent );
+static uint8_t prvEscapeStep( const xSumoEvent *pxEvent );
+
+/*
+ * Start the manoeuvre pointed to by pxNewManoeuvre, recording how long it took
+ * to get from the edge event to the motors being reversed.
+ */
+static void prvBeginManoeuvre( const xEscapeManoeuvre *pxNewManoeuvre, const xSumoEvent *pxEvent );
+
+/*
+ * One control step of the search.  Returns pdTRUE when the opponent has been
+ * found.
+ */
+static portBASE_TYPE prvSearchStep( void );
+
+#if( sumoUSE_OPPONENT_TRACKER == 1 )
+
+	/*
+	 * One control step of the attack.
+	 */
+	static void prvAttackStep( void );
+
+	/*
+	 * Command the motors from the control task, but only if the behaviour is
+	 * still in state ucInState.  The state is checked and the motors set in
+	 * one critical section, so a transition made by the behaviour task is
+	 * never overwritten.
+	 */
+	static void prvSetHeadingInState( uint8_t ucInState, int32_t lMMPerSecond, int32_t lHeading );
+	static void prvSetSpeedsInState( uint8_t ucInState, int32_t lLeftMMPerSecond, int32_t lRightMMPerSecond );
+
+#endif
+
+#if( sumoMEASURE_TASK_SPAWN_LATENCY == 1 )
+
+	/*
+	 * Time how long it takes to create a task that reverses the motors, as the
+	 * edge handling did before the state machine was introduced.
+	 */
+	static void prvMeasureTaskSpawnLatency( const xEscapeStep *pxStep );
+	static void prvSpawnedTask( void *pvParameters );
+
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* The escape manoeuvres, copied from the original edge handling task.  Each
+one starts by reversing both motors. */
+static const xEscapeStep xEscapeLeftSteps[] =
+{
+	{ -sumoESCAPE_SPEED, -sumoESCAPE_SPEED, 150 / portTICK_RATE_MS },
+	{ 0, 0, 100 / portTICK_RATE_MS },
+	{ -sumoESCAPE_SPEED, sumoESCAPE_SPEED, 100 / portTICK_RATE_MS }
+};
+
+static const xEscapeStep xEscapeRightSteps[] =
+{
+	{ -sumoESCAPE_SPEED, -sumoESCAPE_SPEED, 150 / portTICK_RATE_MS },
+	{ 0, 0, 100 / portTICK_RATE_MS },
+	{ sumoESCAPE_SPEED, -sumoESCAPE_SPEED, 100 / portTICK_RATE_MS }
+};
+
+/* Used when the edge is reached while attacking - the opponent is probably
+still in front, so just back off. */
+static const xEscapeStep xRetreatSteps[] =
+{
+	{ -sumoESCAPE_SPEED, -sumoESCAPE_SPEED, 700 / portTICK_RATE_MS }
+};
+
+/* Indexed by floor sensor - left, right, centre. */
+static const xEscapeManoeuvre xEscapeManoeuvres[] =
+{
+	{ xEscapeLeftSteps, sizeof( xEscapeLeftSteps ) / sizeof( xEscapeStep ) },
+	{ xEscapeRightSteps, sizeof( xEscapeRightSteps ) / sizeof( xEscapeStep ) },
+	{ xEscapeRightSteps, sizeof( xEscapeRightSteps ) / sizeof( xEscapeStep ) }
+};
+
+static const xEscapeManoeuvre xRetreat = { xRetreatSteps, sizeof( xRetreatSteps ) / sizeof( xEscapeStep ) };
+
+/* The state machine.  Events not listed for a state are ignored. */
+static const xSumoTransition xTransitions[ sumoNUM_STATES ][ sumoNUM_EVENTS ] =
+{
+	[ sumoSTATE_WAITING ] =
+	{
+		[ sumoEVENT_BUTTON ]			= { prvStartCountdown, sumoSTATE_COUNTDOWN }
+	},
+
+	[ sumoSTATE_COUNTDOWN ] =
+	{
+		[ sumoEVENT_TIMEOUT ]			= { prvCountdownStep, sumoSTATE_COUNTDOWN },
+		[ sumoEVENT_COUNTDOWN_DONE ]	= { prvStartSearch, sumoSTATE_SEARCH }
+	},
+
+	[ sumoSTATE_SEARCH ] =
+	{
+		[ sumoEVENT_EDGE ]				= { prvStartEscape, sumoSTATE_ESCAPE },
+		[ sumoEVENT_OPPONENT ]			= { prvStartAttack, sumoSTATE_ATTACK }
+	},
+
+	[ sumoSTATE_ATTACK ] =
+	{
+		[ sumoEVENT_EDGE ]				= { prvStartRetreat, sumoSTATE_ESCAPE }
+	},
+
+	[ sumoSTATE_ESCAPE ] =
+	{
+		[ sumoEVENT_TIMEOUT ]			= { prvEscapeStep, sumoSTATE_ESCAPE },
+		[ sumoEVENT_EDGE ]				= { prvStartEscape, sumoSTATE_ESCAPE },
+		[ sumoEVENT_ESCAPE_DONE ]		= { prvStartSearch, sumoSTATE_SEARCH }
+	}
+};
+
+/*-----------------------------------------------------------*/
+
+static xQueueHandle xEventQueue = NULL;
+
+/* Given by the button interrupt, which is only enabled while waiting for the
+button. */
+static xSemaphoreHandle xButtonSemaphore = NULL;
+
+/* The task blocks on this set of the event queue and the button semaphore. */
+static xQueueSetHandle xEventSet = NULL;
+
+/* The event queue, the button semaphore, the set and the task are created in
+these rather than on the heap. */
+static xStaticQueue xEventQueueBuffer;
+static uint8_t ucEventQueueStorage[ sumoEVENT_QUEUE_LENGTH * sizeof( xSumoEvent ) ];
+static xStaticQueue xButtonSemaphoreBuffer;
+static xStaticQueue xEventSetBuffer;
+static uint8_t ucEventSetStorage[ sumoEVENT_SET_LENGTH * sizeof( xQueueSetMemberHandle ) ];
+static xStaticTask xSumoTaskBuffer;
+static portSTACK_TYPE xSumoStack[ sumoTASK_STACK_SIZE ];
+
+static uint8_t ucState = sumoSTATE_WAITING;
+
+/* The pending timeout, if xTimeoutSet is pdTRUE. */
+static portBASE_TYPE xTimeoutSet = pdFALSE;
+static portTickType xTimeoutStart = 0, xTimeoutPeriod = 0;
+
+/* The progress of the countdown and escape states. */
+static uint32_t ulCountdownStep = 0UL;
+static const xEscapeManoeuvre *pxManoeuvre = NULL;
+static uint32_t ulManoeuvreStep = 0UL;
+
+/* The progress of the search.  Only accessed by the control task, which is
+told a new search has started through xSearchRestart. */
+static uint32_t ulSearchSteps = 0UL, ulConfirmations = 0UL, ulSearchStart = 0UL;
+static volatile portBASE_TYPE xSearchRestart = pdFALSE;
+
+#if( sumoUSE_OPPONENT_TRACKER == 1 )
+
+	/* pdTRUE while the search is turning on the spot, rather than to the
+	estimate, and the direction to turn in, 1 for anticlockwise. */
+	static portBASE_TYPE xSweeping = pdTRUE;
+	static int32_t lSweepDirection = -1L;
+
+#else
+
+	static int32_t lSearchBaseline = 0L;
+
+#endif
+
+#if( sumoMEASURE_TASK_SPAWN_LATENCY == 1 )
+
+	/* The time the last edge event took to reach the behaviour task, and the
+	timebase value when the task that handles it the old way was created. */
+	static uint32_t ulSpawnDispatch = 0UL, ulSpawnStart = 0UL;
+
+#endif
+
+static xSumoStats xStats = { sumoSTATE_WAITING, 0UL, 0UL, 0UL, 0xffffffffUL, 0UL, 0UL, 0UL, 0UL, 0xffffffffUL, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL };
+
+static const xCommandLineInput xSumoStatsCommand =
+{
+	( const int8_t * const ) "sumo-stats",
+	( const int8_t * const ) "sumo-stats: Displays the edge to reverse latency and the time to acquire the opponent\r\n",
+	prvSumoStatsCommand,
+	0
+};
+
+/*-----------------------------------------------------------*/
+
+void vSumoBehaviourStart( void )
+{
+	xEventQueue = xQueueCreateStatic( sumoEVENT_QUEUE_LENGTH, sizeof( xSumoEvent ), ucEventQueueStorage, &xEventQueueBuffer );
+	configASSERT( xEventQueue );
+	vQueueAddToRegistry( xEventQueue, ( signed char * ) "SumoEvents" );
+
+	/* Members must be empty when added to the set, and a new binary semaphore
+	is given, so it is taken first. */
+	vSemaphoreCreateBinaryStatic( xButtonSemaphore, &xButtonSemaphoreBuffer );
+	configASSERT( xButtonSemaphore );
+	( void ) xSemaphoreTake( xButtonSemaphore, 0 );
+
+	xEventSet = xQueueCreateSetStatic( sumoEVENT_SET_LENGTH, ucEventSetStorage, &xEventSetBuffer );
+	configASSERT( xEventSet );
+	xQueueAddToSet( xEventQueue, xEventSet );
+	xQueueAddToSet( xButtonSemaphore, xEventSet );
+
+	xTaskCreateStatic( prvSumoTask, ( signed char * ) "Sumo", sumoTASK_STACK_SIZE, NULL, sumoTASK_PRIORITY, xSumoStack, &xSumoTaskBuffer );
+
+	FreeRTOS_CLIRegisterCommand( &xSumoStatsCommand );
+}
+/*-----------------------------------------------------------*/
+
+void vSumoControlStep( void )
+{
+xSumoEvent xEvent;
+uint32_t ulAcquire;
+portBASE_TYPE xFound;
+
+	#if( sumoUSE_OPPONENT_TRACKER == 1 )
+	{
+		/* Updated in every state, so there is an estimate to turn to as soon
+		as a search starts. */
+		profilerBEGIN( profilerOPPONENT_TRACKER );
+		( void ) xOpponentTrackerUpdate( lMotorControlGetHeading(), controlloopPERIOD_MS );
+		profilerEND( profilerOPPONENT_TRACKER );
+
+		if( ucState == sumoSTATE_ATTACK )
+		{
+			prvAttackStep();
+		}
+	}
+	#endif
+
+	if( ucState != sumoSTATE_SEARCH )
+	{
+		return;
+	}
+
+	if( xSearchRestart != pdFALSE )
+	{
+		xSearchRestart = pdFALSE;
+		ulSearchSteps = 0UL;
+		ulConfirmations = 0UL;
+		ulSearchStart = ulTimebaseMicroseconds();
+
+		#if( sumoUSE_OPPONENT_TRACKER == 1 )
+		{
+			/* Makes the first step command the motors, whether or not there
+			is an estimate. */
+			xSweeping = pdFALSE;
+		}
+		#else
+		{
+			lSearchBaseline = ( int32_t ) usADCSamplerGetAverage( sumoSEARCH_CHANNEL );
+			return;
+		}
+		#endif
+	}
+
+	xFound = prvSearchStep();
+
+	if( ( xFound != pdFALSE ) || ( ulSearchSteps > sumoSEARCH_MAX_STEPS ) )
+	{
+		LPC_GPIO2->FIOSET = sumoOPPONENT_LED_MASK;
+		ulAcquire = ulTimebaseMicroseconds() - ulSearchStart;
+
+		taskENTER_CRITICAL();
+		{
+			if( xFound != pdFALSE )
+			{
+				xStats.ulAcquisitions++;
+				xStats.ulLastAcquireMicroseconds = ulAcquire;
+				xStats.ulTotalAcquireMicroseconds += ulAcquire;
+
+				if( ulAcquire > xStats.ulMaxAcquireMicroseconds )
+				{
+					xStats.ulMaxAcquireMicroseconds = ulAcquire;
+				}
+			}
+			else
+			{
+				xStats.ulSearchTimeouts++;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		/* Start the search again if it carries on, which it only does if the
+		event is lost. */
+		xSearchRestart = pdTRUE;
+
+		xEvent.ucEvent = sumoEVENT_OPPONENT;
+		if( xQueueSendToBack( xEventQueue, &xEvent, 0 ) != pdPASS )
+		{
+			taskENTER_CRITICAL();
+			{
+				xStats.ulEventsLost++;
+			}
+			taskEXIT_CRITICAL();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vSumoPostEdgeFromISR( uint8_t ucSensor, uint32_t ulTimestamp, portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+xSumoEvent xEvent;
+
+	xEvent.ucEvent = sumoEVENT_EDGE;
+	xEvent.ucSensor = ucSensor;
+	xEvent.ulTimestamp = ulTimestamp;
+
+	/* The edge is the most urgent event, so it goes ahead of anything already
+	queued. */
+	if( xQueueSendToFrontFromISR( xEventQueue, &xEvent, pxHigherPriorityTaskWoken ) != pdPASS )
+	{
+		xStats.ulEventsLost++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vSumoPostPort0EdgesFromISR( uint32_t ulFallen, portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+	if( ( ulFallen & sumoBUTTON_MASK ) != 0UL )
+	{
+		/* The button bounces, but the semaphore is binary, so the extra
+		edges are lost rather than queued. */
+		( void ) xSemaphoreGiveFromISR( xButtonSemaphore, pxHigherPriorityTaskWoken );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vSumoGetStats( xSumoStats *pxStats )
+{
+	taskENTER_CRITICAL();
+	{
+		*pxStats = xStats;
+		pxStats->ulState = ucState;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvSumoTask( void *pvParameters )
+{
+xSumoEvent xEvent;
+xQueueSetMemberHandle xActivated;
+
+	( void ) pvParameters;
+
+	vMotorControlSetSpeeds( 0L, 0L );
+	LPC_GPIO0->FIOCLR = sumoLED_MASK;
+
+	/* Wait for the button to be pressed.  A press before the interrupt was
+	enabled is only seen on the pin. */
+	LPC_GPIOINT->IO0IntClr = sumoBUTTON_MASK;
+	LPC_GPIOINT->IO0IntEnF |= sumoBUTTON_MASK;
+
+	if( ( LPC_GPIO0->FIOPIN & sumoBUTTON_MASK ) == 0UL )
+	{
+		( void ) xSemaphoreGive( xButtonSemaphore );
+	}
+
+	for( ;; )
+	{
+		xActivated = xQueueSelectFromSet( xEventSet, prvTicksToTimeout() );
+
+		if( xActivated == xEventQueue )
+		{
+			( void ) xQueueReceive( xEventQueue, &xEvent, 0 );
+		}
+		else if( xActivated == xButtonSemaphore )
+		{
+			( void ) xSemaphoreTake( xButtonSemaphore, 0 );
+			xEvent.ucEvent = sumoEVENT_BUTTON;
+		}
+		else
+		{
+			prvCancelTimeout();
+			xEvent.ucEvent = sumoEVENT_TIMEOUT;
+		}
+
+		prvDispatch( &xEvent );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvDispatch( xSumoEvent *pxEvent )
+{
+const xSumoTransition *pxTransition;
+
+	while( pxEvent->ucEvent != sumoEVENT_NONE )
+	{
+		configASSERT( pxEvent->ucEvent < sumoNUM_EVENTS );
+		pxTransition = &( xTransitions[ ucState ][ pxEvent->ucEvent ] );
+
+		if( pxTransition->pxAction == NULL )
+		{
+			/* The event does not apply to this state. */
+			break;
+		}
+
+		ucState = pxTransition->ucNextState;
+		pxEvent->ucEvent = pxTransition->pxAction( pxEvent );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetTimeout( portTickType xTicks )
+{
+	xTimeoutStart = xTaskGetTickCount();
+	xTimeoutPeriod = xTicks;
+	xTimeoutSet = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCancelTimeout( void )
+{
+	xTimeoutSet = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static portTickType prvTicksToTimeout( void )
+{
+portTickType xElapsed, xReturn;
+
+	if( xTimeoutSet == pdFALSE )
+	{
+		xReturn = portMAX_DELAY;
+	}
+	else
+	{
+		/* Events that are ignored must not extend the timeout, so the time
+		left is calculated from when the timeout was set. */
+		xElapsed = xTaskGetTickCount() - xTimeoutStart;
+
+		if( xElapsed >= xTimeoutPeriod )
+		{
+			xReturn = 0;
+		}
+		else
+		{
+			xReturn = xTimeoutPeriod - xElapsed;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvStartCountdown( const xSumoEvent *pxEvent )
+{
+	/* The button is only needed to start the bout. */
+	LPC_GPIOINT->IO0IntEnF &= ~sumoBUTTON_MASK;
+
+	ulCountdownStep = 0UL;
+	return prvCountdownStep( pxEvent );
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvCountdownStep( const xSumoEvent *pxEvent )
+{
+uint8_t ucReturn = sumoEVENT_NONE;
+
+	( void ) pxEvent;
+
+	if( ulCountdownStep >= sumoCOUNTDOWN_STEPS )
+	{
+		LPC_GPIO0->FIOCLR = sumoLED_MASK;
+		ucReturn = sumoEVENT_COUNTDOWN_DONE;
+	}
+	else
+	{
+		if( ( ulCountdownStep & 1UL ) == 0UL )
+		{
+			LPC_GPIO0->FIOSET = sumoLED_MASK;
+		}
+		else
+		{
+			LPC_GPIO0->FIOCLR = sumoLED_MASK;
+		}
+
+		ulCountdownStep++;
+		prvSetTimeout( sumoCOUNTDOWN_STEP_MS );
+	}
+
+	return ucReturn;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvStartSearch( const xSumoEvent *pxEvent )
+{
+	( void ) pxEvent;
+
+	/* The control task starts the search on its next step. */
+	xSearchRestart = pdTRUE;
+
+	/* The LED is on while the robot is inside the ring. */
+	LPC_GPIO0->FIOSET = sumoLED_MASK;
+
+	vMotorControlSetSpeeds( sumoSEARCH_SPEED, -sumoSEARCH_SPEED );
+
+	/* The search ends with an event from the control task, or at the edge. */
+	prvCancelTimeout();
+	return sumoEVENT_NONE;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvStartAttack( const xSumoEvent *pxEvent )
+{
+	( void ) pxEvent;
+
+	vMotorControlSetSpeeds( sumoATTACK_SPEED, sumoATTACK_SPEED );
+
+	/* Keep going until the edge is reached. */
+	prvCancelTimeout();
+	return sumoEVENT_NONE;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvStartEscape( const xSumoEvent *pxEvent )
+{
+	configASSERT( pxEvent->ucSensor < ( sizeof( xEscapeManoeuvres ) / sizeof( xEscapeManoeuvre ) ) );
+	prvBeginManoeuvre( &( xEscapeManoeuvres[ pxEvent->ucSensor ] ), pxEvent );
+	return sumoEVENT_NONE;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvStartRetreat( const xSumoEvent *pxEvent )
+{
+	prvBeginManoeuvre( &xRetreat, pxEvent );
+	return sumoEVENT_NONE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBeginManoeuvre( const xEscapeManoeuvre *pxNewManoeuvre, const xSumoEvent *pxEvent )
+{
+uint32_t ulLatency;
+
+	#if( sumoMEASURE_TASK_SPAWN_LATENCY == 1 )
+	{
+		/* The old approach also had to get this far before it could create
+		the task. */
+		ulSpawnDispatch = ulTimebaseMicroseconds() - pxEvent->ulTimestamp;
+	}
+	#endif
+
+	pxManoeuvre = pxNewManoeuvre;
+	ulManoeuvreStep = 0UL;
+	( void ) prvEscapeStep( pxEvent );
+
+	/* The first step has reversed the wheel setpoints.  The motor controller
+	acts on them within one motorcontrolPERIOD_US. */
+	ulLatency = ulTimebaseMicroseconds() - pxEvent->ulTimestamp;
+
+	taskENTER_CRITICAL();
+	{
+		xStats.ulEdgeEvents++;
+		xStats.ulLastEdgeToReverseMicroseconds = ulLatency;
+
+		if( ulLatency < xStats.ulMinEdgeToReverseMicroseconds )
+		{
+			xStats.ulMinEdgeToReverseMicroseconds = ulLatency;
+		}
+
+		if( ulLatency > xStats.ulMaxEdgeToReverseMicroseconds )
+		{
+			xStats.ulMaxEdgeToReverseMicroseconds = ulLatency;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	#if( sumoMEASURE_TASK_SPAWN_LATENCY == 1 )
+	{
+		prvMeasureTaskSpawnLatency( &( pxNewManoeuvre->pxSteps[ 0 ] ) );
+	}
+	#endif
+
+	LPC_GPIO0->FIOCLR = sumoLED_MASK;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvEscapeStep( const xSumoEvent *pxEvent )
+{
+const xEscapeStep *pxStep;
+uint8_t ucReturn = sumoEVENT_NONE;
+
+	( void ) pxEvent;
+
+	if( ulManoeuvreStep >= pxManoeuvre->ulNumSteps )
+	{
+		vMotorControlSetSpeeds( 0L, 0L );
+		ucReturn = sumoEVENT_ESCAPE_DONE;
+	}
+	else
+	{
+		pxStep = &( pxManoeuvre->pxSteps[ ulManoeuvreStep ] );
+		vMotorControlSetSpeeds( pxStep->sLeftSpeed, pxStep->sRightSpeed );
+
+		ulManoeuvreStep++;
+		prvSetTimeout( pxStep->xDuration );
+	}
+
+	return ucReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if( sumoUSE_OPPONENT_TRACKER == 1 )
+
+	static portBASE_TYPE prvSearchStep( void )
+	{
+	xOpponentEstimate xEstimate;
+	int32_t lError;
+
+		vOpponentTrackerGetEstimate( &xEstimate );
+		ulSearchSteps++;
+
+		if( xEstimate.xValid != pdFALSE )
+		{
+			lError = xEstimate.lHeading - lMotorControlGetHeading();
+
+			/* If the opponent is lost again, keep turning the same way. */
+			lSweepDirection = ( lError < 0L ) ? -1L : 1L;
+			xSweeping = pdFALSE;
+
+			if( ( ( xEstimate.ucChannels & ( 1U << sumoSEARCH_CHANNEL ) ) != 0U ) && ( lError < sumoAIM_TOLERANCE_MRAD ) && ( lError > -sumoAIM_TOLERANCE_MRAD ) )
+			{
+				ulConfirmations++;
+			}
+			else
+			{
+				ulConfirmations = 0UL;
+			}
+
+			prvSetHeadingInState( sumoSTATE_SEARCH, 0L, xEstimate.lHeading );
+		}
+		else
+		{
+			ulConfirmations = 0UL;
+			LPC_GPIO2->FIOCLR = sumoOPPONENT_LED_MASK;
+
+			if( xSweeping == pdFALSE )
+			{
+				xSweeping = pdTRUE;
+				prvSetSpeedsInState( sumoSTATE_SEARCH, -lSweepDirection * sumoSEARCH_SPEED, lSweepDirection * sumoSEARCH_SPEED );
+			}
+		}
+
+		return ( ulConfirmations >= sumoOPPONENT_CONFIRMATIONS ) ? pdTRUE : pdFALSE;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvAttackStep( void )
+	{
+	xOpponentEstimate xEstimate;
+	int32_t lError;
+
+		vOpponentTrackerGetEstimate( &xEstimate );
+
+		/* Only steer to a sighting made in this step. */
+		if( ( xEstimate.ucChannels & sumoFRONT_CHANNELS ) != 0U )
+		{
+			lError = xEstimate.lHeading - lMotorControlGetHeading();
+
+			if( ( lError < sumoATTACK_STEER_MRAD ) && ( lError > -sumoATTACK_STEER_MRAD ) )
+			{
+				prvSetHeadingInState( sumoSTATE_ATTACK, sumoATTACK_SPEED, xEstimate.lHeading );
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSetHeadingInState( uint8_t ucInState, int32_t lMMPerSecond, int32_t lHeading )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( ucState == ucInState )
+			{
+				vMotorControlSetHeading( lMMPerSecond, lHeading );
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSetSpeedsInState( uint8_t ucInState, int32_t lLeftMMPerSecond, int32_t lRightMMPerSecond )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( ucState == ucInState )
+			{
+				vMotorControlSetSpeeds( lLeftMMPerSecond, lRightMMPerSecond );
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+#else
+
+	static portBASE_TYPE prvSearchStep( void )
+	{
+	int32_t lDifference;
+
+		lDifference = ( int32_t ) usADCSamplerGetAverage( sumoSEARCH_CHANNEL ) - lSearchBaseline;
+		ulSearchSteps++;
+
+		if( lDifference >= sumoOPPONENT_THRESHOLD )
+		{
+			ulConfirmations++;
+		}
+		else
+		{
+			ulConfirmations = 0UL;
+
+			if( lDifference < sumoOPPONENT_LOST_THRESHOLD )
+			{
+				LPC_GPIO2->FIOCLR = sumoOPPONENT_LED_MASK;
+			}
+		}
+
+		return ( ulConfirmations >= sumoOPPONENT_CONFIRMATIONS ) ? pdTRUE : pdFALSE;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* sumoUSE_OPPONENT_TRACKER */
+
+static portBASE_TYPE prvSumoStatsCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+{
+static xSumoStats xSnapshot;
+static uint32_t ulLine = 0UL;
+portBASE_TYPE xReturn = pdTRUE;
+
+	( void ) xWriteBufferLen;
+	( void ) pcCommandString;
+
+	if( ulLine == 0UL )
+	{
+		/* Every line comes from the same copy of the statistics. */
+		vSumoGetStats( &xSnapshot );
+
+		sprintf( ( char * ) pcWriteBuffer, "%u edge events, %u events lost\r\nEdge to reverse (us)       Last        Min        Max   Failures\r\n",
+				( unsigned int ) xSnapshot.ulEdgeEvents, ( unsigned int ) xSnapshot.ulEventsLost );
+	}
+	else if( ulLine == 1UL )
+	{
+		sprintf( ( char * ) pcWriteBuffer, "state machine        %10u %10u %10u %10u\r\n",
+				( unsigned int ) xSnapshot.ulLastEdgeToReverseMicroseconds,
+				( unsigned int ) ( ( xSnapshot.ulEdgeEvents != 0UL ) ? xSnapshot.ulMinEdgeToReverseMicroseconds : 0UL ),
+				( unsigned int ) xSnapshot.ulMaxEdgeToReverseMicroseconds, 0U );
+	}
+	else if( ulLine == 2UL )
+	{
+		#if( sumoMEASURE_TASK_SPAWN_LATENCY == 1 )
+		{
+			sprintf( ( char * ) pcWriteBuffer, "task spawn           %10u %10u %10u %10u\r\n",
+					( unsigned int ) xSnapshot.ulLastTaskSpawnMicroseconds,
+					( unsigned int ) ( ( xSnapshot.ulTaskSpawns != 0UL ) ? xSnapshot.ulMinTaskSpawnMicroseconds : 0UL ),
+					( unsigned int ) xSnapshot.ulMaxTaskSpawnMicroseconds,
+					( unsigned int ) xSnapshot.ulTaskSpawnFailures );
+		}
+		#else
+		{
+			sprintf( ( char * ) pcWriteBuffer, "task spawn           not measured, build with sumoMEASURE_TASK_SPAWN_LATENCY set to 1\r\n" );
+		}
+		#endif
+	}
+	else
+	{
+		sprintf( ( char * ) pcWriteBuffer, "%u searches found the opponent, %u gave up, %u ms mean %u ms worst time to acquire\r\n",
+				( unsigned int ) xSnapshot.ulAcquisitions, ( unsigned int ) xSnapshot.ulSearchTimeouts,
+				( unsigned int ) ( ( xSnapshot.ulAcquisitions != 0UL ) ? ( xSnapshot.ulTotalAcquireMicroseconds / xSnapshot.ulAcquisitions / 1000UL ) : 0UL ),
+				( unsigned int ) ( xSnapshot.ulMaxAcquireMicroseconds / 1000UL ) );
+
+		xReturn = pdFALSE;
+	}
+
+	if( xReturn == pdFALSE )
+	{
+		ulLine = 0UL;
+	}
+	else
+	{
+		ulLine++;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if( sumoMEASURE_TASK_SPAWN_LATENCY == 1 )
+
+	static void prvMeasureTaskSpawnLatency( const xEscapeStep *pxStep )
+	{
+		/* The created task has a higher priority than this one, so runs, and
+		deletes itself, before xTaskCreate() returns.  Its stack is allocated
+		from the heap, and is the same size as the stacks given to the edge
+		handling tasks that used to be created.  The idle task frees it. */
+		ulSpawnStart = ulTimebaseMicroseconds();
+
+		/* A failed allocation calls vApplicationMallocFailedHook(), which
+		stops everything, so the task is not created unless the heap can hold
+		it.  It may not if the idle task has not yet freed the last one. */
+		if( ( xPortGetFreeHeapSize() < ( ( sumoSPAWNED_TASK_STACK_SIZE * sizeof( portSTACK_TYPE ) ) + sumoSPAWNED_TASK_HEAP_MARGIN ) ) ||
+			( xTaskCreate( prvSpawnedTask, ( signed char * ) "Spawn", sumoSPAWNED_TASK_STACK_SIZE, ( void * ) pxStep, sumoTASK_PRIORITY + 1, NULL ) != pdPASS ) )
+		{
+			/* The old approach would not have reversed at all. */
+			taskENTER_CRITICAL();
+			{
+				xStats.ulTaskSpawnFailures++;
+			}
+			taskEXIT_CRITICAL();
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSpawnedTask( void *pvParameters )
+	{
+	const xEscapeStep *pxStep = ( const xEscapeStep * ) pvParameters;
+	uint32_t ulLatency;
+
+		/* The speeds the state machine has just set, so the escape is not
+		disturbed. */
+		vMotorControlSetSpeeds( pxStep->sLeftSpeed, pxStep->sRightSpeed );
+		ulLatency = ulSpawnDispatch + ( ulTimebaseMicroseconds() - ulSpawnStart );
+
+		taskENTER_CRITICAL();
+		{
+			xStats.ulTaskSpawns++;
+			xStats.ulLastTaskSpawnMicroseconds = ulLatency;
+
+			if( ulLatency < xStats.ulMinTaskSpawnMicroseconds )
+			{
+				xStats.ulMinTaskSpawnMicroseconds = ulLatency;
+			}
+
+			if( ulLatency > xStats.ulMaxTaskSpawnMicroseconds )
+			{
+				xStats.ulMaxTaskSpawnMicroseconds = ulLatency;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		#if configUSE_STACK_MONITOR == 1
+			/* The task may be gone before the stack monitor next looks. */
+			vStackMonitorCheck();
+		#endif
+
+		vTaskDelete( NULL );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* sumoMEASURE_TASK_SPAWN_LATENCY */
+
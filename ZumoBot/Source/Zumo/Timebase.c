@@ -0,0 +1,34 @@
+/*
+ * Free running microsecond counter.  See Timebase.h.
+ */
+
+/* Library includes. */
+#include "LPC17xx.h"
+#include "lpc17xx_timer.h"
+
+/* Zumo includes. */
+#include "Timebase.h"
+
+/*-----------------------------------------------------------*/
+
+void vTimebaseStart( void )
+{
+TIM_TIMERCFG_Type xTimerConfig;
+
+	/* main() starts the timer before the scheduler, and the kernel calls this
+	again through portCONFIGURE_TIMER_FOR_RUN_TIME_STATS().  TIM_Init() resets
+	the counter, so leave a running timer alone. */
+	if( ( LPC_TIM0->TCR & TIM_ENABLE ) != 0UL )
+	{
+		return;
+	}
+
+	/* No match channels are used and the timer interrupt is never enabled,
+	TIMER0 just counts. */
+	xTimerConfig.PrescaleOption = TIM_PRESCALE_USVAL;
+	xTimerConfig.PrescaleValue = 1UL;
+	TIM_Init( LPC_TIM0, TIM_TIMER_MODE, &xTimerConfig );
+
+	TIM_Cmd( LPC_TIM0, ENABLE );
+}
+/*-----------------------------------------------------------*/
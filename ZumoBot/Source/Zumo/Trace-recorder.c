@@ -0,0 +1,321 @@
+/*
+ * Recorder of the kernel trace hooks.  See Trace-recorder.h.  Compiled to
+ * nothing unless configUSE_TRACE_RECORDER is set to 1.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if configUSE_TRACE_RECORDER == 1
+
+/* Library includes. */
+#include "LPC17xx.h"
+
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+
+/* Zumo includes. */
+#include "Cycle-counter.h"
+#include "Trace-recorder.h"
+
+/*-----------------------------------------------------------*/
+
+/* One event. */
+typedef struct xTRACE_RECORD
+{
+	uint32_t ulCycles;
+	uint8_t ucEvent;
+	uint8_t ucTask;
+	uint16_t usObject;
+} xTraceRecord;
+
+/* A task, as named in the output. */
+typedef struct xTRACE_TASK
+{
+	uint8_t ucNumber;
+	uint8_t ucPriority;
+	char cName[ configMAX_TASK_NAME_LEN ];
+} xTraceTask;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Mask the interrupts that use the kernel, returning the mask to restore
+ * with prvRestoreInterrupts().  Unlike portSET_INTERRUPT_MASK_FROM_ISR() and
+ * portCLEAR_INTERRUPT_MASK_FROM_ISR(), which unmask every interrupt, these
+ * nest, so can be used inside the critical sections the hooks are called
+ * from.
+ */
+static uint32_t prvMaskInterrupts( void );
+static void prvRestoreInterrupts( uint32_t ulMask );
+
+/*
+ * Add a record to the buffer, if recording.
+ */
+static void prvRecord( uint32_t ulEvent, uint32_t ulTask, uint32_t ulObject );
+
+/*
+ * Implements the "trace" command.  Outputs one line per call.
+ */
+static portBASE_TYPE prvTraceCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString );
+
+/*-----------------------------------------------------------*/
+
+static const xCommandLineInput xTraceCommand =
+{
+	( const int8_t * const ) "trace",
+	( const int8_t * const ) "trace: Writes out the recorded kernel events as hex, for the tracejson tool, and starts recording again\r\n",
+	prvTraceCommand,
+	0
+};
+
+static xTraceRecord xRecords[ tracerecorderRECORDS ];
+
+/* The next record goes in xRecords[ ulNextRecord ].  ulRecorded counts the
+records made since the buffer was last cleared, and ulFull is set once the
+oldest are being overwritten. */
+static uint32_t ulNextRecord = 0UL;
+static uint32_t ulRecorded = 0UL;
+static uint32_t ulFull = pdFALSE;
+
+/* Events are only recorded while set. */
+static volatile uint32_t ulRecording = pdFALSE;
+
+/* The number of the task running, set by each switch. */
+static uint8_t ucRunningTask = 0U;
+
+/* The tasks and queues created, whether recording or not. */
+static xTraceTask xTasks[ tracerecorderMAX_TASKS ];
+static uint32_t ulNumTasks = 0UL;
+static uint8_t ucQueueTypes[ tracerecorderMAX_QUEUES ];
+static uint32_t ulNumQueues = 0UL;
+
+/*-----------------------------------------------------------*/
+
+void vTraceRecorderStart( void )
+{
+	vCycleCounterEnable();
+	FreeRTOS_CLIRegisterCommand( &xTraceCommand );
+
+	ulNextRecord = 0UL;
+	ulRecorded = 0UL;
+	ulFull = pdFALSE;
+	ulRecording = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vTraceRecorderTaskEvent( uint32_t ulEvent, uint32_t ulTask, uint32_t ulObject )
+{
+	if( ulEvent == tracerecorderSWITCHED_IN )
+	{
+		ucRunningTask = ( uint8_t ) ulTask;
+	}
+
+	prvRecord( ulEvent, ulTask, ulObject );
+}
+/*-----------------------------------------------------------*/
+
+void vTraceRecorderEvent( uint32_t ulEvent, uint32_t ulObject )
+{
+	prvRecord( ulEvent, ucRunningTask, ulObject );
+}
+/*-----------------------------------------------------------*/
+
+void vTraceRecorderTaskCreated( uint32_t ulTask, uint32_t ulPriority, const signed char *pcName )
+{
+	/* Called from inside a critical section. */
+	if( ulNumTasks < tracerecorderMAX_TASKS )
+	{
+		xTasks[ ulNumTasks ].ucNumber = ( uint8_t ) ulTask;
+		xTasks[ ulNumTasks ].ucPriority = ( uint8_t ) ulPriority;
+		strncpy( xTasks[ ulNumTasks ].cName, ( const char * ) pcName, configMAX_TASK_NAME_LEN );
+		xTasks[ ulNumTasks ].cName[ configMAX_TASK_NAME_LEN - 1 ] = '\0';
+		ulNumTasks++;
+	}
+
+	prvRecord( tracerecorderTASK_CREATE, ulTask, ulPriority );
+}
+/*-----------------------------------------------------------*/
+
+uint8_t ucTraceRecorderQueueCreated( uint32_t ulType )
+{
+uint8_t ucNumber;
+uint32_t ulMask;
+
+	/* Queues can be created from more than one task, and the kernel does not
+	hold a critical section around the hook. */
+	ulMask = prvMaskInterrupts();
+	{
+		if( ulNumQueues < tracerecorderMAX_QUEUES )
+		{
+			ucQueueTypes[ ulNumQueues ] = ( uint8_t ) ulType;
+		}
+
+		ulNumQueues++;
+		ucNumber = ( uint8_t ) ulNumQueues;
+	}
+	prvRestoreInterrupts( ulMask );
+
+	prvRecord( tracerecorderQUEUE_CREATE, ucRunningTask, ( ulType << 8UL ) | ucNumber );
+
+	return ucNumber;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecord( uint32_t ulEvent, uint32_t ulTask, uint32_t ulObject )
+{
+xTraceRecord *pxRecord;
+uint32_t ulMask;
+
+	if( ulRecording != pdFALSE )
+	{
+		/* Most hooks are already inside a critical section or the PendSV
+		handler, but not all, and interrupts record too. */
+		ulMask = prvMaskInterrupts();
+		{
+			pxRecord = &( xRecords[ ulNextRecord ] );
+			pxRecord->ulCycles = ulCycleCounterRead();
+			pxRecord->ucEvent = ( uint8_t ) ulEvent;
+			pxRecord->ucTask = ( uint8_t ) ulTask;
+			pxRecord->usObject = ( uint16_t ) ulObject;
+
+			ulNextRecord++;
+			if( ulNextRecord >= tracerecorderRECORDS )
+			{
+				ulNextRecord = 0UL;
+				ulFull = pdTRUE;
+			}
+
+			ulRecorded++;
+		}
+		prvRestoreInterrupts( ulMask );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvMaskInterrupts( void )
+{
+uint32_t ulMask;
+
+	ulMask = __get_BASEPRI();
+	portDISABLE_INTERRUPTS();
+
+	return ulMask;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRestoreInterrupts( uint32_t ulMask )
+{
+	__set_BASEPRI( ulMask );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulTraceRecorderWriteLine( char *pcBuffer, uint32_t ulLine )
+{
+static uint32_t ulFirst, ulKept, ulQueuesNamed;
+uint32_t ulRecord, ulLast, ulReturn = 1UL;
+const xTraceRecord *pxRecord;
+char *pcNext;
+
+	if( ulLine == 0UL )
+	{
+		/* The buffer must not change while it is written out.  Any events
+		until recording starts again are lost. */
+		ulRecording = pdFALSE;
+
+		if( ulFull != pdFALSE )
+		{
+			ulFirst = ulNextRecord;
+			ulKept = tracerecorderRECORDS;
+		}
+		else
+		{
+			ulFirst = 0UL;
+			ulKept = ulNextRecord;
+		}
+
+		ulQueuesNamed = ulNumQueues;
+		if( ulQueuesNamed > tracerecorderMAX_QUEUES )
+		{
+			ulQueuesNamed = tracerecorderMAX_QUEUES;
+		}
+
+		sprintf( pcBuffer, "trace %u %u %u\r\n", ( unsigned int ) configCPU_CLOCK_HZ, ( unsigned int ) ulRecorded, ( unsigned int ) ulKept );
+	}
+	else if( ulLine <= ulNumTasks )
+	{
+		ulLine -= 1UL;
+		sprintf( pcBuffer, "task %u %u %s\r\n", ( unsigned int ) xTasks[ ulLine ].ucNumber, ( unsigned int ) xTasks[ ulLine ].ucPriority, xTasks[ ulLine ].cName );
+	}
+	else if( ulLine <= ( ulNumTasks + ulQueuesNamed ) )
+	{
+		ulLine -= ( ulNumTasks + 1UL );
+		sprintf( pcBuffer, "queue %u %u\r\n", ( unsigned int ) ( ulLine + 1UL ), ( unsigned int ) ucQueueTypes[ ulLine ] );
+	}
+	else
+	{
+		ulRecord = ( ulLine - ( ulNumTasks + ulQueuesNamed + 1UL ) ) * tracerecorderRECORDS_PER_LINE;
+
+		if( ulRecord < ulKept )
+		{
+			ulLast = ulRecord + tracerecorderRECORDS_PER_LINE;
+			if( ulLast > ulKept )
+			{
+				ulLast = ulKept;
+			}
+
+			pcNext = pcBuffer + sprintf( pcBuffer, "rec " );
+
+			for( ; ulRecord < ulLast; ulRecord++ )
+			{
+				pxRecord = &( xRecords[ ( ulFirst + ulRecord ) % tracerecorderRECORDS ] );
+				pcNext += sprintf( pcNext, "%08x%02x%02x%04x", ( unsigned int ) pxRecord->ulCycles, ( unsigned int ) pxRecord->ucEvent, ( unsigned int ) pxRecord->ucTask, ( unsigned int ) pxRecord->usObject );
+			}
+
+			sprintf( pcNext, "\r\n" );
+		}
+		else
+		{
+			sprintf( pcBuffer, "end\r\n" );
+
+			ulNextRecord = 0UL;
+			ulRecorded = 0UL;
+			ulFull = pdFALSE;
+			ulRecording = pdTRUE;
+			ulReturn = 0UL;
+		}
+	}
+
+	return ulReturn;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvTraceCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
+{
+static uint32_t ulLine = 0UL;
+portBASE_TYPE xReturn;
+
+	( void ) xWriteBufferLen;
+	( void ) pcCommandString;
+
+	if( ulTraceRecorderWriteLine( ( char * ) pcWriteBuffer, ulLine ) != 0UL )
+	{
+		ulLine++;
+		xReturn = pdTRUE;
+	}
+	else
+	{
+		ulLine = 0UL;
+		xReturn = pdFALSE;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_TRACE_RECORDER */